@@ -37,6 +37,7 @@ LOCAL_SRC_FILES  := \
     src/graph_module.c\
     src/metadata.c\
     src/session_obj.c\
+    src/session_table.c\
     src/device.c \
     src/utils.c \
     src/device_hw_ep.c
@@ -34,6 +34,7 @@
 #include <agm/agm_priv.h>
 
 struct agm_meta_data_gsl* metadata_merge(int num, ...);
+void metadata_merged_free(struct agm_meta_data_gsl *merged);
 int metadata_copy(struct agm_meta_data_gsl *dest, uint32_t size, uint8_t *payload);
 void metadata_free(struct agm_meta_data_gsl *metadata);
 void metadata_update_cal(struct agm_meta_data_gsl *meta_data,
@@ -38,6 +38,7 @@
 #include <agm/agm_priv.h>
 #include <agm/metadata.h>
 #include <agm/graph.h>
+#include <agm/session_table.h>
 
 enum aif_state {
     AIF_CLOSED,
@@ -102,6 +103,9 @@ struct session_obj {
 
 struct session_pool {
     struct listnode session_list;
+    /* lock free lookups by session id and handle */
+    struct session_table table;
+    /* serializes session creation and teardown */
     pthread_mutex_t lock;
 };
 
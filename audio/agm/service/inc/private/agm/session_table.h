@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef _SESSION_TABLE_H_
+#define _SESSION_TABLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/*
+ * Open addressed hash tables indexing session objects by session id and by
+ * object address. Entries are never removed, so lookups run without locks:
+ * a slot is written once and published with a release store, and a full
+ * table is replaced by a larger copy while the old one is kept until
+ * session_table_deinit(). Adding entries must be serialized by the caller.
+ */
+struct session_table_slot {
+    uint32_t id;
+    _Atomic(void *) obj;
+};
+
+struct session_table_buckets {
+    uint32_t mask;
+    /* keyed by session id */
+    struct session_table_slot *id_slots;
+    /* keyed by object address, to validate handles */
+    _Atomic(void *) *obj_slots;
+    /* previous, smaller generation, freed at deinit */
+    struct session_table_buckets *retired;
+};
+
+struct session_table {
+    _Atomic(struct session_table_buckets *) buckets;
+    uint32_t count;
+};
+
+int session_table_init(struct session_table *tbl);
+void session_table_deinit(struct session_table *tbl);
+int session_table_add(struct session_table *tbl, uint32_t id, void *obj);
+void *session_table_find(struct session_table *tbl, uint32_t id);
+bool session_table_contains(struct session_table *tbl, const void *obj);
+
+#endif /* _SESSION_TABLE_H_ */
@@ -104,58 +104,68 @@ void metadata_print(struct agm_meta_data_gsl* metadata)
 
 }
 
-static void metadata_remove_dup(
-       struct agm_meta_data_gsl* meta_data) {
+#define KEY_HASH_SLOTS 128
 
-    int i, j, k, count;
+static uint32_t key_hash(uint32_t key)
+{
+    return key * 0x9E3779B1U;
+}
 
-    //remove duplicate gkvs
-    count = meta_data->gkv.num_kvs;
-    for (i = 0; i < count; i++) {
-        for (j = i + 1; j < count; j++) {
-            if (meta_data->gkv.kv[i].key == meta_data->gkv.kv[j].key) {
-                for (k = j; k < count-1; k++) {
-                    meta_data->gkv.kv[k].key = meta_data->gkv.kv[k + 1].key;
-                    meta_data->gkv.kv[k].value = meta_data->gkv.kv[k + 1].value;
-                }
-                count--;
-                j--;
-            }
-        }
-    }
-    meta_data->gkv.num_kvs = count;
+/*
+ * Compacts kv[] in place to the first occurrence of every key, in their
+ * original order, with one probe of an open addressed set per entry. The
+ * set holds 1 + the output position of each kept key, 0 marks a free slot.
+ * count is bounded by MAX_KVPAIR_PROPS, so the set stays at most 3/8 full.
+ */
+static uint32_t kv_remove_dup(struct agm_key_value *kv, uint32_t count)
+{
+    uint8_t slots[KEY_HASH_SLOTS];
+    uint32_t i, h, num = 0;
 
-    //remove duplicate ckvs
-    count = meta_data->ckv.num_kvs;
+    memset(slots, 0, sizeof(slots));
     for (i = 0; i < count; i++) {
-        for (j = i + 1; j < count; j++) {
-            if (meta_data->ckv.kv[i].key == meta_data->ckv.kv[j].key) {
-                for (k = j; k < count-1; k++) {
-                    meta_data->ckv.kv[k].key = meta_data->ckv.kv[k + 1].key;
-                    meta_data->ckv.kv[k].value = meta_data->ckv.kv[k + 1].value;
-                }
-                count--;
-                j--;
-            }
-        }
+        for (h = key_hash(kv[i].key) & (KEY_HASH_SLOTS - 1);
+             slots[h] && kv[slots[h] - 1].key != kv[i].key;
+             h = (h + 1) & (KEY_HASH_SLOTS - 1))
+            ;
+        if (slots[h])
+            continue;
+        kv[num++] = kv[i];
+        slots[h] = num;
     }
-    meta_data->ckv.num_kvs = count;
 
-    //remove duplicate props
-    count = meta_data->sg_props.num_values;
+    return num;
+}
+
+static uint32_t props_remove_dup(uint32_t *values, uint32_t count)
+{
+    uint8_t slots[KEY_HASH_SLOTS];
+    uint32_t i, h, num = 0;
+
+    memset(slots, 0, sizeof(slots));
     for (i = 0; i < count; i++) {
-        for (j = i + 1; j < count; j++) {
-            if (meta_data->sg_props.values[i] == meta_data->sg_props.values[j]) {
-                for (k = j; k < count-1; k++) {
-                    meta_data->sg_props.values[k] =
-                        meta_data->sg_props.values[k+1];
-                }
-                count--;
-                j--;
-            }
-        }
+        for (h = key_hash(values[i]) & (KEY_HASH_SLOTS - 1);
+             slots[h] && values[slots[h] - 1] != values[i];
+             h = (h + 1) & (KEY_HASH_SLOTS - 1))
+            ;
+        if (slots[h])
+            continue;
+        values[num++] = values[i];
+        slots[h] = num;
     }
-    meta_data->sg_props.num_values = count;
+
+    return num;
+}
+
+static void metadata_remove_dup(
+       struct agm_meta_data_gsl* meta_data) {
+
+    meta_data->gkv.num_kvs = kv_remove_dup(meta_data->gkv.kv,
+                                           meta_data->gkv.num_kvs);
+    meta_data->ckv.num_kvs = kv_remove_dup(meta_data->ckv.kv,
+                                           meta_data->ckv.num_kvs);
+    meta_data->sg_props.num_values = props_remove_dup(meta_data->sg_props.values,
+                                           meta_data->sg_props.num_values);
 
     //metadata_print(meta_data);
 }
@@ -163,7 +173,9 @@ static void metadata_remove_dup(
 void metadata_update_cal(struct agm_meta_data_gsl *meta_data,
                                      struct agm_key_vector_gsl *ckv)
 {
-    int i, j;
+    uint32_t stack_slots[KEY_HASH_SLOTS];
+    uint32_t *slots = stack_slots;
+    uint32_t i, j, mask, size = 1;
 
     if (!meta_data || !ckv) {
         AGM_LOGE("Invalid params\n");
@@ -181,76 +193,97 @@ void metadata_update_cal(struct agm_meta_data_gsl *meta_data,
         return;
     }
 
-    for (i = 0; i < meta_data->ckv.num_kvs; i++) {
-        for (j = 0; j < ckv->num_kvs; j++) {
-            if (meta_data->ckv.kv[i].key == ckv->kv[j].key) {
-                meta_data->ckv.kv[i].value = ckv->kv[j].value;
+    if (!meta_data->ckv.num_kvs || !ckv->num_kvs)
+        return;
+
+    /*
+     * Open addressed table of 1 + position in ckv, 0 marks a free slot.
+     * A later ckv entry replaces an earlier one with the same key, so the
+     * last value of a key wins as it did with the pairwise search.
+     */
+    while (size < ckv->num_kvs * 2)
+        size <<= 1;
+    if (size > KEY_HASH_SLOTS) {
+        slots = calloc(size, sizeof(uint32_t));
+        if (!slots) {
+            AGM_LOGE("No memory to update %d ckvs\n", ckv->num_kvs);
+            return;
+        }
+    } else {
+        memset(slots, 0, size * sizeof(uint32_t));
+    }
+    mask = size - 1;
+
+    for (j = 0; j < ckv->num_kvs; j++) {
+        for (i = key_hash(ckv->kv[j].key) & mask;
+             slots[i] && ckv->kv[slots[i] - 1].key != ckv->kv[j].key;
+             i = (i + 1) & mask)
+            ;
+        slots[i] = j + 1;
+    }
+
+    for (j = 0; j < meta_data->ckv.num_kvs; j++) {
+        for (i = key_hash(meta_data->ckv.kv[j].key) & mask; slots[i];
+             i = (i + 1) & mask) {
+            if (ckv->kv[slots[i] - 1].key == meta_data->ckv.kv[j].key) {
+                meta_data->ckv.kv[j].value = ckv->kv[slots[i] - 1].value;
+                break;
             }
         }
     }
+
+    if (slots != stack_slots)
+        free(slots);
 }
 
+/*
+ * The merged metadata and its key and property arrays share one allocation,
+ * laid out as struct agm_meta_data_gsl, gkv[], ckv[], props[]. Release it
+ * with metadata_merged_free().
+ */
 struct agm_meta_data_gsl* metadata_merge(int num, ...)
 {
     struct agm_key_value *gkv_offset;
     struct agm_key_value *ckv_offset;
     uint32_t *prop_offset;
     struct agm_meta_data_gsl *temp, *merged = NULL;
+    size_t num_gkv = 0, num_ckv = 0, num_props = 0;
 
     va_list valist;
     int i = 0;
 
-
-    merged = calloc(1, sizeof(struct agm_meta_data_gsl));
-    if (!merged) {
-        AGM_LOGE("No memory to create merged metadata\n");
-        return NULL;
-    }
-
-
     va_start(valist, num);
     for (i = 0; i < num; i++) {
         temp = va_arg(valist, struct agm_meta_data_gsl*);
         if (temp) {
-            merged->gkv.num_kvs += temp->gkv.num_kvs;
-            merged->ckv.num_kvs += temp->ckv.num_kvs;
-            merged->sg_props.num_values += temp->sg_props.num_values;
+            num_gkv += temp->gkv.num_kvs;
+            num_ckv += temp->ckv.num_kvs;
+            num_props += temp->sg_props.num_values;
         }
     }
     va_end(valist);
 
-    if ((merged->gkv.num_kvs > MAX_KVPAIR_PROPS) || (merged->ckv.num_kvs > MAX_KVPAIR_PROPS)
-                                             || (merged->sg_props.num_values > MAX_KVPAIR_PROPS)) {
-        AGM_LOGE("Num GKVs %d Num CKVs %d Num Props %d more than expected: %d", merged->gkv.num_kvs,
-                                merged->ckv.num_kvs, merged->sg_props.num_values, MAX_KVPAIR_PROPS);
-        free(merged);
+    if ((num_gkv > MAX_KVPAIR_PROPS) || (num_ckv > MAX_KVPAIR_PROPS)
+                                     || (num_props > MAX_KVPAIR_PROPS)) {
+        AGM_LOGE("Num GKVs %zu Num CKVs %zu Num Props %zu more than expected: %d", num_gkv,
+                                num_ckv, num_props, MAX_KVPAIR_PROPS);
         return NULL;
     }
 
-    merged->gkv.kv = calloc(merged->gkv.num_kvs, sizeof(struct agm_key_value));
-    if (!merged->gkv.kv) {
-        AGM_LOGE("No memory to merge gkv\n");
-        free(merged);
-        return NULL;
-    }
-
-    merged->ckv.kv = calloc(merged->ckv.num_kvs, sizeof(struct agm_key_value));
-    if (!merged->ckv.kv) {
-        AGM_LOGE("No memory to merge ckv\n");
-        free(merged->gkv.kv);
-        free(merged);
+    merged = calloc(1, sizeof(struct agm_meta_data_gsl) +
+                       (num_gkv + num_ckv) * sizeof(struct agm_key_value) +
+                       num_props * sizeof(uint32_t));
+    if (!merged) {
+        AGM_LOGE("No memory to create merged metadata\n");
         return NULL;
     }
 
-    merged->sg_props.values = calloc(merged->sg_props.num_values,
-                                               sizeof(uint32_t));
-    if (!merged->sg_props.values) {
-        AGM_LOGE("No memory to merge properties\n");
-        free(merged->gkv.kv);
-        free(merged->ckv.kv);
-        free(merged);
-        return NULL;
-    }
+    merged->gkv.num_kvs = num_gkv;
+    merged->gkv.kv = (struct agm_key_value *)(merged + 1);
+    merged->ckv.num_kvs = num_ckv;
+    merged->ckv.kv = merged->gkv.kv + num_gkv;
+    merged->sg_props.num_values = num_props;
+    merged->sg_props.values = (uint32_t *)(merged->ckv.kv + num_ckv);
 
     gkv_offset = merged->gkv.kv;
     ckv_offset = merged->ckv.kv;
@@ -287,6 +320,11 @@ struct agm_meta_data_gsl* metadata_merge(int num, ...)
     return merged;
 }
 
+void metadata_merged_free(struct agm_meta_data_gsl *merged)
+{
+    free(merged);
+}
+
 int metadata_copy(struct agm_meta_data_gsl *dest, uint32_t size,
                                               uint8_t *metadata)
 {
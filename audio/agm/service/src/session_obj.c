@@ -161,8 +161,7 @@ static struct agm_meta_data_gsl* session_get_merged_metadata(struct session_obj
                            &aif_node->sess_aif_meta, &aif_node->dev_obj->metadata);
             pthread_mutex_unlock(&aif_node->dev_obj->lock);
             if (temp) {
-                metadata_free(temp);
-                free(temp);
+                metadata_merged_free(temp);
             }
             temp = merged;
         }
@@ -189,8 +188,7 @@ static struct agm_meta_data_gsl* session_get_merged_metadata_without_aif(struct
         merged = metadata_merge(3, temp, &sess_obj->sess_meta,
                                     &aif_node->sess_aif_meta);
         if (temp) {
-            metadata_free(temp);
-            free(temp);
+            metadata_merged_free(temp);
         }
         temp = merged;
     }
@@ -208,6 +206,13 @@ static int session_pool_init()
         goto done;
     }
     list_init(&sess_pool->session_list);
+    ret = session_table_init(&sess_pool->table);
+    if (ret) {
+        AGM_LOGE("No Memory to create session table\n");
+        free(sess_pool);
+        sess_pool = NULL;
+        goto done;
+    }
     pthread_mutex_init(&sess_pool->lock, (const pthread_mutexattr_t *) NULL);
 
 done:
@@ -276,6 +281,7 @@ static void session_pool_free()
         list_remove(&sess_obj->node);
         sess_obj_free(sess_obj);
     }
+    session_table_deinit(&sess_pool->table);
     pthread_mutex_unlock(&sess_pool->lock);
     free(sess_pool);
 }
@@ -301,36 +307,20 @@ static struct session_obj* session_obj_create(int session_id)
 
 struct session_obj *session_obj_retrieve_from_pool(uint32_t session_id)
 {
-    struct session_obj *obj = NULL;
-    struct listnode *node;
-
-    pthread_mutex_lock(&sess_pool->lock);
-    list_for_each(node, &sess_pool->session_list) {
-        obj = node_to_item(node, struct session_obj, node);
-        if (obj->sess_id == session_id)
-            break;
-        else
-            obj = NULL;
-    }
-    pthread_mutex_unlock(&sess_pool->lock);
-
-    return obj;
+    return session_table_find(&sess_pool->table, session_id);
 }
 
 struct session_obj *session_obj_get_from_pool(uint32_t session_id)
 {
     struct session_obj *obj = NULL;
-    struct listnode *node;
 
-    pthread_mutex_lock(&sess_pool->lock);
-    list_for_each(node, &sess_pool->session_list) {
-        obj = node_to_item(node, struct session_obj, node);
-        if (obj->sess_id == session_id)
-            break;
-        else
-            obj = NULL;
-    }
+    obj = session_table_find(&sess_pool->table, session_id);
+    if (obj)
+        return obj;
 
+    pthread_mutex_lock(&sess_pool->lock);
+    /* another thread may have created it since the lookup above */
+    obj = session_table_find(&sess_pool->table, session_id);
     if (!obj) {
         //AGM_LOGE("Couldnt find a session object in the list,
         //                             creating one\n");
@@ -339,6 +329,12 @@ struct session_obj *session_obj_get_from_pool(uint32_t session_id)
             AGM_LOGE("Couldnt create a session object\n");
             goto done;
         }
+        if (session_table_add(&sess_pool->table, session_id, obj)) {
+            AGM_LOGE("Couldnt add session object to the table\n");
+            sess_obj_free(obj);
+            obj = NULL;
+            goto done;
+        }
         list_add_tail(&sess_pool->session_list, &obj->node);
     }
 
@@ -346,22 +342,10 @@ done:
     pthread_mutex_unlock(&sess_pool->lock);
     return obj;
 }
+
 int session_obj_valid_check(uint64_t hndl)
 {
-
-    struct session_obj *obj = NULL;
-    struct listnode *node;
-
-    pthread_mutex_lock(&sess_pool->lock);
-    list_for_each(node, &sess_pool->session_list) {
-        obj = node_to_item(node, struct session_obj, node);
-        if (obj == hndl) {
-            pthread_mutex_unlock(&sess_pool->lock);
-            return  1;
-        }
-    }
-    pthread_mutex_unlock(&sess_pool->lock);
-    return 0;
+    return session_table_contains(&sess_pool->table, (void *)(uintptr_t)hndl) ? 1 : 0;
 }
 
 /* returns session_obj associated with session id */
@@ -444,16 +428,13 @@ static int session_set_loopback(struct session_obj *sess_obj,
 
 done:
     if (capture_metadata) {
-        metadata_free(capture_metadata);
-        free(capture_metadata);
+        metadata_merged_free(capture_metadata);
     }
     if (playback_metadata) {
-        metadata_free(playback_metadata);
-        free(playback_metadata);
+        metadata_merged_free(playback_metadata);
     }
     if (merged_metadata) {
-        metadata_free(merged_metadata);
-        free(merged_metadata);
+        metadata_merged_free(merged_metadata);
     }
     return ret;
 }
@@ -507,12 +488,10 @@ static int session_set_ec_ref(struct session_obj *sess_obj, uint32_t aif_id,
 
 done:
     if (capture_metadata) {
-        metadata_free(capture_metadata);
-        free(capture_metadata);
+        metadata_merged_free(capture_metadata);
     }
     if (merged_metadata) {
-        metadata_free(merged_metadata);
-        free(merged_metadata);
+        metadata_merged_free(merged_metadata);
     }
     return ret;
 }
@@ -585,13 +564,11 @@ static int session_disconnect_aif(struct session_obj *sess_obj,
 
 done:
     if (merged_meta_sess_aif) {
-        metadata_free(merged_meta_sess_aif);
-        free(merged_meta_sess_aif);
+        metadata_merged_free(merged_meta_sess_aif);
     }
 
     if (merged_metadata) {
-        metadata_free(merged_metadata);
-        free(merged_metadata);
+        metadata_merged_free(merged_metadata);
     }
     return ret;
 }
@@ -823,8 +800,7 @@ close_device:
 
 done:
     if (merged_metadata) {
-        metadata_free(merged_metadata);
-        free(merged_metadata);
+        metadata_merged_free(merged_metadata);
     }
 
     return ret;
@@ -1562,8 +1538,7 @@ int session_obj_set_sess_aif_params_with_tag(struct session_obj *sess_obj,
 
 done:
     if (merged_metadata) {
-        metadata_free(merged_metadata);
-        free(merged_metadata);
+        metadata_merged_free(merged_metadata);
     }
 
     pthread_mutex_unlock(&sess_obj->lock);
@@ -1640,8 +1615,7 @@ int session_obj_rw_acdb_params_with_tag(
 
 free_metadata:
     if (merged_metadata) {
-        metadata_free(merged_metadata);
-        free(merged_metadata);
+        metadata_merged_free(merged_metadata);
     }
 error:
     pthread_mutex_unlock(&sess_obj->lock);
@@ -1736,8 +1710,7 @@ int session_obj_set_sess_aif_cal(struct session_obj *sess_obj,
 
 done:
     if (merged_metadata) {
-        metadata_free(merged_metadata);
-        free(merged_metadata);
+        metadata_merged_free(merged_metadata);
     }
 
     pthread_mutex_unlock(&sess_obj->lock);
@@ -1850,8 +1823,7 @@ int session_obj_get_tag_with_module_info(struct session_obj *sess_obj,
 
 done:
     if (merged_metadata) {
-        metadata_free(merged_metadata);
-        free(merged_metadata);
+        metadata_merged_free(merged_metadata);
     }
 
     pthread_mutex_unlock(&sess_obj->lock);
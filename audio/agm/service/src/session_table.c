@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <agm/session_table.h>
+
+#define SESSION_TABLE_INIT_SIZE 64
+
+static uint32_t hash_id(uint32_t id)
+{
+    return id * 0x9E3779B1U;
+}
+
+static uint32_t hash_obj(const void *obj)
+{
+    uint64_t v = (uintptr_t)obj;
+
+    v = (v ^ (v >> 33)) * 0xFF51AFD7ED558CCDULL;
+    return (uint32_t)(v ^ (v >> 32));
+}
+
+static struct session_table_buckets *buckets_alloc(uint32_t size)
+{
+    struct session_table_buckets *b;
+
+    b = calloc(1, sizeof(struct session_table_buckets));
+    if (!b)
+        return NULL;
+
+    b->mask = size - 1;
+    b->id_slots = calloc(size, sizeof(struct session_table_slot));
+    b->obj_slots = calloc(size, sizeof(*b->obj_slots));
+    if (!b->id_slots || !b->obj_slots) {
+        free(b->id_slots);
+        free(b->obj_slots);
+        free(b);
+        return NULL;
+    }
+
+    return b;
+}
+
+static void buckets_insert(struct session_table_buckets *b, uint32_t id,
+                           void *obj)
+{
+    uint32_t i;
+
+    for (i = hash_id(id) & b->mask;
+         atomic_load_explicit(&b->id_slots[i].obj, memory_order_relaxed);
+         i = (i + 1) & b->mask)
+        ;
+    b->id_slots[i].id = id;
+    atomic_store_explicit(&b->id_slots[i].obj, obj, memory_order_release);
+
+    for (i = hash_obj(obj) & b->mask;
+         atomic_load_explicit(&b->obj_slots[i], memory_order_relaxed);
+         i = (i + 1) & b->mask)
+        ;
+    atomic_store_explicit(&b->obj_slots[i], obj, memory_order_release);
+}
+
+int session_table_init(struct session_table *tbl)
+{
+    struct session_table_buckets *b = buckets_alloc(SESSION_TABLE_INIT_SIZE);
+
+    if (!b)
+        return -ENOMEM;
+
+    tbl->count = 0;
+    atomic_init(&tbl->buckets, b);
+    return 0;
+}
+
+void session_table_deinit(struct session_table *tbl)
+{
+    struct session_table_buckets *b, *next;
+
+    b = atomic_load_explicit(&tbl->buckets, memory_order_relaxed);
+    atomic_store_explicit(&tbl->buckets, NULL, memory_order_relaxed);
+    for (; b; b = next) {
+        next = b->retired;
+        free(b->id_slots);
+        free(b->obj_slots);
+        free(b);
+    }
+    tbl->count = 0;
+}
+
+int session_table_add(struct session_table *tbl, uint32_t id, void *obj)
+{
+    struct session_table_buckets *b, *nb;
+    uint32_t i;
+
+    b = atomic_load_explicit(&tbl->buckets, memory_order_relaxed);
+    /* keep the load at most one half so probe sequences stay short */
+    if ((tbl->count + 1) * 2 > b->mask + 1) {
+        nb = buckets_alloc((b->mask + 1) * 2);
+        if (!nb)
+            return -ENOMEM;
+
+        for (i = 0; i <= b->mask; i++) {
+            void *cur = atomic_load_explicit(&b->id_slots[i].obj,
+                                             memory_order_relaxed);
+            if (cur)
+                buckets_insert(nb, b->id_slots[i].id, cur);
+        }
+        /* readers may still walk the old generation, keep it around */
+        nb->retired = b;
+        atomic_store_explicit(&tbl->buckets, nb, memory_order_release);
+        b = nb;
+    }
+
+    buckets_insert(b, id, obj);
+    tbl->count++;
+    return 0;
+}
+
+void *session_table_find(struct session_table *tbl, uint32_t id)
+{
+    struct session_table_buckets *b;
+    void *obj;
+    uint32_t i;
+
+    b = atomic_load_explicit(&tbl->buckets, memory_order_acquire);
+    for (i = hash_id(id) & b->mask;
+         (obj = atomic_load_explicit(&b->id_slots[i].obj,
+                                     memory_order_acquire)) != NULL;
+         i = (i + 1) & b->mask) {
+        if (b->id_slots[i].id == id)
+            return obj;
+    }
+
+    return NULL;
+}
+
+bool session_table_contains(struct session_table *tbl, const void *obj)
+{
+    struct session_table_buckets *b;
+    void *cur;
+    uint32_t i;
+
+    if (!obj)
+        return false;
+
+    b = atomic_load_explicit(&tbl->buckets, memory_order_acquire);
+    for (i = hash_obj(obj) & b->mask;
+         (cur = atomic_load_explicit(&b->obj_slots[i],
+                                     memory_order_acquire)) != NULL;
+         i = (i + 1) & b->mask) {
+        if (cur == obj)
+            return true;
+    }
+
+    return false;
+}
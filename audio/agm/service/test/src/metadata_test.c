@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <agm/metadata.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+typedef int(*testcase)(void);
+
+#define MAX_KVPAIR_PROPS 48
+#define NUM_ROUNDS       2000
+#define NUM_BENCH_ITERS  20000
+
+/* pairwise versions metadata.c used before, kept as reference */
+static void ref_remove_dup(struct agm_meta_data_gsl *meta_data)
+{
+	size_t i, j, k, count;
+	uint32_t n, m, l, num;
+
+	count = meta_data->gkv.num_kvs;
+	for (i = 0; i < count; i++) {
+		for (j = i + 1; j < count; j++) {
+			if (meta_data->gkv.kv[i].key == meta_data->gkv.kv[j].key) {
+				for (k = j; k < count - 1; k++)
+					meta_data->gkv.kv[k] = meta_data->gkv.kv[k + 1];
+				count--;
+				j--;
+			}
+		}
+	}
+	meta_data->gkv.num_kvs = count;
+
+	count = meta_data->ckv.num_kvs;
+	for (i = 0; i < count; i++) {
+		for (j = i + 1; j < count; j++) {
+			if (meta_data->ckv.kv[i].key == meta_data->ckv.kv[j].key) {
+				for (k = j; k < count - 1; k++)
+					meta_data->ckv.kv[k] = meta_data->ckv.kv[k + 1];
+				count--;
+				j--;
+			}
+		}
+	}
+	meta_data->ckv.num_kvs = count;
+
+	num = meta_data->sg_props.num_values;
+	for (n = 0; n < num; n++) {
+		for (m = n + 1; m < num; m++) {
+			if (meta_data->sg_props.values[n] == meta_data->sg_props.values[m]) {
+				for (l = m; l < num - 1; l++)
+					meta_data->sg_props.values[l] = meta_data->sg_props.values[l + 1];
+				num--;
+				m--;
+			}
+		}
+	}
+	meta_data->sg_props.num_values = num;
+}
+
+static void ref_update_cal(struct agm_meta_data_gsl *meta_data,
+			   struct agm_key_vector_gsl *ckv)
+{
+	size_t i, j;
+
+	for (i = 0; i < meta_data->ckv.num_kvs; i++) {
+		for (j = 0; j < ckv->num_kvs; j++) {
+			if (meta_data->ckv.kv[i].key == ckv->kv[j].key)
+				meta_data->ckv.kv[i].value = ckv->kv[j].value;
+		}
+	}
+}
+
+/* allocates the way metadata_merge() used to, one calloc per array */
+static struct agm_meta_data_gsl *ref_merge(struct agm_meta_data_gsl **list, int num)
+{
+	struct agm_meta_data_gsl *merged;
+	int i;
+
+	merged = calloc(1, sizeof(*merged));
+	for (i = 0; i < num; i++) {
+		merged->gkv.num_kvs += list[i]->gkv.num_kvs;
+		merged->ckv.num_kvs += list[i]->ckv.num_kvs;
+		merged->sg_props.num_values += list[i]->sg_props.num_values;
+	}
+	merged->gkv.kv = calloc(merged->gkv.num_kvs, sizeof(struct agm_key_value));
+	merged->ckv.kv = calloc(merged->ckv.num_kvs, sizeof(struct agm_key_value));
+	merged->sg_props.values = calloc(merged->sg_props.num_values, sizeof(uint32_t));
+
+	merged->gkv.num_kvs = 0;
+	merged->ckv.num_kvs = 0;
+	merged->sg_props.num_values = 0;
+	for (i = 0; i < num; i++) {
+		memcpy(merged->gkv.kv + merged->gkv.num_kvs, list[i]->gkv.kv,
+		       list[i]->gkv.num_kvs * sizeof(struct agm_key_value));
+		merged->gkv.num_kvs += list[i]->gkv.num_kvs;
+		memcpy(merged->ckv.kv + merged->ckv.num_kvs, list[i]->ckv.kv,
+		       list[i]->ckv.num_kvs * sizeof(struct agm_key_value));
+		merged->ckv.num_kvs += list[i]->ckv.num_kvs;
+		memcpy(merged->sg_props.values + merged->sg_props.num_values,
+		       list[i]->sg_props.values,
+		       list[i]->sg_props.num_values * sizeof(uint32_t));
+		merged->sg_props.num_values += list[i]->sg_props.num_values;
+		merged->sg_props.prop_id = list[i]->sg_props.prop_id;
+	}
+	ref_remove_dup(merged);
+
+	return merged;
+}
+
+static void ref_free(struct agm_meta_data_gsl *merged)
+{
+	metadata_free(merged);
+	free(merged);
+}
+
+static uint32_t rand_state = 1;
+
+static uint32_t next_rand(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return rand_state;
+}
+
+struct test_meta {
+	struct agm_meta_data_gsl meta;
+	struct agm_key_value gkv[MAX_KVPAIR_PROPS];
+	struct agm_key_value ckv[MAX_KVPAIR_PROPS];
+	uint32_t props[MAX_KVPAIR_PROPS];
+};
+
+static void fill_meta_counts(struct test_meta *t, uint32_t num_gkv, uint32_t num_ckv,
+			     uint32_t num_props, uint32_t key_range)
+{
+	uint32_t i;
+
+	t->meta.gkv.num_kvs = num_gkv;
+	t->meta.ckv.num_kvs = num_ckv;
+	t->meta.sg_props.num_values = num_props;
+	t->meta.sg_props.prop_id = next_rand();
+	t->meta.gkv.kv = t->gkv;
+	t->meta.ckv.kv = t->ckv;
+	t->meta.sg_props.values = t->props;
+
+	for (i = 0; i < num_gkv; i++) {
+		t->gkv[i].key = 0xA1000000 + next_rand() % key_range;
+		t->gkv[i].value = next_rand();
+	}
+	for (i = 0; i < num_ckv; i++) {
+		t->ckv[i].key = 0xA5000000 + next_rand() % key_range;
+		t->ckv[i].value = next_rand();
+	}
+	for (i = 0; i < num_props; i++)
+		t->props[i] = next_rand() % key_range;
+}
+
+/* keys are drawn from a small range so that duplicates are common */
+static void fill_meta(struct test_meta *t, uint32_t max_count, uint32_t key_range)
+{
+	uint32_t num_gkv = next_rand() % (max_count + 1);
+	uint32_t num_ckv = next_rand() % (max_count + 1);
+	uint32_t num_props = next_rand() % (max_count + 1);
+
+	fill_meta_counts(t, num_gkv, num_ckv, num_props, key_range);
+}
+
+static int meta_equal(struct agm_meta_data_gsl *a, struct agm_meta_data_gsl *b)
+{
+	return a->gkv.num_kvs == b->gkv.num_kvs &&
+	       a->ckv.num_kvs == b->ckv.num_kvs &&
+	       a->sg_props.num_values == b->sg_props.num_values &&
+	       a->sg_props.prop_id == b->sg_props.prop_id &&
+	       !memcmp(a->gkv.kv, b->gkv.kv, a->gkv.num_kvs * sizeof(struct agm_key_value)) &&
+	       !memcmp(a->ckv.kv, b->ckv.kv, a->ckv.num_kvs * sizeof(struct agm_key_value)) &&
+	       !memcmp(a->sg_props.values, b->sg_props.values,
+		       a->sg_props.num_values * sizeof(uint32_t));
+}
+
+static struct agm_meta_data_gsl *merge_list(struct agm_meta_data_gsl **list, int num)
+{
+	switch (num) {
+	case 1:
+		return metadata_merge(1, list[0]);
+	case 2:
+		return metadata_merge(2, list[0], list[1]);
+	case 3:
+		return metadata_merge(3, list[0], list[1], list[2]);
+	default:
+		return metadata_merge(4, list[0], list[1], list[2], list[3]);
+	}
+}
+
+/* random GKV, CKV and property sets, merged the way sessions do */
+int test_merge_matches_reference(void)
+{
+	struct test_meta inputs[4];
+	struct agm_meta_data_gsl *list[4];
+	struct agm_meta_data_gsl *ref, *merged;
+	int round, i, num, equal;
+
+	for (round = 0; round < NUM_ROUNDS; round++) {
+		num = 1 + next_rand() % 4;
+		for (i = 0; i < num; i++) {
+			fill_meta(&inputs[i], MAX_KVPAIR_PROPS / 4, 1 + next_rand() % 24);
+			list[i] = &inputs[i].meta;
+		}
+
+		merged = merge_list(list, num);
+		if (!merged)
+			goto fail;
+		ref = ref_merge(list, num);
+		equal = meta_equal(merged, ref);
+		ref_free(ref);
+		metadata_merged_free(merged);
+		if (!equal)
+			goto fail;
+	}
+
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+
+fail:
+	printf("TEST FAIL: %s() round %d\n", __func__, round);
+	return -1;
+}
+
+/* merging a merged result again has to be stable */
+int test_merge_chained(void)
+{
+	struct test_meta a, b;
+	struct agm_meta_data_gsl *first, *second;
+	int ret = -1;
+
+	fill_meta(&a, MAX_KVPAIR_PROPS / 4, 8);
+	fill_meta(&b, MAX_KVPAIR_PROPS / 4, 8);
+	first = metadata_merge(2, &a.meta, &b.meta);
+	if (!first)
+		goto done;
+	second = metadata_merge(2, NULL, first);
+	if (second) {
+		ret = meta_equal(first, second) ? 0 : -1;
+		metadata_merged_free(second);
+	}
+	metadata_merged_free(first);
+
+done:
+	printf("TEST %s: %s()\n", ret ? "FAIL" : "PASS", __func__);
+	return ret;
+}
+
+int test_merge_limits(void)
+{
+	struct test_meta a, b;
+	struct agm_meta_data_gsl *merged;
+
+	memset(&a, 0, sizeof(a));
+	memset(&b, 0, sizeof(b));
+	a.meta.gkv.kv = a.gkv;
+	b.meta.gkv.kv = b.gkv;
+	a.meta.gkv.num_kvs = MAX_KVPAIR_PROPS / 2;
+	b.meta.gkv.num_kvs = MAX_KVPAIR_PROPS / 2 + 1;
+
+	merged = metadata_merge(2, &a.meta, &b.meta);
+	if (merged) {
+		metadata_merged_free(merged);
+		goto fail;
+	}
+
+	/* empty inputs still give valid arrays */
+	merged = metadata_merge(2, NULL, NULL);
+	if (!merged || merged->gkv.num_kvs || merged->ckv.num_kvs ||
+	    merged->sg_props.num_values || !merged->ckv.kv) {
+		metadata_merged_free(merged);
+		goto fail;
+	}
+	metadata_merged_free(merged);
+
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+
+fail:
+	printf("TEST FAIL: %s()\n", __func__);
+	return -1;
+}
+
+int test_update_cal_matches_reference(void)
+{
+	static struct agm_key_value cal[512];
+	struct test_meta t, expect;
+	struct agm_key_vector_gsl ckv;
+	uint32_t i, range;
+	int round;
+
+	for (round = 0; round < NUM_ROUNDS; round++) {
+		range = 1 + next_rand() % 64;
+		fill_meta(&t, MAX_KVPAIR_PROPS, range);
+		ckv.kv = cal;
+		ckv.num_kvs = next_rand() % 513;
+		for (i = 0; i < ckv.num_kvs; i++) {
+			cal[i].key = 0xA5000000 + next_rand() % range;
+			cal[i].value = next_rand();
+		}
+
+		expect = t;
+		expect.meta.ckv.kv = expect.ckv;
+		ref_update_cal(&expect.meta, &ckv);
+		metadata_update_cal(&t.meta, &ckv);
+		if (memcmp(t.ckv, expect.ckv, t.meta.ckv.num_kvs * sizeof(struct agm_key_value)))
+			goto fail;
+	}
+
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+
+fail:
+	printf("TEST FAIL: %s() round %d\n", __func__, round);
+	return -1;
+}
+
+static double elapsed_ns(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+/*
+ * metadata_merge() refuses more than MAX_KVPAIR_PROPS keys, so the merge
+ * is timed up to that bound. Calibration updates are not bounded and are
+ * timed with 64 to 512 keys.
+ */
+int bench_metadata(void)
+{
+	static struct agm_key_value cal[512];
+	struct test_meta inputs[3], t;
+	struct agm_meta_data_gsl *list[3], *merged;
+	struct agm_key_vector_gsl ckv;
+	struct timespec start, end;
+	uint32_t n, i;
+	int iter;
+
+	for (n = 12; n <= MAX_KVPAIR_PROPS; n *= 2) {
+		for (i = 0; i < 3; i++) {
+			fill_meta_counts(&inputs[i], n / 3, n / 3, n / 3, n);
+			list[i] = &inputs[i].meta;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (iter = 0; iter < NUM_BENCH_ITERS; iter++)
+			ref_free(ref_merge(list, 3));
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		printf("merge %2u keys: pairwise %.0f ns, ", n,
+		       elapsed_ns(&start, &end) / NUM_BENCH_ITERS);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (iter = 0; iter < NUM_BENCH_ITERS; iter++) {
+			merged = merge_list(list, 3);
+			metadata_merged_free(merged);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		printf("hashed %.0f ns\n", elapsed_ns(&start, &end) / NUM_BENCH_ITERS);
+	}
+
+	for (n = 64; n <= 512; n *= 2) {
+		fill_meta_counts(&t, 0, MAX_KVPAIR_PROPS, 0, n);
+		for (i = 0; i < MAX_KVPAIR_PROPS; i++)
+			t.ckv[i].key = 0xA5000000 + i * (n / MAX_KVPAIR_PROPS + 1);
+		ckv.kv = cal;
+		ckv.num_kvs = n;
+		for (i = 0; i < n; i++) {
+			cal[i].key = 0xA5000000 + i;
+			cal[i].value = next_rand();
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (iter = 0; iter < NUM_BENCH_ITERS; iter++)
+			ref_update_cal(&t.meta, &ckv);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		printf("update_cal %3u keys: pairwise %.0f ns, ", n,
+		       elapsed_ns(&start, &end) / NUM_BENCH_ITERS);
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (iter = 0; iter < NUM_BENCH_ITERS; iter++)
+			metadata_update_cal(&t.meta, &ckv);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		printf("hashed %.0f ns\n", elapsed_ns(&start, &end) / NUM_BENCH_ITERS);
+	}
+
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+}
+
+int main() {
+	int ret = 0;
+	int i = 0;
+
+	testcase testcases[] = {
+				test_merge_matches_reference,
+				test_merge_chained,
+				test_merge_limits,
+				test_update_cal_matches_reference,
+				bench_metadata,
+	};
+
+	int testcount  = sizeof(testcases)/sizeof(testcase);
+	int failed_count = 0;
+
+	for (i = 0; i < testcount; i++) {
+		printf("************* Start TestCase:%d*************\n", i+1);
+		ret = testcases[i]();
+		if (ret) {
+			printf("Failed @ testcase no :%d\n", i+1);
+			failed_count++;
+		}
+		printf("************* End TestCase:%d*************\n", i+1);
+		printf("\n\n");
+	}
+
+	printf("\n\n");
+	printf("*************TEST REPORT*************\n");
+	printf("RAN:           %d/%d\n", i, testcount);
+	printf("SUCCESSESFULL: %d\n", testcount- failed_count);
+	printf("FAILED:        %d\n", failed_count);
+	printf("*************************************\n\n\n\n");
+	return failed_count ? 1 : 0;
+}
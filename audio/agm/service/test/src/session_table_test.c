@@ -0,0 +1,395 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <agm/session_table.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef int(*testcase)(void);
+
+#define NUM_OBJS           512
+#define NUM_BENCH_SESSIONS 32
+#define NUM_BENCH_WRITES   200000
+
+struct test_obj {
+	uint32_t id;
+	struct test_obj *next;
+};
+
+static struct test_obj objs[NUM_OBJS];
+
+static void objs_init(void)
+{
+	int i;
+
+	for (i = 0; i < NUM_OBJS; i++) {
+		objs[i].id = i * 2 + 1;
+		objs[i].next = NULL;
+	}
+}
+
+int test_add_find(void)
+{
+	struct session_table tbl;
+	int i;
+
+	objs_init();
+	if (session_table_init(&tbl))
+		goto fail;
+
+	for (i = 0; i < 16; i++)
+		if (session_table_add(&tbl, objs[i].id, &objs[i]))
+			goto fail_deinit;
+
+	for (i = 0; i < 16; i++) {
+		if (session_table_find(&tbl, objs[i].id) != &objs[i])
+			goto fail_deinit;
+		if (!session_table_contains(&tbl, &objs[i]))
+			goto fail_deinit;
+	}
+
+	session_table_deinit(&tbl);
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+
+fail_deinit:
+	session_table_deinit(&tbl);
+fail:
+	printf("TEST FAIL: %s()\n", __func__);
+	return -1;
+}
+
+int test_miss(void)
+{
+	struct session_table tbl;
+	struct test_obj other;
+	int i;
+
+	objs_init();
+	if (session_table_init(&tbl))
+		goto fail;
+
+	if (session_table_find(&tbl, 1) || session_table_contains(&tbl, &objs[0]))
+		goto fail_deinit;
+
+	for (i = 0; i < 16; i++)
+		if (session_table_add(&tbl, objs[i].id, &objs[i]))
+			goto fail_deinit;
+
+	/* ids of the test objects are never even */
+	for (i = 0; i < 64; i++)
+		if (session_table_find(&tbl, i * 2))
+			goto fail_deinit;
+
+	if (session_table_contains(&tbl, &other) ||
+	    session_table_contains(&tbl, &objs[16]) ||
+	    session_table_contains(&tbl, NULL))
+		goto fail_deinit;
+
+	session_table_deinit(&tbl);
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+
+fail_deinit:
+	session_table_deinit(&tbl);
+fail:
+	printf("TEST FAIL: %s()\n", __func__);
+	return -1;
+}
+
+int test_growth(void)
+{
+	struct session_table tbl;
+	int i, j;
+
+	objs_init();
+	if (session_table_init(&tbl))
+		goto fail;
+
+	for (i = 0; i < NUM_OBJS; i++) {
+		if (session_table_add(&tbl, objs[i].id, &objs[i]))
+			goto fail_deinit;
+		/* everything added so far has to survive each resize */
+		if ((i & (i + 1)) == 0) {
+			for (j = 0; j <= i; j++) {
+				if (session_table_find(&tbl, objs[j].id) != &objs[j] ||
+				    !session_table_contains(&tbl, &objs[j]))
+					goto fail_deinit;
+			}
+		}
+	}
+
+	for (i = 0; i < NUM_OBJS; i++)
+		if (session_table_find(&tbl, objs[i].id) != &objs[i])
+			goto fail_deinit;
+
+	session_table_deinit(&tbl);
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+
+fail_deinit:
+	session_table_deinit(&tbl);
+fail:
+	printf("TEST FAIL: %s()\n", __func__);
+	return -1;
+}
+
+/* ids hashing to the same bucket have to be told apart */
+int test_colliding_ids(void)
+{
+	struct session_table tbl;
+	int i;
+
+	if (session_table_init(&tbl))
+		goto fail;
+
+	for (i = 0; i < 24; i++) {
+		objs[i].id = i << 26;
+		if (session_table_add(&tbl, objs[i].id, &objs[i]))
+			goto fail_deinit;
+	}
+
+	for (i = 0; i < 24; i++)
+		if (session_table_find(&tbl, i << 26) != &objs[i])
+			goto fail_deinit;
+
+	session_table_deinit(&tbl);
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+
+fail_deinit:
+	session_table_deinit(&tbl);
+fail:
+	printf("TEST FAIL: %s()\n", __func__);
+	return -1;
+}
+
+struct reader_args {
+	struct session_table *tbl;
+	volatile int *added;
+	volatile int *stop;
+	int errors;
+};
+
+static void *reader_thread(void *data)
+{
+	struct reader_args *args = data;
+	int i, n;
+
+	while (!__atomic_load_n(args->stop, __ATOMIC_ACQUIRE)) {
+		n = __atomic_load_n(args->added, __ATOMIC_ACQUIRE);
+		for (i = 0; i < n; i++) {
+			if (session_table_find(args->tbl, objs[i].id) != &objs[i] ||
+			    !session_table_contains(args->tbl, &objs[i]))
+				args->errors++;
+		}
+	}
+
+	return NULL;
+}
+
+/* lookups without a lock while the table is filled and resized */
+int test_concurrent_readers(void)
+{
+	struct session_table tbl;
+	struct reader_args args[4];
+	pthread_t threads[4];
+	volatile int added = 0, stop = 0;
+	int i, ret = -1;
+
+	objs_init();
+	if (session_table_init(&tbl))
+		goto fail;
+
+	for (i = 0; i < 4; i++) {
+		args[i].tbl = &tbl;
+		args[i].added = &added;
+		args[i].stop = &stop;
+		args[i].errors = 0;
+		pthread_create(&threads[i], NULL, reader_thread, &args[i]);
+	}
+
+	for (i = 0; i < NUM_OBJS; i++) {
+		if (session_table_add(&tbl, objs[i].id, &objs[i]))
+			break;
+		__atomic_store_n(&added, i + 1, __ATOMIC_RELEASE);
+	}
+	__atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+
+	ret = (i == NUM_OBJS) ? 0 : -1;
+	for (i = 0; i < 4; i++) {
+		pthread_join(threads[i], NULL);
+		if (args[i].errors)
+			ret = -1;
+	}
+
+	session_table_deinit(&tbl);
+	if (ret)
+		goto fail;
+
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+
+fail:
+	printf("TEST FAIL: %s()\n", __func__);
+	return -1;
+}
+
+/*
+ * Every agm_session_write() resolves its handle once through
+ * session_obj_valid_check(). Compare that lookup, done by 32 sessions
+ * writing in parallel, against the previous mutex protected list walk.
+ */
+struct bench_args {
+	struct session_table *tbl;
+	struct test_obj *list;
+	pthread_mutex_t *lock;
+	struct test_obj *obj;
+	int hits;
+};
+
+static int list_valid_check(struct bench_args *args)
+{
+	struct test_obj *node;
+
+	pthread_mutex_lock(args->lock);
+	for (node = args->list; node; node = node->next) {
+		if (node == args->obj) {
+			pthread_mutex_unlock(args->lock);
+			return 1;
+		}
+	}
+	pthread_mutex_unlock(args->lock);
+	return 0;
+}
+
+static void *bench_list_thread(void *data)
+{
+	struct bench_args *args = data;
+	int i;
+
+	for (i = 0; i < NUM_BENCH_WRITES; i++)
+		args->hits += list_valid_check(args);
+
+	return NULL;
+}
+
+static void *bench_table_thread(void *data)
+{
+	struct bench_args *args = data;
+	int i;
+
+	for (i = 0; i < NUM_BENCH_WRITES; i++)
+		args->hits += session_table_contains(args->tbl, args->obj);
+
+	return NULL;
+}
+
+static double bench_run(void *(*fn)(void *), struct bench_args *args)
+{
+	pthread_t threads[NUM_BENCH_SESSIONS];
+	struct timespec start, end;
+	int i;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < NUM_BENCH_SESSIONS; i++)
+		pthread_create(&threads[i], NULL, fn, &args[i]);
+	for (i = 0; i < NUM_BENCH_SESSIONS; i++)
+		pthread_join(threads[i], NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+}
+
+int bench_session_lookup(void)
+{
+	struct session_table tbl;
+	struct bench_args args[NUM_BENCH_SESSIONS];
+	pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+	struct test_obj *list = NULL;
+	double list_ns, table_ns;
+	int i, ret = 0;
+
+	objs_init();
+	if (session_table_init(&tbl))
+		goto fail;
+
+	for (i = 0; i < NUM_BENCH_SESSIONS; i++) {
+		/* list_add_tail order, the last session walks the whole list */
+		objs[NUM_BENCH_SESSIONS - 1 - i].next = list;
+		list = &objs[NUM_BENCH_SESSIONS - 1 - i];
+		session_table_add(&tbl, objs[i].id, &objs[i]);
+	}
+
+	for (i = 0; i < NUM_BENCH_SESSIONS; i++) {
+		args[i].tbl = &tbl;
+		args[i].list = list;
+		args[i].lock = &lock;
+		args[i].obj = &objs[i];
+		args[i].hits = 0;
+	}
+	list_ns = bench_run(bench_list_thread, args);
+	for (i = 0; i < NUM_BENCH_SESSIONS; i++)
+		if (args[i].hits != NUM_BENCH_WRITES)
+			ret = -1;
+
+	for (i = 0; i < NUM_BENCH_SESSIONS; i++)
+		args[i].hits = 0;
+	table_ns = bench_run(bench_table_thread, args);
+	for (i = 0; i < NUM_BENCH_SESSIONS; i++)
+		if (args[i].hits != NUM_BENCH_WRITES)
+			ret = -1;
+
+	session_table_deinit(&tbl);
+	if (ret)
+		goto fail;
+
+	printf("%d sessions x %d writes: list %.1f ms, table %.1f ms\n",
+	       NUM_BENCH_SESSIONS, NUM_BENCH_WRITES, list_ns / 1e6, table_ns / 1e6);
+	printf("TEST PASS: %s()\n", __func__);
+	return 0;
+
+fail:
+	printf("TEST FAIL: %s()\n", __func__);
+	return -1;
+}
+
+int main() {
+	int ret = 0;
+	int i = 0;
+
+	testcase testcases[] = {
+				test_add_find,
+				test_miss,
+				test_growth,
+				test_colliding_ids,
+				test_concurrent_readers,
+				bench_session_lookup,
+	};
+
+	int testcount  = sizeof(testcases)/sizeof(testcase);
+	int failed_count = 0;
+
+	for (i = 0; i < testcount; i++) {
+		printf("************* Start TestCase:%d*************\n", i+1);
+		ret = testcases[i]();
+		if (ret) {
+			printf("Failed @ testcase no :%d\n", i+1);
+			failed_count++;
+		}
+		printf("************* End TestCase:%d*************\n", i+1);
+		printf("\n\n");
+	}
+
+	printf("\n\n");
+	printf("*************TEST REPORT*************\n");
+	printf("RAN:           %d/%d\n", i, testcount);
+	printf("SUCCESSESFULL: %d\n", testcount- failed_count);
+	printf("FAILED:        %d\n", failed_count);
+	printf("*************************************\n\n\n\n");
+	return failed_count ? 1 : 0;
+}
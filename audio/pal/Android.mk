@@ -58,6 +58,10 @@ ifeq ($(strip $(AUDIO_FEATURE_ENABLED_EC_REF_CAPTURE)),true)
 LOCAL_CFLAGS += -DEC_REF_CAPTURE_ENABLED
 endif
 
+ifeq ($(TARGET_BUILD_VARIANT),eng)
+LOCAL_CFLAGS += -DPAL_LOCK_ORDER_CHECK
+endif
+
 LOCAL_C_INCLUDES              += $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include
 LOCAL_C_INCLUDES              += $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/techpack/audio/include
 LOCAL_ADDITIONAL_DEPENDENCIES += $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
@@ -150,6 +154,65 @@ endif
 
 include $(BUILD_SHARED_LIBRARY)
 
+#-------------------------------------------
+#            Build PAL unit tests
+#-------------------------------------------
+include $(CLEAR_VARS)
+
+LOCAL_MODULE        := PalUnitTest
+LOCAL_MODULE_OWNER  := qti
+LOCAL_MODULE_TAGS   := optional
+LOCAL_VENDOR_MODULE := true
+
+LOCAL_CFLAGS        := -D_ANDROID_
+LOCAL_CFLAGS        += -Wno-macro-redefined
+LOCAL_CFLAGS        += -Wall -Werror -Wno-unused-parameter
+LOCAL_CFLAGS        += -DCONFIG_GSL
+LOCAL_CPPFLAGS      += -fexceptions -frtti
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include
+
+LOCAL_C_INCLUDES              += $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include
+LOCAL_C_INCLUDES              += $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/techpack/audio/include
+LOCAL_ADDITIONAL_DEPENDENCIES += $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
+
+LOCAL_SRC_FILES := \
+    test/unit/PalRingBufferTest.cpp \
+    test/unit/SoundTriggerEngineGslTest.cpp \
+    test/unit/SessionAlsaUtilsTest.cpp \
+    test/unit/PayloadBuilderTest.cpp \
+    test/unit/ResourceManagerTest.cpp \
+    test/unit/PalLockOrderTest.cpp
+
+# The KV and device info indexes are checked against the XML of every target
+LOCAL_TEST_DATA := $(call find-test-data-in-subdirs, $(LOCAL_PATH), "usecaseKvManager*.xml", configs)
+LOCAL_TEST_DATA += $(call find-test-data-in-subdirs, $(LOCAL_PATH), "resourcemanager*.xml", configs)
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+    libar-pal \
+    libexpat \
+    liblog
+
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa libqti-tinycompress
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa libtinycompress
+endif
+
+include $(BUILD_NATIVE_TEST)
+
 endif
 
 #-------------------------------------------
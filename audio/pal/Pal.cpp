@@ -217,13 +217,13 @@ int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
         return status;
     }
 
-    rm->lockValidStreamMutex();
+    rm->lockSharedValidStreamMutex();
     if (!rm->isActiveStream(stream_handle)) {
         status = -EINVAL;
-        rm->unlockValidStreamMutex();
+        rm->unlockSharedValidStreamMutex();
         return status;
     }
-    rm->unlockValidStreamMutex();
+    rm->unlockSharedValidStreamMutex();
 
     s = reinterpret_cast<Stream *>(stream_handle);
     s->setCachedState(STREAM_IDLE);
@@ -87,6 +87,8 @@
 #include "ACDPlatformInfo.h"
 #include "ContextManager.h"
 #include "SignalHandler.h"
+#include "PalLockOrder.h"
+#include "PalStreamList.h"
 #include <fstream>
 
 typedef enum {
@@ -272,6 +274,8 @@ struct usecase_info {
     std::vector<usecase_custom_config_info> config;
     uint32_t priority;
     uint32_t bit_width;
+    // position in config by custom key
+    std::unordered_map<std::string, int32_t> configIndex;
 
 };
 
@@ -417,6 +421,8 @@ struct deviceIn {
     bool fractionalSRSupported;
     uint32_t bit_width;
     pal_audio_fmt_t bitFormatSupported;
+    // position in usecase by stream type
+    std::unordered_map<int, int32_t> usecaseIndex;
 };
 
 class ResourceManager
@@ -459,7 +465,7 @@ private:
     void onVUIStreamRegistered();
     void onVUIStreamDeregistered();
 protected:
-    std::list <Stream*> mActiveStreams;
+    PalStreamList<Stream*> mActiveStreams;
     std::list <StreamPCM*> active_streams_ll;
     std::list <StreamPCM*> active_streams_ulla;
     std::list <StreamPCM*> active_streams_ull;
@@ -490,12 +496,18 @@ protected:
     bool use_lpi_;
     pal_speaker_rotation_type rotation_type_;
     bool isDeviceSwitch = false;
-    static std::mutex mResourceManagerMutex;
-    static std::mutex mGraphMutex;
-    static std::mutex mActiveStreamMutex;
-    static std::mutex mValidStreamMutex;
-    static std::mutex mSleepMonitorMutex;
-    static std::mutex mListFrontEndsMutex;
+    /*
+     * Taken in the order declared in PalLockOrder.h. The resource manager
+     * and valid stream mutexes are shared locked by the lookups that only
+     * read the active device and stream tables. deviceInfo is not modified
+     * after init, apart from the EC ref counts, and is read without a lock.
+     */
+    static PalRankedMutex<std::shared_timed_mutex> mResourceManagerMutex;
+    static PalRankedMutex<std::mutex> mGraphMutex;
+    static PalRankedMutex<std::mutex> mActiveStreamMutex;
+    static PalRankedMutex<std::shared_timed_mutex> mValidStreamMutex;
+    static PalRankedMutex<std::mutex> mSleepMonitorMutex;
+    static PalRankedMutex<std::mutex> mListFrontEndsMutex;
     static int snd_virt_card;
     static int snd_hw_card;
 
@@ -538,6 +550,8 @@ protected:
     static std::map<std::string, int> handsetPosTable;
     static std::map<pal_device_id_t, std::vector<std::string>> deviceTempCtrlsMap;
     static std::vector<deviceIn> deviceInfo;
+    // position in deviceInfo by device id, built once the resource xml is parsed
+    static std::unordered_map<int, int32_t> deviceInfoIndex;
     static std::vector<tx_ecinfo> txEcInfo;
     static struct vsid_info vsidInfo;
     static struct volume_set_param_info volumeSetParamInfo_;
@@ -646,8 +660,11 @@ public:
     int32_t getDeviceConfig(struct pal_device *deviceattr,
                             struct pal_stream_attributes *attributes);
     /*getDeviceInfo - updates channels, fluence info of the device*/
-    void getDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type,
-                       std::string key, struct pal_device_info *devinfo);
+    static void getDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type,
+                              const std::string &key, struct pal_device_info *devinfo);
+    /*deviceInfo lookup by device id, -EINVAL if the device is not configured*/
+    static int32_t getDeviceInfoIndex(int deviceId);
+    static void buildDeviceInfoIndex();
     bool getEcRefStatus(pal_stream_type_t tx_streamtype,pal_stream_type_t rx_streamtype);
     int32_t getVsidInfo(struct vsid_info  *info);
     int32_t getVolumeSetParamInfo(struct volume_set_param_info *volinfo);
@@ -883,6 +900,8 @@ public:
     void unlockActiveStream() { mActiveStreamMutex.unlock(); };
     void lockValidStreamMutex() { mValidStreamMutex.lock(); };
     void unlockValidStreamMutex() { mValidStreamMutex.unlock(); };
+    void lockSharedValidStreamMutex() { mValidStreamMutex.lock_shared(); };
+    void unlockSharedValidStreamMutex() { mValidStreamMutex.unlock_shared(); };
     void lockResourceManagerMutex() {mResourceManagerMutex.lock();};
     void unlockResourceManagerMutex() {mResourceManagerMutex.unlock();};
     void getSharedBEActiveStreamDevs(std::vector <std::tuple<Stream *, uint32_t>> &activeStreamDevs,
@@ -893,8 +912,8 @@ public:
     int getPalValueFromGKV(pal_key_vector_t *gkv, int key);
     pal_speaker_rotation_type getCurrentRotationType();
     void ssrHandler(card_status_t state);
-    int32_t getSidetoneMode(pal_device_id_t deviceId, pal_stream_type_t type,
-                            sidetone_mode_t *mode);
+    static int32_t getSidetoneMode(pal_device_id_t deviceId, pal_stream_type_t type,
+                                   sidetone_mode_t *mode);
     int getStreamInstanceID(Stream *str);
     int resetStreamInstanceID(Stream *str);
     int resetStreamInstanceID(Stream *str, uint32_t sInstanceID);
@@ -63,6 +63,7 @@
 #define LOG_TAG "PAL: ResourceManager"
 #include "ResourceManager.h"
 #include "Session.h"
+#include "SessionAlsaUtils.h"
 #include "Device.h"
 #include "Stream.h"
 #include "StreamPCM.h"
@@ -409,12 +410,14 @@ std::vector <int> ResourceManager::streamPpTag = {0};
 std::vector <int> ResourceManager::mixerTag = {0};
 std::vector <int> ResourceManager::devicePpTag = {0};
 std::vector <int> ResourceManager::deviceTag = {0};
-std::mutex ResourceManager::mResourceManagerMutex;
-std::mutex ResourceManager::mGraphMutex;
-std::mutex ResourceManager::mActiveStreamMutex;
-std::mutex ResourceManager::mValidStreamMutex;
-std::mutex ResourceManager::mSleepMonitorMutex;
-std::mutex ResourceManager::mListFrontEndsMutex;
+PalRankedMutex<std::shared_timed_mutex> ResourceManager::mResourceManagerMutex(
+        PAL_LOCK_RANK_RESOURCE_MANAGER);
+PalRankedMutex<std::mutex> ResourceManager::mGraphMutex(PAL_LOCK_RANK_GRAPH);
+PalRankedMutex<std::mutex> ResourceManager::mActiveStreamMutex(PAL_LOCK_RANK_ACTIVE_STREAM);
+PalRankedMutex<std::shared_timed_mutex> ResourceManager::mValidStreamMutex(
+        PAL_LOCK_RANK_VALID_STREAM);
+PalRankedMutex<std::mutex> ResourceManager::mSleepMonitorMutex(PAL_LOCK_RANK_SLEEP_MONITOR);
+PalRankedMutex<std::mutex> ResourceManager::mListFrontEndsMutex(PAL_LOCK_RANK_LIST_FRONT_ENDS);
 std::vector <int> ResourceManager::listAllFrontEndIds = {0};
 std::vector <int> ResourceManager::listFreeFrontEndIds = {0};
 std::vector <int> ResourceManager::listAllPcmPlaybackFrontEnds = {0};
@@ -500,6 +503,7 @@ void str_parms_destroy(struct str_parms *str_parms){return;}
 
 std::vector<uint32_t> ResourceManager::lpi_vote_streams_;
 std::vector<deviceIn> ResourceManager::deviceInfo;
+std::unordered_map<int, int32_t> ResourceManager::deviceInfoIndex;
 std::vector<tx_ecinfo> ResourceManager::txEcInfo;
 struct vsid_info ResourceManager::vsidInfo;
 struct volume_set_param_info ResourceManager::volumeSetParamInfo_;
@@ -717,6 +721,7 @@ ResourceManager::ResourceManager()
         PAL_ERR(LOG_TAG, "error in resource xml parsing ret %d", ret);
         throw std::runtime_error("error in resource xml parsing");
     }
+    buildDeviceInfoIndex();
 
     if (isHifiFilterEnabled)
         audio_route_apply_and_update_path(audio_route, "hifi-filter-coefficients");
@@ -872,6 +877,7 @@ ResourceManager::~ResourceManager()
     listAllPcmExtEcTxFrontEnds.clear();
     devInfo.clear();
     deviceInfo.clear();
+    deviceInfoIndex.clear();
     txEcInfo.clear();
 
     STInstancesLists.clear();
@@ -1037,6 +1043,8 @@ void ResourceManager::ssrHandlingLoop(std::shared_ptr<ResourceManager> rm)
 
             mActiveStreamMutex.lock();
             rm->cardState = state;
+            if (state == CARD_STATUS_OFFLINE)
+                SessionAlsaUtils::invalidateMixerCtlCache();
             if (state != prevState) {
                 if (rm->globalCb) {
                     PAL_DBG(LOG_TAG, "Notifying client about sound card state %d global cb %pK",
@@ -1635,123 +1643,151 @@ bool ResourceManager::getEcRefStatus(pal_stream_type_t tx_streamtype,pal_stream_
     return ecref_status;
 }
 
-void ResourceManager::getDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type, std::string key, struct pal_device_info *devinfo)
+void ResourceManager::buildDeviceInfoIndex()
 {
-    bool found = false;
-
+    deviceInfoIndex.clear();
     for (int32_t i = 0; i < deviceInfo.size(); i++) {
-        if (deviceId == deviceInfo[i].deviceId) {
-            devinfo->max_channels = deviceInfo[i].max_channel;
-            devinfo->channels = deviceInfo[i].channel;
-            devinfo->sndDevName = deviceInfo[i].sndDevName;
-            devinfo->samplerate = deviceInfo[i].samplerate;
-            devinfo->isExternalECRefEnabledFlag = deviceInfo[i].isExternalECRefEnabled;
-            devinfo->priority = MIN_USECASE_PRIORITY;
-            devinfo->bit_width = deviceInfo[i].bit_width;
-            devinfo->bitFormatSupported = deviceInfo[i].bitFormatSupported;
-            devinfo->channels_overwrite = false;
-            devinfo->samplerate_overwrite = false;
-            devinfo->sndDevName_overwrite = false;
-            devinfo->bit_width_overwrite = false;
-            devinfo->fractionalSRSupported = deviceInfo[i].fractionalSRSupported;
-            for (int32_t j = 0; j < deviceInfo[i].usecase.size(); j++) {
-                if (type == deviceInfo[i].usecase[j].type) {
-                    if (deviceInfo[i].usecase[j].channel) {
-                        devinfo->channels = deviceInfo[i].usecase[j].channel;
-                        devinfo->channels_overwrite = true;
-                        PAL_VERBOSE(LOG_TAG, "getting overwritten channels %d for usecase %d for dev %s",
-                                devinfo->channels,
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    if (deviceInfo[i].usecase[j].samplerate) {
-                        devinfo->samplerate = deviceInfo[i].usecase[j].samplerate;
-                        devinfo->samplerate_overwrite = true;
-                        PAL_VERBOSE(LOG_TAG, "getting overwritten samplerate %d for usecase %d for dev %s",
-                                devinfo->samplerate,
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    if (!(deviceInfo[i].usecase[j].sndDevName).empty()) {
-                        devinfo->sndDevName = deviceInfo[i].usecase[j].sndDevName;
-                        devinfo->sndDevName_overwrite = true;
-                        PAL_VERBOSE(LOG_TAG, "getting overwritten snd device name %s for usecase %d for dev %s",
-                                devinfo->sndDevName.c_str(),
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    if (deviceInfo[i].usecase[j].priority) {
-                        devinfo->priority = deviceInfo[i].usecase[j].priority;
-                        PAL_VERBOSE(LOG_TAG, "getting priority %d for usecase %d for dev %s",
-                                devinfo->priority,
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    if (deviceInfo[i].usecase[j].bit_width) {
-                        devinfo->bit_width = deviceInfo[i].usecase[j].bit_width;
-                        devinfo->bit_width_overwrite = true;
-                        PAL_VERBOSE(LOG_TAG, "getting overwritten bit width %d for usecase %d for dev %s",
-                                devinfo->bit_width,
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    /*parse custom config if there*/
-                    for (int32_t k = 0; k < deviceInfo[i].usecase[j].config.size(); k++) {
-                        if (!deviceInfo[i].usecase[j].config[k].key.compare(key)) {
-                            /*overwrite the channels if needed*/
-                            if (deviceInfo[i].usecase[j].config[k].channel) {
-                                devinfo->channels = deviceInfo[i].usecase[j].config[k].channel;
-                                devinfo->channels_overwrite = true;
-                                PAL_VERBOSE(LOG_TAG, "got overwritten channels %d for custom key %s usecase %d for dev %s",
-                                        devinfo->channels,
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            if (deviceInfo[i].usecase[j].config[k].samplerate) {
-                                devinfo->samplerate = deviceInfo[i].usecase[j].config[k].samplerate;
-                                devinfo->samplerate_overwrite = true;
-                                PAL_VERBOSE(LOG_TAG, "got overwritten samplerate %d for custom key %s usecase %d for dev %s",
-                                        devinfo->samplerate,
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            if (!(deviceInfo[i].usecase[j].config[k].sndDevName).empty()) {
-                                devinfo->sndDevName = deviceInfo[i].usecase[j].config[k].sndDevName;
-                                devinfo->sndDevName_overwrite = true;
-                                PAL_VERBOSE(LOG_TAG, "got overwitten snd dev %s for custom key %s usecase %d for dev %s",
-                                        devinfo->sndDevName.c_str(),
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            if (deviceInfo[i].usecase[j].config[k].priority &&
-                                deviceInfo[i].usecase[j].config[k].priority != MIN_USECASE_PRIORITY) {
-                                devinfo->priority = deviceInfo[i].usecase[j].config[k].priority;
-                                PAL_VERBOSE(LOG_TAG, "got priority %d for custom key %s usecase %d for dev %s",
-                                        devinfo->priority,
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            if (deviceInfo[i].usecase[j].config[k].bit_width) {
-                                devinfo->bit_width = deviceInfo[i].usecase[j].config[k].bit_width;
-                                devinfo->bit_width_overwrite = true;
-                                PAL_VERBOSE(LOG_TAG, "got overwritten bit width %d for custom key %s usecase %d for dev %s",
-                                        devinfo->bit_width,
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            found = true;
-                            break;
-                        }
-                    }
-                }
-            }
+        /* lookups stop at the first entry of a device, keep that one */
+        deviceInfoIndex.emplace(deviceInfo[i].deviceId, i);
+        deviceInfo[i].usecaseIndex.clear();
+        for (int32_t j = 0; j < deviceInfo[i].usecase.size(); j++) {
+            struct usecase_info &usecase = deviceInfo[i].usecase[j];
+
+            deviceInfo[i].usecaseIndex.emplace(usecase.type, j);
+            usecase.configIndex.clear();
+            for (int32_t k = 0; k < usecase.config.size(); k++)
+                usecase.configIndex.emplace(usecase.config[k].key, k);
         }
     }
+    PAL_DBG(LOG_TAG, "indexed %zu devices", deviceInfoIndex.size());
+}
+
+int32_t ResourceManager::getDeviceInfoIndex(int deviceId)
+{
+    auto it = deviceInfoIndex.find(deviceId);
+
+    return (it != deviceInfoIndex.end()) ? it->second : -EINVAL;
+}
+
+void ResourceManager::getDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type,
+                                    const std::string &key, struct pal_device_info *devinfo)
+{
+    int32_t i = getDeviceInfoIndex(deviceId);
+
+    if (i < 0)
+        return;
+
+    const struct deviceIn &dev = deviceInfo[i];
+    devinfo->max_channels = dev.max_channel;
+    devinfo->channels = dev.channel;
+    devinfo->sndDevName = dev.sndDevName;
+    devinfo->samplerate = dev.samplerate;
+    devinfo->isExternalECRefEnabledFlag = dev.isExternalECRefEnabled;
+    devinfo->priority = MIN_USECASE_PRIORITY;
+    devinfo->bit_width = dev.bit_width;
+    devinfo->bitFormatSupported = dev.bitFormatSupported;
+    devinfo->channels_overwrite = false;
+    devinfo->samplerate_overwrite = false;
+    devinfo->sndDevName_overwrite = false;
+    devinfo->bit_width_overwrite = false;
+    devinfo->fractionalSRSupported = dev.fractionalSRSupported;
+
+    auto uc = dev.usecaseIndex.find(type);
+    if (uc == dev.usecaseIndex.end())
+        return;
+
+    const struct usecase_info &usecase = dev.usecase[uc->second];
+    if (usecase.channel) {
+        devinfo->channels = usecase.channel;
+        devinfo->channels_overwrite = true;
+        PAL_VERBOSE(LOG_TAG, "getting overwritten channels %d for usecase %d for dev %s",
+                devinfo->channels,
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
+    if (usecase.samplerate) {
+        devinfo->samplerate = usecase.samplerate;
+        devinfo->samplerate_overwrite = true;
+        PAL_VERBOSE(LOG_TAG, "getting overwritten samplerate %d for usecase %d for dev %s",
+                devinfo->samplerate,
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
+    if (!(usecase.sndDevName).empty()) {
+        devinfo->sndDevName = usecase.sndDevName;
+        devinfo->sndDevName_overwrite = true;
+        PAL_VERBOSE(LOG_TAG, "getting overwritten snd device name %s for usecase %d for dev %s",
+                devinfo->sndDevName.c_str(),
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
+    if (usecase.priority) {
+        devinfo->priority = usecase.priority;
+        PAL_VERBOSE(LOG_TAG, "getting priority %d for usecase %d for dev %s",
+                devinfo->priority,
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
+    if (usecase.bit_width) {
+        devinfo->bit_width = usecase.bit_width;
+        devinfo->bit_width_overwrite = true;
+        PAL_VERBOSE(LOG_TAG, "getting overwritten bit width %d for usecase %d for dev %s",
+                devinfo->bit_width,
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
+
+    /*parse custom config if there*/
+    auto cfg = usecase.configIndex.find(key);
+    if (cfg == usecase.configIndex.end())
+        return;
+
+    const struct usecase_custom_config_info &config = usecase.config[cfg->second];
+    /*overwrite the channels if needed*/
+    if (config.channel) {
+        devinfo->channels = config.channel;
+        devinfo->channels_overwrite = true;
+        PAL_VERBOSE(LOG_TAG, "got overwritten channels %d for custom key %s usecase %d for dev %s",
+                devinfo->channels,
+                key.c_str(),
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
+    if (config.samplerate) {
+        devinfo->samplerate = config.samplerate;
+        devinfo->samplerate_overwrite = true;
+        PAL_VERBOSE(LOG_TAG, "got overwritten samplerate %d for custom key %s usecase %d for dev %s",
+                devinfo->samplerate,
+                key.c_str(),
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
+    if (!(config.sndDevName).empty()) {
+        devinfo->sndDevName = config.sndDevName;
+        devinfo->sndDevName_overwrite = true;
+        PAL_VERBOSE(LOG_TAG, "got overwitten snd dev %s for custom key %s usecase %d for dev %s",
+                devinfo->sndDevName.c_str(),
+                key.c_str(),
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
+    if (config.priority && config.priority != MIN_USECASE_PRIORITY) {
+        devinfo->priority = config.priority;
+        PAL_VERBOSE(LOG_TAG, "got priority %d for custom key %s usecase %d for dev %s",
+                devinfo->priority,
+                key.c_str(),
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
+    if (config.bit_width) {
+        devinfo->bit_width = config.bit_width;
+        devinfo->bit_width_overwrite = true;
+        PAL_VERBOSE(LOG_TAG, "got overwritten bit width %d for custom key %s usecase %d for dev %s",
+                devinfo->bit_width,
+                key.c_str(),
+                type,
+                deviceNameLUT.at(deviceId).c_str());
+    }
 }
 
 int32_t ResourceManager::getSidetoneMode(pal_device_id_t deviceId,
@@ -1759,16 +1795,14 @@ int32_t ResourceManager::getSidetoneMode(pal_device_id_t deviceId,
                                          sidetone_mode_t *mode){
     int32_t status = 0;
 
+    int32_t i = getDeviceInfoIndex(deviceId);
+
     *mode = SIDETONE_OFF;
-    for (int32_t size1 = 0; size1 < deviceInfo.size(); size1++) {
-        if (deviceId == deviceInfo[size1].deviceId) {
-            for (int32_t size2 = 0; size2 < deviceInfo[size1].usecase.size(); size2++) {
-                if (type == deviceInfo[size1].usecase[size2].type) {
-                    *mode = deviceInfo[size1].usecase[size2].sidetoneMode;
-                    PAL_DBG(LOG_TAG, "found sidetoneMode %d for dev %d", *mode, deviceId);
-                    break;
-                }
-            }
+    if (i >= 0) {
+        auto uc = deviceInfo[i].usecaseIndex.find(type);
+        if (uc != deviceInfo[i].usecaseIndex.end()) {
+            *mode = deviceInfo[i].usecase[uc->second].sidetoneMode;
+            PAL_DBG(LOG_TAG, "found sidetoneMode %d for dev %d", *mode, deviceId);
         }
     }
     return status;
@@ -2806,7 +2840,7 @@ int ResourceManager::deregisterStream(Stream *s)
             break;
     }
 
-    deregisterstream(s, mActiveStreams);
+    mActiveStreams.remove(s);
     mValidStreamMutex.unlock();
     mActiveStreamMutex.unlock();
 exit:
@@ -2830,13 +2864,14 @@ bool isStreamActive(T s, std::list<T> &streams)
     return ret;
 }
 
+template <class T>
+bool isStreamActive(T s, PalStreamList<T> &streams)
+{
+    return streams.contains(s);
+}
+
 int ResourceManager::isActiveStream(pal_stream_handle_t *handle) {
-    for (auto &s : mActiveStreams) {
-        if (handle == reinterpret_cast<uint64_t *>(s)) {
-            return true;
-        }
-    }
-    return false;
+    return isStreamActive(reinterpret_cast<Stream *>(handle), mActiveStreams);
 }
 
 int ResourceManager::initStreamUserCounter(Stream *s)
@@ -2971,13 +3006,8 @@ bool ResourceManager::isExternalECSupported(std::shared_ptr<Device> tx_dev) {
     }
 
     tx_dev_id = tx_dev->getSndDeviceId();
-    for (i = 0; i < deviceInfo.size(); i++) {
-        if (tx_dev_id == deviceInfo[i].deviceId) {
-            break;
-        }
-    }
-
-    if (i == deviceInfo.size()) {
+    i = getDeviceInfoIndex(tx_dev_id);
+    if (i < 0) {
         PAL_ERR(LOG_TAG, "Tx device %d not found", tx_dev_id);
         goto exit;
     }
@@ -2998,12 +3028,10 @@ bool ResourceManager::isExternalECRefEnabled(int rx_dev_id)
 {
     bool is_enabled = false;
 
-    for (int i = 0; i < deviceInfo.size(); i++) {
-        if (rx_dev_id == deviceInfo[i].deviceId) {
-            is_enabled = deviceInfo[i].isExternalECRefEnabled;
-            break;
-        }
-    }
+    int i = getDeviceInfoIndex(rx_dev_id);
+
+    if (i >= 0)
+        is_enabled = deviceInfo[i].isExternalECRefEnabled;
 
     return is_enabled;
 }
@@ -3437,7 +3465,7 @@ bool ResourceManager::isDeviceActive(pal_device_id_t deviceId)
     int candidateDeviceId;
     PAL_DBG(LOG_TAG, "Enter.");
 
-    mResourceManagerMutex.lock();
+    mResourceManagerMutex.lock_shared();
     for (int i = 0; i < active_devices.size(); i++) {
         candidateDeviceId = active_devices[i].first->getSndDeviceId();
         if (deviceId == candidateDeviceId) {
@@ -3447,7 +3475,7 @@ bool ResourceManager::isDeviceActive(pal_device_id_t deviceId)
         }
     }
 
-    mResourceManagerMutex.unlock();
+    mResourceManagerMutex.unlock_shared();
     PAL_DBG(LOG_TAG, "Exit.");
     return is_active;
 }
@@ -3457,9 +3485,9 @@ bool ResourceManager::isDeviceActive(std::shared_ptr<Device> d, Stream *s)
     bool is_active = false;
 
     PAL_DBG(LOG_TAG, "Enter.");
-    mResourceManagerMutex.lock();
+    mResourceManagerMutex.lock_shared();
     is_active = isDeviceActive_l(d, s);
-    mResourceManagerMutex.unlock();
+    mResourceManagerMutex.unlock_shared();
     PAL_DBG(LOG_TAG, "Exit.");
     return is_active;
 }
@@ -3523,10 +3551,10 @@ int ResourceManager::removePlugInDevice(pal_device_id_t device_id,
 int ResourceManager::getActiveDevices(std::vector<std::shared_ptr<Device>> &deviceList)
 {
     int ret = 0;
-    mResourceManagerMutex.lock();
+    mResourceManagerMutex.lock_shared();
     for (int i = 0; i < active_devices.size(); i++)
         deviceList.push_back(active_devices[i].first);
-    mResourceManagerMutex.unlock();
+    mResourceManagerMutex.unlock_shared();
     return ret;
 }
 
@@ -4722,9 +4750,9 @@ std::shared_ptr<Device> ResourceManager::getActiveEchoReferenceRxDevices(
 {
     std::shared_ptr<Device> rx_device = nullptr;
     PAL_DBG(LOG_TAG, "Enter.");
-    mResourceManagerMutex.lock();
+    mResourceManagerMutex.lock_shared();
     rx_device = getActiveEchoReferenceRxDevices_l(tx_str);
-    mResourceManagerMutex.unlock();
+    mResourceManagerMutex.unlock_shared();
     PAL_DBG(LOG_TAG, "Exit.");
     return rx_device;
 }
@@ -4815,17 +4843,14 @@ bool ResourceManager::checkECRef(std::shared_ptr<Device> rx_dev,
     rx_dev_id = rx_dev->getSndDeviceId();
     tx_dev_id = tx_dev->getSndDeviceId();
 
-    for (int i = 0; i < deviceInfo.size(); i++) {
-        if (tx_dev_id == deviceInfo[i].deviceId) {
-            for (int j = 0; j < deviceInfo[i].rx_dev_ids.size(); j++) {
-                if (rx_dev_id == deviceInfo[i].rx_dev_ids[j]) {
-                    result = true;
-                    break;
-                }
+    int i = getDeviceInfoIndex(tx_dev_id);
+    if (i >= 0) {
+        for (int j = 0; j < deviceInfo[i].rx_dev_ids.size(); j++) {
+            if (rx_dev_id == deviceInfo[i].rx_dev_ids[j]) {
+                result = true;
+                break;
             }
         }
-        if (result)
-            break;
     }
 
     PAL_DBG(LOG_TAG, "EC Ref: %d, rx dev: %d, tx dev: %d",
@@ -4863,13 +4888,8 @@ int ResourceManager::updateECDeviceMap(std::shared_ptr<Device> rx_dev,
     }
 
     tx_dev_id = tx_dev->getSndDeviceId();
-    for (i = 0; i < deviceInfo.size(); i++) {
-        if (tx_dev_id == deviceInfo[i].deviceId) {
-            break;
-        }
-    }
-
-    if (i == deviceInfo.size()) {
+    i = getDeviceInfoIndex(tx_dev_id);
+    if (i < 0) {
         PAL_ERR(LOG_TAG, "Tx device %d not found", tx_dev_id);
         return -EINVAL;
     }
@@ -4950,13 +4970,8 @@ std::shared_ptr<Device> ResourceManager::clearInternalECRefCounts(Stream *tx_str
     }
 
     tx_dev_id = tx_dev->getSndDeviceId();
-    for (i = 0; i < deviceInfo.size(); i++) {
-        if (tx_dev_id == deviceInfo[i].deviceId) {
-            break;
-        }
-    }
-
-    if (i == deviceInfo.size()) {
+    i = getDeviceInfoIndex(tx_dev_id);
+    if (i < 0) {
         PAL_ERR(LOG_TAG, "Tx device %d not found", tx_dev_id);
         goto exit;
     }
@@ -5072,9 +5087,9 @@ int ResourceManager::getActiveStream(std::vector<Stream*> &activestreams,
 {
     int ret = 0;
     PAL_DBG(LOG_TAG, "Enter.");
-    mResourceManagerMutex.lock();
+    mResourceManagerMutex.lock_shared();
     ret = getActiveStream_l(activestreams, d);
-    mResourceManagerMutex.unlock();
+    mResourceManagerMutex.unlock_shared();
     PAL_DBG(LOG_TAG, "Exit. ret %d", ret);
     return ret;
 }
@@ -5132,9 +5147,9 @@ int ResourceManager::getOrphanStream(std::vector<Stream*> &orphanstreams,
 {
     int ret = 0;
     PAL_DBG(LOG_TAG, "Enter.");
-    mResourceManagerMutex.lock();
+    mResourceManagerMutex.lock_shared();
     ret = getOrphanStream_l(orphanstreams, retrystreams);
-    mResourceManagerMutex.unlock();
+    mResourceManagerMutex.unlock_shared();
     PAL_DBG(LOG_TAG, "Exit. ret %d", ret);
     return ret;
 }
@@ -5643,7 +5658,7 @@ int ResourceManager::checkAndUpdateGroupDevConfig(struct pal_device *deviceattr,
 std::shared_ptr<ResourceManager> ResourceManager::getInstance()
 {
     if(!rm) {
-        std::lock_guard<std::mutex> lock(ResourceManager::mResourceManagerMutex);
+        std::lock_guard<decltype(mResourceManagerMutex)> lock(ResourceManager::mResourceManagerMutex);
         if (!rm) {
             std::shared_ptr<ResourceManager> sp(new ResourceManager());
             rm = sp;
@@ -5706,6 +5721,7 @@ void ResourceManager::deinit()
     card_status_t state = CARD_STATUS_NONE;
 
     mixerClosed = true;
+    SessionAlsaUtils::invalidateMixerCtlCache();
     mixer_close(audio_virt_mixer);
     mixer_close(audio_hw_mixer);
     if (audio_route) {
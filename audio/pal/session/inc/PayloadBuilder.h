@@ -42,6 +42,7 @@
 #include <algorithm>
 #include <expat.h>
 #include <map>
+#include <unordered_map>
 #include <regex>
 #include <sstream>
 #include "Stream.h"
@@ -148,6 +149,28 @@ struct allKVs {
     std::vector<kvInfo> keys_values;
 };
 
+/* keys_and_values entry with its selector pairs interned to integer ids */
+struct kvIndexEntry {
+    std::vector<uint32_t> selector_ids; /* sorted, duplicates kept */
+    const kvInfo *info;
+};
+
+/* Everything a lookup needs for one stream type or device id, built once at init */
+struct kvTypeIndex {
+    /* keys_and_values of each block listing the type, in XML order */
+    std::vector<std::vector<kvIndexEntry>> blocks;
+    /* union of the selector names of those blocks, as retrieveSelectors returns them */
+    std::vector<std::string> selector_names;
+};
+
+struct selectorPairHash {
+    size_t operator()(const std::pair<selector_type_t, std::string> &selector) const {
+        return std::hash<std::string>()(selector.second) ^ (size_t)selector.first;
+    }
+};
+
+typedef std::unordered_map<int32_t, kvTypeIndex> kvIndex;
+
 typedef enum {
     TAG_USECASEXML_ROOT,
     TAG_STREAM_SEL,
@@ -181,6 +204,12 @@ protected:
    static std::vector<allKVs> all_streampps;
    static std::vector<allKVs> all_devices;
    static std::vector<allKVs> all_devicepps;
+   static kvIndex stream_index;
+   static kvIndex streampp_index;
+   static kvIndex device_index;
+   static kvIndex devicepp_index;
+   static std::unordered_map<std::pair<selector_type_t, std::string>, uint32_t,
+       selectorPairHash> selector_ids;
 
 public:
     void payloadUsbAudioConfig(uint8_t** payload, size_t* size,
@@ -277,8 +306,12 @@ public:
         std::vector<allKVs> &any_type);
     static std::vector <std::pair<selector_type_t, std::string>> getSelectorValues(
         std::vector<std::string> &selectors, Stream* s, struct pal_device* dAttr);
-    static bool compareSelectorPairs(std::vector <std::pair<selector_type_t, std::string>>
-        &selector_val, std::vector<std::pair<selector_type_t, std::string>> &filled_selector_pairs);
+    static void buildKVIndex(std::vector<allKVs> &any_type, kvIndex &index);
+    static kvIndex *getKVIndex(std::vector<allKVs> &any_type);
+    static bool getSelectorIds(std::vector<std::pair<selector_type_t, std::string>>
+        &filled_selector_pairs, std::vector<uint32_t> &filled_ids);
+    static bool compareSelectorIds(const std::vector<uint32_t> &selector_ids,
+        const std::vector<uint32_t> &filled_ids);
     static int retrieveKVs(std::vector<std::pair<selector_type_t, std::string>>
         &filled_selector_pairs, uint32_t type, std::vector<allKVs> &any_type,
         std::vector<std::pair<int32_t, int32_t>> &keyVector);
@@ -89,6 +89,10 @@ private:
     static struct mixer_ctl *getStaticMixerControl(struct mixer *am, std::string name);
 public:
     ~SessionAlsaUtils();
+    /* cached equivalent of mixer_get_ctl_by_name() */
+    static struct mixer_ctl *getMixerControl(struct mixer *am, const std::string &name);
+    /* drop the cached controls, required before a mixer is closed or reset */
+    static void invalidateMixerCtlCache();
     static bool isRxDevice(uint32_t devId);
     static int setMixerCtlData(struct mixer_ctl *ctl, MixerCtlType id, void *data, int size);
     static int getTagMetadata(int32_t tagsent, std::vector <std::pair<int, int>> &tkv, struct agm_tag_config *tagConfig);
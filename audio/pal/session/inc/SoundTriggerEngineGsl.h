@@ -116,9 +116,15 @@ class SoundTriggerEngineGsl : public SoundTriggerEngine {
     }
     void UpdateState(eng_state_t state);
     void UpdateStateToActive() override;
+    static int32_t ReadToRingBuffer(Session *session, Stream *s,
+        PalRingBuffer *buffer, size_t read_size, size_t period_size,
+        uint8_t *bounce_buf, struct pal_ring_buffer_region *region,
+        int32_t *size);
 
  private:
     int32_t StartBuffering(Stream *s);
+    size_t WriteToRingBuffer(uint8_t *data, size_t size,
+        uint32_t *bytes_to_drop, FILE *dump_fd);
     int32_t RestartRecognition_l(Stream *s);
     int32_t UpdateSessionPayload(st_param_id_type_t param);
     int32_t ParseDetectionPayloadPDK(void *event_data);
@@ -170,6 +170,12 @@ std::vector<allKVs> PayloadBuilder::all_streams;
 std::vector<allKVs> PayloadBuilder::all_streampps;
 std::vector<allKVs> PayloadBuilder::all_devices;
 std::vector<allKVs> PayloadBuilder::all_devicepps;
+kvIndex PayloadBuilder::stream_index;
+kvIndex PayloadBuilder::streampp_index;
+kvIndex PayloadBuilder::device_index;
+kvIndex PayloadBuilder::devicepp_index;
+std::unordered_map<std::pair<selector_type_t, std::string>, uint32_t, selectorPairHash>
+    PayloadBuilder::selector_ids;
 
 template <typename T>
 void PayloadBuilder::populateChannelMap(T pcmChannel, uint8_t numChannel)
@@ -863,6 +869,7 @@ int PayloadBuilder::init()
     all_streampps.clear();
     all_devices.clear();
     all_devicepps.clear();
+    selector_ids.clear();
 
     if (getSocId() == ARRAX_SOC_ID) {
         PAL_INFO(LOG_TAG, "XML parsing started %s", USECASE_ARRAX_XML_FILE);
@@ -915,9 +922,65 @@ freeParser:
 closeFile:
     fclose(file);
 done:
+    buildKVIndex(all_streams, stream_index);
+    buildKVIndex(all_streampps, streampp_index);
+    buildKVIndex(all_devices, device_index);
+    buildKVIndex(all_devicepps, devicepp_index);
+    PAL_INFO(LOG_TAG, "KV index built, %zu selector values", selector_ids.size());
     return ret;
 }
 
+void PayloadBuilder::buildKVIndex(std::vector<allKVs> &any_type, kvIndex &index)
+{
+    index.clear();
+
+    for (int32_t i = 0; i < any_type.size(); i++) {
+        std::vector<kvIndexEntry> block;
+        for (int32_t j = 0; j < any_type[i].keys_values.size(); j++) {
+            kvIndexEntry entry = {};
+            entry.info = &any_type[i].keys_values[j];
+            for (auto &selector : any_type[i].keys_values[j].selector_pairs) {
+                auto id = selector_ids.emplace(selector, selector_ids.size());
+                entry.selector_ids.push_back(id.first->second);
+            }
+            std::sort(entry.selector_ids.begin(), entry.selector_ids.end());
+            block.push_back(entry);
+        }
+
+        /* a block listing the same type twice is still searched once */
+        std::set<int32_t> types(any_type[i].id_type.begin(), any_type[i].id_type.end());
+        for (auto type : types)
+            index[type].blocks.push_back(block);
+    }
+
+    for (auto &type_index : index) {
+        std::vector<std::string> &gkv_selectors = type_index.second.selector_names;
+        for (auto &block : type_index.second.blocks) {
+            for (auto &entry : block) {
+                gkv_selectors.insert(gkv_selectors.end(), entry.info->selector_names.begin(),
+                    entry.info->selector_names.end());
+            }
+        }
+        if (gkv_selectors.size())
+            removeDuplicateSelectors(gkv_selectors);
+    }
+}
+
+kvIndex *PayloadBuilder::getKVIndex(std::vector<allKVs> &any_type)
+{
+    if (&any_type == &all_streams)
+        return &stream_index;
+    if (&any_type == &all_streampps)
+        return &streampp_index;
+    if (&any_type == &all_devices)
+        return &device_index;
+    if (&any_type == &all_devicepps)
+        return &devicepp_index;
+
+    PAL_ERR(LOG_TAG, "No KV index for this table");
+    return nullptr;
+}
+
 void PayloadBuilder::payloadTimestamp(std::shared_ptr<std::vector<uint8_t>>& payload,
                                       size_t *size, uint32_t moduleId)
 {
@@ -2204,42 +2267,41 @@ exit:
     return status;
 }
 
-bool PayloadBuilder::compareSelectorPairs(
-    std::vector<std::pair<selector_type_t, std::string>>& selector_pairs,
-    std::vector<std::pair<selector_type_t, std::string>>& filled_selector_pairs)
+bool PayloadBuilder::getSelectorIds(
+    std::vector<std::pair<selector_type_t, std::string>> &filled_selector_pairs,
+    std::vector<uint32_t> &filled_ids)
 {
-    int count = 0;
-    bool result = false;
-
-    PAL_DBG(LOG_TAG, "Enter: selector size: %zu filled_sel size: %zu",
-        selector_pairs.size(), filled_selector_pairs.size());
-    if (selector_pairs.size() == filled_selector_pairs.size()) {
-        std::sort(filled_selector_pairs.begin(), filled_selector_pairs.end());
-        std::sort(selector_pairs.begin(), selector_pairs.end());
-        result = std::equal(selector_pairs.begin(), selector_pairs.end(),
-            filled_selector_pairs.begin());
-        if (result) {
-            PAL_DBG(LOG_TAG,"Return True");
-            goto exit;
-        }
-    } else {
-        for (int i = 0; i < filled_selector_pairs.size(); i++) {
-            if (selector_pairs.end() != std::find(selector_pairs.begin(),
-                selector_pairs.end(), filled_selector_pairs[i])) {
-                count++;
-                PAL_DBG(LOG_TAG,"Inside the find loop count=%d", count);
-            }
-        }
-        PAL_DBG(LOG_TAG, "After find count:%d", count);
-        if (filled_selector_pairs.size() == count) {
-            result = true;
-            PAL_DBG(LOG_TAG,"Return True");
-            goto exit;
+    for (int i = 0; i < filled_selector_pairs.size(); i++) {
+        auto id = selector_ids.find(filled_selector_pairs[i]);
+        if (id == selector_ids.end()) {
+            PAL_DBG(LOG_TAG, "selector type:%d value:%s not in xml",
+                filled_selector_pairs[i].first, filled_selector_pairs[i].second.c_str());
+            return false;
         }
+        filled_ids.push_back(id->second);
     }
-exit:
-    PAL_DBG(LOG_TAG, "Exit result: %d", result);
-    return result;
+    std::sort(filled_ids.begin(), filled_ids.end());
+
+    return true;
+}
+
+/*
+ * Selector sets of the same size must be equal. Otherwise every filled selector has to be one
+ * of the entry's selectors, an entry lists several values of a selector as a comma separated
+ * string.
+ */
+bool PayloadBuilder::compareSelectorIds(const std::vector<uint32_t> &selector_ids,
+    const std::vector<uint32_t> &filled_ids)
+{
+    if (selector_ids.size() == filled_ids.size())
+        return selector_ids == filled_ids;
+
+    for (int i = 0; i < filled_ids.size(); i++) {
+        if (!std::binary_search(selector_ids.begin(), selector_ids.end(), filled_ids[i]))
+            return false;
+    }
+
+    return true;
 }
 
 bool PayloadBuilder::findKVs(std::vector<std::pair<selector_type_t, std::string>>
@@ -2247,38 +2309,32 @@ bool PayloadBuilder::findKVs(std::vector<std::pair<selector_type_t, std::string>
     std::vector<std::pair<int, int>> &keyVector)
 {
     bool found = false;
-
-    for (int32_t i = 0; i < any_type.size(); i++) {
-        if (isIdTypeAvailable(type, any_type[i].id_type)) {
-            for (int32_t j = 0; j < any_type[i].keys_values.size(); j++) {
-                if (filled_selector_pairs.empty() != true) {
-                    if (compareSelectorPairs(any_type[i].keys_values[j].selector_pairs,
-                           filled_selector_pairs)) {
-                        for (int32_t k = 0; k < any_type[i].keys_values[j].kv_pairs.size(); k++) {
-                            keyVector.push_back(
-                                std::make_pair(any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value));
-                            PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n",
-                                any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value);
-                        }
-                        found = true;
-                        break;
-                    }
-                } else {
-                    if (any_type[i].keys_values[j].selector_pairs.empty()) {
-                        for (int32_t k = 0; k < any_type[i].keys_values[j].kv_pairs.size(); k++) {
-                            keyVector.push_back(
-                                std::make_pair(any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value));
-                            PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n",
-                                any_type[i].keys_values[j].kv_pairs[k].key,
-                                any_type[i].keys_values[j].kv_pairs[k].value);
-                        }
-                        found = true;
-                        break;
-                    }
+    std::vector<uint32_t> filled_ids;
+    kvIndex *index = getKVIndex(any_type);
+
+    if (!index)
+        return false;
+
+    auto type_index = index->find(type);
+    if (type_index == index->end())
+        return false;
+
+    /* A selector value that is not in the xml can not match any entry */
+    if (!getSelectorIds(filled_selector_pairs, filled_ids))
+        return false;
+
+    for (auto &block : type_index->second.blocks) {
+        for (auto &entry : block) {
+            if (filled_ids.empty() ? entry.selector_ids.empty() :
+                    compareSelectorIds(entry.selector_ids, filled_ids)) {
+                for (int32_t k = 0; k < entry.info->kv_pairs.size(); k++) {
+                    keyVector.push_back(std::make_pair(entry.info->kv_pairs[k].key,
+                        entry.info->kv_pairs[k].value));
+                    PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n",
+                        entry.info->kv_pairs[k].key, entry.info->kv_pairs[k].value);
                 }
+                found = true;
+                break;
             }
         }
     }
@@ -2497,22 +2553,14 @@ bool PayloadBuilder::isIdTypeAvailable(int32_t type, std::vector<int>& id_type)
 std::vector<std::string> PayloadBuilder::retrieveSelectors(int32_t type, std::vector<allKVs> &any_type)
 {
     std::vector<std::string> gkv_selectors;
+    kvIndex *index = getKVIndex(any_type);
     PAL_DBG(LOG_TAG, "Enter: size_of_all :%zu type:%d", any_type.size(), type);
 
-    /* looping for all keys_and_values selectors and store in the gkv_selectors */
-    for (int32_t i = 0; i < any_type.size(); i++) {
-         if (isIdTypeAvailable(type, any_type[i].id_type)) {
-             PAL_DBG(LOG_TAG, "KeysAndValues_size: %zu", any_type[i].keys_values.size());
-             for(int32_t j = 0; j < any_type[i].keys_values.size(); j++) {
-                 for(int32_t k = 0; k < any_type[i].keys_values[j].selector_names.size(); k++) {
-                     gkv_selectors.push_back(any_type[i].keys_values[j].selector_names[k]);
-                 }
-             }
-         }
-    }
-
-    if (gkv_selectors.size())
-          removeDuplicateSelectors(gkv_selectors);
+    if (index) {
+        auto type_index = index->find(type);
+        if (type_index != index->end())
+            gkv_selectors = type_index->second.selector_names;
+    }
 
     for (int32_t i = 0; i < gkv_selectors.size(); i++) {
          PAL_DBG(LOG_TAG, "gkv_selectors: %s", gkv_selectors[i].c_str());
@@ -590,7 +590,7 @@ int Session::setSlotMask(const std::shared_ptr<ResourceManager>& rm, struct pal_
 
     // set FE ctl to BE first in case this is called from connectionSessionDevice
     rm->getBackendName(dAttr.id, backendname);
-    ctl = mixer_get_ctl_by_name(mixer, feName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, feName.str());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", feName.str().data());
         status = -EINVAL;
@@ -600,7 +600,7 @@ int Session::setSlotMask(const std::shared_ptr<ResourceManager>& rm, struct pal_
     ctl = NULL;
 
     // set tag data
-    ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
         status = -EINVAL;
@@ -942,7 +942,7 @@ int setConfig(Stream * s, pal_stream_type_t sType, configType type, uint32_t tag
                 goto exit;
             }
             tagCntrlName << stream << pcmDevIds.at(0) << " " << setParamTagControl;
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 return -ENOENT;
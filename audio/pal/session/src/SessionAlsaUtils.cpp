@@ -38,6 +38,8 @@
 #include <sstream>
 #include <string>
 #include <set>
+#include <mutex>
+#include <unordered_map>
 //#include "SessionAlsa.h"
 //#include "SessionAlsaPcm.h"
 //#include "SessionAlsaCompress.h"
@@ -79,6 +81,15 @@ static const char *beCtrlNames[] = {
     " grp config",
 };
 
+/*
+ * Controls of each mixer indexed by name. The AGM virtual card exposes thousands of
+ * controls and mixer_get_ctl_by_name() compares against all of them, so every mixer
+ * is scanned once on first use and later lookups are a hash lookup.
+ */
+static std::mutex mixerCtlCacheMutex;
+static std::unordered_map<struct mixer *,
+        std::unordered_map<std::string, struct mixer_ctl *>> mixerCtlCache;
+
 struct agmMetaData {
     uint8_t *buf;
     uint32_t size;
@@ -295,27 +306,66 @@ bool SessionAlsaUtils::isMmapUsecase(struct pal_stream_attributes sAttr)
 
 }
 
-struct mixer_ctl *SessionAlsaUtils::getStaticMixerControl(struct mixer *am, std::string name)
+struct mixer_ctl *SessionAlsaUtils::getMixerControl(struct mixer *am, const std::string &name)
 {
-    std::ostringstream cntrlName;
+    struct mixer_ctl *ctl = nullptr;
+    unsigned int numCtls;
+
+    if (!am)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mixerCtlCacheMutex);
+    auto cache = mixerCtlCache.find(am);
+    if (cache == mixerCtlCache.end()) {
+        cache = mixerCtlCache.emplace(am,
+                std::unordered_map<std::string, struct mixer_ctl *>()).first;
+        numCtls = mixer_get_num_ctls(am);
+        cache->second.reserve(numCtls);
+        for (unsigned int i = 0; i < numCtls; i++) {
+            ctl = mixer_get_ctl(am, i);
+            if (!ctl || !mixer_ctl_get_name(ctl))
+                continue;
+            /* keep the first match, as mixer_get_ctl_by_name() does */
+            cache->second.emplace(mixer_ctl_get_name(ctl), ctl);
+        }
+        PAL_DBG(LOG_TAG, "indexed %u mixer controls of mixer %pK", numCtls, am);
+    }
+
+    auto it = cache->second.find(name);
+    if (it != cache->second.end())
+        return it->second;
+
+    /* controls added after the mixer was indexed are only found by a full scan */
+    ctl = mixer_get_ctl_by_name(am, name.c_str());
+    if (ctl)
+        cache->second.emplace(name, ctl);
+
+    return ctl;
+}
+
+void SessionAlsaUtils::invalidateMixerCtlCache()
+{
+    std::lock_guard<std::mutex> lock(mixerCtlCacheMutex);
+    mixerCtlCache.clear();
+}
 
-    cntrlName << name;
-    PAL_DBG(LOG_TAG, "mixer control name is %s", cntrlName.str().data());
+struct mixer_ctl *SessionAlsaUtils::getStaticMixerControl(struct mixer *am, std::string name)
+{
+    PAL_DBG(LOG_TAG, "mixer control name is %s", name.c_str());
 
-    return mixer_get_ctl_by_name(am, cntrlName.str().data());
+    return getMixerControl(am, name);
 }
 
 struct mixer_ctl *SessionAlsaUtils::getFeMixerControl(struct mixer *am, std::string feName,
         uint32_t idx)
 {
-    std::ostringstream cntrlName;
     struct mixer_ctl *ctl = NULL;
 
-    cntrlName << feName << feCtrlNames[idx];
-    PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
-    ctl = mixer_get_ctl_by_name(am, cntrlName.str().data());
+    feName.append(feCtrlNames[idx]);
+    PAL_DBG(LOG_TAG, "mixer control %s", feName.c_str());
+    ctl = getMixerControl(am, feName);
     if (!ctl)
-        PAL_FATAL(LOG_TAG, "invalid mixer control: %s", cntrlName.str().data());
+        PAL_FATAL(LOG_TAG, "invalid mixer control: %s", feName.c_str());
 
     return ctl;
 }
@@ -323,11 +373,9 @@ struct mixer_ctl *SessionAlsaUtils::getFeMixerControl(struct mixer *am, std::str
 struct mixer_ctl *SessionAlsaUtils::getBeMixerControl(struct mixer *am, std::string beName,
         uint32_t idx)
 {
-    std::ostringstream cntrlName;
-
-    cntrlName << beName << beCtrlNames[idx];
-    PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
-    return mixer_get_ctl_by_name(am, cntrlName.str().data());
+    beName.append(beCtrlNames[idx]);
+    PAL_DBG(LOG_TAG, "mixer control %s", beName.c_str());
+    return getMixerControl(am, beName);
 }
 
 int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManager> rmHandle,
@@ -991,7 +1039,7 @@ int SessionAlsaUtils::getTimestamp(struct mixer *mixer, const std::vector<int> &
         return -EINVAL;
     }
     CntrlName<<pcmDeviceName<<" "<<getParamControl;
-    ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+    ctl = getMixerControl(mixer, CntrlName.str());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
         return -ENOENT;
@@ -1064,7 +1112,7 @@ int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1148,7 +1196,7 @@ int SessionAlsaUtils::getTagsWithModuleInfo(struct mixer *mixer, int device, con
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1200,7 +1248,7 @@ int SessionAlsaUtils::setMixerParameter(struct mixer *mixer, int device,
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1236,7 +1284,7 @@ int SessionAlsaUtils::setStreamMetadataType(struct mixer *mixer, int device, con
     }
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1290,7 +1338,7 @@ int SessionAlsaUtils::registerMixerEvent(struct mixer *mixer, int device, void *
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1329,7 +1377,7 @@ int SessionAlsaUtils::setECRefPath(struct mixer *mixer, int device, const char *
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     printf("%s mixer -%s-\n", __func__, mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         printf("Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1366,7 +1414,7 @@ int SessionAlsaUtils::mixerWriteDatapathParams(struct mixer *mixer, int device,
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -2022,7 +2070,7 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
             break;
     }
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
-    disconnectCtrl = mixer_get_ctl_by_name(mixerHandle, disconnectCtrlName.str().data());
+    disconnectCtrl = getMixerControl(mixerHandle, disconnectCtrlName.str());
     if (!disconnectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", disconnectCtrlName.str().data());
         return -EINVAL;
@@ -2120,7 +2168,7 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
             break;
     }
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
-    disconnectCtrl = mixer_get_ctl_by_name(mixerHandle, disconnectCtrlName.str().data());
+    disconnectCtrl = getMixerControl(mixerHandle, disconnectCtrlName.str());
     if (!disconnectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", disconnectCtrlName.str().data());
         return -EINVAL;
@@ -2259,7 +2307,7 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
          }
     }
 
-    connectCtrl = mixer_get_ctl_by_name(mixerHandle, connectCtrlName.str().data());
+    connectCtrl = getMixerControl(mixerHandle, connectCtrlName.str());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
         status = -EINVAL;
@@ -2329,7 +2377,7 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
         }
     }
 
-    connectCtrl = mixer_get_ctl_by_name(mixerHandle, connectCtrlName.str().data());
+    connectCtrl = getMixerControl(mixerHandle, connectCtrlName.str());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
         status = -EINVAL;
@@ -2547,7 +2595,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
 
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
 
-    aifMdCtrl = mixer_get_ctl_by_name(mixerHandle, aifMdName.str().data());
+    aifMdCtrl = getMixerControl(mixerHandle, aifMdName.str());
     PAL_DBG(LOG_TAG, "mixer control %s", aifMdName.str().data());
     if (!aifMdCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", aifMdName.str().data());
@@ -2557,7 +2605,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     if (deviceMetaData.size)
         mixer_ctl_set_array(aifMdCtrl, (void *)deviceMetaData.buf, deviceMetaData.size);
 
-    feCtrl = mixer_get_ctl_by_name(mixerHandle, cntrlName.str().data());
+    feCtrl = getMixerControl(mixerHandle, cntrlName.str());
     PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
     if (!feCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", cntrlName.str().data());
@@ -2566,7 +2614,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     }
     mixer_ctl_set_enum_by_string(feCtrl, aifBackEndsToConnect[0].second.data());
 
-    feMdCtrl = mixer_get_ctl_by_name(mixerHandle, feMdName.str().data());
+    feMdCtrl = getMixerControl(mixerHandle, feMdName.str());
     PAL_DBG(LOG_TAG, "mixer control %s", feMdName.str().data());
     if (!feMdCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", feMdName.str().data());
@@ -127,6 +127,11 @@ int32_t SoundTriggerEngine::CreateBuffer(uint32_t buffer_size,
     }
 
     if (engine_size != reader_list.size()) {
+        /* the caller hands out the new readers in place of these, free them here */
+        for (i = 0; i < reader_list.size(); i++) {
+            buffer_->removeReader(reader_list[i]);
+            delete reader_list[i];
+        }
         reader_list.clear();
         for (i = 0; i < engine_size; i++) {
             reader = buffer_->newReader();
@@ -195,6 +195,89 @@ void SoundTriggerEngineGsl::CheckAndSetDetectionConfLevels(Stream *s) {
             st->GetSoundModelInfo()->GetDetConfLevels()[i]);
 }
 
+/*
+ * Reads read_size bytes from the session straight into the ring buffer.
+ * Session reads are kept to whole periods: when the reserved region wraps
+ * in the middle of a period, that period is read into bounce_buf and split
+ * over the two spans. Nothing is read while the ring buffer has no room
+ * for read_size, *size is 0 then.
+ */
+int32_t SoundTriggerEngineGsl::ReadToRingBuffer(Session *session, Stream *s,
+    PalRingBuffer *buffer, size_t read_size, size_t period_size,
+    uint8_t *bounce_buf, struct pal_ring_buffer_region *region,
+    int32_t *size) {
+    int32_t status = 0;
+    int32_t read_bytes = 0;
+    size_t split_size = 0;
+    size_t head_size = 0;
+    uint8_t *dst[3];
+    size_t dst_size[3];
+    struct pal_buffer buf;
+
+    *size = 0;
+    if (buffer->reserve(read_size, region) < read_size) {
+        buffer->commit(0);
+        return 0;
+    }
+
+    // whole periods of the first span, the period across the wrap, the rest
+    split_size = region->size[1] ? region->size[0] % period_size : 0;
+    head_size = split_size ?
+        std::min(period_size - split_size, region->size[1]) : 0;
+    dst[0] = (uint8_t *)region->data[0];
+    dst_size[0] = region->size[0] - split_size;
+    dst[1] = bounce_buf;
+    dst_size[1] = split_size + head_size;
+    dst[2] = (uint8_t *)region->data[1] + head_size;
+    dst_size[2] = region->size[1] - head_size;
+
+    for (int i = 0; i < 3; i++) {
+        if (!dst_size[i])
+            continue;
+
+        std::memset(&buf, 0, sizeof(struct pal_buffer));
+        buf.buffer = dst[i];
+        buf.size = dst_size[i];
+        status = session->read(s, SHMEM_ENDPOINT, &buf, &read_bytes);
+        if (status)
+            break;
+
+        if (dst[i] == bounce_buf) {
+            ar_mem_cpy((uint8_t *)region->data[0] + dst_size[0], split_size,
+                bounce_buf, std::min((size_t)read_bytes, split_size));
+            if ((size_t)read_bytes > split_size)
+                ar_mem_cpy((uint8_t *)region->data[1], head_size,
+                    bounce_buf + split_size, read_bytes - split_size);
+        }
+        *size += read_bytes;
+        if ((size_t)read_bytes != dst_size[i])
+            break;
+    }
+    buffer->commit(*size);
+
+    return status;
+}
+
+size_t SoundTriggerEngineGsl::WriteToRingBuffer(uint8_t *data, size_t size,
+    uint32_t *bytes_to_drop, FILE *dump_fd) {
+    size_t ret = 0;
+
+    if (*bytes_to_drop >= size) {
+        *bytes_to_drop -= size;
+        return 0;
+    }
+
+    data += *bytes_to_drop;
+    size -= *bytes_to_drop;
+    *bytes_to_drop = 0;
+    ret = buffer_->write((void *)data, size);
+    if (st_info_->GetEnableDebugDumps()) {
+        ST_DBG_FILE_WRITE(dump_fd, data, size);
+    }
+
+    return ret;
+}
+
 int32_t SoundTriggerEngineGsl::StartBuffering(Stream *s) {
     int32_t status = 0;
     int32_t size = 0;
@@ -206,9 +289,15 @@ int32_t SoundTriggerEngineGsl::StartBuffering(Stream *s) {
     size_t total_read_size = 0;
     size_t ftrt_size = 0;
     size_t size_to_read = 0;
+    size_t read_size = 0;
     size_t read_offset = 0;
     size_t bytes_written = 0;
+    size_t ret = 0;
+    uint8_t *src[2] = {nullptr, nullptr};
+    size_t src_size[2] = {0, 0};
+    struct pal_ring_buffer_region region;
     uint32_t sleep_ms = 0;
+    uint32_t period_ms = 0;
     bool event_notified = false;
     StreamSoundTrigger *st = (StreamSoundTrigger *)s;
     struct pal_mmap_position mmap_pos;
@@ -224,6 +313,7 @@ int32_t SoundTriggerEngineGsl::StartBuffering(Stream *s) {
         BITS_PER_BYTE * MS_PER_SEC /
         (sm_cfg_->GetSampleRate() * sm_cfg_->GetBitWidth() *
         sm_cfg_->GetOutChannels());
+    period_ms = sleep_ms / input_buf_num;
 
     std::memset(&buf, 0, sizeof(struct pal_buffer));
     buf.size = input_buf_size * input_buf_num;
@@ -311,73 +401,68 @@ int32_t SoundTriggerEngineGsl::StartBuffering(Stream *s) {
                 goto exit;
             }
 
-            if (size_to_read != buf.size) {
-                buf.buffer = (uint8_t *)realloc(buf.buffer, size_to_read);
-                if (!buf.buffer) {
-                    PAL_ERR(LOG_TAG, "buf.buffer allocation failed");
-                    status = -ENOMEM;
-                    goto exit;
-                }
-                buf.size = size_to_read;
-            }
-
-            // TODO: directly write to PalRingBuffer with shared buffer pointer
-            if (read_offset + size_to_read <= mmap_buffer_size_) {
-                ar_mem_cpy(buf.buffer, size_to_read,
-                    (uint8_t *)mmap_buffer_.buffer + read_offset,
-                    size_to_read);
-                read_offset += size_to_read;
-            } else {
-                ar_mem_cpy(buf.buffer, mmap_buffer_size_ - read_offset,
-                    (uint8_t *)mmap_buffer_.buffer + read_offset,
-                    mmap_buffer_size_ - read_offset);
-                ar_mem_cpy(buf.buffer + mmap_buffer_size_ - read_offset,
-                    size_to_read + read_offset - mmap_buffer_size_,
-                    (uint8_t *)mmap_buffer_.buffer,
-                    size_to_read + read_offset - mmap_buffer_size_);
-                read_offset = size_to_read + read_offset - mmap_buffer_size_;
-            }
+            // copy from shared buffer straight into ring buffer
+            src[0] = (uint8_t *)mmap_buffer_.buffer + read_offset;
+            src_size[0] = std::min(size_to_read, mmap_buffer_size_ - read_offset);
+            src[1] = (uint8_t *)mmap_buffer_.buffer;
+            src_size[1] = size_to_read - src_size[0];
+            read_offset = (read_offset + size_to_read) % mmap_buffer_size_;
             size = size_to_read;
             PAL_VERBOSE(LOG_TAG, "read %d bytes from shared buffer", size);
             total_read_size += size;
-        } else if (buffer_->getFreeSize() >= buf.size) {
+        } else {
+            read_size = buf.size;
             if (total_read_size < ftrt_size &&
-                ftrt_size - total_read_size < buf.size) {
-                buf.size = ftrt_size - total_read_size;
-                status = session_->read(s, SHMEM_ENDPOINT, &buf, &size);
-                buf.size = input_buf_size * input_buf_num;
+                ftrt_size - total_read_size < read_size)
+                read_size = ftrt_size - total_read_size;
+
+            size = 0;
+            if (bytes_to_drop) {
+                // dropped data never reaches ring buffer, read it aside
+                if (buffer_->getFreeSize() >= read_size) {
+                    buf.size = read_size;
+                    status = session_->read(s, SHMEM_ENDPOINT, &buf, &size);
+                    buf.size = input_buf_size * input_buf_num;
+                    src[0] = buf.buffer;
+                    src_size[0] = size;
+                }
             } else {
-                status = session_->read(s, SHMEM_ENDPOINT, &buf, &size);
+                // read into ring buffer directly, in whole periods
+                status = ReadToRingBuffer(session_, s, buffer_, read_size,
+                    input_buf_size, buf.buffer, &region, &size);
+                if (size && st_info_->GetEnableDebugDumps()) {
+                    ST_DBG_FILE_WRITE(dsp_output_fd, region.data[0],
+                        std::min((size_t)size, region.size[0]));
+                    if ((size_t)size > region.size[0])
+                        ST_DBG_FILE_WRITE(dsp_output_fd, region.data[1],
+                            size - region.size[0]);
+                }
             }
             if (status) {
                 break;
             }
-            PAL_VERBOSE(LOG_TAG, "requested %zu, read %d", buf.size, size);
+            if (!size) {
+                /*
+                 * Ring buffer is full, nothing was read. Let the readers
+                 * drain it for a period instead of polling it, and let
+                 * stop/restart through in the meantime.
+                 */
+                mutex_.unlock();
+                std::this_thread::sleep_for(std::chrono::milliseconds(period_ms));
+                mutex_.lock();
+            }
+            PAL_VERBOSE(LOG_TAG, "requested %zu, read %d", read_size, size);
             total_read_size += size;
         }
         ATRACE_ASYNC_END("stEngine: lab read", (int32_t)module_type_);
-        // write data to ring buffer
-        if (size) {
-            size_t ret = 0;
-            if (bytes_to_drop) {
-                if (size < bytes_to_drop) {
-                    bytes_to_drop -= size;
-                } else {
-                    ret = buffer_->write((void*)(buf.buffer + bytes_to_drop),
-                        size - bytes_to_drop);
-                    bytes_to_drop = 0;
-                    if (st_info_->GetEnableDebugDumps()) {
-                        ST_DBG_FILE_WRITE(dsp_output_fd,
-                            buf.buffer + bytes_to_drop, size - bytes_to_drop);
-                    }
-                }
-            } else {
-                ret = buffer_->write(buf.buffer, size);
-                if (st_info_->GetEnableDebugDumps()) {
-                    ST_DBG_FILE_WRITE(dsp_output_fd, buf.buffer, size);
-                }
-            }
+        // write data copied aside to ring buffer
+        for (int i = 0; i < 2; i++) {
+            if (!src_size[i])
+                continue;
+            ret = WriteToRingBuffer(src[i], src_size[i], &bytes_to_drop,
+                dsp_output_fd);
             PAL_VERBOSE(LOG_TAG, "%zu written to ring buffer", ret);
+            src_size[i] = 0;
         }
 
         // notify client until ftrt data read
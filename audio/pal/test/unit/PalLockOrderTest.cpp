@@ -0,0 +1,262 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/* the checker is on whatever the build variant of the library */
+#define PAL_LOCK_ORDER_CHECK
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "PalLockOrder.h"
+
+namespace {
+
+const int kStreamThreads = 24;
+const int kReaderThreads = 4;
+const int kCycles = 500;
+const int kDevices = 8;
+
+/*
+ * Own mutex types, so the checked PalRankedMutex instantiations here do not
+ * collide with the ones in libar-pal.
+ */
+class TestMutex : public std::mutex {};
+class TestSharedMutex : public std::shared_timed_mutex {};
+
+struct FakeStream {
+    std::mutex mStreamMutex;
+    int device;
+};
+
+/*
+ * The ResourceManager globals with the ranks of the real ones, and the
+ * tables they guard.
+ */
+struct FakeResourceManager {
+    PalRankedMutex<TestMutex> mActiveStreamMutex{PAL_LOCK_RANK_ACTIVE_STREAM};
+    PalRankedMutex<TestMutex> mGraphMutex{PAL_LOCK_RANK_GRAPH};
+    PalRankedMutex<TestSharedMutex> mResourceManagerMutex{PAL_LOCK_RANK_RESOURCE_MANAGER};
+    PalRankedMutex<TestSharedMutex> mValidStreamMutex{PAL_LOCK_RANK_VALID_STREAM};
+    PalRankedMutex<TestMutex> mListFrontEndsMutex{PAL_LOCK_RANK_LIST_FRONT_ENDS};
+    PalRankedMutex<TestMutex> mSleepMonitorMutex{PAL_LOCK_RANK_SLEEP_MONITOR};
+
+    std::unordered_set<FakeStream *> mValidStreams;
+    std::list<FakeStream *> mActiveStreams;
+    std::map<int, int> mDeviceRefCounts;
+    int mFrontEnds = 0;
+    int mLpiVotes = 0;
+
+    /* pal_stream_open(): handle check, registerStream(), front end allocation */
+    void open(FakeStream *s)
+    {
+        mValidStreamMutex.lock();
+        mValidStreams.insert(s);
+        mValidStreamMutex.unlock();
+
+        mActiveStreamMutex.lock();
+        mValidStreamMutex.lock();
+        mActiveStreams.push_back(s);
+        mValidStreamMutex.unlock();
+        mActiveStreamMutex.unlock();
+
+        mListFrontEndsMutex.lock();
+        mFrontEnds++;
+        mListFrontEndsMutex.unlock();
+    }
+
+    /* Stream::start(): graph open, device enable and sleep monitor vote */
+    void start(FakeStream *s)
+    {
+        mActiveStreamMutex.lock();
+        std::lock_guard<std::mutex> lock(s->mStreamMutex);
+        mGraphMutex.lock();
+        mResourceManagerMutex.lock();
+        mDeviceRefCounts[s->device]++;
+        mResourceManagerMutex.unlock();
+        mSleepMonitorMutex.lock();
+        mLpiVotes++;
+        mSleepMonitorMutex.unlock();
+        mGraphMutex.unlock();
+        mActiveStreamMutex.unlock();
+    }
+
+    /* switchDevice(): disconnect from the old device, connect the new one */
+    void switchDevice(FakeStream *s, int device)
+    {
+        mActiveStreamMutex.lock();
+        std::lock_guard<std::mutex> lock(s->mStreamMutex);
+        mGraphMutex.lock();
+        mResourceManagerMutex.lock();
+        mDeviceRefCounts[s->device]--;
+        s->device = device;
+        mDeviceRefCounts[s->device]++;
+        mResourceManagerMutex.unlock();
+        mGraphMutex.unlock();
+        mActiveStreamMutex.unlock();
+    }
+
+    void stop(FakeStream *s)
+    {
+        mActiveStreamMutex.lock();
+        std::lock_guard<std::mutex> lock(s->mStreamMutex);
+        mGraphMutex.lock();
+        mResourceManagerMutex.lock();
+        mDeviceRefCounts[s->device]--;
+        mResourceManagerMutex.unlock();
+        mSleepMonitorMutex.lock();
+        mLpiVotes--;
+        mSleepMonitorMutex.unlock();
+        mGraphMutex.unlock();
+        mActiveStreamMutex.unlock();
+    }
+
+    /* pal_stream_close(): deregisterStream(), front end release */
+    void close(FakeStream *s)
+    {
+        mActiveStreamMutex.lock();
+        mValidStreamMutex.lock();
+        mActiveStreams.remove(s);
+        mValidStreams.erase(s);
+        mValidStreamMutex.unlock();
+        mActiveStreamMutex.unlock();
+
+        mListFrontEndsMutex.lock();
+        mFrontEnds--;
+        mListFrontEndsMutex.unlock();
+    }
+
+    /* the pal_stream_* handle check */
+    bool isValidStream(FakeStream *s)
+    {
+        mValidStreamMutex.lock_shared();
+        bool valid = mValidStreams.count(s) != 0;
+        mValidStreamMutex.unlock_shared();
+        return valid;
+    }
+
+    /* isDeviceActive() */
+    bool isDeviceActive(int device)
+    {
+        mResourceManagerMutex.lock_shared();
+        auto it = mDeviceRefCounts.find(device);
+        bool active = it != mDeviceRefCounts.end() && it->second > 0;
+        mResourceManagerMutex.unlock_shared();
+        return active;
+    }
+};
+
+} // namespace
+
+/*
+ * Streams opening, starting, switching, stopping and closing in parallel
+ * with threads doing the shared lookups. Any lock taken out of rank order
+ * aborts. Run the host build under TSAN to check the tables for races.
+ */
+TEST(PalLockOrderTest, StressFakeStreams)
+{
+    FakeResourceManager rm;
+    std::atomic<bool> done{false};
+    std::atomic<long> invalid{0}, reads{0};
+    std::vector<std::thread> threads;
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int t = 0; t < kReaderThreads; t++) {
+        threads.emplace_back([&, t] {
+            for (int n = 0; !done; n++) {
+                rm.isDeviceActive((t + n) % kDevices);
+                reads++;
+            }
+        });
+    }
+    std::vector<std::thread> streamThreads;
+    for (int t = 0; t < kStreamThreads; t++) {
+        streamThreads.emplace_back([&, t] {
+            for (int n = 0; n < kCycles; n++) {
+                FakeStream stream;
+                stream.device = t % kDevices;
+
+                rm.open(&stream);
+                rm.start(&stream);
+                rm.switchDevice(&stream, (t + n + 1) % kDevices);
+                if (!rm.isValidStream(&stream))
+                    invalid++;
+                reads++;
+                rm.stop(&stream);
+                rm.close(&stream);
+            }
+        });
+    }
+    for (auto &thread : streamThreads)
+        thread.join();
+    done = true;
+    for (auto &thread : threads)
+        thread.join();
+    auto time = std::chrono::steady_clock::now() - begin;
+
+    EXPECT_EQ(0, invalid);
+    EXPECT_TRUE(rm.mValidStreams.empty());
+    EXPECT_TRUE(rm.mActiveStreams.empty());
+    EXPECT_EQ(0, rm.mFrontEnds);
+    EXPECT_EQ(0, rm.mLpiVotes);
+    for (auto &count : rm.mDeviceRefCounts)
+        EXPECT_EQ(0, count.second) << "device " << count.first;
+    std::cout << kStreamThreads * kCycles << " stream cycles, " << reads << " shared reads in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(time).count() << " ms"
+              << std::endl;
+}
+
+TEST(PalLockOrderTest, InversionAborts)
+{
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    FakeResourceManager rm;
+
+    /* setParameter() has to drop the resource manager mutex first */
+    EXPECT_DEATH({
+        rm.mResourceManagerMutex.lock();
+        rm.mActiveStreamMutex.lock();
+    }, "");
+    EXPECT_DEATH({
+        rm.mGraphMutex.lock();
+        rm.mGraphMutex.lock();
+    }, "");
+    EXPECT_DEATH({
+        rm.mValidStreamMutex.lock_shared();
+        rm.mResourceManagerMutex.lock_shared();
+    }, "");
+}
+
+TEST(PalLockOrderTest, RankedOrderDoesNotAbort)
+{
+    FakeResourceManager rm;
+
+    rm.mActiveStreamMutex.lock();
+    rm.mGraphMutex.lock();
+    rm.mResourceManagerMutex.lock_shared();
+    rm.mValidStreamMutex.lock();
+    rm.mListFrontEndsMutex.lock();
+    rm.mSleepMonitorMutex.lock();
+    rm.mSleepMonitorMutex.unlock();
+    rm.mListFrontEndsMutex.unlock();
+    rm.mValidStreamMutex.unlock();
+    rm.mResourceManagerMutex.unlock_shared();
+    rm.mGraphMutex.unlock();
+    rm.mActiveStreamMutex.unlock();
+
+    /* a dropped mutex can be retaken after a lower rank one */
+    rm.mResourceManagerMutex.lock();
+    rm.mResourceManagerMutex.unlock();
+    rm.mActiveStreamMutex.lock();
+    rm.mActiveStreamMutex.unlock();
+}
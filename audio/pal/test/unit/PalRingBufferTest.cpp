@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "PalRingBuffer.h"
+
+namespace {
+
+/* 20ms of 16kHz mono 16 bit audio, the LAB period of a voice UI session */
+const size_t kPeriodSize = 640;
+
+void fillPattern(char *data, size_t size, size_t offset)
+{
+    for (size_t i = 0; i < size; i++)
+        data[i] = (char)((offset + i) * 7);
+}
+
+/*
+ * The single mutex implementation PalRingBuffer had before it became lock
+ * free, kept as the reference for the benchmark.
+ */
+class MutexRingBuffer {
+ public:
+    struct Reader {
+        size_t readOffset = 0;
+        size_t unreadSize = 0;
+    };
+
+    explicit MutexRingBuffer(size_t size) : buffer_(size), writeOffset_(0) {}
+
+    Reader *newReader()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        readers_.push_back(new Reader());
+        return readers_.back();
+    }
+
+    ~MutexRingBuffer()
+    {
+        for (Reader *reader : readers_)
+            delete reader;
+    }
+
+    size_t write(const char *data, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t freeSize = buffer_.size();
+        size_t first = 0;
+
+        for (Reader *reader : readers_)
+            freeSize = std::min(freeSize, buffer_.size() - reader->unreadSize);
+        size = std::min(size, freeSize);
+        first = std::min(size, buffer_.size() - writeOffset_);
+        memcpy(&buffer_[writeOffset_], data, first);
+        memcpy(&buffer_[0], data + first, size - first);
+        writeOffset_ = (writeOffset_ + size) % buffer_.size();
+        for (Reader *reader : readers_)
+            reader->unreadSize += size;
+
+        return size;
+    }
+
+    size_t read(Reader *reader, char *data, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t first = 0;
+
+        size = std::min(size, reader->unreadSize);
+        first = std::min(size, buffer_.size() - reader->readOffset);
+        memcpy(data, &buffer_[reader->readOffset], first);
+        memcpy(data + first, &buffer_[0], size - first);
+        reader->readOffset = (reader->readOffset + size) % buffer_.size();
+        reader->unreadSize -= size;
+
+        return size;
+    }
+
+ private:
+    std::mutex mutex_;
+    std::vector<char> buffer_;
+    size_t writeOffset_;
+    std::vector<Reader *> readers_;
+};
+
+/*
+ * Streams totalSize bytes from one writer thread to numReaders reader threads
+ * and returns the time it took, in the LAB pattern of one period per write.
+ */
+template <class WriteFn, class ReadFn>
+std::chrono::nanoseconds streamPeriods(size_t totalSize, int numReaders, WriteFn writeFn,
+                                       ReadFn readFn)
+{
+    std::vector<std::thread> readers;
+    auto begin = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < numReaders; i++) {
+        readers.emplace_back([&, i] {
+            char data[kPeriodSize];
+            size_t readSize = 0;
+
+            while (readSize < totalSize) {
+                size_t size = readFn(i, data, sizeof(data));
+                if (!size)
+                    std::this_thread::yield();
+                readSize += size;
+            }
+        });
+    }
+
+    char data[kPeriodSize] = {};
+    size_t writtenSize = 0;
+    while (writtenSize < totalSize) {
+        size_t size = writeFn(data, std::min(sizeof(data), totalSize - writtenSize));
+        if (!size)
+            std::this_thread::yield();
+        writtenSize += size;
+    }
+
+    for (std::thread &reader : readers)
+        reader.join();
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin);
+}
+
+}  // namespace
+
+TEST(PalRingBufferTest, ReadersGetAllData)
+{
+    /* more readers than the initial slots, the slot array has to grow */
+    const int numReaders = PAL_RING_BUFFER_INIT_READER_SLOTS * 4 + 1;
+    PalRingBuffer ringBuffer(kPeriodSize * 4);
+    std::vector<PalRingBufferReader *> readers;
+    char data[kPeriodSize * 3];
+    char readData[kPeriodSize * 3];
+
+    for (int i = 0; i < numReaders; i++) {
+        readers.push_back(ringBuffer.newReader());
+        ASSERT_NE(nullptr, readers.back());
+        readers.back()->updateState(READER_ENABLED);
+    }
+
+    for (size_t offset = 0; offset < kPeriodSize * 30; offset += sizeof(data)) {
+        fillPattern(data, sizeof(data), offset);
+        ASSERT_EQ(sizeof(data), ringBuffer.write(data, sizeof(data)));
+        /* the slowest reader holds the space */
+        EXPECT_EQ(kPeriodSize, ringBuffer.getFreeSize());
+        for (PalRingBufferReader *reader : readers) {
+            EXPECT_EQ(sizeof(data), reader->getUnreadSize());
+            ASSERT_EQ((int32_t)sizeof(readData), reader->read(readData, sizeof(readData)));
+            ASSERT_EQ(0, memcmp(data, readData, sizeof(data)));
+        }
+        EXPECT_EQ(kPeriodSize * 4, ringBuffer.getFreeSize());
+    }
+
+    for (PalRingBufferReader *reader : readers) {
+        ringBuffer.removeReader(reader);
+        delete reader;
+    }
+}
+
+TEST(PalRingBufferTest, SlowestReaderLimitsWriter)
+{
+    PalRingBuffer ringBuffer(kPeriodSize * 2);
+    PalRingBufferReader *fast = ringBuffer.newReader();
+    PalRingBufferReader *slow = ringBuffer.newReader();
+    PalRingBufferReader *disabled = ringBuffer.newReader();
+    char data[kPeriodSize] = {};
+
+    fast->updateState(READER_ENABLED);
+    slow->updateState(READER_ENABLED);
+
+    EXPECT_EQ(kPeriodSize, ringBuffer.write(data, kPeriodSize));
+    EXPECT_EQ((int32_t)kPeriodSize, fast->read(data, kPeriodSize));
+    EXPECT_EQ(kPeriodSize, ringBuffer.write(data, kPeriodSize));
+    /* slow has not read anything, disabled readers do not hold space */
+    EXPECT_EQ(0u, ringBuffer.write(data, kPeriodSize));
+    EXPECT_EQ(kPeriodSize * 2, slow->advanceReadOffset(kPeriodSize * 2));
+    EXPECT_EQ(kPeriodSize, ringBuffer.write(data, kPeriodSize));
+
+    ringBuffer.reset();
+    EXPECT_FALSE(fast->isEnabled());
+    EXPECT_EQ(0u, fast->getUnreadSize());
+    EXPECT_EQ(kPeriodSize * 2, ringBuffer.getFreeSize());
+
+    ringBuffer.removeReader(fast);
+    ringBuffer.removeReader(slow);
+    ringBuffer.removeReader(disabled);
+    delete fast;
+    delete slow;
+    delete disabled;
+}
+
+/* readers come and go, and the slot array grows, while the writer scans them */
+TEST(PalRingBufferTest, ReaderChurnWhileWriting)
+{
+    PalRingBuffer ringBuffer(kPeriodSize * 8);
+    std::atomic<bool> stop(false);
+    std::thread writer([&] {
+        char data[kPeriodSize] = {};
+        while (!stop.load())
+            ringBuffer.write(data, sizeof(data));
+    });
+    char data[kPeriodSize];
+
+    for (int round = 0; round < 200; round++) {
+        std::vector<PalRingBufferReader *> readers;
+        for (int i = 0; i < (round % 40) + 1; i++) {
+            readers.push_back(ringBuffer.newReader());
+            readers.back()->updateState(READER_ENABLED);
+        }
+        for (PalRingBufferReader *reader : readers) {
+            reader->read(data, sizeof(data));
+            ringBuffer.removeReader(reader);
+            delete reader;
+        }
+    }
+
+    stop = true;
+    writer.join();
+}
+
+TEST(PalRingBufferTest, ResetWhileRemovingReaders)
+{
+    PalRingBuffer ringBuffer(kPeriodSize * 8);
+    std::atomic<bool> stop(false);
+    std::thread control([&] {
+        while (!stop.load())
+            ringBuffer.reset();
+    });
+
+    for (int i = 0; i < 20000; i++) {
+        PalRingBufferReader *reader = ringBuffer.newReader();
+        reader->updateState(READER_ENABLED);
+        ringBuffer.removeReader(reader);
+        delete reader;
+    }
+
+    stop = true;
+    control.join();
+}
+
+TEST(PalRingBufferTest, Throughput)
+{
+    const size_t totalSize = kPeriodSize * 20000;
+
+    for (int numReaders : {1, 2, 4}) {
+        PalRingBuffer ringBuffer(kPeriodSize * 50);
+        std::vector<PalRingBufferReader *> readers;
+        for (int i = 0; i < numReaders; i++) {
+            readers.push_back(ringBuffer.newReader());
+            readers.back()->updateState(READER_ENABLED);
+        }
+        auto lockFreeTime = streamPeriods(totalSize, numReaders,
+            [&](char *data, size_t size) { return ringBuffer.write(data, size); },
+            [&](int i, char *data, size_t size) {
+                return (size_t)readers[i]->read(data, size);
+            });
+        for (PalRingBufferReader *reader : readers) {
+            ringBuffer.removeReader(reader);
+            delete reader;
+        }
+
+        MutexRingBuffer mutexBuffer(kPeriodSize * 50);
+        std::vector<MutexRingBuffer::Reader *> mutexReaders;
+        for (int i = 0; i < numReaders; i++)
+            mutexReaders.push_back(mutexBuffer.newReader());
+        auto mutexTime = streamPeriods(totalSize, numReaders,
+            [&](char *data, size_t size) { return mutexBuffer.write(data, size); },
+            [&](int i, char *data, size_t size) {
+                return mutexBuffer.read(mutexReaders[i], data, size);
+            });
+
+        std::cout << numReaders << " readers: lock free " << lockFreeTime.count() / 20000
+                  << " ns, mutex " << mutexTime.count() / 20000 << " ns per period"
+                  << std::endl;
+    }
+}
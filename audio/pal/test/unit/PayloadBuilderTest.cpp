@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+#include <glob.h>
+#include <libgen.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "PayloadBuilder.h"
+
+namespace {
+
+typedef std::vector<std::pair<selector_type_t, std::string>> SelectorPairs;
+typedef std::vector<std::pair<int, int>> KeyVector;
+
+/* Queries built from the selector values of a type, capped per type */
+const size_t kMaxQueries = 4000;
+
+/*
+ * The linear scans PayloadBuilder had before the KV index, kept as the
+ * reference. Entry selectors are sorted on a copy, the old code sorted the
+ * parsed tables in place.
+ */
+bool linearCompareSelectorPairs(SelectorPairs selector_pairs, SelectorPairs &filled_selector_pairs)
+{
+    size_t count = 0;
+
+    if (selector_pairs.size() == filled_selector_pairs.size()) {
+        std::sort(filled_selector_pairs.begin(), filled_selector_pairs.end());
+        std::sort(selector_pairs.begin(), selector_pairs.end());
+        return std::equal(selector_pairs.begin(), selector_pairs.end(),
+            filled_selector_pairs.begin());
+    }
+
+    for (size_t i = 0; i < filled_selector_pairs.size(); i++) {
+        if (selector_pairs.end() != std::find(selector_pairs.begin(),
+            selector_pairs.end(), filled_selector_pairs[i]))
+            count++;
+    }
+    return filled_selector_pairs.size() == count;
+}
+
+bool linearHasType(int32_t type, const std::vector<int> &id_type)
+{
+    return std::find(id_type.begin(), id_type.end(), type) != id_type.end();
+}
+
+bool linearFindKVs(SelectorPairs &filled_selector_pairs, uint32_t type,
+    std::vector<allKVs> &any_type, KeyVector &keyVector)
+{
+    bool found = false;
+
+    for (size_t i = 0; i < any_type.size(); i++) {
+        if (!linearHasType(type, any_type[i].id_type))
+            continue;
+        for (size_t j = 0; j < any_type[i].keys_values.size(); j++) {
+            kvInfo &info = any_type[i].keys_values[j];
+            if (filled_selector_pairs.empty() ? info.selector_pairs.empty() :
+                    linearCompareSelectorPairs(info.selector_pairs, filled_selector_pairs)) {
+                for (size_t k = 0; k < info.kv_pairs.size(); k++)
+                    keyVector.push_back(std::make_pair(info.kv_pairs[k].key,
+                        info.kv_pairs[k].value));
+                found = true;
+                break;
+            }
+        }
+    }
+    return found;
+}
+
+int linearRetrieveKVs(SelectorPairs &filled_selector_pairs, uint32_t type,
+    std::vector<allKVs> &any_type, KeyVector &keyVector)
+{
+    bool custom_config_fallback = false;
+
+    if (linearFindKVs(filled_selector_pairs, type, any_type, keyVector))
+        return 0;
+
+    for (size_t i = 0; i < filled_selector_pairs.size(); i++) {
+        if (filled_selector_pairs[i].first == CUSTOM_CONFIG_SEL) {
+            filled_selector_pairs.erase(filled_selector_pairs.begin() + i);
+            custom_config_fallback = true;
+        }
+    }
+    if (custom_config_fallback &&
+            linearFindKVs(filled_selector_pairs, type, any_type, keyVector))
+        return 0;
+
+    return -EINVAL;
+}
+
+std::vector<std::string> linearRetrieveSelectors(int32_t type, std::vector<allKVs> &any_type)
+{
+    std::vector<std::string> gkv_selectors;
+
+    for (size_t i = 0; i < any_type.size(); i++) {
+        if (!linearHasType(type, any_type[i].id_type))
+            continue;
+        for (auto &info : any_type[i].keys_values)
+            gkv_selectors.insert(gkv_selectors.end(), info.selector_names.begin(),
+                info.selector_names.end());
+    }
+
+    auto end = gkv_selectors.end();
+    for (auto i = gkv_selectors.begin(); i != end; ++i)
+        end = std::remove(i + 1, end, *i);
+    gkv_selectors.erase(end, gkv_selectors.end());
+
+    return gkv_selectors;
+}
+
+class PayloadBuilderTables : public PayloadBuilder {
+ public:
+    using PayloadBuilder::all_streams;
+    using PayloadBuilder::all_streampps;
+    using PayloadBuilder::all_devices;
+    using PayloadBuilder::all_devicepps;
+    using PayloadBuilder::selector_ids;
+
+    static std::vector<std::vector<allKVs> *> tables()
+    {
+        return {&all_streams, &all_streampps, &all_devices, &all_devicepps};
+    }
+
+    /* Parses xml_file and builds the index as init() does for the file of the SoC */
+    static bool load(const std::string &xml_file)
+    {
+        struct user_xml_data tag_data;
+        char buf[1024];
+        size_t bytes_read;
+        bool ok = true;
+
+        memset(&tag_data, 0, sizeof(tag_data));
+        for (auto table : tables())
+            table->clear();
+        selector_ids.clear();
+
+        FILE *file = fopen(xml_file.c_str(), "r");
+        if (!file)
+            return false;
+        XML_Parser parser = XML_ParserCreate(NULL);
+        XML_SetUserData(parser, &tag_data);
+        XML_SetElementHandler(parser, startTag, endTag);
+        XML_SetCharacterDataHandler(parser, handleData);
+        do {
+            bytes_read = fread(buf, 1, sizeof(buf), file);
+            if (XML_Parse(parser, buf, (int)bytes_read, bytes_read == 0) == XML_STATUS_ERROR)
+                ok = false;
+        } while (ok && bytes_read);
+        XML_ParserFree(parser);
+        fclose(file);
+
+        buildKVIndex(all_streams, stream_index);
+        buildKVIndex(all_streampps, streampp_index);
+        buildKVIndex(all_devices, device_index);
+        buildKVIndex(all_devicepps, devicepp_index);
+        return ok;
+    }
+};
+
+/*
+ * The usecase XML of every target, installed with the test, and the one of
+ * this device.
+ */
+std::vector<std::string> usecaseXmlFiles()
+{
+    std::vector<std::string> files;
+    char exe[PATH_MAX] = {};
+    std::vector<std::string> patterns = {"/vendor/etc/usecaseKvManager*.xml"};
+
+    if (readlink("/proc/self/exe", exe, sizeof(exe) - 1) > 0)
+        patterns.insert(patterns.begin(),
+            std::string(dirname(exe)) + "/configs/*/usecaseKvManager*.xml");
+
+    for (auto &pattern : patterns) {
+        glob_t matches = {};
+        if (!glob(pattern.c_str(), 0, NULL, &matches)) {
+            for (size_t i = 0; i < matches.gl_pathc; i++)
+                files.push_back(matches.gl_pathv[i]);
+        }
+        globfree(&matches);
+    }
+    return files;
+}
+
+/*
+ * Lookups for one type: every combination of the values the table has for
+ * the type's selectors, each selector also left unfilled, plus a value that
+ * is not in the XML and a custom config that needs the fallback. Each entry's
+ * own selectors and all but the last of them are added as well.
+ */
+std::vector<SelectorPairs> buildQueries(std::vector<allKVs> &table, int32_t type,
+    const std::vector<std::string> &selector_names)
+{
+    std::map<selector_type_t, std::set<std::string>> values;
+    std::vector<SelectorPairs> queries = {SelectorPairs()};
+
+    for (auto &block : table) {
+        for (auto &info : block.keys_values) {
+            for (auto &selector : info.selector_pairs)
+                values[selector.first].insert(selector.second);
+        }
+    }
+    for (auto &value : values)
+        value.second.insert("UNKNOWN_VALUE");
+    values[CUSTOM_CONFIG_SEL].insert("unknown-custom-config");
+
+    for (auto &name : selector_names) {
+        selector_type_t selector = selectorstypeLUT.at(name);
+        std::vector<SelectorPairs> next;
+        for (auto &query : queries) {
+            next.push_back(query);
+            for (auto &value : values[selector]) {
+                if (next.size() >= kMaxQueries)
+                    break;
+                next.push_back(query);
+                next.back().push_back(std::make_pair(selector, value));
+            }
+        }
+        queries.swap(next);
+    }
+
+    for (auto &block : table) {
+        if (!linearHasType(type, block.id_type))
+            continue;
+        for (auto &info : block.keys_values) {
+            queries.push_back(info.selector_pairs);
+            if (!info.selector_pairs.empty()) {
+                queries.push_back(info.selector_pairs);
+                queries.back().pop_back();
+            }
+        }
+    }
+    return queries;
+}
+
+/* Every type listed in the table, and one that is not */
+std::set<int32_t> tableTypes(std::vector<allKVs> &table)
+{
+    std::set<int32_t> types = {12345};
+
+    for (auto &block : table)
+        types.insert(block.id_type.begin(), block.id_type.end());
+    return types;
+}
+
+} // namespace
+
+TEST(PayloadBuilderTest, KVIndexMatchesLinearScan)
+{
+    std::vector<std::string> files = usecaseXmlFiles();
+    ASSERT_FALSE(files.empty());
+    size_t lookups = 0, found = 0;
+
+    for (auto &file : files) {
+        SCOPED_TRACE(file);
+        ASSERT_TRUE(PayloadBuilderTables::load(file));
+        std::vector<std::vector<allKVs> *> tables = PayloadBuilderTables::tables();
+
+        for (size_t t = 0; t < tables.size(); t++) {
+            std::vector<allKVs> &table = *tables[t];
+            for (int32_t type : tableTypes(table)) {
+                std::vector<std::string> selectors = linearRetrieveSelectors(type, table);
+                ASSERT_EQ(selectors, PayloadBuilder::retrieveSelectors(type, table))
+                    << "table " << t << " type " << type;
+
+                for (auto &query : buildQueries(table, type, selectors)) {
+                    SelectorPairs linear_pairs = query, indexed_pairs = query;
+                    KeyVector linear_kvs, indexed_kvs;
+                    int linear_status = linearRetrieveKVs(linear_pairs, type, table, linear_kvs);
+                    int indexed_status = PayloadBuilder::retrieveKVs(indexed_pairs, type, table,
+                        indexed_kvs);
+
+                    /* The old path left the filled selectors sorted, callers do not rely on it */
+                    std::sort(linear_pairs.begin(), linear_pairs.end());
+                    std::sort(indexed_pairs.begin(), indexed_pairs.end());
+                    ASSERT_EQ(linear_status, indexed_status) << "table " << t << " type " << type;
+                    ASSERT_EQ(linear_kvs, indexed_kvs) << "table " << t << " type " << type;
+                    ASSERT_EQ(linear_pairs, indexed_pairs) << "table " << t << " type " << type;
+                    lookups++;
+                    found += linear_status ? 0 : 1;
+                }
+            }
+        }
+    }
+    std::cout << files.size() << " usecase XML files, " << lookups << " lookups, " << found
+              << " found" << std::endl;
+}
+
+TEST(PayloadBuilderTest, LookupTime)
+{
+    std::vector<std::string> files = usecaseXmlFiles();
+    ASSERT_FALSE(files.empty());
+    ASSERT_TRUE(PayloadBuilderTables::load(files.front()));
+    const int kRepeats = 20;
+    std::chrono::steady_clock::duration linear_time{}, indexed_time{};
+    std::chrono::steady_clock::duration linear_selectors_time{}, indexed_selectors_time{};
+    size_t lookups = 0, selector_lookups = 0;
+    KeyVector kvs;
+
+    for (auto table : PayloadBuilderTables::tables()) {
+        for (int32_t type : tableTypes(*table)) {
+            auto begin = std::chrono::steady_clock::now();
+            std::vector<std::string> selectors = linearRetrieveSelectors(type, *table);
+            auto middle = std::chrono::steady_clock::now();
+            PayloadBuilder::retrieveSelectors(type, *table);
+            indexed_selectors_time += std::chrono::steady_clock::now() - middle;
+            linear_selectors_time += middle - begin;
+            selector_lookups++;
+
+            std::vector<SelectorPairs> queries = buildQueries(*table, type, selectors);
+            begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < kRepeats; i++) {
+                for (auto &query : queries) {
+                    SelectorPairs pairs = query;
+                    kvs.clear();
+                    linearRetrieveKVs(pairs, type, *table, kvs);
+                }
+            }
+            middle = std::chrono::steady_clock::now();
+            for (int i = 0; i < kRepeats; i++) {
+                for (auto &query : queries) {
+                    SelectorPairs pairs = query;
+                    kvs.clear();
+                    PayloadBuilder::retrieveKVs(pairs, type, *table, kvs);
+                }
+            }
+            indexed_time += std::chrono::steady_clock::now() - middle;
+            linear_time += middle - begin;
+            lookups += kRepeats * queries.size();
+        }
+    }
+
+    auto perLookup = [](std::chrono::steady_clock::duration time, size_t count) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / count;
+    };
+    std::cout << files.front() << ": retrieveKVs indexed " << perLookup(indexed_time, lookups)
+              << " ns, linear " << perLookup(linear_time, lookups)
+              << " ns; retrieveSelectors indexed "
+              << perLookup(indexed_selectors_time, selector_lookups) << " ns, linear "
+              << perLookup(linear_selectors_time, selector_lookups) << " ns" << std::endl;
+}
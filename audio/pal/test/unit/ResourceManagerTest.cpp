@@ -0,0 +1,400 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+#include <glob.h>
+#include <libgen.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ResourceManager.h"
+
+namespace {
+
+/* Streams a device switch walks, more than run concurrently on a target */
+const int kConcurrentStreams = 24;
+
+class ResourceManagerTables : public ResourceManager {
+ public:
+    using ResourceManager::deviceInfo;
+
+    /*
+     * Parses xml_file and builds the index as the constructor does. False
+     * if the file fails to parse or names a device this build leaves out.
+     */
+    static bool load(const std::string &xml_file)
+    {
+        deviceInfo.clear();
+        try {
+            if (XmlParser(xml_file))
+                return false;
+        } catch (const std::out_of_range &) {
+            return false;
+        }
+        buildDeviceInfoIndex();
+        return true;
+    }
+};
+
+/*
+ * getDeviceInfo() and getSidetoneMode() as they were before the device info
+ * index, kept as the reference.
+ */
+void linearGetDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type,
+    std::string key, struct pal_device_info *devinfo)
+{
+    std::vector<deviceIn> &deviceInfo = ResourceManagerTables::deviceInfo;
+
+    for (size_t i = 0; i < deviceInfo.size(); i++) {
+        if (deviceId != deviceInfo[i].deviceId)
+            continue;
+        devinfo->max_channels = deviceInfo[i].max_channel;
+        devinfo->channels = deviceInfo[i].channel;
+        devinfo->sndDevName = deviceInfo[i].sndDevName;
+        devinfo->samplerate = deviceInfo[i].samplerate;
+        devinfo->isExternalECRefEnabledFlag = deviceInfo[i].isExternalECRefEnabled;
+        devinfo->priority = MIN_USECASE_PRIORITY;
+        devinfo->bit_width = deviceInfo[i].bit_width;
+        devinfo->bitFormatSupported = deviceInfo[i].bitFormatSupported;
+        devinfo->channels_overwrite = false;
+        devinfo->samplerate_overwrite = false;
+        devinfo->sndDevName_overwrite = false;
+        devinfo->bit_width_overwrite = false;
+        devinfo->fractionalSRSupported = deviceInfo[i].fractionalSRSupported;
+        for (size_t j = 0; j < deviceInfo[i].usecase.size(); j++) {
+            struct usecase_info &usecase = deviceInfo[i].usecase[j];
+
+            if (type != usecase.type)
+                continue;
+            if (usecase.channel) {
+                devinfo->channels = usecase.channel;
+                devinfo->channels_overwrite = true;
+            }
+            if (usecase.samplerate) {
+                devinfo->samplerate = usecase.samplerate;
+                devinfo->samplerate_overwrite = true;
+            }
+            if (!(usecase.sndDevName).empty()) {
+                devinfo->sndDevName = usecase.sndDevName;
+                devinfo->sndDevName_overwrite = true;
+            }
+            if (usecase.priority)
+                devinfo->priority = usecase.priority;
+            if (usecase.bit_width) {
+                devinfo->bit_width = usecase.bit_width;
+                devinfo->bit_width_overwrite = true;
+            }
+            for (size_t k = 0; k < usecase.config.size(); k++) {
+                struct usecase_custom_config_info &config = usecase.config[k];
+
+                if (config.key.compare(key))
+                    continue;
+                if (config.channel) {
+                    devinfo->channels = config.channel;
+                    devinfo->channels_overwrite = true;
+                }
+                if (config.samplerate) {
+                    devinfo->samplerate = config.samplerate;
+                    devinfo->samplerate_overwrite = true;
+                }
+                if (!(config.sndDevName).empty()) {
+                    devinfo->sndDevName = config.sndDevName;
+                    devinfo->sndDevName_overwrite = true;
+                }
+                if (config.priority && config.priority != MIN_USECASE_PRIORITY)
+                    devinfo->priority = config.priority;
+                if (config.bit_width) {
+                    devinfo->bit_width = config.bit_width;
+                    devinfo->bit_width_overwrite = true;
+                }
+                break;
+            }
+        }
+    }
+}
+
+void linearGetSidetoneMode(pal_device_id_t deviceId, pal_stream_type_t type,
+    sidetone_mode_t *mode)
+{
+    std::vector<deviceIn> &deviceInfo = ResourceManagerTables::deviceInfo;
+
+    *mode = SIDETONE_OFF;
+    for (size_t i = 0; i < deviceInfo.size(); i++) {
+        if (deviceId != deviceInfo[i].deviceId)
+            continue;
+        for (size_t j = 0; j < deviceInfo[i].usecase.size(); j++) {
+            if (type == deviceInfo[i].usecase[j].type) {
+                *mode = deviceInfo[i].usecase[j].sidetoneMode;
+                break;
+            }
+        }
+    }
+}
+
+/* deregisterstream() on the std::list mActiveStreams was, the reference */
+int linearDeregister(Stream *s, std::list<Stream *> &streams)
+{
+    auto iter = std::find(streams.begin(), streams.end(), s);
+
+    if (iter == streams.end())
+        return -ENOENT;
+    streams.erase(iter);
+    return 0;
+}
+
+/* Filled with a pattern so fields getDeviceInfo() leaves alone compare too */
+struct pal_device_info untouchedDeviceInfo()
+{
+    struct pal_device_info devinfo;
+
+    devinfo.channels = -1;
+    devinfo.max_channels = -1;
+    devinfo.samplerate = -1;
+    devinfo.sndDevName = "untouched";
+    devinfo.isExternalECRefEnabledFlag = true;
+    devinfo.priority = 0xdead;
+    devinfo.fractionalSRSupported = true;
+    devinfo.channels_overwrite = true;
+    devinfo.samplerate_overwrite = true;
+    devinfo.sndDevName_overwrite = true;
+    devinfo.bit_width_overwrite = true;
+    devinfo.bit_width = 0xdead;
+    devinfo.bitFormatSupported = (pal_audio_fmt_t)0xdead;
+    return devinfo;
+}
+
+bool sameDeviceInfo(const struct pal_device_info &a, const struct pal_device_info &b)
+{
+    return a.channels == b.channels && a.max_channels == b.max_channels &&
+        a.samplerate == b.samplerate && a.sndDevName == b.sndDevName &&
+        a.isExternalECRefEnabledFlag == b.isExternalECRefEnabledFlag &&
+        a.priority == b.priority && a.fractionalSRSupported == b.fractionalSRSupported &&
+        a.channels_overwrite == b.channels_overwrite &&
+        a.samplerate_overwrite == b.samplerate_overwrite &&
+        a.sndDevName_overwrite == b.sndDevName_overwrite &&
+        a.bit_width_overwrite == b.bit_width_overwrite && a.bit_width == b.bit_width &&
+        a.bitFormatSupported == b.bitFormatSupported;
+}
+
+/*
+ * The resource manager XML of every target, installed with the test, and
+ * the ones of this device.
+ */
+std::vector<std::string> resourceXmlFiles()
+{
+    std::vector<std::string> files;
+    char exe[PATH_MAX] = {};
+    std::vector<std::string> patterns = {"/vendor/etc/resourcemanager*.xml"};
+
+    if (readlink("/proc/self/exe", exe, sizeof(exe) - 1) > 0)
+        patterns.insert(patterns.begin(),
+            std::string(dirname(exe)) + "/configs/*/resourcemanager*.xml");
+
+    for (auto &pattern : patterns) {
+        glob_t matches = {};
+        if (!glob(pattern.c_str(), 0, NULL, &matches)) {
+            for (size_t i = 0; i < matches.gl_pathc; i++)
+                files.push_back(matches.gl_pathv[i]);
+        }
+        globfree(&matches);
+    }
+    return files;
+}
+
+/* Every custom key of the parsed file, no key and one that is not there */
+std::vector<std::string> customKeys()
+{
+    std::set<std::string> keys = {"", "unknown-custom-key"};
+
+    for (auto &dev : ResourceManagerTables::deviceInfo) {
+        for (auto &usecase : dev.usecase) {
+            for (auto &config : usecase.config)
+                keys.insert(config.key);
+        }
+    }
+    return std::vector<std::string>(keys.begin(), keys.end());
+}
+
+Stream *fakeStream(std::vector<char> &storage, int i)
+{
+    return reinterpret_cast<Stream *>(&storage[i]);
+}
+
+} // namespace
+
+TEST(ResourceManagerTest, DeviceInfoIndexMatchesLinearScan)
+{
+    std::vector<std::string> files = resourceXmlFiles();
+    size_t lookups = 0, skipped = 0;
+
+    for (auto &file : files) {
+        SCOPED_TRACE(file);
+        if (!ResourceManagerTables::load(file)) {
+            skipped++;
+            continue;
+        }
+        std::vector<std::string> keys = customKeys();
+
+        for (int dev = PAL_DEVICE_OUT_MIN; dev <= PAL_DEVICE_IN_MAX; dev++) {
+            for (int type = 0; type <= PAL_STREAM_MAX; type++) {
+                sidetone_mode_t expectedMode, actualMode;
+
+                linearGetSidetoneMode((pal_device_id_t)dev, (pal_stream_type_t)type,
+                    &expectedMode);
+                ResourceManager::getSidetoneMode((pal_device_id_t)dev,
+                    (pal_stream_type_t)type, &actualMode);
+                ASSERT_EQ(expectedMode, actualMode) << "device " << dev << " type " << type;
+
+                for (auto &key : keys) {
+                    struct pal_device_info expected = untouchedDeviceInfo();
+                    struct pal_device_info actual = untouchedDeviceInfo();
+
+                    linearGetDeviceInfo((pal_device_id_t)dev, (pal_stream_type_t)type,
+                        key, &expected);
+                    ResourceManager::getDeviceInfo((pal_device_id_t)dev,
+                        (pal_stream_type_t)type, key, &actual);
+                    ASSERT_TRUE(sameDeviceInfo(expected, actual))
+                        << "device " << dev << " type " << type << " key " << key;
+                    lookups++;
+                }
+            }
+        }
+    }
+    ASSERT_LT(skipped, files.size());
+    std::cout << files.size() - skipped << " files, " << skipped << " skipped, " << lookups
+              << " lookups" << std::endl;
+}
+
+/* Lookups of the configured devices, for every stream type and custom key */
+TEST(ResourceManagerTest, DeviceInfoLookupTime)
+{
+    std::vector<std::string> files = resourceXmlFiles();
+    std::chrono::steady_clock::duration linear{}, indexed{};
+    size_t lookups = 0;
+
+    for (auto &file : files) {
+        if (!ResourceManagerTables::load(file))
+            continue;
+        std::vector<std::string> keys = customKeys();
+        std::vector<int> devices;
+        struct pal_device_info devinfo;
+
+        for (auto &dev : ResourceManagerTables::deviceInfo)
+            devices.push_back(dev.deviceId);
+
+        auto begin = std::chrono::steady_clock::now();
+        for (int dev : devices) {
+            for (int type = 0; type < PAL_STREAM_MAX; type++) {
+                for (auto &key : keys)
+                    linearGetDeviceInfo((pal_device_id_t)dev, (pal_stream_type_t)type,
+                        key, &devinfo);
+            }
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (int dev : devices) {
+            for (int type = 0; type < PAL_STREAM_MAX; type++) {
+                for (auto &key : keys)
+                    ResourceManager::getDeviceInfo((pal_device_id_t)dev,
+                        (pal_stream_type_t)type, key, &devinfo);
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        linear += middle - begin;
+        indexed += end - middle;
+        lookups += devices.size() * PAL_STREAM_MAX * keys.size();
+    }
+    ASSERT_GT(lookups, (size_t)0);
+    std::cout << lookups << " getDeviceInfo lookups: linear "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(linear).count() / lookups
+              << " ns, indexed "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(indexed).count() / lookups
+              << " ns" << std::endl;
+}
+
+/*
+ * Random register and deregister calls, a stream registered more than once
+ * and streams that were never registered included. After each call the
+ * index must agree with the list on every stream.
+ */
+TEST(ResourceManagerTest, ActiveStreamIndexMatchesList)
+{
+    const int kStreams = 2 * kConcurrentStreams;
+    const int kCalls = 20000;
+    std::vector<char> storage(kStreams);
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> pick(0, kStreams - 1);
+    std::uniform_int_distribution<int> action(0, 2);
+    PalStreamList<Stream *> streams;
+    std::list<Stream *> expected;
+
+    for (int call = 0; call < kCalls; call++) {
+        Stream *s = fakeStream(storage, pick(gen));
+
+        /* keep around kConcurrentStreams registered */
+        if (action(gen) == 0 || expected.size() > (size_t)kConcurrentStreams) {
+            ASSERT_EQ(linearDeregister(s, expected), streams.remove(s)) << "call " << call;
+        } else {
+            expected.push_back(s);
+            streams.push_back(s);
+        }
+
+        ASSERT_EQ(expected.size(), streams.size());
+        ASSERT_EQ(expected.empty(), streams.empty());
+        ASSERT_TRUE(std::equal(expected.begin(), expected.end(), streams.begin()))
+            << "call " << call;
+        for (int i = 0; i < kStreams; i++) {
+            Stream *other = fakeStream(storage, i);
+            bool active = std::find(expected.begin(), expected.end(), other) != expected.end();
+            ASSERT_EQ(active, streams.contains(other)) << "call " << call << " stream " << i;
+        }
+    }
+}
+
+/* Registered and unknown handles against kConcurrentStreams active streams */
+TEST(ResourceManagerTest, ActiveStreamLookupTime)
+{
+    const int kIterations = 100000;
+    std::vector<char> storage(2 * kConcurrentStreams);
+    PalStreamList<Stream *> streams;
+    std::list<Stream *> list;
+    size_t hits = 0;
+
+    for (int i = 0; i < kConcurrentStreams; i++) {
+        streams.push_back(fakeStream(storage, i));
+        list.push_back(fakeStream(storage, i));
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int n = 0; n < kIterations; n++) {
+        Stream *s = fakeStream(storage, n % storage.size());
+        hits += std::find(list.begin(), list.end(), s) != list.end();
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int n = 0; n < kIterations; n++) {
+        Stream *s = fakeStream(storage, n % storage.size());
+        hits -= streams.contains(s);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    EXPECT_EQ((size_t)0, hits);
+    std::cout << kConcurrentStreams << " active streams: list "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(middle - begin).count() /
+                     kIterations
+              << " ns, indexed "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count() /
+                     kIterations
+              << " ns per lookup" << std::endl;
+}
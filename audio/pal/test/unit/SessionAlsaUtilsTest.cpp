@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SessionAlsaUtils.h"
+
+/*
+ * Fake tinyalsa mixer. The test binary defines the mixer lookups, so they
+ * take the place of the tinyalsa ones for SessionAlsaUtils as well.
+ */
+struct mixer_ctl {
+    std::string name;
+};
+
+struct mixer {
+    std::vector<mixer_ctl *> ctls;
+    size_t numScans = 0;
+};
+
+unsigned int mixer_get_num_ctls(struct mixer *mixer)
+{
+    return (unsigned int)mixer->ctls.size();
+}
+
+struct mixer_ctl *mixer_get_ctl(struct mixer *mixer, unsigned int id)
+{
+    return id < mixer->ctls.size() ? mixer->ctls[id] : nullptr;
+}
+
+const char *mixer_ctl_get_name(const struct mixer_ctl *ctl)
+{
+    return ctl->name.c_str();
+}
+
+struct mixer_ctl *mixer_get_ctl_by_name(struct mixer *mixer, const char *name)
+{
+    mixer->numScans++;
+    for (mixer_ctl *ctl : mixer->ctls) {
+        if (ctl->name == name)
+            return ctl;
+    }
+    return nullptr;
+}
+
+namespace {
+
+/* Controls of a virtual card with a few hundred PCM front ends, as AGM has */
+class FakeMixer {
+ public:
+    explicit FakeMixer(int numPcms)
+    {
+        const char *suffixes[] = {" control", " metadata", " connect", " disconnect",
+                                  " setParam", " getTaggedInfo", " setParamTag", " getParam"};
+        for (int pcm = 100; pcm < 100 + numPcms; pcm++) {
+            for (const char *suffix : suffixes)
+                add("PCM" + std::to_string(pcm) + suffix);
+        }
+        for (const char *be : {"CODEC_DMA-LPAIF_RXTX-RX-0", "CODEC_DMA-LPAIF_VA-TX-0"}) {
+            add(std::string(be) + " metadata");
+            add(std::string(be) + " rate ch fmt");
+        }
+    }
+
+    ~FakeMixer()
+    {
+        SessionAlsaUtils::invalidateMixerCtlCache();
+        for (mixer_ctl *ctl : mixer_.ctls)
+            delete ctl;
+    }
+
+    mixer_ctl *add(const std::string &name)
+    {
+        mixer_.ctls.push_back(new mixer_ctl{name});
+        return mixer_.ctls.back();
+    }
+
+    struct mixer *get() { return &mixer_; }
+
+ private:
+    struct mixer mixer_;
+};
+
+}  // namespace
+
+TEST(SessionAlsaUtilsTest, CachedLookupsMatchScan)
+{
+    FakeMixer fake(200);
+    struct mixer *mixer = fake.get();
+    /* duplicate names resolve to the first control, like a scan does */
+    mixer_ctl *first = fake.add("PCM150 duplicate");
+    fake.add("PCM150 duplicate");
+
+    std::vector<std::string> names;
+    for (mixer_ctl *ctl : mixer->ctls)
+        names.push_back(ctl->name);
+    for (const std::string &name : names) {
+        mixer_ctl *expected = mixer_get_ctl_by_name(mixer, name.c_str());
+        EXPECT_EQ(expected, SessionAlsaUtils::getMixerControl(mixer, name)) << name;
+    }
+    EXPECT_EQ(first, SessionAlsaUtils::getMixerControl(mixer, "PCM150 duplicate"));
+    EXPECT_EQ(nullptr, SessionAlsaUtils::getMixerControl(mixer, "PCM999 control"));
+    EXPECT_EQ(nullptr, SessionAlsaUtils::getMixerControl(mixer, "PCM100"));
+    EXPECT_EQ(nullptr, SessionAlsaUtils::getMixerControl(nullptr, "PCM100 control"));
+
+    /* known names are answered from the index without another scan */
+    size_t numScans = mixer->numScans;
+    for (const std::string &name : names)
+        SessionAlsaUtils::getMixerControl(mixer, name);
+    EXPECT_EQ(numScans, mixer->numScans);
+}
+
+TEST(SessionAlsaUtilsTest, ControlAddedAfterIndexing)
+{
+    FakeMixer fake(4);
+    struct mixer *mixer = fake.get();
+
+    ASSERT_NE(nullptr, SessionAlsaUtils::getMixerControl(mixer, "PCM100 control"));
+    EXPECT_EQ(nullptr, SessionAlsaUtils::getMixerControl(mixer, "PCM100 sidetone"));
+    mixer_ctl *added = fake.add("PCM100 sidetone");
+    EXPECT_EQ(added, SessionAlsaUtils::getMixerControl(mixer, "PCM100 sidetone"));
+
+    /* found once by a scan, then kept */
+    size_t numScans = mixer->numScans;
+    EXPECT_EQ(added, SessionAlsaUtils::getMixerControl(mixer, "PCM100 sidetone"));
+    EXPECT_EQ(numScans, mixer->numScans);
+}
+
+/* after a sound card reset the same mixer may hand out different controls */
+TEST(SessionAlsaUtilsTest, InvalidateDropsControls)
+{
+    FakeMixer fake(4);
+    struct mixer *mixer = fake.get();
+    mixer_ctl *before = SessionAlsaUtils::getMixerControl(mixer, "PCM101 metadata");
+    ASSERT_NE(nullptr, before);
+
+    SessionAlsaUtils::invalidateMixerCtlCache();
+    mixer_ctl *after = new mixer_ctl{"PCM101 metadata"};
+    for (mixer_ctl *&ctl : mixer->ctls) {
+        if (ctl == before) {
+            ctl = after;
+            delete before;
+        }
+    }
+    EXPECT_EQ(after, SessionAlsaUtils::getMixerControl(mixer, "PCM101 metadata"));
+}
+
+/* about the lookups a stream open does, on a card with 1600 controls */
+TEST(SessionAlsaUtilsTest, LookupTime)
+{
+    const int numIterations = 1000;
+    FakeMixer fake(200);
+    struct mixer *mixer = fake.get();
+    std::vector<std::string> names;
+    for (int pcm = 180; pcm < 185; pcm++) {
+        for (const char *suffix : {" control", " metadata", " connect", " setParamTag"})
+            names.push_back("PCM" + std::to_string(pcm) + suffix);
+    }
+
+    size_t found = 0;
+    SessionAlsaUtils::getMixerControl(mixer, names[0]);
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < numIterations; i++) {
+        for (const std::string &name : names)
+            found += SessionAlsaUtils::getMixerControl(mixer, name) != nullptr;
+    }
+    auto cachedTime = std::chrono::steady_clock::now() - begin;
+
+    begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < numIterations; i++) {
+        for (const std::string &name : names)
+            found += mixer_get_ctl_by_name(mixer, name.c_str()) != nullptr;
+    }
+    auto scanTime = std::chrono::steady_clock::now() - begin;
+
+    EXPECT_EQ(names.size() * numIterations * 2, found);
+    auto perOpen = [&](std::chrono::steady_clock::duration time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() /
+               numIterations;
+    };
+    std::cout << names.size() << " lookups: cached " << perOpen(cachedTime) << " ns, scan "
+              << perOpen(scanTime) << " ns" << std::endl;
+}
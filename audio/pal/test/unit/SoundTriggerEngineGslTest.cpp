@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Session.h"
+#include "SoundTriggerEngineGsl.h"
+
+namespace {
+
+/* 20ms periods of mono 16 bit audio */
+const uint32_t kPeriodMs = 20;
+
+size_t periodSize(uint32_t sampleRate)
+{
+    return sampleRate * 2 * kPeriodMs / 1000;
+}
+
+char patternByte(size_t offset)
+{
+    return (char)(offset * 7 + offset / 251);
+}
+
+/*
+ * LAB session of one engine. Hands out a continuous byte pattern and, when
+ * paced, blocks each read until the DSP would have produced the data, like
+ * the GSL read of a real session does.
+ */
+class FakeSession : public Session {
+ public:
+    FakeSession(size_t periodSize, uint32_t sampleRate, bool paced)
+        : periodSize_(periodSize),
+          bytesPerSec_(sampleRate * 2),
+          paced_(paced),
+          begin_(std::chrono::steady_clock::now()) {}
+
+    int open(Stream *s) override { return 0; }
+    int prepare(Stream *s) override { return 0; }
+    int setConfig(Stream *s, configType type, int tag) override { return 0; }
+    int start(Stream *s) override { return 0; }
+    int stop(Stream *s) override { return 0; }
+    int close(Stream *s) override { return 0; }
+    int setupSessionDevice(Stream *s, pal_stream_type_t streamType,
+                           std::shared_ptr<Device> device) override { return 0; }
+    int connectSessionDevice(Stream *s, pal_stream_type_t streamType,
+                             std::shared_ptr<Device> device) override { return 0; }
+    int disconnectSessionDevice(Stream *s, pal_stream_type_t streamType,
+                                std::shared_ptr<Device> device) override { return 0; }
+    int setECRef(Stream *s, std::shared_ptr<Device> rxDev, bool isEnable) override
+    {
+        return 0;
+    }
+
+    int read(Stream *s, int tag, struct pal_buffer *buf, int *size) override
+    {
+        numReads_++;
+        if (buf->size % periodSize_)
+            numPartialReads_++;
+        if (paced_)
+            std::this_thread::sleep_until(begin_ +
+                std::chrono::microseconds((offset_ + buf->size) * 1000000 / bytesPerSec_));
+
+        for (size_t i = 0; i < buf->size; i++)
+            buf->buffer[i] = patternByte(offset_ + i);
+        offset_ += buf->size;
+        *size = (int)buf->size;
+        return 0;
+    }
+
+    size_t numReads_ = 0;
+    size_t numPartialReads_ = 0;
+    size_t offset_ = 0;
+
+ private:
+    size_t periodSize_;
+    size_t bytesPerSec_;
+    bool paced_;
+    std::chrono::steady_clock::time_point begin_;
+};
+
+/* Reads everything unread and checks it continues the session pattern */
+bool drainReader(PalRingBufferReader *reader, size_t *offset)
+{
+    char data[4096];
+    int32_t size = 0;
+
+    while ((size = reader->read(data, sizeof(data))) > 0) {
+        for (int32_t i = 0; i < size; i++) {
+            if (data[i] != patternByte(*offset + i))
+                return false;
+        }
+        *offset += size;
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST(SoundTriggerEngineGslTest, WrappedRegionsAreReadInWholePeriods)
+{
+    const size_t period = periodSize(16000);
+    /* not a multiple of the period, so every wrap splits one */
+    PalRingBuffer ringBuffer(period * 7 + period / 3);
+    PalRingBufferReader *reader = ringBuffer.newReader();
+    FakeSession session(period, 16000, false);
+    std::vector<uint8_t> bounce(period * 2);
+    struct pal_ring_buffer_region region;
+    size_t readOffset = 0;
+    int32_t size = 0;
+
+    reader->updateState(READER_ENABLED);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(0, SoundTriggerEngineGsl::ReadToRingBuffer(&session, nullptr, &ringBuffer,
+            period * 2, period, bounce.data(), &region, &size));
+        ASSERT_EQ((int32_t)period * 2, size);
+        ASSERT_TRUE(drainReader(reader, &readOffset));
+    }
+
+    EXPECT_EQ(session.offset_, readOffset);
+    EXPECT_EQ(0u, session.numPartialReads_);
+    ringBuffer.removeReader(reader);
+    delete reader;
+}
+
+TEST(SoundTriggerEngineGslTest, FullRingBufferReadsNothing)
+{
+    const size_t period = periodSize(16000);
+    PalRingBuffer ringBuffer(period * 5);
+    PalRingBufferReader *reader = ringBuffer.newReader();
+    FakeSession session(period, 16000, false);
+    std::vector<uint8_t> bounce(period * 2);
+    struct pal_ring_buffer_region region;
+    size_t readOffset = 0;
+    int32_t size = 0;
+
+    reader->updateState(READER_ENABLED);
+    for (int i = 0; i < 2; i++) {
+        ASSERT_EQ(0, SoundTriggerEngineGsl::ReadToRingBuffer(&session, nullptr, &ringBuffer,
+            period * 2, period, bounce.data(), &region, &size));
+        ASSERT_EQ((int32_t)period * 2, size);
+    }
+
+    /* one period left, the session must not be read until a full read fits */
+    size_t numReads = session.numReads_;
+    EXPECT_EQ(0, SoundTriggerEngineGsl::ReadToRingBuffer(&session, nullptr, &ringBuffer,
+        period * 2, period, bounce.data(), &region, &size));
+    EXPECT_EQ(0, size);
+    EXPECT_EQ(numReads, session.numReads_);
+    EXPECT_EQ(period, ringBuffer.getFreeSize());
+
+    ASSERT_TRUE(drainReader(reader, &readOffset));
+    EXPECT_EQ(0, SoundTriggerEngineGsl::ReadToRingBuffer(&session, nullptr, &ringBuffer,
+        period * 2, period, bounce.data(), &region, &size));
+    EXPECT_EQ((int32_t)period * 2, size);
+    ASSERT_TRUE(drainReader(reader, &readOffset));
+    EXPECT_EQ(session.offset_, readOffset);
+
+    ringBuffer.removeReader(reader);
+    delete reader;
+}
+
+/*
+ * Engines at 16kHz and 48kHz buffer concurrently, each in its own thread
+ * running the StartBuffering() read loop against a real time session, with
+ * a client that reads in bursts. Every engine has to keep up with its DSP.
+ */
+TEST(SoundTriggerEngineGslTest, MultipleEnginesKeepUp)
+{
+    const uint32_t sampleRates[] = {16000, 48000, 16000, 48000};
+    const int numPeriods = 50;
+    const int numEngines = sizeof(sampleRates) / sizeof(sampleRates[0]);
+    std::vector<std::thread> threads;
+    std::atomic<int> failures(0);
+    std::atomic<int> waits(0);
+    auto begin = std::chrono::steady_clock::now();
+
+    for (int e = 0; e < numEngines; e++) {
+        threads.emplace_back([&, e] {
+            const size_t period = periodSize(sampleRates[e]);
+            const size_t totalSize = period * numPeriods;
+            PalRingBuffer ringBuffer(period * 4 + period / 2);
+            PalRingBufferReader *reader = ringBuffer.newReader();
+            FakeSession session(period, sampleRates[e], true);
+            std::vector<uint8_t> bounce(period * 2);
+            std::atomic<bool> done(false);
+            size_t readOffset = 0;
+            bool intact = true;
+
+            reader->updateState(READER_ENABLED);
+            std::thread client([&] {
+                while (!done.load() || reader->getUnreadSize()) {
+                    /* the client is late by a few periods at a time */
+                    std::this_thread::sleep_for(std::chrono::milliseconds(kPeriodMs * 3));
+                    intact = drainReader(reader, &readOffset) && intact;
+                }
+            });
+
+            size_t totalReadSize = 0;
+            while (totalReadSize < totalSize) {
+                struct pal_ring_buffer_region region;
+                int32_t size = 0;
+                if (SoundTriggerEngineGsl::ReadToRingBuffer(&session, nullptr, &ringBuffer,
+                        period * 2, period, bounce.data(), &region, &size)) {
+                    failures++;
+                    break;
+                }
+                if (!size) {
+                    waits++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(kPeriodMs));
+                }
+                totalReadSize += size;
+            }
+            done = true;
+            client.join();
+
+            if (!intact || readOffset != totalReadSize || session.numPartialReads_)
+                failures++;
+            ringBuffer.removeReader(reader);
+            delete reader;
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - begin);
+    EXPECT_EQ(0, failures.load());
+    /* one second of audio per engine, allow for the client lagging at the end */
+    EXPECT_LT(elapsed.count(), numPeriods * kPeriodMs + kPeriodMs * 10);
+    std::cout << numEngines << " engines: " << elapsed.count() << " ms for "
+              << numPeriods * kPeriodMs << " ms of audio, " << waits.load()
+              << " waits on a full ring buffer" << std::endl;
+}
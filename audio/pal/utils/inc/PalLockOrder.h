@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef PAL_LOCK_ORDER_H_
+#define PAL_LOCK_ORDER_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <mutex>
+#include <shared_mutex>
+#include "PalCommon.h"
+
+/*
+ * Lock hierarchy of the ResourceManager global mutexes. A thread must take
+ * them in increasing rank order, and has to drop a mutex before taking one
+ * of a lower rank (e.g. mResourceManagerMutex is unlocked around calls that
+ * take mActiveStreamMutex). Per stream mutexes sit between the active stream
+ * and graph ranks, the per device mDeviceMutex below the graph rank.
+ */
+typedef enum {
+    PAL_LOCK_RANK_ACTIVE_STREAM = 0,  /* mActiveStreamMutex */
+    PAL_LOCK_RANK_GRAPH,              /* mGraphMutex */
+    PAL_LOCK_RANK_RESOURCE_MANAGER,   /* mResourceManagerMutex */
+    PAL_LOCK_RANK_VALID_STREAM,       /* mValidStreamMutex */
+    PAL_LOCK_RANK_LIST_FRONT_ENDS,    /* mListFrontEndsMutex */
+    PAL_LOCK_RANK_SLEEP_MONITOR,      /* mSleepMonitorMutex */
+    PAL_LOCK_RANK_MAX,
+} pal_lock_rank_t;
+
+#ifdef PAL_LOCK_ORDER_CHECK
+/* number of mutexes of each rank held by the calling thread */
+inline uint32_t *palHeldLockRanks()
+{
+    static thread_local uint32_t held[PAL_LOCK_RANK_MAX] = {0};
+    return held;
+}
+#endif
+
+/*
+ * Mutex wrapper carrying its rank in the hierarchy above. Builds with
+ * PAL_LOCK_ORDER_CHECK defined track the ranks held by each thread and
+ * abort when a mutex is locked while one of an equal or higher rank is
+ * held. Otherwise it only forwards to the wrapped mutex. Mutex is either
+ * std::mutex or std::shared_timed_mutex, the shared calls need the latter.
+ */
+template <class Mutex>
+class PalRankedMutex
+{
+public:
+    explicit PalRankedMutex(pal_lock_rank_t rank) : mRank(rank) {}
+    PalRankedMutex(const PalRankedMutex &) = delete;
+    PalRankedMutex &operator=(const PalRankedMutex &) = delete;
+
+    void lock() { checkOrder(); mMutex.lock(); acquired(); }
+    bool try_lock() { return mMutex.try_lock() ? (acquired(), true) : false; }
+    void unlock() { released(); mMutex.unlock(); }
+    void lock_shared() { checkOrder(); mMutex.lock_shared(); acquired(); }
+    bool try_lock_shared() { return mMutex.try_lock_shared() ? (acquired(), true) : false; }
+    void unlock_shared() { released(); mMutex.unlock_shared(); }
+
+private:
+#ifdef PAL_LOCK_ORDER_CHECK
+    void checkOrder()
+    {
+        uint32_t *held = palHeldLockRanks();
+
+        for (int rank = mRank; rank < PAL_LOCK_RANK_MAX; rank++) {
+            if (held[rank]) {
+                PAL_ERR("PAL: LockOrder", "lock rank %d taken while holding rank %d",
+                        mRank, rank);
+                abort();
+            }
+        }
+    }
+    void acquired() { palHeldLockRanks()[mRank]++; }
+    void released() { palHeldLockRanks()[mRank]--; }
+#else
+    void checkOrder() {}
+    void acquired() {}
+    void released() {}
+#endif
+
+    Mutex mMutex;
+    const pal_lock_rank_t mRank;
+};
+
+#endif /* PAL_LOCK_ORDER_H_ */
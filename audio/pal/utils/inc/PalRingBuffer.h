@@ -34,31 +34,59 @@
 
 
 #include <stdlib.h>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <vector>
 #include <string>
 #include <iostream>
 #include <string.h>
+#include <thread>
 
 #ifndef PALRINGBUFFER_H_
 #define PALRINGBUFFER_H_
 
 #define DEFAULT_PAL_RING_BUFFER_SIZE 4096 * 10
+#define PAL_RING_BUFFER_INIT_READER_SLOTS 8
+#define PAL_RING_BUFFER_CACHE_LINE_SIZE 64
+/*
+ * Hot positions are surrounded by a full cache line of padding rather than
+ * over-aligned, so the layout holds for plain operator new under c++14.
+ */
+#define PAL_RING_BUFFER_PAD(name) char name[PAL_RING_BUFFER_CACHE_LINE_SIZE]
 
 typedef enum {
     READER_DISABLED = 0,
     READER_ENABLED = 1,
 } pal_ring_buffer_reader_state;
 
+/*
+ * Writable area handed out by PalRingBuffer::reserve(). When the reserved
+ * area wraps around the end of the ring, it is split into two spans.
+ */
+struct pal_ring_buffer_region {
+    char *data[2];
+    size_t size[2];
+};
+
 class PalRingBuffer;
 
+/*
+ * Single writer, multiple readers ring buffer.
+ *
+ * The data path (write/reserve/commit on the writer side, read/
+ * advanceReadOffset/getUnreadSize on the reader side) is lock free: the
+ * writer publishes a monotonically increasing write position and each
+ * reader owns its own read position, so neither side waits on the other.
+ * Control operations (newReader, removeReader, reset, resizeRingBuffer,
+ * updateState) are serialized by ctrlMutex_; reset and resize must not
+ * race with an active writer.
+ */
 class PalRingBufferReader {
  public:
      PalRingBufferReader(PalRingBuffer *buffer)
          : ringBuffer_(buffer),
-           unreadSize_(0),
-           readOffset_(0),
+           readPos_(0),
            state_(READER_DISABLED) {}
 
     ~PalRingBufferReader() {};
@@ -69,33 +97,59 @@ class PalRingBufferReader {
     void getIndices(uint32_t *startIndice, uint32_t *endIndice);
     size_t getUnreadSize();
     void reset();
-    bool isEnabled() { return state_ == READER_ENABLED; }
+    bool isEnabled() { return state_.load(std::memory_order_acquire) == READER_ENABLED; }
 
     friend class PalRingBuffer;
     friend class StreamSoundTrigger;
 
  protected:
+    void resetLocked();
+
     PalRingBuffer *ringBuffer_;
-    size_t unreadSize_;
-    size_t readOffset_;
-    pal_ring_buffer_reader_state state_;
+    PAL_RING_BUFFER_PAD(padBefore_);
+    /* only modified by the owner of this reader, read by the writer */
+    std::atomic<uint64_t> readPos_;
+    std::atomic<pal_ring_buffer_reader_state> state_;
+    PAL_RING_BUFFER_PAD(padAfter_);
+};
+
+/*
+ * Reader slots scanned by the writer. The array is replaced by a larger copy
+ * when it is full, the old one is freed once no writer pass can still use it.
+ */
+struct PalRingBufferReaderSlots {
+    explicit PalRingBufferReaderSlots(size_t slotCount)
+        : count(slotCount),
+          readers(new std::atomic<PalRingBufferReader*>[slotCount]) {
+        for (size_t i = 0; i < count; i++)
+            readers[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    size_t count;
+    std::unique_ptr<std::atomic<PalRingBufferReader*>[]> readers;
 };
 
 class PalRingBuffer {
  public:
     explicit PalRingBuffer(size_t bufferSize)
         : buffer_((char*)(new char[bufferSize])),
+          bufferEnd_(bufferSize),
           startIndex(0),
           endIndex(0),
-          writeOffset_(0),
-          bufferEnd_(bufferSize) {}
+          writePos_(0),
+          reservedSize_(0),
+          writerSeq_(0),
+          slots_(new PalRingBufferReaderSlots(PAL_RING_BUFFER_INIT_READER_SLOTS)) {}
 
     ~PalRingBuffer() {
+        PalRingBufferReaderSlots *slots = slots_.load(std::memory_order_relaxed);
+
         if (buffer_)
-            delete buffer_;
+            delete[] buffer_;
 
-        for (int i = 0; i < readOffsets_.size(); i++)
-            delete readOffsets_[i];
+        for (size_t i = 0; i < slots->count; i++)
+            delete slots->readers[i].load(std::memory_order_relaxed);
+        delete slots;
     }
 
     PalRingBufferReader* newReader();
@@ -104,6 +158,8 @@ class PalRingBuffer {
     size_t read(std::shared_ptr<PalRingBufferReader>reader, void* readBuffer,
                 size_t readSize);
     size_t write(void* writeBuffer, size_t writeSize);
+    size_t reserve(size_t size, struct pal_ring_buffer_region *region);
+    size_t commit(size_t size);
     size_t getFreeSize();
     void updateIndices(uint32_t startIndice, uint32_t endIndice);
     void reset();
@@ -111,14 +167,21 @@ class PalRingBuffer {
     void resizeRingBuffer(size_t bufferSize);
 
  protected:
-    std::mutex mutex_;
+    std::mutex ctrlMutex_;
     char* buffer_;
-    uint32_t startIndex;
-    uint32_t endIndex;
-    size_t writeOffset_;
     size_t bufferEnd_;
-    std::vector<PalRingBufferReader*> readOffsets_;
-    void updateUnReadSize(size_t writtenSize);
+    std::atomic<uint32_t> startIndex;
+    std::atomic<uint32_t> endIndex;
+    PAL_RING_BUFFER_PAD(padBeforeWritePos_);
+    /* total bytes committed since last reset, only modified by the writer */
+    std::atomic<uint64_t> writePos_;
+    size_t reservedSize_;
+    /* odd while the writer walks the reader slots, see waitForWriterLocked() */
+    std::atomic<uint64_t> writerSeq_;
+    PAL_RING_BUFFER_PAD(padAfterWritePos_);
+    /* replaced under ctrlMutex_, loaded by the writer while writerSeq_ is odd */
+    std::atomic<PalRingBufferReaderSlots*> slots_;
+    void waitForWriterLocked();
     friend class PalRingBufferReader;
 };
 #endif
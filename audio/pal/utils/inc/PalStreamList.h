@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef PAL_STREAM_LIST_H_
+#define PAL_STREAM_LIST_H_
+
+#include <errno.h>
+#include <stdint.h>
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+
+/*
+ * Streams in registration order, with a count of the entries of each stream
+ * so that membership checks hash instead of walking the list. A stream may
+ * be added more than once, remove() drops its first entry and it stays a
+ * member until every entry is removed, as with a plain std::list.
+ */
+template <class T>
+class PalStreamList
+{
+public:
+    typedef typename std::list<T>::iterator iterator;
+    typedef typename std::list<T>::const_iterator const_iterator;
+
+    void push_back(T s)
+    {
+        mStreams.push_back(s);
+        mCounts[s]++;
+    }
+
+    /* -ENOENT if s is not in the list */
+    int remove(T s)
+    {
+        auto count = mCounts.find(s);
+
+        if (count == mCounts.end())
+            return -ENOENT;
+        mStreams.erase(std::find(mStreams.begin(), mStreams.end(), s));
+        if (--count->second == 0)
+            mCounts.erase(count);
+        return 0;
+    }
+
+    bool contains(T s) const { return mCounts.find(s) != mCounts.end(); }
+    size_t size() const { return mStreams.size(); }
+    bool empty() const { return mStreams.empty(); }
+
+    iterator begin() { return mStreams.begin(); }
+    iterator end() { return mStreams.end(); }
+    const_iterator begin() const { return mStreams.begin(); }
+    const_iterator end() const { return mStreams.end(); }
+
+private:
+    std::list<T> mStreams;
+    std::unordered_map<T, uint32_t> mCounts;
+};
+
+#endif /* PAL_STREAM_LIST_H_ */
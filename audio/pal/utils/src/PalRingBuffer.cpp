@@ -28,18 +28,40 @@
  */
 
 
-#ifdef LINUX_ENABLED
 #include <algorithm>
-#endif
 #include "PalRingBuffer.h"
 #include "PalCommon.h"
 #define LOG_TAG "PAL: PalRingBuffer"
 
+/*
+ * A writer inside getFreeSize() may have loaded a reader or the slot array
+ * before it was cleared or replaced, wait for that pass to finish. Later
+ * passes only see the new state.
+ */
+void PalRingBuffer::waitForWriterLocked()
+{
+    uint64_t seq = writerSeq_.load(std::memory_order_seq_cst);
+
+    if (seq & 1) {
+        while (writerSeq_.load(std::memory_order_acquire) == seq)
+            std::this_thread::yield();
+    }
+}
+
 int32_t PalRingBuffer::removeReader(PalRingBufferReader *reader)
 {
-    auto iter = std::find(readOffsets_.begin(), readOffsets_.end(), reader);
-    if (iter != readOffsets_.end())
-        readOffsets_.erase(iter);
+    std::lock_guard<std::mutex> lock(ctrlMutex_);
+    PalRingBufferReaderSlots *slots = slots_.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < slots->count; i++) {
+        if (slots->readers[i].load(std::memory_order_relaxed) == reader) {
+            slots->readers[i].store(nullptr, std::memory_order_seq_cst);
+            break;
+        }
+    }
+
+    /* the owner deletes the reader once this returns */
+    waitForWriterLocked();
 
     return 0;
 }
@@ -52,94 +74,114 @@ size_t PalRingBuffer::read(std::shared_ptr<PalRingBufferReader>reader __unused,
 
 size_t PalRingBuffer::getFreeSize()
 {
+    uint64_t writePos = writePos_.load(std::memory_order_relaxed);
+    uint64_t unreadSize = 0;
+    uint64_t maxUnreadSize = 0;
+    PalRingBufferReaderSlots *slots = nullptr;
+    PalRingBufferReader *reader = nullptr;
+
+    /* pairs with waitForWriterLocked(), nothing loaded here is freed while seq is odd */
+    writerSeq_.fetch_add(1, std::memory_order_seq_cst);
+    slots = slots_.load(std::memory_order_seq_cst);
+    for (size_t i = 0; i < slots->count; i++) {
+        reader = slots->readers[i].load(std::memory_order_seq_cst);
+        if (!reader || !reader->isEnabled())
+            continue;
+
+        unreadSize = writePos - reader->readPos_.load(std::memory_order_acquire);
+        maxUnreadSize = std::max(maxUnreadSize, unreadSize);
+    }
+    writerSeq_.fetch_add(1, std::memory_order_release);
 
-    size_t freeSize = bufferEnd_;
-    std::vector<PalRingBufferReader*>::iterator it;
+    if (maxUnreadSize >= bufferEnd_)
+        return 0;
 
-    for (it = readOffsets_.begin(); it != readOffsets_.end(); it++) {
-        if ((*(it))->state_ == READER_ENABLED)
-            freeSize = std::min(freeSize, bufferEnd_ - (*(it))->unreadSize_);
-    }
-    return freeSize;
+    return bufferEnd_ - maxUnreadSize;
+}
+
+void PalRingBuffer::updateIndices(uint32_t startIndice, uint32_t endIndice)
+{
+    startIndex.store(startIndice, std::memory_order_relaxed);
+    endIndex.store(endIndice, std::memory_order_release);
+    PAL_VERBOSE(LOG_TAG, "start index = %u, end index = %u", startIndice, endIndice);
 }
 
-void PalRingBuffer::updateUnReadSize(size_t writtenSize)
+size_t PalRingBuffer::reserve(size_t size, struct pal_ring_buffer_region *region)
 {
-    int32_t i = 0;
-    std::vector<PalRingBufferReader*>::iterator it;
+    size_t freeSize = getFreeSize();
+    size_t sizeToReserve = std::min(size, freeSize);
+    size_t writeOffset = writePos_.load(std::memory_order_relaxed) % bufferEnd_;
 
-    for (it = readOffsets_.begin(); it != readOffsets_.end(); it++, i++) {
-        (*(it))->unreadSize_ += writtenSize;
-        PAL_VERBOSE(LOG_TAG, "Reader (%d), unreadSize(%zu)", i, (*(it))->unreadSize_);
-    }
+    if (!region)
+        return 0;
+
+    region->data[0] = buffer_ + writeOffset;
+    region->size[0] = std::min(sizeToReserve, bufferEnd_ - writeOffset);
+    region->data[1] = buffer_;
+    region->size[1] = sizeToReserve - region->size[0];
+    reservedSize_ = sizeToReserve;
+
+    PAL_VERBOSE(LOG_TAG, "reserved %zu bytes, freeSize(%zu), writeOffset(%zu)",
+                sizeToReserve, freeSize, writeOffset);
+    return sizeToReserve;
 }
 
-void PalRingBuffer::updateIndices(uint32_t startIndice, uint32_t endIndice)
+size_t PalRingBuffer::commit(size_t size)
 {
-    startIndex = startIndice;
-    endIndex = endIndice;
-    PAL_VERBOSE(LOG_TAG, "start index = %u, end index = %u", startIndex, endIndex);
+    if (size > reservedSize_) {
+        PAL_ERR(LOG_TAG, "Cannot commit %zu bytes greater than reserved size %zu",
+                size, reservedSize_);
+        size = reservedSize_;
+    }
+
+    /* publish the data to all readers at once */
+    writePos_.store(writePos_.load(std::memory_order_relaxed) + size,
+                    std::memory_order_release);
+    reservedSize_ = 0;
+
+    return size;
 }
 
 size_t PalRingBuffer::write(void* writeBuffer, size_t writeSize)
 {
-    /* update the unread size for each reader*/
-    mutex_.lock();
-    size_t freeSize = getFreeSize();
-    size_t writtenSize = 0;
-    int32_t i = 0;
+    struct pal_ring_buffer_region region;
     size_t sizeToCopy = 0;
 
-    PAL_DBG(LOG_TAG, "Enter. freeSize(%zu), writeOffset(%zu)", freeSize, writeOffset_);
-
-    if (writeSize <= freeSize)
-        sizeToCopy = writeSize;
-    else
-        sizeToCopy = freeSize;
-
-    if (sizeToCopy) {
-        //buffer wrapped around
-        if (writeOffset_ + sizeToCopy > bufferEnd_) {
-            i = bufferEnd_ - writeOffset_;
-
-            ar_mem_cpy(buffer_ + writeOffset_, i, writeBuffer, i);
-            writtenSize += i;
-            sizeToCopy -= writtenSize;
-            ar_mem_cpy(buffer_, sizeToCopy, (char*)writeBuffer + writtenSize,
-                             sizeToCopy);
-            writtenSize += sizeToCopy;
-            writeOffset_ = sizeToCopy;
-        } else {
-            ar_mem_cpy(buffer_ + writeOffset_, sizeToCopy, writeBuffer,
-                             sizeToCopy);
-            writeOffset_ += sizeToCopy;
-            writtenSize = sizeToCopy;
-        }
-    }
-    updateUnReadSize(writtenSize);
-    writeOffset_ = writeOffset_ % bufferEnd_;
-    PAL_DBG(LOG_TAG, "Exit. writeOffset(%zu)", writeOffset_);
-    mutex_.unlock();
-    return writtenSize;
+    sizeToCopy = reserve(writeSize, &region);
+    PAL_DBG(LOG_TAG, "Enter. writeSize(%zu), sizeToCopy(%zu)", writeSize, sizeToCopy);
+
+    if (region.size[0])
+        ar_mem_cpy(region.data[0], region.size[0], writeBuffer, region.size[0]);
+    if (region.size[1])
+        ar_mem_cpy(region.data[1], region.size[1],
+                   (char *)writeBuffer + region.size[0], region.size[1]);
+
+    return commit(sizeToCopy);
 }
 
 void PalRingBuffer::reset()
 {
-    std::vector<PalRingBufferReader*>::iterator it;
-
-    mutex_.lock();
-    startIndex = 0;
-    endIndex = 0;
-    writeOffset_ = 0;
-    mutex_.unlock();
-
-    /* Reset all the associated readers */
-    for (it = readOffsets_.begin(); it != readOffsets_.end(); it++)
-        (*(it))->reset();
+    std::lock_guard<std::mutex> lock(ctrlMutex_);
+    PalRingBufferReaderSlots *slots = slots_.load(std::memory_order_relaxed);
+    PalRingBufferReader *reader = nullptr;
+
+    startIndex.store(0, std::memory_order_relaxed);
+    endIndex.store(0, std::memory_order_relaxed);
+    writePos_.store(0, std::memory_order_release);
+    reservedSize_ = 0;
+
+    /* Reset all the associated readers, removeReader() can not run meanwhile */
+    for (size_t i = 0; i < slots->count; i++) {
+        reader = slots->readers[i].load(std::memory_order_relaxed);
+        if (reader)
+            reader->resetLocked();
+    }
 }
 
 void PalRingBuffer::resizeRingBuffer(size_t bufferSize)
 {
+    std::lock_guard<std::mutex> lock(ctrlMutex_);
+
     if (buffer_) {
         delete[] buffer_;
         buffer_ = nullptr;
@@ -150,145 +192,141 @@ void PalRingBuffer::resizeRingBuffer(size_t bufferSize)
 
 int32_t PalRingBufferReader::read(void* readBuffer, size_t bufferSize)
 {
-    int32_t readSize = 0;
-
-    if (state_ == READER_DISABLED)
+    uint64_t writePos = 0;
+    uint64_t readPos = 0;
+    size_t unreadSize = 0;
+    size_t readSize = 0;
+    size_t readOffset = 0;
+    size_t firstSize = 0;
+
+    if (!isEnabled())
         return -EINVAL;
 
+    writePos = ringBuffer_->writePos_.load(std::memory_order_acquire);
+    readPos = readPos_.load(std::memory_order_relaxed);
+
     // Return 0 when no data can be read for current reader
-    if (unreadSize_ == 0)
+    if (writePos == readPos)
         return 0;
 
-    ringBuffer_->mutex_.lock();
-
-    // when writeOffset leads readOffset
-    if (ringBuffer_->writeOffset_ > readOffset_) {
-        unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
-
-        if (bufferSize >= unreadSize_) {
-            ar_mem_cpy(readBuffer, unreadSize_, ringBuffer_->buffer_ +
-                             readOffset_, unreadSize_);
-            readOffset_ += unreadSize_;
-            readSize = unreadSize_;
-            unreadSize_ = 0;
-        } else {
-            ar_mem_cpy(readBuffer, unreadSize_, ringBuffer_->buffer_ +
-                             readOffset_, bufferSize);
-            readOffset_ += bufferSize;
-            readSize = bufferSize;
-            unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
-        }
-    } else {
-        //When readOffset leads WriteOffset
-        int32_t freeClientSize = bufferSize;
-        int32_t i = ringBuffer_->bufferEnd_ - readOffset_;
-
-        if (bufferSize >= i) {
-            ar_mem_cpy(readBuffer, i, (char*)(ringBuffer_->buffer_ +
-                             readOffset_), i);
-            readSize = i;
-            freeClientSize -= readSize;
-            unreadSize_ = ringBuffer_->writeOffset_;
-            readOffset_ = 0;
-            //copy remaining unread buffer
-            if (freeClientSize > unreadSize_) {
-                ar_mem_cpy((char *)readBuffer + readSize, unreadSize_,
-                                 ringBuffer_->buffer_, unreadSize_);
-                readSize += unreadSize_;
-                readOffset_ = unreadSize_;
-                unreadSize_ = 0;
-            } else {
-                //copy whatever we can
-                ar_mem_cpy((char *)readBuffer + readSize, freeClientSize,
-                                 ringBuffer_->buffer_, freeClientSize);
-                readSize += freeClientSize;
-                readOffset_ = freeClientSize;
-                unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
-            }
-
-        } else {
-            ar_mem_cpy(readBuffer, bufferSize, ringBuffer_->buffer_ +
-                             readOffset_, bufferSize);
-            readSize = bufferSize;
-            readOffset_ += bufferSize;
-            unreadSize_ = ringBuffer_->bufferEnd_ - readOffset_ +
-                          ringBuffer_->writeOffset_;
-        }
-    }
-    ringBuffer_->mutex_.unlock();
+    // data older than one buffer length has been overwritten already
+    if (writePos - readPos > ringBuffer_->bufferEnd_)
+        readPos = writePos - ringBuffer_->bufferEnd_;
+
+    unreadSize = writePos - readPos;
+    readSize = std::min(bufferSize, unreadSize);
+    readOffset = readPos % ringBuffer_->bufferEnd_;
+    firstSize = std::min(readSize, ringBuffer_->bufferEnd_ - readOffset);
+
+    ar_mem_cpy(readBuffer, firstSize, ringBuffer_->buffer_ + readOffset,
+               firstSize);
+    // buffer wrapped around, copy remaining data from the start
+    if (readSize > firstSize)
+        ar_mem_cpy((char *)readBuffer + firstSize, readSize - firstSize,
+                   ringBuffer_->buffer_, readSize - firstSize);
+
+    /* release the consumed area back to the writer */
+    readPos_.store(readPos + readSize, std::memory_order_release);
+
     return readSize;
 }
 
 size_t PalRingBufferReader::advanceReadOffset(size_t advanceSize)
 {
-    size_t size_advanced = 0;
-
-    std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+    uint64_t readPos = readPos_.load(std::memory_order_relaxed);
+    size_t unreadSize = getUnreadSize();
 
     /* add code to advance the offset here*/
-    if (unreadSize_ < advanceSize) {
+    if (unreadSize < advanceSize) {
         PAL_ERR(LOG_TAG, "Cannot advance read offset %zu greater than unread size %zu",
-            advanceSize, unreadSize_);
-        return size_advanced;
+            advanceSize, unreadSize);
+        return 0;
     }
 
-    unreadSize_ -= advanceSize;
-    if (readOffset_ + advanceSize < ringBuffer_->bufferEnd_) {
-        readOffset_ += advanceSize;
-    } else {
-        readOffset_ = readOffset_ + advanceSize - ringBuffer_->bufferEnd_;
-    }
-    size_advanced += advanceSize;
+    readPos_.store(readPos + advanceSize, std::memory_order_release);
 
-    return size_advanced;
+    return advanceSize;
 }
 
 void PalRingBufferReader::updateState(pal_ring_buffer_reader_state state)
 {
-    PAL_DBG(LOG_TAG, "update reader state to %d", state);
-    std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+    uint64_t writePos = 0;
 
-    if (state_ == READER_DISABLED && state == READER_ENABLED) {
-        if (unreadSize_ > ringBuffer_->bufferEnd_)
-           unreadSize_ = ringBuffer_->bufferEnd_;
-
-        if (unreadSize_ <= ringBuffer_->writeOffset_) {
-            readOffset_ = ringBuffer_->writeOffset_ - unreadSize_;
-        } else {
-            readOffset_ = ringBuffer_->writeOffset_ +
-                ringBuffer_->bufferEnd_ - unreadSize_;
-        }
+    PAL_DBG(LOG_TAG, "update reader state to %d", state);
+    std::lock_guard<std::mutex> lock(ringBuffer_->ctrlMutex_);
+
+    if (state_.load(std::memory_order_relaxed) == READER_DISABLED &&
+        state == READER_ENABLED) {
+        writePos = ringBuffer_->writePos_.load(std::memory_order_acquire);
+        if (writePos - readPos_.load(std::memory_order_relaxed) >
+            ringBuffer_->bufferEnd_)
+            readPos_.store(writePos - ringBuffer_->bufferEnd_,
+                           std::memory_order_release);
     }
-    state_ = state;
+    state_.store(state, std::memory_order_release);
 }
 
 void PalRingBufferReader::getIndices(uint32_t *startIndice, uint32_t *endIndice)
 {
-    *startIndice = ringBuffer_->startIndex;
-    *endIndice = ringBuffer_->endIndex;
+    *endIndice = ringBuffer_->endIndex.load(std::memory_order_acquire);
+    *startIndice = ringBuffer_->startIndex.load(std::memory_order_relaxed);
     PAL_VERBOSE(LOG_TAG, "start index = %u, end index = %u",
-                ringBuffer_->startIndex, ringBuffer_->endIndex);
+                *startIndice, *endIndice);
 }
 
 size_t PalRingBufferReader::getUnreadSize()
 {
-    PAL_VERBOSE(LOG_TAG, "unread size %zu", unreadSize_);
-    return unreadSize_;
+    size_t unreadSize = ringBuffer_->writePos_.load(std::memory_order_acquire) -
+                        readPos_.load(std::memory_order_relaxed);
+
+    PAL_VERBOSE(LOG_TAG, "unread size %zu", unreadSize);
+    return unreadSize;
 }
 
 void PalRingBufferReader::reset()
 {
-    ringBuffer_->mutex_.lock();
-    readOffset_ = 0;
-    unreadSize_ = 0;
-    state_ = READER_DISABLED;
-    ringBuffer_->mutex_.unlock();
+    std::lock_guard<std::mutex> lock(ringBuffer_->ctrlMutex_);
+
+    resetLocked();
+}
+
+void PalRingBufferReader::resetLocked()
+{
+    state_.store(READER_DISABLED, std::memory_order_release);
+    readPos_.store(ringBuffer_->writePos_.load(std::memory_order_acquire),
+                   std::memory_order_release);
 }
 
 PalRingBufferReader* PalRingBuffer::newReader()
 {
-    PalRingBufferReader* readOffset =
-                  new PalRingBufferReader(this);
-    readOffsets_.push_back(readOffset);
+    PalRingBufferReader* readOffset = nullptr;
+    PalRingBufferReaderSlots *slots = nullptr;
+    PalRingBufferReaderSlots *newSlots = nullptr;
+    size_t freeSlot = 0;
+    std::lock_guard<std::mutex> lock(ctrlMutex_);
+
+    slots = slots_.load(std::memory_order_relaxed);
+    while (freeSlot < slots->count &&
+           slots->readers[freeSlot].load(std::memory_order_relaxed))
+        freeSlot++;
+
+    if (freeSlot == slots->count) {
+        /* all slots taken, publish a copy with twice the slots */
+        newSlots = new PalRingBufferReaderSlots(slots->count * 2);
+        for (size_t i = 0; i < slots->count; i++)
+            newSlots->readers[i].store(slots->readers[i].load(std::memory_order_relaxed),
+                                       std::memory_order_relaxed);
+        slots_.store(newSlots, std::memory_order_seq_cst);
+        waitForWriterLocked();
+        delete slots;
+        slots = newSlots;
+        PAL_DBG(LOG_TAG, "grew reader slots to %zu", slots->count);
+    }
+
+    readOffset = new PalRingBufferReader(this);
+    readOffset->readPos_.store(writePos_.load(std::memory_order_relaxed),
+                               std::memory_order_relaxed);
+    slots->readers[freeSlot].store(readOffset, std::memory_order_release);
+
     return readOffset;
 }
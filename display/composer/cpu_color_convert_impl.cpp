@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <QtiGralloc.h>
+#include <errno.h>
+#include <utils/constants.h>
+#include <utils/debug.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "cpu_color_convert_impl.h"
+#include "cpu_image_ops.h"
+#include "gr_utils.h"
+
+#define __CLASS__ "CPUColorConvertImpl"
+
+namespace sdm {
+
+static bool IsCPUAccessible(const private_handle_t *hnd) {
+  return !(hnd->flags & (private_handle_t::PRIV_FLAGS_UBWC_ALIGNED |
+                         private_handle_t::PRIV_FLAGS_SECURE_BUFFER));
+}
+
+static bool IsSupportedSource(const private_handle_t *hnd) {
+  return IsCPUAccessible(hnd) &&
+         (hnd->format == HAL_PIXEL_FORMAT_RGBA_8888 || hnd->format == HAL_PIXEL_FORMAT_RGBX_8888);
+}
+
+static bool IsSupportedDestination(const private_handle_t *hnd) {
+  if (!IsCPUAccessible(hnd)) {
+    return false;
+  }
+
+  switch (hnd->format) {
+    case HAL_PIXEL_FORMAT_YCbCr_420_SP:
+    case HAL_PIXEL_FORMAT_YCbCr_420_SP_VENUS:
+    case HAL_PIXEL_FORMAT_NV12_ENCODEABLE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+static void ScaleRow(const uint8_t *src, const uint32_t *src_x, uint32_t count, uint8_t *dst) {
+  const uint32_t *src_pixels = reinterpret_cast<const uint32_t *>(src);
+  uint32_t *dst_pixels = reinterpret_cast<uint32_t *>(dst);
+  for (uint32_t i = 0; i < count; i++) {
+    dst_pixels[i] = src_pixels[src_x[i]];
+  }
+}
+
+int CPUColorConvertImpl::Init() {
+  // The GLES backend only has the RGB to YUV shader as well.
+  if (target_ != kTargetYUV) {
+    DLOGE("Unsupported GLRenderTarget: %d", target_);
+    return -1;
+  }
+
+  return 0;
+}
+
+int CPUColorConvertImpl::Blit(const native_handle_t *src_hnd, const native_handle_t *dst_hnd,
+                              const GLRect &src_rect, const GLRect &dst_rect,
+                              const shared_ptr<Fence> &src_acquire_fence,
+                              const shared_ptr<Fence> &dst_acquire_fence,
+                              shared_ptr<Fence> *release_fence) {
+  DTRACE_SCOPED();
+  *release_fence = nullptr;
+
+  const private_handle_t *src = static_cast<const private_handle_t *>(src_hnd);
+  const private_handle_t *dst = static_cast<const private_handle_t *>(dst_hnd);
+  if (!IsSupportedSource(src) || !IsSupportedDestination(dst)) {
+    DLOGE("Unsupported buffers, src format %d flags 0x%x, dst format %d flags 0x%x", src->format,
+          src->flags, dst->format, dst->flags);
+    return -1;
+  }
+
+  // Setup only what the layout calculation needs, as HWCBufferAllocator::GetBufferLayout does.
+  private_handle_t layout_hnd(-1, 0, 0, 0, 0, 0, 0);
+  layout_hnd.format = dst->format;
+  layout_hnd.width = dst->width;
+  layout_hnd.height = dst->height;
+  uint32_t stride[4] = {};
+  uint32_t offset[4] = {};
+  uint32_t num_planes = 0;
+  if (gralloc::GetBufferLayout(&layout_hnd, stride, offset, &num_planes) < 0 || num_planes < 2) {
+    DLOGE("GetBufferLayout failed for format %d", dst->format);
+    return -1;
+  }
+
+  // Chroma is subsampled, so the written area is kept on even coordinates.
+  uint32_t left = UINT32(std::max(dst_rect.left, 0.0f)) & ~1U;
+  uint32_t top = UINT32(std::max(dst_rect.top, 0.0f)) & ~1U;
+  uint32_t right = std::min(UINT32(std::max(dst_rect.right, 0.0f)),
+                            UINT32(dst->unaligned_width)) & ~1U;
+  uint32_t bottom = std::min(UINT32(std::max(dst_rect.bottom, 0.0f)),
+                             UINT32(dst->unaligned_height)) & ~1U;
+  if (right <= left || bottom <= top) {
+    return 0;
+  }
+
+  if (Fence::Wait(src_acquire_fence) != kErrorNone ||
+      Fence::Wait(dst_acquire_fence) != kErrorNone) {
+    DLOGW("Wait on acquire fence failed, errno = %d", errno);
+    return -1;
+  }
+
+  CPUMappedBuffer src_buffer, dst_buffer;
+  if (!src_buffer.Map(src->fd, src->size, false) || !dst_buffer.Map(dst->fd, dst->size, true)) {
+    return -1;
+  }
+
+  uint32_t width = right - left;
+  uint32_t height = bottom - top;
+  uint32_t src_width = UINT32(src->unaligned_width);
+  uint32_t src_stride = UINT32(src->width) * 4;
+  const uint8_t *src_base = src_buffer.Base();
+  uint8_t *luma = dst_buffer.Base() + offset[0] + top * stride[0] + left;
+  uint8_t *chroma = dst_buffer.Base() + offset[1] + (top / 2) * stride[1] + left;
+
+  std::vector<uint32_t> src_x;
+  if (src_width != width) {
+    GetScaleMap(src_width, width, &src_x);
+  }
+  std::vector<uint32_t> src_y;
+  GetScaleMap(UINT32(src->unaligned_height), height, &src_y);
+
+  CPUWorkerPool::GetInstance()->ParallelFor(height / 2, [&](uint32_t begin, uint32_t end) {
+    std::vector<uint8_t> scaled_rows(src_x.empty() ? 0 : width * 8);
+
+    for (uint32_t pair = begin; pair < end; pair++) {
+      uint32_t y = pair * 2;
+      const uint8_t *row0 = src_base + src_y[y] * src_stride;
+      const uint8_t *row1 = src_base + src_y[y + 1] * src_stride;
+      if (!src_x.empty()) {
+        ScaleRow(row0, src_x.data(), width, scaled_rows.data());
+        ScaleRow(row1, src_x.data(), width, scaled_rows.data() + width * 4);
+        row0 = scaled_rows.data();
+        row1 = scaled_rows.data() + width * 4;
+      }
+
+      ConvertRowPairToNV12(row0, row1, width, luma + y * stride[0], luma + (y + 1) * stride[0],
+                           chroma + pair * stride[1]);
+    }
+  });
+
+  return 0;
+}
+
+}  // namespace sdm
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __CPU_COLOR_CONVERT_IMPL_H__
+#define __CPU_COLOR_CONVERT_IMPL_H__
+
+#include "gl_color_convert.h"
+
+namespace sdm {
+
+// CPU backend of GLColorConvert. Like the GLES shader it converts the whole RGBA source into
+// dst_rect of an NV12 destination with full range BT.601, scaling with the nearest neighbour.
+// Blit completes before it returns, so the release fence is always empty.
+class CPUColorConvertImpl : public GLColorConvert {
+ public:
+  explicit CPUColorConvertImpl(GLRenderTarget target) : target_(target) { }
+  virtual ~CPUColorConvertImpl() { }
+  virtual int Blit(const native_handle_t *src_hnd, const native_handle_t *dst_hnd,
+                   const GLRect &src_rect, const GLRect &dst_rect,
+                   const shared_ptr<Fence> &src_acquire_fence,
+                   const shared_ptr<Fence> &dst_acquire_fence, shared_ptr<Fence> *release_fence);
+  virtual int Init();
+  virtual int Deinit() { return 0; }
+  virtual void Reset() { }
+
+ private:
+  GLRenderTarget target_ = kTargetYUV;
+};
+
+}  // namespace sdm
+
+#endif  // __CPU_COLOR_CONVERT_IMPL_H__
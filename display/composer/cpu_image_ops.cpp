@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <errno.h>
+#include <linux/dma-buf.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <utils/constants.h>
+#include <utils/debug.h>
+
+#include <algorithm>
+
+#include "cpu_image_ops.h"
+
+#define __CLASS__ "CPUImageOps"
+
+namespace sdm {
+
+CPUWorkerPool *CPUWorkerPool::GetInstance() {
+  static CPUWorkerPool worker_pool(std::min(std::max(std::thread::hardware_concurrency(), 1U),
+                                            kMaxThreads));
+  return &worker_pool;
+}
+
+CPUWorkerPool::CPUWorkerPool(uint32_t num_threads) {
+  for (uint32_t i = 1; i < num_threads; i++) {
+    workers_.emplace_back(&CPUWorkerPool::WorkerThread, this);
+  }
+}
+
+CPUWorkerPool::~CPUWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    exit_ = true;
+  }
+  job_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void CPUWorkerPool::ParallelFor(uint32_t count,
+                                const std::function<void(uint32_t, uint32_t)> &fn) {
+  if (!count) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> call_lock(call_lock_);
+  std::unique_lock<std::mutex> lock(lock_);
+  // Two bands per thread, so a thread that gets preempted does not hold up the whole frame
+  job_ = &fn;
+  job_count_ = count;
+  num_bands_ = std::min(count, UINT32(workers_.size() + 1) * 2);
+  next_band_ = 0;
+  done_bands_ = 0;
+  generation_++;
+  job_cv_.notify_all();
+
+  while (RunBand(&lock)) {}
+  done_cv_.wait(lock, [this] { return done_bands_ == num_bands_; });
+  job_ = nullptr;
+}
+
+bool CPUWorkerPool::RunBand(std::unique_lock<std::mutex> *lock) {
+  if (!job_ || next_band_ == num_bands_) {
+    return false;
+  }
+
+  const std::function<void(uint32_t, uint32_t)> *job = job_;
+  uint32_t band = next_band_++;
+  uint32_t begin = UINT32(UINT64(job_count_) * band / num_bands_);
+  uint32_t end = UINT32(UINT64(job_count_) * (band + 1) / num_bands_);
+
+  lock->unlock();
+  (*job)(begin, end);
+  lock->lock();
+
+  if (++done_bands_ == num_bands_) {
+    done_cv_.notify_one();
+  }
+
+  return true;
+}
+
+void CPUWorkerPool::WorkerThread() {
+  std::unique_lock<std::mutex> lock(lock_);
+  uint64_t generation = generation_;
+  while (true) {
+    job_cv_.wait(lock, [&] { return exit_ || generation != generation_; });
+    if (exit_) {
+      break;
+    }
+
+    generation = generation_;
+    while (RunBand(&lock)) {}
+  }
+}
+
+CPUMappedBuffer::~CPUMappedBuffer() {
+  if (base_) {
+    SyncAccess(true);
+    munmap(base_, size_);
+  }
+}
+
+bool CPUMappedBuffer::Map(int fd, uint32_t size, bool write) {
+  void *base = mmap(NULL, size, write ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    DLOGE("mmap failed for fd %d, errno = %d", fd, errno);
+    return false;
+  }
+
+  fd_ = fd;
+  size_ = size;
+  write_ = write;
+  base_ = static_cast<uint8_t *>(base);
+  SyncAccess(false);
+
+  return true;
+}
+
+void CPUMappedBuffer::SyncAccess(bool end) {
+  struct dma_buf_sync sync = {};
+  sync.flags = (end ? DMA_BUF_SYNC_END : DMA_BUF_SYNC_START) |
+               (write_ ? DMA_BUF_SYNC_RW : DMA_BUF_SYNC_READ);
+  if (ioctl(fd_, INT(DMA_BUF_IOCTL_SYNC), &sync)) {
+    DLOGW("DMA_BUF_IOCTL_SYNC failed for fd %d, errno = %d", fd_, errno);
+  }
+}
+
+void UnpackRow(CPUPixelLayout layout, const uint8_t *src, const uint32_t *src_x, uint32_t count,
+               float *r, float *g, float *b, float *a) {
+  const float k8Bit = 1.0f / 255.0f;
+  const float k10Bit = 1.0f / 1023.0f;
+  const float k2Bit = 1.0f / 3.0f;
+  bool opaque = (layout == kCPUPixelRGBX8888 || layout == kCPUPixelRGBX1010102);
+
+  if (layout == kCPUPixelRGBA8888 || layout == kCPUPixelRGBX8888) {
+    for (uint32_t i = 0; i < count; i++) {
+      const uint8_t *pixel = src + (src_x ? src_x[i] : i) * 4;
+      r[i] = FLOAT(pixel[0]) * k8Bit;
+      g[i] = FLOAT(pixel[1]) * k8Bit;
+      b[i] = FLOAT(pixel[2]) * k8Bit;
+      a[i] = opaque ? 1.0f : FLOAT(pixel[3]) * k8Bit;
+    }
+  } else {
+    const uint32_t *words = reinterpret_cast<const uint32_t *>(src);
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t word = words[src_x ? src_x[i] : i];
+      r[i] = FLOAT(word & 0x3ff) * k10Bit;
+      g[i] = FLOAT((word >> 10) & 0x3ff) * k10Bit;
+      b[i] = FLOAT((word >> 20) & 0x3ff) * k10Bit;
+      a[i] = opaque ? 1.0f : FLOAT(word >> 30) * k2Bit;
+    }
+  }
+}
+
+static inline float Saturate(float c) {
+  return std::min(std::max(c, 0.0f), 1.0f);
+}
+
+void PackRow(CPUPixelLayout layout, const float *r, const float *g, const float *b,
+             const float *a, uint32_t count, uint8_t *dst) {
+  bool opaque = (layout == kCPUPixelRGBX8888 || layout == kCPUPixelRGBX1010102);
+
+  if (layout == kCPUPixelRGBA8888 || layout == kCPUPixelRGBX8888) {
+    for (uint32_t i = 0; i < count; i++) {
+      uint8_t *pixel = dst + i * 4;
+      pixel[0] = UINT8(Saturate(r[i]) * 255.0f + 0.5f);
+      pixel[1] = UINT8(Saturate(g[i]) * 255.0f + 0.5f);
+      pixel[2] = UINT8(Saturate(b[i]) * 255.0f + 0.5f);
+      pixel[3] = opaque ? 0xff : UINT8(Saturate(a[i]) * 255.0f + 0.5f);
+    }
+  } else {
+    uint32_t *words = reinterpret_cast<uint32_t *>(dst);
+    for (uint32_t i = 0; i < count; i++) {
+      uint32_t alpha = opaque ? 3 : UINT32(Saturate(a[i]) * 3.0f + 0.5f);
+      words[i] = UINT32(Saturate(r[i]) * 1023.0f + 0.5f) |
+                 (UINT32(Saturate(g[i]) * 1023.0f + 0.5f) << 10) |
+                 (UINT32(Saturate(b[i]) * 1023.0f + 0.5f) << 20) | (alpha << 30);
+    }
+  }
+}
+
+void GetScaleMap(uint32_t src_width, uint32_t dst_width, std::vector<uint32_t> *src_x) {
+  src_x->resize(dst_width);
+  for (uint32_t i = 0; i < dst_width; i++) {
+    // Samples at the centre of each destination pixel
+    uint64_t x = (UINT64(2 * i + 1) * src_width) / (UINT64(2) * dst_width);
+    src_x->at(i) = std::min(UINT32(x), src_width - 1);
+  }
+}
+
+static void UnpackEntries(const Color10Bit *entries, uint32_t count, std::vector<float> *table) {
+  const float k10Bit = 1.0f / 1023.0f;
+  table->assign(count * 4, 0.0f);
+  for (uint32_t i = 0; i < count; i++) {
+    table->at(i * 4) = FLOAT(entries[i].R) * k10Bit;
+    table->at(i * 4 + 1) = FLOAT(entries[i].G) * k10Bit;
+    table->at(i * 4 + 2) = FLOAT(entries[i].B) * k10Bit;
+  }
+}
+
+bool CPULut3d::Init(const Color10Bit *lut_entries, uint32_t dim, const Color10Bit *xform_entries,
+                    uint32_t xform_size) {
+  if (!lut_entries || dim < 2) {
+    DLOGE("Invalid 3D LUT, dim = %d", dim);
+    return false;
+  }
+
+  dim_ = dim;
+  UnpackEntries(lut_entries, dim * dim * dim, &lut_);
+
+  xform_size_ = (xform_entries && xform_size > 1) ? xform_size : 0;
+  if (xform_size_) {
+    UnpackEntries(xform_entries, xform_size_, &xform_);
+  }
+
+  return true;
+}
+
+static inline float Lerp(float c0, float c1, float f) {
+  return c0 + (c1 - c0) * f;
+}
+
+void CPULut3d::ApplyXform(float *c, uint32_t count, uint32_t channel) const {
+  const float *xform = xform_.data() + channel;
+  const float scale = FLOAT(xform_size_ - 1);
+  const uint32_t max_index = xform_size_ - 2;
+
+  for (uint32_t i = 0; i < count; i++) {
+    float x = Saturate(c[i]) * scale;
+    uint32_t x0 = std::min(UINT32(x), max_index);
+    c[i] = Lerp(xform[x0 * 4], xform[(x0 + 1) * 4], x - FLOAT(x0));
+  }
+}
+
+void CPULut3d::Map(float *r, float *g, float *b, uint32_t count) const {
+  if (xform_size_) {
+    ApplyXform(r, count, 0);
+    ApplyXform(g, count, 1);
+    ApplyXform(b, count, 2);
+  }
+
+  const float *lut = lut_.data();
+  const float scale = FLOAT(dim_ - 1);
+  const uint32_t max_index = dim_ - 2;
+  const uint32_t stride_g = dim_ * 4;
+  const uint32_t stride_b = dim_ * dim_ * 4;
+
+  for (uint32_t i = 0; i < count; i++) {
+    float x = Saturate(r[i]) * scale;
+    float y = Saturate(g[i]) * scale;
+    float z = Saturate(b[i]) * scale;
+    uint32_t x0 = std::min(UINT32(x), max_index);
+    uint32_t y0 = std::min(UINT32(y), max_index);
+    uint32_t z0 = std::min(UINT32(z), max_index);
+    float fx = x - FLOAT(x0);
+    float fy = y - FLOAT(y0);
+    float fz = z - FLOAT(z0);
+
+    const float *c000 = lut + x0 * 4 + y0 * stride_g + z0 * stride_b;
+    const float *c010 = c000 + stride_g;
+    const float *c001 = c000 + stride_b;
+    const float *c011 = c001 + stride_g;
+    // All four lanes are interpolated, which maps to one vector register per corner
+    float out[4];
+    for (uint32_t ch = 0; ch < 4; ch++) {
+      float c00 = Lerp(c000[ch], c000[ch + 4], fx);
+      float c10 = Lerp(c010[ch], c010[ch + 4], fx);
+      float c01 = Lerp(c001[ch], c001[ch + 4], fx);
+      float c11 = Lerp(c011[ch], c011[ch + 4], fx);
+      out[ch] = Lerp(Lerp(c00, c10, fy), Lerp(c01, c11, fy), fz);
+    }
+
+    r[i] = out[0];
+    g[i] = out[1];
+    b[i] = out[2];
+  }
+}
+
+// BT.601 full range coefficients in Q14
+static const int32_t kYr = 4899, kYg = 9617, kYb = 1868;
+static const int32_t kCbr = -2765, kCbg = -5427, kCbb = 8192;
+static const int32_t kCrr = 8192, kCrg = -6860, kCrb = -1332;
+
+static void ConvertLumaRow(const uint8_t *src, uint32_t width, uint8_t *y) {
+  for (uint32_t i = 0; i < width; i++) {
+    const uint8_t *pixel = src + i * 4;
+    y[i] = UINT8((kYr * pixel[0] + kYg * pixel[1] + kYb * pixel[2] + (1 << 13)) >> 14);
+  }
+}
+
+void ConvertRowPairToNV12(const uint8_t *src0, const uint8_t *src1, uint32_t width, uint8_t *y0,
+                          uint8_t *y1, uint8_t *uv) {
+  ConvertLumaRow(src0, width, y0);
+  ConvertLumaRow(src1, width, y1);
+
+  // Sums of 2x2 blocks carry two extra bits, so chroma is rounded from Q16
+  const int32_t kChromaOffset = (128 << 16) + (1 << 15);
+  for (uint32_t i = 0; i < width / 2; i++) {
+    const uint8_t *p0 = src0 + i * 8;
+    const uint8_t *p1 = src1 + i * 8;
+    int32_t r = p0[0] + p0[4] + p1[0] + p1[4];
+    int32_t g = p0[1] + p0[5] + p1[1] + p1[5];
+    int32_t b = p0[2] + p0[6] + p1[2] + p1[6];
+    int32_t cb = (kCbr * r + kCbg * g + kCbb * b + kChromaOffset) >> 16;
+    int32_t cr = (kCrr * r + kCrg * g + kCrb * b + kChromaOffset) >> 16;
+    uv[i * 2] = UINT8(std::min(cb, 255));
+    uv[i * 2 + 1] = UINT8(std::min(cr, 255));
+  }
+}
+
+}  // namespace sdm
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __CPU_IMAGE_OPS_H__
+#define __CPU_IMAGE_OPS_H__
+
+#include <color_metadata.h>
+#include <stdint.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pixel kernels of the CPU colour backend. Rows are processed as planes of normalized floats or
+// as fixed point integers in plain loops, which the compiler vectorizes with NEON or SSE.
+
+namespace sdm {
+
+enum CPUPixelLayout {
+  kCPUPixelRGBA8888,     // Bytes in R, G, B, A order
+  kCPUPixelRGBX8888,
+  kCPUPixelRGBA1010102,  // 32 bit words, R in the low bits
+  kCPUPixelRGBX1010102,
+};
+
+// Runs the bands of a frame on a few worker threads, the calling thread processes bands as well.
+// Callers from different threads are serialized.
+class CPUWorkerPool {
+ public:
+  static CPUWorkerPool *GetInstance();
+
+  // Splits [0, count) into bands and calls fn(begin, end) for each of them.
+  void ParallelFor(uint32_t count, const std::function<void(uint32_t, uint32_t)> &fn);
+
+ private:
+  static constexpr uint32_t kMaxThreads = 4;
+
+  explicit CPUWorkerPool(uint32_t num_threads);
+  ~CPUWorkerPool();
+  void WorkerThread();
+  bool RunBand(std::unique_lock<std::mutex> *lock);
+
+  std::mutex call_lock_;
+  std::mutex lock_;
+  std::condition_variable job_cv_;
+  std::condition_variable done_cv_;
+  std::vector<std::thread> workers_;
+  const std::function<void(uint32_t, uint32_t)> *job_ = nullptr;
+  uint32_t job_count_ = 0;
+  uint32_t num_bands_ = 0;
+  uint32_t next_band_ = 0;
+  uint32_t done_bands_ = 0;
+  uint64_t generation_ = 0;
+  bool exit_ = false;
+};
+
+// Buffer of a gralloc handle mapped for CPU access, with the dma-buf cache maintenance around it.
+class CPUMappedBuffer {
+ public:
+  ~CPUMappedBuffer();
+  bool Map(int fd, uint32_t size, bool write);
+  uint8_t *Base() { return base_; }
+
+ private:
+  void SyncAccess(bool end);
+
+  int fd_ = -1;
+  uint32_t size_ = 0;
+  bool write_ = false;
+  uint8_t *base_ = nullptr;
+};
+
+// Unpacks count pixels into normalized r, g, b, a planes. When src_x is set, output pixel i reads
+// source column src_x[i], which implements nearest neighbour scaling.
+void UnpackRow(CPUPixelLayout layout, const uint8_t *src, const uint32_t *src_x, uint32_t count,
+               float *r, float *g, float *b, float *a);
+void PackRow(CPUPixelLayout layout, const float *r, const float *g, const float *b,
+             const float *a, uint32_t count, uint8_t *dst);
+
+// Maps source columns for nearest neighbour scaling of src_width pixels into dst_width pixels.
+void GetScaleMap(uint32_t src_width, uint32_t dst_width, std::vector<uint32_t> *src_x);
+
+// Software version of the GPU tonemapper textures: an optional per channel 1D LUT followed by a
+// trilinearly sampled 3D LUT. Both tables sample at c * (size - 1) and clamp at the edges.
+class CPULut3d {
+ public:
+  bool Init(const Color10Bit *lut_entries, uint32_t dim, const Color10Bit *xform_entries,
+            uint32_t xform_size);
+  // Maps count pixels in place.
+  void Map(float *r, float *g, float *b, uint32_t count) const;
+
+ private:
+  void ApplyXform(float *c, uint32_t count, uint32_t channel) const;
+
+  uint32_t dim_ = 0;
+  uint32_t xform_size_ = 0;
+  // Entries are padded to four floats, red index varies fastest
+  std::vector<float> lut_;
+  std::vector<float> xform_;
+};
+
+// Full range BT.601 conversion of two RGBA8888 rows into two luma rows and one row of interleaved
+// CbCr, each chroma sample is the average of a 2x2 block. width must be even.
+void ConvertRowPairToNV12(const uint8_t *src0, const uint8_t *src1, uint32_t width, uint8_t *y0,
+                          uint8_t *y1, uint8_t *uv);
+
+}  // namespace sdm
+
+#endif  // __CPU_IMAGE_OPS_H__
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <QtiGralloc.h>
+#include <errno.h>
+#include <utils/constants.h>
+#include <utils/debug.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "cpu_tonemapper.h"
+
+#define __CLASS__ "CPUToneMapper"
+
+namespace sdm {
+
+static bool GetPixelLayout(const private_handle_t *hnd, CPUPixelLayout *layout) {
+  if (hnd->flags & (private_handle_t::PRIV_FLAGS_UBWC_ALIGNED |
+                    private_handle_t::PRIV_FLAGS_SECURE_BUFFER)) {
+    return false;
+  }
+
+  switch (hnd->format) {
+    case HAL_PIXEL_FORMAT_RGBA_8888:
+      *layout = kCPUPixelRGBA8888;
+      return true;
+    case HAL_PIXEL_FORMAT_RGBX_8888:
+      *layout = kCPUPixelRGBX8888;
+      return true;
+    case HAL_PIXEL_FORMAT_RGBA_1010102:
+      *layout = kCPUPixelRGBA1010102;
+      return true;
+    case HAL_PIXEL_FORMAT_RGBX_1010102:
+      *layout = kCPUPixelRGBX1010102;
+      return true;
+    default:
+      return false;
+  }
+}
+
+CPUToneMapper *CPUToneMapper::Create(bool inverse, const Color10Bit *lut_entries, uint32_t dim,
+                                     const Color10Bit *xform_entries, uint32_t xform_size) {
+  CPUToneMapper *tone_mapper = new CPUToneMapper(inverse);
+  if (!tone_mapper->lut_.Init(lut_entries, dim, xform_entries, xform_size)) {
+    delete tone_mapper;
+    return nullptr;
+  }
+
+  return tone_mapper;
+}
+
+bool CPUToneMapper::IsFormatSupported(LayerBufferFormat format) {
+  return (format == kFormatRGBA8888 || format == kFormatRGBX8888 ||
+          format == kFormatRGBA1010102 || format == kFormatRGBX1010102);
+}
+
+int CPUToneMapper::Blit(const native_handle_t *dst_hnd, const native_handle_t *src_hnd,
+                        const shared_ptr<Fence> &acquire_fence) {
+  DTRACE_SCOPED();
+  const private_handle_t *src = static_cast<const private_handle_t *>(src_hnd);
+  const private_handle_t *dst = static_cast<const private_handle_t *>(dst_hnd);
+  CPUPixelLayout src_layout = kCPUPixelRGBA8888;
+  CPUPixelLayout dst_layout = kCPUPixelRGBA8888;
+  if (!GetPixelLayout(src, &src_layout) || !GetPixelLayout(dst, &dst_layout)) {
+    DLOGE("Unsupported buffers, src format %d flags 0x%x, dst format %d flags 0x%x", src->format,
+          src->flags, dst->format, dst->flags);
+    return -1;
+  }
+
+  if (Fence::Wait(acquire_fence) != kErrorNone) {
+    DLOGW("Wait on acquire fence failed, errno = %d", errno);
+    return -1;
+  }
+
+  CPUMappedBuffer src_buffer, dst_buffer;
+  if (!src_buffer.Map(src->fd, src->size, false) || !dst_buffer.Map(dst->fd, dst->size, true)) {
+    return -1;
+  }
+
+  uint32_t src_width = UINT32(src->unaligned_width);
+  uint32_t src_height = UINT32(src->unaligned_height);
+  uint32_t dst_width = UINT32(dst->unaligned_width);
+  uint32_t dst_height = UINT32(dst->unaligned_height);
+  uint32_t src_stride = UINT32(src->width) * 4;
+  uint32_t dst_stride = UINT32(dst->width) * 4;
+  const uint8_t *src_base = src_buffer.Base();
+  uint8_t *dst_base = dst_buffer.Base();
+
+  std::vector<uint32_t> src_x;
+  if (src_width != dst_width) {
+    GetScaleMap(src_width, dst_width, &src_x);
+  }
+  std::vector<uint32_t> src_y;
+  GetScaleMap(src_height, dst_height, &src_y);
+  const uint32_t *src_map = src_x.empty() ? nullptr : src_x.data();
+
+  CPUWorkerPool::GetInstance()->ParallelFor(dst_height, [&](uint32_t begin, uint32_t end) {
+    std::vector<float> planes(dst_width * 4);
+    float *r = planes.data();
+    float *g = r + dst_width;
+    float *b = g + dst_width;
+    float *a = b + dst_width;
+
+    for (uint32_t y = begin; y < end; y++) {
+      UnpackRow(src_layout, src_base + src_y[y] * src_stride, src_map, dst_width, r, g, b, a);
+
+      if (inverse_) {
+        // Source is premultiplied, the LUT applies to straight colour
+        for (uint32_t i = 0; i < dst_width; i++) {
+          float scale = (a[i] > 0.0f) ? (1.0f / a[i]) : 0.0f;
+          r[i] *= scale;
+          g[i] *= scale;
+          b[i] *= scale;
+        }
+      }
+
+      lut_.Map(r, g, b, dst_width);
+
+      if (inverse_) {
+        for (uint32_t i = 0; i < dst_width; i++) {
+          r[i] *= a[i];
+          g[i] *= a[i];
+          b[i] *= a[i];
+        }
+      } else {
+        std::fill(a, a + dst_width, 1.0f);
+      }
+
+      PackRow(dst_layout, r, g, b, a, dst_width, dst_base + y * dst_stride);
+    }
+  });
+
+  return 0;
+}
+
+}  // namespace sdm
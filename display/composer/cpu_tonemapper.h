@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __CPU_TONEMAPPER_H__
+#define __CPU_TONEMAPPER_H__
+
+#include <core/layer_buffer.h>
+#include <cutils/native_handle.h>
+#include <utils/fence.h>
+
+#include "cpu_image_ops.h"
+
+namespace sdm {
+
+// CPU counterpart of the GPU Tonemapper, used when GLES is not available or not wanted. Handles
+// linear RGBA8888 and RGBA1010102 buffers, with nearest neighbour scaling when the source and
+// destination sizes differ.
+class CPUToneMapper {
+ public:
+  // inverse maps SDR to HDR on premultiplied pixels, forward maps HDR to SDR and drops alpha.
+  static CPUToneMapper *Create(bool inverse, const Color10Bit *lut_entries, uint32_t dim,
+                               const Color10Bit *xform_entries, uint32_t xform_size);
+  static bool IsFormatSupported(LayerBufferFormat format);
+
+  // Waits for acquire_fence and tone maps src into dst before returning, so dst needs no fence.
+  int Blit(const native_handle_t *dst_hnd, const native_handle_t *src_hnd,
+           const shared_ptr<Fence> &acquire_fence);
+
+ private:
+  explicit CPUToneMapper(bool inverse) : inverse_(inverse) { }
+
+  bool inverse_ = false;
+  CPULut3d lut_;
+};
+
+}  // namespace sdm
+
+#endif  // __CPU_TONEMAPPER_H__
@@ -27,14 +27,39 @@
  * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "cpu_color_convert_impl.h"
 #include "gl_color_convert_impl.h"
 #include "gl_color_convert.h"
+#include "hwc_debugger.h"
 
 #define __CLASS__ "GLColorConvert"
 
 namespace sdm {
 
+static GLColorConvert* GetCPUInstance(GLRenderTarget target, bool secure) {
+  // Secure buffers can not be mapped for CPU access.
+  if (secure) {
+    return nullptr;
+  }
+
+  CPUColorConvertImpl* color_convert = new CPUColorConvertImpl(target);
+  if (color_convert->Init() != 0) {
+    GLColorConvert::Destroy(color_convert);
+    return nullptr;
+  }
+
+  DLOGI("Created CPU instance successfully");
+
+  return color_convert;
+}
+
 GLColorConvert* GLColorConvert::GetInstance(GLRenderTarget target, bool secure) {
+  int value = 0;
+  HWCDebugHandler::Get()->GetProperty(ENABLE_CPU_COLOR_BACKEND_PROP, &value);
+  if (value == 1) {
+    return GetCPUInstance(target, secure);
+  }
+
   GLColorConvertImpl* color_convert = new GLColorConvertImpl(target, secure);
   if (color_convert == nullptr) {
     DLOGE("Failed to create color convert instance for %d target %d secure", target, secure);
@@ -43,9 +68,9 @@ GLColorConvert* GLColorConvert::GetInstance(GLRenderTarget target, bool secure)
 
   int status = color_convert->Init();
   if (status != 0) {
-    DLOGE("Failed to initialize GL Color convert instance %d", status);
+    DLOGE("Failed to initialize GL Color convert instance %d, trying CPU backend", status);
     delete color_convert;
-    return nullptr;
+    return GetCPUInstance(target, secure);
   }
 
   DLOGI("Created instance successfully");
@@ -54,12 +79,11 @@ GLColorConvert* GLColorConvert::GetInstance(GLRenderTarget target, bool secure)
 }
 
 void GLColorConvert::Destroy(GLColorConvert* intf) {
-  GLColorConvertImpl* color_convert = static_cast<GLColorConvertImpl*>(intf);
-  if (color_convert->Deinit() != 0) {
+  if (intf->Deinit() != 0) {
     DLOGE("De Init failed");
   }
 
-  delete color_convert;
+  delete intf;
 }
 
 }  // namespace sdm
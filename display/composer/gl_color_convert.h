@@ -58,6 +58,7 @@ class GLColorConvert {
                    shared_ptr<Fence> *release_fence) = 0;
   virtual void Reset() = 0;
  protected:
+  virtual int Deinit() = 0;
   virtual ~GLColorConvert() { }
 };
 
@@ -1794,6 +1794,9 @@ HWC2::Error HWCDisplay::PostCommitLayerStack(shared_ptr<Fence> *out_retire_fence
   if (dump_frame_count_) {
     dump_frame_count_--;
     dump_frame_index_++;
+    if (!dump_frame_count_) {
+      frame_dump_writer_.Trim();
+    }
   }
 
   layer_stack_.flags.geometry_changed = false;
@@ -1828,7 +1831,6 @@ DisplayError HWCDisplay::SetMaxMixerStages(uint32_t max_mixer_stages) {
 
 void HWCDisplay::DumpInputBuffers() {
   char dir_path[PATH_MAX];
-  int  status;
 
   if (!dump_frame_count_ || flush_ || !dump_input_layers_) {
     return;
@@ -1838,23 +1840,11 @@ void HWCDisplay::DumpInputBuffers() {
   snprintf(dir_path, sizeof(dir_path), "%s/frame_dump_disp_id_%02u_%s", HWCDebugHandler::DumpDir(),
            UINT32(id_), GetDisplayString());
 
-  status = mkdir(dir_path, 777);
-  if ((status != 0) && errno != EEXIST) {
-    DLOGW("Failed to create %s directory errno = %d, desc = %s", dir_path, errno, strerror(errno));
-    return;
-  }
-
-  // Even if directory exists already, need to explicitly change the permission.
-  if (chmod(dir_path, 0777) != 0) {
-    DLOGW("Failed to change permissions on %s directory", dir_path);
-    return;
-  }
-
+  // Fence waits, copies and file writes happen on the frame dump writer thread
   for (uint32_t i = 0; i < layer_stack_.layers.size(); i++) {
     auto layer = layer_stack_.layers.at(i);
     const native_handle_t *handle =
         reinterpret_cast<const native_handle_t *>(layer->input_buffer.buffer_id);
-    Fence::Wait(layer->input_buffer.acquire_fence);
 
     DLOGI("Dump layer[%d] of %lu handle %p", i, layer_stack_.layers.size(), handle);
 
@@ -1863,16 +1853,12 @@ void HWCDisplay::DumpInputBuffers() {
       continue;
     }
 
-    void *base_ptr = NULL;
-    int error = buffer_allocator_->MapBuffer(handle, nullptr, base_ptr);
-    if (error != kErrorNone) {
-      DLOGE("Failed to map buffer, error = %d", error);
+    if (layer->input_buffer.flags.secure) {
+      DLOGI("Skip dump of secure layer[%d]", i);
       continue;
     }
 
     char dump_file_name[PATH_MAX];
-    size_t result = 0;
-
     uint32_t width = 0, height = 0, alloc_size = 0;
     int32_t format = 0;
 
@@ -1885,67 +1871,25 @@ void HWCDisplay::DumpInputBuffers() {
              dir_path, i, width, height, qdutils::GetHALPixelFormatString(format),
              dump_frame_index_);
 
-    if (base_ptr != nullptr) {
-      FILE *fp = fopen(dump_file_name, "w+");
-      if (fp) {
-        result = fwrite(base_ptr, alloc_size, 1, fp);
-        fclose(fp);
-      }
-    }
-
-    int release_fence = -1;
-    error = buffer_allocator_->UnmapBuffer(handle, &release_fence);
-    if (error != kErrorNone) {
-      DLOGE("Failed to unmap buffer, error = %d", error);
-      continue;
-    }
-
-    DLOGI("Frame Dump %s: is %s", dump_file_name, result ? "Successful" : "Failed");
+    frame_dump_writer_.Queue(layer->input_buffer.planes[0].fd, alloc_size,
+                             layer->input_buffer.acquire_fence, dir_path, dump_file_name);
   }
 }
 
-void HWCDisplay::DumpOutputBuffer(const BufferInfo &buffer_info, void *base,
-                                  shared_ptr<Fence> &retire_fence) {
+void HWCDisplay::DumpOutputBuffer(const BufferInfo &buffer_info, int fd,
+                                  const shared_ptr<Fence> &fence) {
   char dir_path[PATH_MAX];
-  int  status;
+  char dump_file_name[PATH_MAX];
 
   snprintf(dir_path, sizeof(dir_path), "%s/frame_dump_disp_id_%02u_%s", HWCDebugHandler::DumpDir(),
            UINT32(id_), GetDisplayString());
+  snprintf(dump_file_name, sizeof(dump_file_name), "%s/output_layer_%dx%d_%s_frame%d.raw",
+           dir_path, buffer_info.alloc_buffer_info.aligned_width,
+           buffer_info.alloc_buffer_info.aligned_height,
+           GetFormatString(buffer_info.buffer_config.format), dump_frame_index_);
 
-  status = mkdir(dir_path, 777);
-  if ((status != 0) && errno != EEXIST) {
-    DLOGW("Failed to create %s directory errno = %d, desc = %s", dir_path, errno, strerror(errno));
-    return;
-  }
-
-  // Even if directory exists already, need to explicitly change the permission.
-  if (chmod(dir_path, 0777) != 0) {
-    DLOGW("Failed to change permissions on %s directory", dir_path);
-    return;
-  }
-
-  if (base) {
-    char dump_file_name[PATH_MAX];
-    size_t result = 0;
-
-    if (Fence::Wait(retire_fence) != kErrorNone) {
-      DLOGW("sync_wait error errno = %d, desc = %s", errno, strerror(errno));
-      return;
-    }
-
-    snprintf(dump_file_name, sizeof(dump_file_name), "%s/output_layer_%dx%d_%s_frame%d.raw",
-             dir_path, buffer_info.alloc_buffer_info.aligned_width,
-             buffer_info.alloc_buffer_info.aligned_height,
-             GetFormatString(buffer_info.buffer_config.format), dump_frame_index_);
-
-    FILE *fp = fopen(dump_file_name, "w+");
-    if (fp) {
-      result = fwrite(base, buffer_info.alloc_buffer_info.size, 1, fp);
-      fclose(fp);
-    }
-
-    DLOGI("Frame Dump of %s is %s", dump_file_name, result ? "Successful" : "Failed");
-  }
+  frame_dump_writer_.Queue(fd, buffer_info.alloc_buffer_info.size, fence, dir_path,
+                           dump_file_name);
 }
 
 const char *HWCDisplay::GetDisplayString() {
@@ -2415,6 +2359,8 @@ void HWCDisplay::Dump(std::ostringstream *os) {
         << std::endl;
   }
 
+  frame_dump_writer_.Dump(os);
+
   if (layer_stack_invalid_) {
     *os << "\n Layers added or removed but not reflected to SDM's layer stack yet\n";
     return;
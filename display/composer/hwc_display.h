@@ -75,6 +75,7 @@
 #include "hwc_buffer_allocator.h"
 #include "hwc_callbacks.h"
 #include "hwc_display_event_handler.h"
+#include "hwc_frame_dump_writer.h"
 #include "hwc_layers.h"
 #include "hwc_buffer_sync_handler.h"
 
@@ -490,8 +491,8 @@ class HWCDisplay : public DisplayEventHandler {
   virtual DisplayError CECMessage(char *message);
   virtual DisplayError HistogramEvent(int source_fd, uint32_t blob_id);
   virtual DisplayError HandleEvent(DisplayEvent event);
-  virtual void DumpOutputBuffer(const BufferInfo &buffer_info, void *base,
-                                shared_ptr<Fence> &retire_fence);
+  virtual void DumpOutputBuffer(const BufferInfo &buffer_info, int fd,
+                                const shared_ptr<Fence> &fence);
   virtual HWC2::Error PrepareLayerStack(uint32_t *out_num_types, uint32_t *out_num_requests);
   virtual HWC2::Error CommitLayerStack(void);
   virtual HWC2::Error PostCommitLayerStack(shared_ptr<Fence> *out_retire_fence);
@@ -549,6 +550,7 @@ class HWCDisplay : public DisplayEventHandler {
   uint32_t dump_frame_count_ = 0;
   uint32_t dump_frame_index_ = 0;
   bool dump_input_layers_ = false;
+  HWCFrameDumpWriter frame_dump_writer_;
   HWC2::PowerMode current_power_mode_ = HWC2::PowerMode::Off;
   HWC2::PowerMode pending_power_mode_ = HWC2::PowerMode::Off;
   bool swap_interval_zero_ = false;
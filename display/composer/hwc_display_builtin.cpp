@@ -959,23 +959,14 @@ void HWCDisplayBuiltIn::HandleFrameCapture() {
 
 void HWCDisplayBuiltIn::HandleFrameDump() {
   if (dump_frame_count_) {
-    int ret = 0;
-    ret = Fence::Wait(output_buffer_.release_fence);
-    if (ret != kErrorNone) {
-      DLOGE("sync_wait error errno = %d, desc = %s", errno, strerror(errno));
-    }
-
-    if (!ret) {
-      DumpOutputBuffer(output_buffer_info_, output_buffer_base_, layer_stack_.retire_fence);
-      validated_ = false;
-    }
+    // The frame dump writer waits for readback and retire before copying the output buffer
+    shared_ptr<Fence> fence = Fence::Merge(output_buffer_.release_fence, layer_stack_.retire_fence);
+    DumpOutputBuffer(output_buffer_info_, output_buffer_info_.alloc_buffer_info.fd, fence);
+    validated_ = false;
 
     if (0 == (dump_frame_count_ - 1)) {
       dump_output_to_file_ = false;
-      // Unmap and Free buffer
-      if (munmap(output_buffer_base_, output_buffer_info_.alloc_buffer_info.size) != 0) {
-        DLOGE("unmap failed with err %d", errno);
-      }
+      // Free buffer, the frame dump writer holds its own reference until the dump is copied
       if (buffer_allocator_->FreeBuffer(&output_buffer_info_) != 0) {
         DLOGE("FreeBuffer failed");
       }
@@ -986,7 +977,6 @@ void HWCDisplayBuiltIn::HandleFrameDump() {
 
       output_buffer_ = {};
       output_buffer_info_ = {};
-      output_buffer_base_ = nullptr;
       cwb_client_ = kCWBClientNone;
     }
   }
@@ -1028,17 +1018,6 @@ HWC2::Error HWCDisplayBuiltIn::SetFrameDumpConfig(uint32_t count, uint32_t bit_m
     return HWC2::Error::NoResources;
   }
 
-  void *buffer = mmap(NULL, output_buffer_info_.alloc_buffer_info.size, PROT_READ | PROT_WRITE,
-                      MAP_SHARED, output_buffer_info_.alloc_buffer_info.fd, 0);
-
-  if (buffer == MAP_FAILED) {
-    DLOGE("mmap failed with err %d", errno);
-    buffer_allocator_->FreeBuffer(&output_buffer_info_);
-    output_buffer_info_ = {};
-    return HWC2::Error::NoResources;
-  }
-
-  output_buffer_base_ = buffer;
   const native_handle_t *handle = static_cast<native_handle_t *>(output_buffer_info_.private_data);
   SetReadbackBuffer(handle, nullptr, post_processed, kCWBClientFrameDump);
 
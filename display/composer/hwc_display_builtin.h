@@ -234,7 +234,6 @@ class HWCDisplayBuiltIn : public HWCDisplay, public SyncTask<LayerStitchTaskCode
   // Members for N frame output dump to file
   bool dump_output_to_file_ = false;
   BufferInfo output_buffer_info_ = {};
-  void *output_buffer_base_ = nullptr;
   bool pending_refresh_ = true;
   bool enable_optimize_refresh_ = false;
 
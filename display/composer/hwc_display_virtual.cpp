@@ -82,10 +82,10 @@ HWC2::Error HWCDisplayVirtual::DumpVDSBuffer() {
       BufferInfo buffer_info;
       const native_handle_t *output_handle =
           reinterpret_cast<const native_handle_t *>(output_buffer_.buffer_id);
-      void *base_ptr = NULL;
-      int error = buffer_allocator_->MapBuffer(output_handle, nullptr, base_ptr);
-      if (error != 0) {
-        DLOGE("Failed to map output buffer, error = %d", error);
+      int fd = -1;
+      buffer_allocator_->GetFd((void *)output_handle, fd);
+      if (fd < 0) {
+        DLOGE("Invalid output buffer fd");
         return HWC2::Error::BadParameter;
       }
       uint32_t width, height, alloc_size = 0;
@@ -100,14 +100,7 @@ HWC2::Error HWCDisplayVirtual::DumpVDSBuffer() {
       buffer_info.buffer_config.height = height;
       buffer_info.buffer_config.format = HWCLayer::GetSDMFormat(format, flags);
       buffer_info.alloc_buffer_info.size = alloc_size;
-      DumpOutputBuffer(buffer_info, base_ptr, layer_stack_.retire_fence);
-
-      int release_fence = -1;
-      error = buffer_allocator_->UnmapBuffer(output_handle, &release_fence);
-      if (error != kErrorNone) {
-        DLOGE("Failed to unmap buffer, error = %d", error);
-        return HWC2::Error::BadParameter;
-      }
+      DumpOutputBuffer(buffer_info, fd, layer_stack_.retire_fence);
     }
   }
 
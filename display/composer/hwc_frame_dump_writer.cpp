@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utils/debug.h>
+
+#include <cinttypes>
+
+#include "hwc_frame_dump_writer.h"
+
+#define __CLASS__ "HWCFrameDumpWriter"
+
+namespace sdm {
+
+HWCFrameDumpWriter::~HWCFrameDumpWriter() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    exit_ = true;
+  }
+  cv_.notify_one();
+  if (writer_thread_.joinable()) {
+    writer_thread_.join();
+  }
+
+  for (auto &slot : slots_) {
+    if (slot.fd >= 0) {
+      close(slot.fd);
+    }
+  }
+}
+
+bool HWCFrameDumpWriter::Queue(int fd, uint32_t size, const shared_ptr<Fence> &fence,
+                               const std::string &dir_path, const std::string &file_path) {
+  if (fd < 0 || !size) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(lock_);
+  Slot *slot = GetOldestSlot(kSlotFree);
+  if (!slot) {
+    dropped_count_++;
+    DLOGW("Writer is behind, dropped %s (%" PRIu64 " dropped)", file_path.c_str(),
+          dropped_count_);
+    return false;
+  }
+
+  slot->fd = dup(fd);
+  if (slot->fd < 0) {
+    DLOGE("Failed to dup fd %d, errno = %d", fd, errno);
+    failed_count_++;
+    return false;
+  }
+
+  slot->state = kSlotPending;
+  slot->sequence = next_sequence_++;
+  slot->size = size;
+  slot->fence = fence;
+  slot->dir_path = dir_path;
+  slot->file_path = file_path;
+  queued_count_++;
+  trim_ = false;
+
+  if (!writer_thread_.joinable()) {
+    writer_thread_ = std::thread(&HWCFrameDumpWriter::WriterThread, this);
+  }
+  cv_.notify_one();
+
+  return true;
+}
+
+void HWCFrameDumpWriter::Trim() {
+  std::lock_guard<std::mutex> lock(lock_);
+  trim_ = true;
+  for (auto &slot : slots_) {
+    if (slot.state == kSlotFree) {
+      std::vector<uint8_t>().swap(slot.staging);
+    }
+  }
+}
+
+void HWCFrameDumpWriter::Dump(std::ostringstream *os) {
+  std::lock_guard<std::mutex> lock(lock_);
+  *os << "Frame dump writer: queued " << queued_count_ << ", written " << written_count_;
+  *os << ", dropped " << dropped_count_ << ", failed " << failed_count_ << std::endl;
+}
+
+HWCFrameDumpWriter::Slot *HWCFrameDumpWriter::GetOldestSlot(SlotState state) {
+  Slot *oldest = nullptr;
+  for (auto &slot : slots_) {
+    if (slot.state == state && (!oldest || slot.sequence < oldest->sequence)) {
+      oldest = &slot;
+    }
+  }
+
+  return oldest;
+}
+
+void HWCFrameDumpWriter::WriterThread() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true) {
+    cv_.wait(lock, [this] {
+      return exit_ || GetOldestSlot(kSlotPending) || GetOldestSlot(kSlotCopied);
+    });
+    if (exit_) {
+      break;
+    }
+
+    // Copies go first, the source buffer can be reused by its producer once it is released
+    Slot *slot = GetOldestSlot(kSlotPending);
+    bool copy = (slot != nullptr);
+    if (!copy) {
+      slot = GetOldestSlot(kSlotCopied);
+    }
+    slot->state = kSlotBusy;
+
+    lock.unlock();
+    bool success = copy ? CopyToStaging(slot) : WriteToFile(slot);
+    lock.lock();
+
+    if (!success) {
+      failed_count_++;
+    } else if (!copy) {
+      written_count_++;
+    }
+
+    slot->state = (copy && success) ? kSlotCopied : kSlotFree;
+    if (slot->state == kSlotFree && trim_) {
+      std::vector<uint8_t>().swap(slot->staging);
+    }
+  }
+}
+
+bool HWCFrameDumpWriter::CopyToStaging(Slot *slot) {
+  bool success = false;
+  if (Fence::Wait(slot->fence) != kErrorNone) {
+    DLOGW("sync_wait error errno = %d, desc = %s", errno, strerror(errno));
+  } else {
+    void *base = mmap(NULL, slot->size, PROT_READ, MAP_SHARED, slot->fd, 0);
+    if (base == MAP_FAILED) {
+      DLOGE("mmap failed for %s, errno = %d", slot->file_path.c_str(), errno);
+    } else {
+      // Keeps its capacity across frames, so steady state dumps do not allocate
+      slot->staging.resize(slot->size);
+      memcpy(slot->staging.data(), base, slot->size);
+      munmap(base, slot->size);
+      success = true;
+    }
+  }
+
+  close(slot->fd);
+  slot->fd = -1;
+  slot->fence = nullptr;
+
+  return success;
+}
+
+bool HWCFrameDumpWriter::WriteToFile(Slot *slot) {
+  int status = mkdir(slot->dir_path.c_str(), 777);
+  if ((status != 0) && errno != EEXIST) {
+    DLOGW("Failed to create %s directory errno = %d, desc = %s", slot->dir_path.c_str(), errno,
+          strerror(errno));
+    return false;
+  }
+
+  // Even if directory exists already, need to explicitly change the permission.
+  if (chmod(slot->dir_path.c_str(), 0777) != 0) {
+    DLOGW("Failed to change permissions on %s directory", slot->dir_path.c_str());
+    return false;
+  }
+
+  size_t result = 0;
+  FILE *fp = fopen(slot->file_path.c_str(), "w+");
+  if (fp) {
+    result = fwrite(slot->staging.data(), slot->staging.size(), 1, fp);
+    fclose(fp);
+  }
+
+  DLOGI("Frame Dump %s: is %s", slot->file_path.c_str(), result ? "Successful" : "Failed");
+
+  return result != 0;
+}
+
+}  // namespace sdm
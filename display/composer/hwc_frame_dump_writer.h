@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __HWC_FRAME_DUMP_WRITER_H__
+#define __HWC_FRAME_DUMP_WRITER_H__
+
+#include <utils/fence.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sdm {
+
+// Writes frame dumps from a background thread so that waiting on fences, copying buffers and
+// file I/O stay off the composition thread. Each queued dump holds its own dma-buf fd and fence
+// reference. Once the fence signals the buffer is copied into one of a fixed ring of staging
+// buffers and written to disk later. Copies run ahead of writes, so a source buffer is read as
+// soon as possible after its fence signals. Dumps queued while every slot is busy are dropped
+// and counted instead of stalling the caller.
+class HWCFrameDumpWriter {
+ public:
+  ~HWCFrameDumpWriter();
+
+  // fd is duplicated, ownership stays with the caller. Returns false if the dump was dropped.
+  bool Queue(int fd, uint32_t size, const shared_ptr<Fence> &fence, const std::string &dir_path,
+             const std::string &file_path);
+  // Releases staging memory once the queued dumps are written.
+  void Trim();
+  void Dump(std::ostringstream *os);
+
+ private:
+  enum SlotState {
+    kSlotFree,
+    kSlotPending,  // Waiting for the fence and the copy into staging
+    kSlotCopied,   // Staging holds the frame, waiting to be written
+    kSlotBusy,     // Owned by the writer thread
+  };
+
+  struct Slot {
+    SlotState state = kSlotFree;
+    uint64_t sequence = 0;
+    int fd = -1;
+    uint32_t size = 0;
+    shared_ptr<Fence> fence = nullptr;
+    std::string dir_path;
+    std::string file_path;
+    std::vector<uint8_t> staging;
+  };
+
+  static const uint32_t kNumSlots = 8;
+
+  void WriterThread();
+  Slot *GetOldestSlot(SlotState state);
+  bool CopyToStaging(Slot *slot);
+  bool WriteToFile(Slot *slot);
+
+  std::mutex lock_;
+  std::condition_variable cv_;
+  std::thread writer_thread_;
+  bool exit_ = false;
+  bool trim_ = false;
+  uint64_t next_sequence_ = 0;
+  Slot slots_[kNumSlots];
+  uint64_t queued_count_ = 0;
+  uint64_t dropped_count_ = 0;
+  uint64_t failed_count_ = 0;
+  uint64_t written_count_ = 0;
+};
+
+}  // namespace sdm
+
+#endif  // __HWC_FRAME_DUMP_WRITER_H__
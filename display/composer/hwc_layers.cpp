@@ -326,18 +326,17 @@ HWC2::Error HWCLayer::SetLayerBuffer(buffer_handle_t buffer, shared_ptr<Fence> a
 
   const native_handle_t *handle = static_cast<const native_handle_t *>(buffer);
 
-  int fd = -1;
-  buffer_allocator_->GetFd(const_cast<native_handle_t *>(handle), fd);
-  if (fd < 0) {
+  const BufferInfoSnapshot *info = GetBufferInfoSnapshot(handle);
+  if (!info) {
     return HWC2::Error::BadParameter;
   }
 
   LayerBuffer *layer_buffer = &layer_->input_buffer;
+  // Custom dimensions follow the crop and interlace metadata, so they are queried every frame
   int aligned_width, aligned_height;
   buffer_allocator_->GetCustomWidthAndHeight(handle, &aligned_width, &aligned_height);
 
-  LayerBufferFormat format;
-  buffer_allocator_->GetSDMFormat(const_cast<native_handle_t *>(handle), format);
+  LayerBufferFormat format = info->format;
   if ((format != layer_buffer->format) || (UINT32(aligned_width) != layer_buffer->width) ||
       (UINT32(aligned_height) != layer_buffer->height)) {
     // Layer buffer geometry has changed.
@@ -347,22 +346,16 @@ HWC2::Error HWCLayer::SetLayerBuffer(buffer_handle_t buffer, shared_ptr<Fence> a
   layer_buffer->format = format;
   layer_buffer->width = UINT32(aligned_width);
   layer_buffer->height = UINT32(aligned_height);
-  buffer_allocator_->GetUnalignedWidth(const_cast<native_handle_t *>(handle),
-                                       layer_buffer->unaligned_width);
-  buffer_allocator_->GetUnalignedHeight(const_cast<native_handle_t *>(handle),
-                                        layer_buffer->unaligned_height);
-
-  uint32_t buffer_type;
-  buffer_allocator_->GetBufferType(const_cast<native_handle_t *>(handle), buffer_type);
-  layer_buffer->flags.video = (buffer_type == BUFFER_TYPE_VIDEO) ? true : false;
+  layer_buffer->unaligned_width = info->unaligned_width;
+  layer_buffer->unaligned_height = info->unaligned_height;
+  layer_buffer->flags.video = (info->buffer_type == BUFFER_TYPE_VIDEO) ? true : false;
 
   if (SetMetaData(handle, layer_) != kErrorNone) {
     return HWC2::Error::BadLayer;
   }
 
   // TZ Protected Buffer - L1
-  int32_t flags;
-  buffer_allocator_->GetPrivateFlags(const_cast<native_handle_t *>(handle), flags);
+  int32_t flags = info->private_flags;
   secure_ = (flags & qtigralloc::PRIV_FLAGS_SECURE_BUFFER);
   bool secure_camera = secure_ && (flags & qtigralloc::PRIV_FLAGS_CAMERA_WRITE);
   bool secure_display = (flags & qtigralloc::PRIV_FLAGS_SECURE_DISPLAY);
@@ -380,19 +373,64 @@ HWC2::Error HWCLayer::SetLayerBuffer(buffer_handle_t buffer, shared_ptr<Fence> a
   if (buffer_fd_ >= 0) {
     ::close(buffer_fd_);
   }
-  buffer_fd_ = ::dup(fd);
+  buffer_fd_ = ::dup(info->fd);
   layer_buffer->planes[0].fd = buffer_fd_;
   layer_buffer->planes[0].offset = 0;
-  buffer_allocator_->GetWidth(const_cast<native_handle_t *>(handle),
-                              layer_buffer->planes[0].stride);
-  buffer_allocator_->GetAllocationSize(const_cast<native_handle_t *>(handle), layer_buffer->size);
+  layer_buffer->planes[0].stride = info->stride;
+  layer_buffer->size = info->size;
   buffer_flipped_ = reinterpret_cast<uint64_t>(handle) != layer_buffer->buffer_id;
   layer_buffer->buffer_id = reinterpret_cast<uint64_t>(handle);
-  buffer_allocator_->GetBufferId(const_cast<native_handle_t *>(handle), layer_buffer->handle_id);
+  layer_buffer->handle_id = info->handle_id;
 
   return HWC2::Error::None;
 }
 
+const BufferInfoSnapshot *HWCLayer::GetBufferInfoSnapshot(const native_handle_t *handle) {
+  // The gralloc buffer id is unique per allocation, but a freed handle address can be reused to
+  // import the same buffer again with a new fd. The fd is read from the handle every frame and is
+  // part of the key, so a snapshot never refers to a closed fd. Reading both from the handle
+  // avoids a mapper round trip, handles that are not gralloc private handles go through the
+  // mapper.
+  native_handle_t *hnd = const_cast<native_handle_t *>(handle);
+  uint64_t id = 0;
+  int fd = -1;
+  if (private_handle_t::validate(handle) == 0) {
+    const private_handle_t *pvt_handle = reinterpret_cast<const private_handle_t *>(handle);
+    id = pvt_handle->id;
+    fd = pvt_handle->fd;
+  } else if (buffer_allocator_->GetBufferId(hnd, id) != kErrorNone ||
+             buffer_allocator_->GetFd(hnd, fd) != kErrorNone) {
+    DLOGW("Invalid buffer handle: %p on layer: %d", handle, UINT32(id_));
+    return nullptr;
+  }
+  if (fd < 0) {
+    return nullptr;
+  }
+  for (auto &entry : buffer_info_cache_) {
+    if (entry.handle == handle && entry.id == id && entry.fd == fd) {
+      return &entry;
+    }
+  }
+
+  BufferInfoSnapshot info = {};
+  info.fd = fd;
+  buffer_allocator_->GetSDMFormat(hnd, info.format);
+  buffer_allocator_->GetUnalignedWidth(hnd, info.unaligned_width);
+  buffer_allocator_->GetUnalignedHeight(hnd, info.unaligned_height);
+  buffer_allocator_->GetBufferType(hnd, info.buffer_type);
+  buffer_allocator_->GetPrivateFlags(hnd, info.private_flags);
+  buffer_allocator_->GetWidth(hnd, info.stride);
+  buffer_allocator_->GetAllocationSize(hnd, info.size);
+  buffer_allocator_->GetBufferId(hnd, info.handle_id);
+  info.handle = handle;
+  info.id = id;
+
+  BufferInfoSnapshot &slot = buffer_info_cache_[buffer_info_next_slot_];
+  buffer_info_next_slot_ = (buffer_info_next_slot_ + 1) % kBufferInfoCacheSize;
+  slot = info;
+  return &slot;
+}
+
 HWC2::Error HWCLayer::SetLayerSurfaceDamage(hwc_region_t damage) {
   surface_updated_ = true;
   if ((damage.numRects == 1) && (damage.rects[0].bottom == 0) && (damage.rects[0].right == 0)) {
@@ -959,9 +997,18 @@ DisplayError HWCLayer::SetMetaData(const native_handle_t *pvt_handle, Layer *lay
   LayerBuffer *layer_buffer = &layer->input_buffer;
   native_handle_t *handle = const_cast<native_handle_t *>(pvt_handle);
 
+  // Fetch which vendor metadata is set in one mapper call instead of one per type
+  bool metadata_set[METADATA_SET_SIZE] = {};
+  if (static_cast<int>(qtigralloc::get(handle, QTI_VENDOR_METADATA_STATUS, &metadata_set)) != 0) {
+    DLOGW("Unable to get metadata state");
+  }
+  auto is_set = [&metadata_set](uint32_t type) {
+    return metadata_set[GET_VENDOR_METADATA_STATUS_INDEX(type)];
+  };
+
   float fps = 0;
   uint32_t frame_rate = layer->frame_rate;
-  if (qtigralloc::getMetadataState(handle, QTI_REFRESH_RATE)) {
+  if (is_set(QTI_REFRESH_RATE)) {
     if (static_cast<int>(qtigralloc::get(handle, QTI_REFRESH_RATE, &fps)) == 0) {
       frame_rate = (fps != 0) ? RoundToStandardFPS(fps) : layer->frame_rate;
       has_metadata_refresh_rate_ = true;
@@ -969,7 +1016,9 @@ DisplayError HWCLayer::SetMetaData(const native_handle_t *pvt_handle, Layer *lay
   }
 
   int32_t interlaced = 0;
-  qtigralloc::get(handle, QTI_PP_PARAM_INTERLACED, &interlaced);
+  if (is_set(QTI_PP_PARAM_INTERLACED)) {
+    qtigralloc::get(handle, QTI_PP_PARAM_INTERLACED, &interlaced);
+  }
   bool interlace = interlaced ? true : false;
 
   if (interlace != layer_buffer->flags.interlace) {
@@ -978,7 +1027,7 @@ DisplayError HWCLayer::SetMetaData(const native_handle_t *pvt_handle, Layer *lay
   }
 
   uint32_t linear_format = 0;
-  if (qtigralloc::getMetadataState(handle, QTI_LINEAR_FORMAT)) {
+  if (is_set(QTI_LINEAR_FORMAT)) {
     if (static_cast<int>(qtigralloc::get(handle, QTI_LINEAR_FORMAT, &linear_format)) == 0) {
       layer_buffer->format = GetSDMFormat(INT32(linear_format), 0);
     }
@@ -998,7 +1047,7 @@ DisplayError HWCLayer::SetMetaData(const native_handle_t *pvt_handle, Layer *lay
     layer_buffer->ubwc_crstats[i].clear();
   }
 
-  if (qtigralloc::getMetadataState(handle, QTI_UBWC_CR_STATS_INFO)) {
+  if (is_set(QTI_UBWC_CR_STATS_INFO)) {
     if (static_cast<int>(qtigralloc::get(handle, QTI_UBWC_CR_STATS_INFO, &cr_stats)) == 0) {
       // Only copy top layer for now as only top field for interlaced is used
       GetUBWCStatsFromMetaData(&cr_stats[0], &(layer_buffer->ubwc_crstats[0]));
@@ -1006,7 +1055,9 @@ DisplayError HWCLayer::SetMetaData(const native_handle_t *pvt_handle, Layer *lay
   }
 
   uint32_t single_buffer = 0;
-  qtigralloc::get(handle, QTI_SINGLE_BUFFER_MODE, &single_buffer);
+  if (is_set(QTI_SINGLE_BUFFER_MODE)) {
+    qtigralloc::get(handle, QTI_SINGLE_BUFFER_MODE, &single_buffer);
+  }
   single_buffer_ = (single_buffer == 1);
 
   // Handle colorMetaData / Dataspace handling now
@@ -86,6 +86,23 @@ enum LayerTypes {
   kLayerBrowser = 3,
 };
 
+// Buffer properties that stay fixed for the lifetime of a gralloc buffer. They are fetched
+// through the mapper once per buffer and reused while a layer cycles through its buffer queue.
+// Anything derived from per-frame metadata (crop, interlace, color etc.) is not part of it.
+struct BufferInfoSnapshot {
+  const native_handle_t *handle = nullptr;
+  uint64_t id = 0;
+  int fd = -1;
+  LayerBufferFormat format = kFormatInvalid;
+  uint32_t unaligned_width = 0;
+  uint32_t unaligned_height = 0;
+  uint32_t buffer_type = 0;
+  int32_t private_flags = 0;
+  uint32_t stride = 0;
+  uint32_t size = 0;
+  uint64_t handle_id = 0;
+};
+
 class HWCLayer {
  public:
   explicit HWCLayer(hwc2_display_t display_id, HWCBufferAllocator *buf_allocator);
@@ -164,6 +181,10 @@ class HWCLayer {
   bool color_transform_matrix_set_ = false;
   bool buffer_flipped_ = false;
   bool secure_ = false;
+  // Enough for a triple buffered queue plus one buffer in transition
+  static const uint32_t kBufferInfoCacheSize = 4;
+  BufferInfoSnapshot buffer_info_cache_[kBufferInfoCacheSize] = {};
+  uint32_t buffer_info_next_slot_ = 0;
 
   // Composition requested by client(SF)
   HWC2::Composition client_requested_ = HWC2::Composition::Device;
@@ -175,6 +196,7 @@ class HWCLayer {
   void SetRect(const hwc_frect_t &source, LayerRect *target);
   uint32_t GetUint32Color(const hwc_color_t &source);
   void GetUBWCStatsFromMetaData(UBWCStats *cr_stats, UbwcCrStatsVector *cr_vec);
+  const BufferInfoSnapshot *GetBufferInfoSnapshot(const native_handle_t *handle);
   DisplayError SetMetaData(const native_handle_t *pvt_handle, Layer *layer);
   uint32_t RoundToStandardFPS(float fps);
   void ValidateAndSetCSC(const native_handle_t *handle);
@@ -70,7 +70,6 @@ ToneMapSession::~ToneMapSession() {
 void ToneMapSession::OnTask(const ToneMapTaskCode &task_code,
                             SyncTask<ToneMapTaskCode>::TaskContext *task_context) {
   switch (task_code) {
-#ifndef TARGET_HEADLESS
     case ToneMapTaskCode::kCodeGetInstance: {
         ToneMapGetInstanceContext *ctx = static_cast<ToneMapGetInstanceContext *>(task_context);
         Lut3d &lut_3d = ctx->layer->lut_3d;
@@ -80,10 +79,26 @@ void ToneMapSession::OnTask(const ToneMapTaskCode &task_code,
           grid_entries = lut_3d.gridEntries;
           grid_size = INT(lut_3d.gridSize);
         }
-        gpu_tone_mapper_ = TonemapperFactory_GetInstance(tone_map_config_.type,
-                                                         lut_3d.lutEntries, lut_3d.dim,
-                                                         grid_entries, grid_size,
-                                                         tone_map_config_.secure);
+        int use_cpu_backend = 0;
+        HWCDebugHandler::Get()->GetProperty(ENABLE_CPU_COLOR_BACKEND_PROP, &use_cpu_backend);
+#ifndef TARGET_HEADLESS
+        if (use_cpu_backend != 1) {
+          gpu_tone_mapper_ = TonemapperFactory_GetInstance(tone_map_config_.type,
+                                                           lut_3d.lutEntries, lut_3d.dim,
+                                                           grid_entries, grid_size,
+                                                           tone_map_config_.secure);
+        }
+#endif
+        // The CPU blit runs synchronously on the present path, about 34 ms for a 1080p frame on
+        // one core, so it is used only when selected and not as a fallback for a failed GLES
+        // instance. Secure buffers can not be mapped for CPU access.
+        if (use_cpu_backend == 1 && !tone_map_config_.secure &&
+            CPUToneMapper::IsFormatSupported(ctx->layer->input_buffer.format) &&
+            CPUToneMapper::IsFormatSupported(tone_map_config_.format)) {
+          cpu_tone_mapper_ = CPUToneMapper::Create(tone_map_config_.type == TONEMAP_INVERSE,
+                                                   lut_3d.lutEntries, lut_3d.dim, grid_entries,
+                                                   UINT32(grid_size));
+        }
       }
       break;
 
@@ -94,17 +109,29 @@ void ToneMapSession::OnTask(const ToneMapTaskCode &task_code,
                                 (buffer_info_[buffer_index].private_data);
         const void *src_hnd = reinterpret_cast<const void *>
                                 (ctx->layer->input_buffer.buffer_id);
+        if (cpu_tone_mapper_) {
+          // Output is complete on return, no fence to wait on.
+          ctx->error = cpu_tone_mapper_->Blit(static_cast<const native_handle_t *>(dst_hnd),
+                                              static_cast<const native_handle_t *>(src_hnd),
+                                              ctx->merged);
+          ctx->fence = nullptr;
+          break;
+        }
+#ifndef TARGET_HEADLESS
         int fence = gpu_tone_mapper_->blit(dst_hnd, src_hnd, Fence::Dup(ctx->merged));
         ctx->fence = Fence::Create(fence, "tonemap");
+#endif
       }
       break;
 
     case ToneMapTaskCode::kCodeDestroy: {
+#ifndef TARGET_HEADLESS
         delete gpu_tone_mapper_;
+#endif
+        delete cpu_tone_mapper_;
       }
       break;
 
-#endif
     default:
       break;
   }
@@ -179,6 +206,7 @@ bool ToneMapSession::IsSameToneMapConfig(Layer *layer, PrimariesTransfer blend_c
 int HWCToneMapper::HandleToneMap(LayerStack *layer_stack) {
   uint32_t gpu_count = 0;
   DisplayError error = kErrorNone;
+  int status = 0;
 
   for (uint32_t i = 0; i < layer_stack->layers.size(); i++) {
     uint32_t session_index = 0;
@@ -218,16 +246,19 @@ int HWCToneMapper::HandleToneMap(LayerStack *layer_stack) {
       }
 
       ToneMapSession *session = tone_map_sessions_.at(session_index);
-      ToneMap(layer, session);
+      if (ToneMap(layer, session) != 0) {
+        // The layer keeps its own buffer for this frame.
+        status = -1;
+      }
       DLOGI_IF(kTagClient, "Layer %d associated with session index %d", i, session_index);
       session->layer_index_ = INT(i);
     }
   }
 
-  return 0;
+  return status;
 }
 
-void HWCToneMapper::ToneMap(Layer* layer, ToneMapSession *session) {
+int HWCToneMapper::ToneMap(Layer* layer, ToneMapSession *session) {
   ToneMapBlitContext ctx = {};
   ctx.layer = layer;
 
@@ -242,8 +273,16 @@ void HWCToneMapper::ToneMap(Layer* layer, ToneMapSession *session) {
   session->tone_map_task_.PerformTask(ToneMapTaskCode::kCodeBlit, &ctx);
   DTRACE_END();
 
+  if (ctx.error) {
+    // The intermediate buffer was not written, do not present it.
+    DLOGE("Tone map blit failed, error = %d", ctx.error);
+    return -1;
+  }
+
   DumpToneMapOutput(session, ctx.fence);
   session->UpdateBuffer(ctx.fence, &layer->input_buffer);
+
+  return 0;
 }
 
 void HWCToneMapper::PostCommit(LayerStack *layer_stack) {
@@ -365,7 +404,7 @@ DisplayError HWCToneMapper::AcquireToneMapSession(Layer *layer, uint32_t *sessio
   ctx.layer = layer;
   session->tone_map_task_.PerformTask(ToneMapTaskCode::kCodeGetInstance, &ctx);
 
-  if (session->gpu_tone_mapper_ == NULL) {
+  if (session->gpu_tone_mapper_ == NULL && session->cpu_tone_mapper_ == NULL) {
     DLOGE("Get Tonemapper failed!");
     delete session;
     return kErrorNotSupported;
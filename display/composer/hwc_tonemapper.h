@@ -41,6 +41,7 @@
 #include <vector>
 #include "hwc_buffer_sync_handler.h"
 #include "hwc_buffer_allocator.h"
+#include "cpu_tonemapper.h"
 
 class Tonemapper;
 
@@ -60,6 +61,7 @@ struct ToneMapBlitContext : public SyncTask<ToneMapTaskCode>::TaskContext {
   Layer *layer = nullptr;
   shared_ptr<Fence> merged = nullptr;
   shared_ptr<Fence> fence = nullptr;
+  int error = 0;
 };
 
 struct ToneMapConfig {
@@ -88,6 +90,7 @@ class ToneMapSession : public SyncTask<ToneMapTaskCode>::TaskHandler {
   static const uint8_t kNumIntermediateBuffers = 2;
   SyncTask<ToneMapTaskCode> tone_map_task_;
   Tonemapper *gpu_tone_mapper_ = nullptr;
+  CPUToneMapper *cpu_tone_mapper_ = nullptr;
   HWCBufferAllocator *buffer_allocator_ = nullptr;
   ToneMapConfig tone_map_config_ = {};
   uint8_t current_buffer_index_ = 0;
@@ -109,7 +112,7 @@ class HWCToneMapper {
   void Terminate();
 
  private:
-  void ToneMap(Layer *layer, ToneMapSession *session);
+  int ToneMap(Layer *layer, ToneMapSession *session);
   DisplayError AcquireToneMapSession(Layer *layer, uint32_t *sess_idx, PrimariesTransfer blend_cs);
   void DumpToneMapOutput(ToneMapSession *session, shared_ptr<sdm::Fence> acquire_fence);
 
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <QtiGralloc.h>
+#include <TonemapFactory.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "cpu_color_convert_impl.h"
+#include "cpu_image_ops.h"
+#include "cpu_tonemapper.h"
+#include "gl_color_convert_impl.h"
+#include "hwc_buffer_allocator.h"
+
+namespace sdm {
+
+namespace {
+
+const uint32_t kWidth = 1920;
+const uint32_t kHeight = 1080;
+const uint32_t kLutDim = 17;
+// The GPU filters textures with reduced precision weights and subsamples chroma on its own, so
+// the CPU output is compared to it within a couple of codes.
+const int kMaxDiff = 2;
+
+// A smooth LUT with some channel mixing, like the tone map LUTs of real content
+std::vector<Color10Bit> ToneMapLut() {
+  std::vector<Color10Bit> entries;
+  for (uint32_t b = 0; b < kLutDim; b++) {
+    for (uint32_t g = 0; g < kLutDim; g++) {
+      for (uint32_t r = 0; r < kLutDim; r++) {
+        double c[3] = {double(r) / (kLutDim - 1), double(g) / (kLutDim - 1),
+                       double(b) / (kLutDim - 1)};
+        Color10Bit entry = {};
+        entry.R = uint32_t(1023.0 * std::pow(0.9 * c[0] + 0.1 * c[1], 0.8) + 0.5);
+        entry.G = uint32_t(1023.0 * std::pow(0.9 * c[1] + 0.1 * c[2], 0.8) + 0.5);
+        entry.B = uint32_t(1023.0 * std::pow(0.9 * c[2] + 0.1 * c[0], 0.8) + 0.5);
+        entries.push_back(entry);
+      }
+    }
+  }
+  return entries;
+}
+
+class CPUColorBackendTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    for (auto &buffer : buffers_) {
+      allocator_.FreeBuffer(buffer.get());
+    }
+    buffers_.clear();
+  }
+
+  BufferInfo *Allocate(LayerBufferFormat format) {
+    std::unique_ptr<BufferInfo> buffer(new BufferInfo());
+    buffer->buffer_config.width = kWidth;
+    buffer->buffer_config.height = kHeight;
+    buffer->buffer_config.format = format;
+    buffer->buffer_config.buffer_count = 1;
+    buffer->buffer_config.cache = true;
+    if (allocator_.AllocateBuffer(buffer.get()) != kErrorNone) {
+      return nullptr;
+    }
+    buffers_.push_back(std::move(buffer));
+    return buffers_.back().get();
+  }
+
+  static const private_handle_t *Handle(const BufferInfo *buffer) {
+    return static_cast<const private_handle_t *>(buffer->private_data);
+  }
+
+  // Premultiplied gradient in all four channels
+  static void FillGradient(const BufferInfo *buffer) {
+    const private_handle_t *hnd = Handle(buffer);
+    CPUMappedBuffer mapped;
+    ASSERT_TRUE(mapped.Map(hnd->fd, hnd->size, true));
+    for (uint32_t y = 0; y < kHeight; y++) {
+      uint8_t *row = mapped.Base() + y * UINT32(hnd->width) * 4;
+      for (uint32_t x = 0; x < kWidth; x++) {
+        uint32_t alpha = 64 + y * 191 / (kHeight - 1);
+        row[x * 4] = UINT8(x * 255 / (kWidth - 1) * alpha / 255);
+        row[x * 4 + 1] = UINT8(y * 255 / (kHeight - 1) * alpha / 255);
+        row[x * 4 + 2] = UINT8((x + y) * 255 / (kWidth + kHeight - 2) * alpha / 255);
+        row[x * 4 + 3] = UINT8(alpha);
+      }
+    }
+  }
+
+  // Largest difference between two RGBA8888 buffers over the first num_channels channels
+  static int MaxDiffRGBA(const BufferInfo *a, const BufferInfo *b, uint32_t num_channels) {
+    const private_handle_t *hnd_a = Handle(a);
+    const private_handle_t *hnd_b = Handle(b);
+    CPUMappedBuffer mapped_a, mapped_b;
+    if (!mapped_a.Map(hnd_a->fd, hnd_a->size, false) ||
+        !mapped_b.Map(hnd_b->fd, hnd_b->size, false)) {
+      return 256;
+    }
+
+    int max_diff = 0;
+    for (uint32_t y = 0; y < kHeight; y++) {
+      const uint8_t *row_a = mapped_a.Base() + y * UINT32(hnd_a->width) * 4;
+      const uint8_t *row_b = mapped_b.Base() + y * UINT32(hnd_b->width) * 4;
+      for (uint32_t x = 0; x < kWidth; x++) {
+        for (uint32_t ch = 0; ch < num_channels; ch++) {
+          max_diff = std::max(max_diff, std::abs(row_a[x * 4 + ch] - row_b[x * 4 + ch]));
+        }
+      }
+    }
+    return max_diff;
+  }
+
+  // Largest differences between two NV12 buffers, luma and chroma separately
+  void MaxDiffNV12(const BufferInfo *a, const BufferInfo *b, int *luma_diff, int *chroma_diff) {
+    uint32_t stride[4] = {};
+    uint32_t offset[4] = {};
+    uint32_t num_planes = 0;
+    *luma_diff = *chroma_diff = 256;
+    ASSERT_EQ(kErrorNone, allocator_.GetBufferLayout(a->alloc_buffer_info, stride, offset,
+                                                     &num_planes));
+    ASSERT_GE(num_planes, 2U);
+
+    const private_handle_t *hnd_a = Handle(a);
+    const private_handle_t *hnd_b = Handle(b);
+    CPUMappedBuffer mapped_a, mapped_b;
+    ASSERT_TRUE(mapped_a.Map(hnd_a->fd, hnd_a->size, false));
+    ASSERT_TRUE(mapped_b.Map(hnd_b->fd, hnd_b->size, false));
+
+    *luma_diff = *chroma_diff = 0;
+    for (uint32_t y = 0; y < kHeight; y++) {
+      const uint8_t *row_a = mapped_a.Base() + offset[0] + y * stride[0];
+      const uint8_t *row_b = mapped_b.Base() + offset[0] + y * stride[0];
+      for (uint32_t x = 0; x < kWidth; x++) {
+        *luma_diff = std::max(*luma_diff, std::abs(row_a[x] - row_b[x]));
+      }
+    }
+    for (uint32_t y = 0; y < kHeight / 2; y++) {
+      const uint8_t *row_a = mapped_a.Base() + offset[1] + y * stride[1];
+      const uint8_t *row_b = mapped_b.Base() + offset[1] + y * stride[1];
+      for (uint32_t x = 0; x < kWidth; x++) {
+        *chroma_diff = std::max(*chroma_diff, std::abs(row_a[x] - row_b[x]));
+      }
+    }
+  }
+
+  HWCBufferAllocator allocator_;
+  std::vector<std::unique_ptr<BufferInfo>> buffers_;
+};
+
+}  // namespace
+
+// The GLES tonemapper is the reference output for both directions
+TEST_F(CPUColorBackendTest, ToneMapMatchesGL) {
+  std::vector<Color10Bit> lut = ToneMapLut();
+  BufferInfo *src = Allocate(kFormatRGBA8888);
+  BufferInfo *gl_dst = Allocate(kFormatRGBA8888);
+  BufferInfo *cpu_dst = Allocate(kFormatRGBA8888);
+  ASSERT_TRUE(src && gl_dst && cpu_dst);
+  FillGradient(src);
+
+  for (int type : {TONEMAP_FORWARD, TONEMAP_INVERSE}) {
+    std::unique_ptr<Tonemapper> gl_tone_mapper(
+        TonemapperFactory_GetInstance(type, lut.data(), kLutDim, nullptr, 0, false));
+    std::unique_ptr<CPUToneMapper> cpu_tone_mapper(
+        CPUToneMapper::Create(type == TONEMAP_INVERSE, lut.data(), kLutDim, nullptr, 0));
+    ASSERT_NE(nullptr, gl_tone_mapper);
+    ASSERT_NE(nullptr, cpu_tone_mapper);
+
+    int fence_fd = gl_tone_mapper->blit(gl_dst->private_data, src->private_data, -1);
+    ASSERT_EQ(kErrorNone, Fence::Wait(Fence::Create(fence_fd, "gl_tonemap")));
+    ASSERT_EQ(0, cpu_tone_mapper->Blit(Handle(cpu_dst), Handle(src), nullptr));
+
+    // Forward tone mapping drops alpha
+    EXPECT_LE(MaxDiffRGBA(gl_dst, cpu_dst, (type == TONEMAP_INVERSE) ? 4 : 3), kMaxDiff)
+        << "type " << type;
+  }
+}
+
+// The virtual display conversion, with GLColorConvertImpl as the reference output
+TEST_F(CPUColorBackendTest, NV12MatchesGL) {
+  BufferInfo *src = Allocate(kFormatRGBA8888);
+  BufferInfo *gl_dst = Allocate(kFormatYCbCr420SemiPlanarVenus);
+  BufferInfo *cpu_dst = Allocate(kFormatYCbCr420SemiPlanarVenus);
+  ASSERT_TRUE(src && gl_dst && cpu_dst);
+  FillGradient(src);
+
+  GLColorConvertImpl gl_convert(kTargetYUV, false);
+  CPUColorConvertImpl cpu_convert(kTargetYUV);
+  ASSERT_EQ(0, gl_convert.Init());
+  ASSERT_EQ(0, cpu_convert.Init());
+
+  GLRect rect;
+  rect.right = FLOAT(kWidth);
+  rect.bottom = FLOAT(kHeight);
+  shared_ptr<Fence> release_fence = nullptr;
+  ASSERT_EQ(0, gl_convert.Blit(Handle(src), Handle(gl_dst), rect, rect, nullptr, nullptr,
+                               &release_fence));
+  ASSERT_EQ(kErrorNone, Fence::Wait(release_fence));
+  ASSERT_EQ(0, cpu_convert.Blit(Handle(src), Handle(cpu_dst), rect, rect, nullptr, nullptr,
+                                &release_fence));
+  gl_convert.Deinit();
+
+  int luma_diff = 0, chroma_diff = 0;
+  MaxDiffNV12(gl_dst, cpu_dst, &luma_diff, &chroma_diff);
+  EXPECT_LE(luma_diff, kMaxDiff);
+  EXPECT_LE(chroma_diff, kMaxDiff);
+}
+
+// Time of a full CPU blit, mapping and cache maintenance included
+TEST_F(CPUColorBackendTest, FrameTime) {
+  const int kFrames = 20;
+  std::vector<Color10Bit> lut = ToneMapLut();
+  BufferInfo *src = Allocate(kFormatRGBA8888);
+  BufferInfo *rgba_dst = Allocate(kFormatRGBA8888);
+  BufferInfo *nv12_dst = Allocate(kFormatYCbCr420SemiPlanarVenus);
+  ASSERT_TRUE(src && rgba_dst && nv12_dst);
+  FillGradient(src);
+
+  std::unique_ptr<CPUToneMapper> tone_mapper(
+      CPUToneMapper::Create(false, lut.data(), kLutDim, nullptr, 0));
+  ASSERT_NE(nullptr, tone_mapper);
+  auto begin = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; frame++) {
+    ASSERT_EQ(0, tone_mapper->Blit(Handle(rgba_dst), Handle(src), nullptr));
+  }
+  auto tone_map_time = std::chrono::steady_clock::now() - begin;
+
+  CPUColorConvertImpl convert(kTargetYUV);
+  ASSERT_EQ(0, convert.Init());
+  GLRect rect;
+  rect.right = FLOAT(kWidth);
+  rect.bottom = FLOAT(kHeight);
+  shared_ptr<Fence> release_fence = nullptr;
+  begin = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; frame++) {
+    ASSERT_EQ(0, convert.Blit(Handle(src), Handle(nv12_dst), rect, rect, nullptr, nullptr,
+                              &release_fence));
+  }
+  auto nv12_time = std::chrono::steady_clock::now() - begin;
+
+  auto per_frame = [&](std::chrono::steady_clock::duration time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time).count() / kFrames;
+  };
+  std::cout << "1080p CPU blit: tone map " << per_frame(tone_map_time) << " us, NV12 "
+            << per_frame(nv12_time) << " us per frame" << std::endl;
+}
+
+}  // namespace sdm
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "cpu_image_ops.h"
+
+namespace sdm {
+
+namespace {
+
+const uint32_t kWidth = 1920;
+const uint32_t kHeight = 1080;
+
+Color10Bit MakeEntry(uint32_t r, uint32_t g, uint32_t b) {
+  Color10Bit entry = {};
+  entry.R = r & 0x3ff;
+  entry.G = g & 0x3ff;
+  entry.B = b & 0x3ff;
+  return entry;
+}
+
+std::vector<Color10Bit> RandomEntries(uint32_t count, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<uint32_t> dist(0, 1023);
+  std::vector<Color10Bit> entries(count);
+  for (Color10Bit &entry : entries) {
+    entry = MakeEntry(dist(gen), dist(gen), dist(gen));
+  }
+  return entries;
+}
+
+std::vector<Color10Bit> IdentityLut(uint32_t dim) {
+  std::vector<Color10Bit> entries;
+  for (uint32_t b = 0; b < dim; b++) {
+    for (uint32_t g = 0; g < dim; g++) {
+      for (uint32_t r = 0; r < dim; r++) {
+        entries.push_back(MakeEntry(r * 1023 / (dim - 1), g * 1023 / (dim - 1),
+                                    b * 1023 / (dim - 1)));
+      }
+    }
+  }
+  return entries;
+}
+
+double Component(const Color10Bit &entry, uint32_t channel) {
+  uint32_t value = (channel == 0) ? entry.R : ((channel == 1) ? entry.G : entry.B);
+  return value / 1023.0;
+}
+
+// Double precision version of the GPU tonemapper sampling, which the CPU LUT is meant to match
+double SampleXform(const std::vector<Color10Bit> &xform, double c, uint32_t channel) {
+  double x = std::min(std::max(c, 0.0), 1.0) * (xform.size() - 1);
+  uint32_t x0 = std::min(uint32_t(x), uint32_t(xform.size() - 2));
+  double f = x - x0;
+  return Component(xform[x0], channel) * (1.0 - f) + Component(xform[x0 + 1], channel) * f;
+}
+
+void SampleLut(const std::vector<Color10Bit> &lut, uint32_t dim, const double in[3],
+               double out[3]) {
+  uint32_t i0[3];
+  double f[3];
+  for (uint32_t ch = 0; ch < 3; ch++) {
+    double x = std::min(std::max(in[ch], 0.0), 1.0) * (dim - 1);
+    i0[ch] = std::min(uint32_t(x), dim - 2);
+    f[ch] = x - i0[ch];
+  }
+
+  for (uint32_t ch = 0; ch < 3; ch++) {
+    out[ch] = 0.0;
+    for (uint32_t corner = 0; corner < 8; corner++) {
+      uint32_t dx = corner & 1, dy = (corner >> 1) & 1, dz = (corner >> 2) & 1;
+      double weight = (dx ? f[0] : 1.0 - f[0]) * (dy ? f[1] : 1.0 - f[1]) *
+                      (dz ? f[2] : 1.0 - f[2]);
+      uint32_t index = (i0[0] + dx) + (i0[1] + dy) * dim + (i0[2] + dz) * dim * dim;
+      out[ch] += weight * Component(lut[index], ch);
+    }
+  }
+}
+
+std::vector<uint8_t> GradientRGBA(uint32_t width, uint32_t height) {
+  std::vector<uint8_t> pixels(width * height * 4);
+  for (uint32_t y = 0; y < height; y++) {
+    for (uint32_t x = 0; x < width; x++) {
+      uint8_t *pixel = &pixels[(y * width + x) * 4];
+      pixel[0] = uint8_t(x * 255 / (width - 1));
+      pixel[1] = uint8_t(y * 255 / (height - 1));
+      pixel[2] = uint8_t((x + y) * 255 / (width + height - 2));
+      pixel[3] = uint8_t(255 - x * 255 / (width - 1));
+    }
+  }
+  return pixels;
+}
+
+uint8_t RoundTo8Bit(double value) {
+  return uint8_t(std::min(std::max(std::floor(value + 0.5), 0.0), 255.0));
+}
+
+}  // namespace
+
+TEST(CPUImageOpsTest, LutMatchesReference) {
+  const uint32_t kDim = 17;
+  const uint32_t kXformSize = 64;
+  const uint32_t kCount = 4096;
+  std::vector<Color10Bit> lut = RandomEntries(kDim * kDim * kDim, 1);
+  std::vector<Color10Bit> xform = RandomEntries(kXformSize, 2);
+
+  // Inputs past both ends are clamped, and the grid points themselves are sampled as well
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<float> dist(-0.1f, 1.1f);
+  std::vector<float> r(kCount), g(kCount), b(kCount);
+  for (uint32_t i = 0; i < kCount; i++) {
+    r[i] = (i < kDim) ? float(i) / (kDim - 1) : dist(gen);
+    g[i] = (i < kDim) ? float(i) / (kDim - 1) : dist(gen);
+    b[i] = (i < kDim) ? 1.0f - float(i) / (kDim - 1) : dist(gen);
+  }
+
+  for (bool with_xform : {false, true}) {
+    CPULut3d cpu_lut;
+    ASSERT_TRUE(cpu_lut.Init(lut.data(), kDim, with_xform ? xform.data() : nullptr,
+                             with_xform ? kXformSize : 0));
+    std::vector<float> out_r = r, out_g = g, out_b = b;
+    cpu_lut.Map(out_r.data(), out_g.data(), out_b.data(), kCount);
+
+    double max_error = 0.0;
+    for (uint32_t i = 0; i < kCount; i++) {
+      double in[3] = {r[i], g[i], b[i]};
+      if (with_xform) {
+        for (uint32_t ch = 0; ch < 3; ch++) {
+          in[ch] = SampleXform(xform, in[ch], ch);
+        }
+      }
+      double expected[3];
+      SampleLut(lut, kDim, in, expected);
+      max_error = std::max(max_error, std::fabs(expected[0] - out_r[i]));
+      max_error = std::max(max_error, std::fabs(expected[1] - out_g[i]));
+      max_error = std::max(max_error, std::fabs(expected[2] - out_b[i]));
+    }
+    // Well below one 10 bit code, the output precision of the GPU textures
+    EXPECT_LT(max_error, 0.05 / 1023) << (with_xform ? "with" : "without") << " 1D LUT";
+  }
+}
+
+// An identity LUT leaves every 8 bit and 10 bit code unchanged through unpack, map and pack. With
+// 32 grid points every entry is an exact 10 bit code.
+TEST(CPUImageOpsTest, IdentityLutIsBitExact) {
+  const uint32_t kDim = 32;
+  std::vector<Color10Bit> lut = IdentityLut(kDim);
+  CPULut3d cpu_lut;
+  ASSERT_TRUE(cpu_lut.Init(lut.data(), kDim, nullptr, 0));
+
+  std::vector<uint8_t> src8(256 * 4);
+  for (uint32_t i = 0; i < 256; i++) {
+    src8[i * 4] = uint8_t(i);
+    src8[i * 4 + 1] = uint8_t(255 - i);
+    src8[i * 4 + 2] = uint8_t(i * 7);
+    src8[i * 4 + 3] = uint8_t(i * 3);
+  }
+  std::vector<uint32_t> src10(1024);
+  for (uint32_t i = 0; i < 1024; i++) {
+    src10[i] = i | ((1023 - i) << 10) | (((i * 5) & 0x3ff) << 20) | ((i & 3) << 30);
+  }
+
+  struct {
+    CPUPixelLayout layout;
+    const uint8_t *src;
+    uint32_t count;
+  } cases[] = {
+    {kCPUPixelRGBA8888, src8.data(), 256},
+    {kCPUPixelRGBA1010102, reinterpret_cast<const uint8_t *>(src10.data()), 1024},
+  };
+  for (const auto &test : cases) {
+    std::vector<float> planes(test.count * 4);
+    float *r = planes.data(), *g = r + test.count, *b = g + test.count, *a = b + test.count;
+    UnpackRow(test.layout, test.src, nullptr, test.count, r, g, b, a);
+    cpu_lut.Map(r, g, b, test.count);
+    std::vector<uint8_t> dst(test.count * 4);
+    PackRow(test.layout, r, g, b, a, test.count, dst.data());
+    EXPECT_TRUE(std::equal(dst.begin(), dst.end(), test.src)) << "layout " << test.layout;
+  }
+}
+
+// Primaries and greys with their full range BT.601 codes
+TEST(CPUImageOpsTest, NV12Golden) {
+  const struct {
+    uint8_t r, g, b;
+    uint8_t y, cb, cr;
+  } kColours[] = {
+    {0, 0, 0, 0, 128, 128},       {255, 255, 255, 255, 128, 128}, {128, 128, 128, 128, 128, 128},
+    {255, 0, 0, 76, 85, 255},     {0, 255, 0, 150, 44, 21},       {0, 0, 255, 29, 255, 107},
+    {255, 255, 0, 226, 1, 149},   {0, 255, 255, 179, 171, 1},     {255, 0, 255, 105, 212, 235},
+  };
+
+  for (const auto &colour : kColours) {
+    uint8_t row[8] = {colour.r, colour.g, colour.b, 255, colour.r, colour.g, colour.b, 255};
+    uint8_t y0[2], y1[2], uv[2];
+    ConvertRowPairToNV12(row, row, 2, y0, y1, uv);
+    SCOPED_TRACE(::testing::Message() << "rgb " << int(colour.r) << " " << int(colour.g) << " "
+                                      << int(colour.b));
+    EXPECT_EQ(colour.y, y0[0]);
+    EXPECT_EQ(colour.y, y1[1]);
+    EXPECT_EQ(colour.cb, uv[0]);
+    EXPECT_EQ(colour.cr, uv[1]);
+  }
+}
+
+TEST(CPUImageOpsTest, NV12MatchesReference) {
+  std::mt19937 gen(4);
+  std::uniform_int_distribution<int> dist(0, 255);
+  const uint32_t kRowWidth = 1022;
+  std::vector<uint8_t> rows(kRowWidth * 8);
+  for (uint8_t &c : rows) {
+    c = uint8_t(dist(gen));
+  }
+  const uint8_t *row0 = rows.data();
+  const uint8_t *row1 = row0 + kRowWidth * 4;
+  std::vector<uint8_t> y0(kRowWidth), y1(kRowWidth), uv(kRowWidth);
+  ConvertRowPairToNV12(row0, row1, kRowWidth, y0.data(), y1.data(), uv.data());
+
+  int max_error = 0;
+  auto luma = [](const uint8_t *p) { return 0.299 * p[0] + 0.587 * p[1] + 0.114 * p[2]; };
+  for (uint32_t i = 0; i < kRowWidth; i++) {
+    max_error = std::max(max_error, std::abs(int(RoundTo8Bit(luma(row0 + i * 4))) - y0[i]));
+    max_error = std::max(max_error, std::abs(int(RoundTo8Bit(luma(row1 + i * 4))) - y1[i]));
+  }
+  for (uint32_t i = 0; i < kRowWidth / 2; i++) {
+    double rgb[3] = {};
+    for (uint32_t ch = 0; ch < 3; ch++) {
+      rgb[ch] = (row0[i * 8 + ch] + row0[i * 8 + 4 + ch] + row1[i * 8 + ch] +
+                 row1[i * 8 + 4 + ch]) / 4.0;
+    }
+    double cb = -0.168736 * rgb[0] - 0.331264 * rgb[1] + 0.5 * rgb[2] + 128.0;
+    double cr = 0.5 * rgb[0] - 0.418688 * rgb[1] - 0.081312 * rgb[2] + 128.0;
+    max_error = std::max(max_error, std::abs(int(RoundTo8Bit(cb)) - uv[i * 2]));
+    max_error = std::max(max_error, std::abs(int(RoundTo8Bit(cr)) - uv[i * 2 + 1]));
+  }
+  EXPECT_LE(max_error, 1);
+}
+
+// Kernel throughput on a 1080p frame over the worker pool, without mapping or fence waits
+TEST(CPUImageOpsTest, FrameTime) {
+  const int kFrames = 10;
+  const uint32_t kDim = 33;
+  std::vector<Color10Bit> lut = RandomEntries(kDim * kDim * kDim, 5);
+  CPULut3d cpu_lut;
+  ASSERT_TRUE(cpu_lut.Init(lut.data(), kDim, nullptr, 0));
+  std::vector<uint8_t> src = GradientRGBA(kWidth, kHeight);
+  std::vector<uint8_t> dst(src.size());
+  std::vector<uint8_t> nv12(kWidth * kHeight * 3 / 2);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; frame++) {
+    CPUWorkerPool::GetInstance()->ParallelFor(kHeight, [&](uint32_t row_begin, uint32_t row_end) {
+      std::vector<float> planes(kWidth * 4);
+      float *r = planes.data(), *g = r + kWidth, *b = g + kWidth, *a = b + kWidth;
+      for (uint32_t y = row_begin; y < row_end; y++) {
+        UnpackRow(kCPUPixelRGBA8888, &src[y * kWidth * 4], nullptr, kWidth, r, g, b, a);
+        cpu_lut.Map(r, g, b, kWidth);
+        PackRow(kCPUPixelRGBA8888, r, g, b, a, kWidth, &dst[y * kWidth * 4]);
+      }
+    });
+  }
+  auto tone_map_time = std::chrono::steady_clock::now() - begin;
+
+  begin = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; frame++) {
+    CPUWorkerPool::GetInstance()->ParallelFor(kHeight / 2, [&](uint32_t pair_begin,
+                                                               uint32_t pair_end) {
+      for (uint32_t pair = pair_begin; pair < pair_end; pair++) {
+        uint32_t y = pair * 2;
+        ConvertRowPairToNV12(&src[y * kWidth * 4], &src[(y + 1) * kWidth * 4], kWidth,
+                             &nv12[y * kWidth], &nv12[(y + 1) * kWidth],
+                             &nv12[kWidth * kHeight + pair * kWidth]);
+      }
+    });
+  }
+  auto nv12_time = std::chrono::steady_clock::now() - begin;
+
+  auto per_frame = [&](std::chrono::steady_clock::duration time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time).count() / kFrames;
+  };
+  std::cout << "1080p: 33^3 tone map " << per_frame(tone_map_time) << " us, NV12 "
+            << per_frame(nv12_time) << " us per frame" << std::endl;
+}
+
+}  // namespace sdm
@@ -53,6 +53,9 @@ static void get_properties(gralloc::GrallocProperties *props) {
   props->ubwc_disable = property_get_bool("vendor.gralloc.disable_ubwc", 0);
 
   props->ahardware_buffer_disable = property_get_bool("vendor.gralloc.disable_ahardware_buffer", 0);
+
+  props->validate_buffer_info_cache =
+      property_get_bool("vendor.gralloc.validate_buffer_info_cache", 0);
 }
 
 namespace vendor {
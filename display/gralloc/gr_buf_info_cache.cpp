@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <inttypes.h>
+#include <log/log.h>
+#include <string.h>
+
+#include <functional>
+
+#include "gr_buf_info_cache.h"
+
+namespace gralloc {
+
+BufferInfoCache *BufferInfoCache::s_instance = nullptr;
+
+BufferInfoCache *BufferInfoCache::GetInstance() {
+  static std::mutex s_lock;
+  std::lock_guard<std::mutex> obj(s_lock);
+  if (!s_instance) {
+    s_instance = new BufferInfoCache();
+  }
+
+  return s_instance;
+}
+
+size_t BufferInfoCache::KeyHash::operator()(const Key &key) const {
+  size_t hash = std::hash<uint64_t>()(key.usage);
+  hash = hash * 31 + std::hash<int>()(key.width);
+  hash = hash * 31 + std::hash<int>()(key.height);
+  hash = hash * 31 + std::hash<int>()(key.format);
+  hash = hash * 31 + std::hash<int>()(key.layer_count);
+  return hash;
+}
+
+void BufferInfoCache::ComputeSize(const BufferInfo &info, Entry *entry) {
+  entry->err = gralloc::GetBufferSizeAndDimensions(info, &entry->size, &entry->alignedw,
+                                                   &entry->alignedh, &entry->graphics_metadata);
+}
+
+void BufferInfoCache::ComputePlaneLayout(const BufferInfo &info, int32_t flags, Entry *entry) {
+  entry->plane_flags = flags;
+  entry->plane_count = 0;
+  memset(entry->plane_info, 0, sizeof(entry->plane_info));
+  if (IsYuvFormat(info.format)) {
+    entry->plane_err = GetYUVPlaneInfo(info, info.format, INT(entry->alignedw),
+                                       INT(entry->alignedh), flags, &entry->plane_count,
+                                       entry->plane_info);
+  } else if (IsUncompressedRGBFormat(info.format) || IsCompressedRGBFormat(info.format)) {
+    GetRGBPlaneInfo(info, info.format, INT(entry->alignedw), INT(entry->alignedh), flags,
+                    &entry->plane_count, entry->plane_info);
+    entry->plane_err = 0;
+  } else {
+    entry->plane_err = -EINVAL;
+  }
+  entry->plane_layout_valid = true;
+}
+
+BufferInfoCache::Entry *BufferInfoCache::LookupLocked(const Key &key) {
+  auto it = map_.find(key);
+  if (it == map_.end()) {
+    misses_++;
+    return nullptr;
+  }
+
+  hits_++;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  return &it->second->second;
+}
+
+BufferInfoCache::Entry *BufferInfoCache::InsertLocked(const Key &key, const Entry &entry) {
+  auto it = map_.find(key);
+  if (it != map_.end()) {
+    it->second->second = entry;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return &it->second->second;
+  }
+
+  if (lru_.size() >= kMaxEntries) {
+    map_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+  lru_.emplace_front(key, entry);
+  map_[key] = lru_.begin();
+  return &lru_.front().second;
+}
+
+int BufferInfoCache::GetBufferSizeAndDimensions(const BufferInfo &info, unsigned int *size,
+                                                unsigned int *alignedw, unsigned int *alignedh,
+                                                GraphicsMetadata *graphics_metadata) {
+  Key key = {info.width, info.height, info.format, info.layer_count, info.usage};
+  std::lock_guard<std::mutex> lock(lock_);
+
+  Entry *entry = LookupLocked(key);
+  if (entry && validate_) {
+    Entry fresh = {};
+    ComputeSize(info, &fresh);
+    if (fresh.err != entry->err || fresh.size != entry->size ||
+        fresh.alignedw != entry->alignedw || fresh.alignedh != entry->alignedh ||
+        memcmp(&fresh.graphics_metadata, &entry->graphics_metadata, sizeof(GraphicsMetadata))) {
+      ALOGE("%s: stale entry for %dx%d format %d usage 0x%" PRIx64 ": size %u/%u AWxAH %ux%u/%ux%u",
+            __FUNCTION__, info.width, info.height, info.format, info.usage, entry->size,
+            fresh.size, entry->alignedw, entry->alignedh, fresh.alignedw, fresh.alignedh);
+      entry = InsertLocked(key, fresh);
+    }
+  } else if (!entry) {
+    Entry fresh = {};
+    ComputeSize(info, &fresh);
+    entry = InsertLocked(key, fresh);
+  }
+
+  *size = entry->size;
+  *alignedw = entry->alignedw;
+  *alignedh = entry->alignedh;
+  if (graphics_metadata) {
+    *graphics_metadata = entry->graphics_metadata;
+  }
+  return entry->err;
+}
+
+int BufferInfoCache::GetPlaneLayout(const BufferInfo &info, unsigned int alignedw,
+                                    unsigned int alignedh, int32_t flags, int *plane_count,
+                                    PlaneLayoutInfo plane_info[8]) {
+  Key key = {info.width, info.height, info.format, info.layer_count, info.usage};
+  std::lock_guard<std::mutex> lock(lock_);
+
+  Entry *entry = LookupLocked(key);
+  if (!entry) {
+    Entry fresh = {};
+    ComputeSize(info, &fresh);
+    entry = InsertLocked(key, fresh);
+  }
+
+  if (entry->err || entry->alignedw != alignedw || entry->alignedh != alignedh) {
+    // Handle was not laid out the way this process would, don't cache it
+    Entry fresh = {};
+    fresh.alignedw = alignedw;
+    fresh.alignedh = alignedh;
+    ComputePlaneLayout(info, flags, &fresh);
+    *plane_count = fresh.plane_count;
+    memcpy(plane_info, fresh.plane_info, sizeof(fresh.plane_info));
+    return fresh.plane_err;
+  }
+
+  if (!entry->plane_layout_valid || entry->plane_flags != flags) {
+    ComputePlaneLayout(info, flags, entry);
+  } else if (validate_) {
+    Entry fresh = *entry;
+    ComputePlaneLayout(info, flags, &fresh);
+    if (fresh.plane_err != entry->plane_err || fresh.plane_count != entry->plane_count ||
+        memcmp(fresh.plane_info, entry->plane_info, sizeof(fresh.plane_info))) {
+      ALOGE("%s: stale plane layout for %dx%d format %d usage 0x%" PRIx64, __FUNCTION__,
+            info.width, info.height, info.format, info.usage);
+      *entry = fresh;
+    }
+  }
+
+  *plane_count = entry->plane_count;
+  memcpy(plane_info, entry->plane_info, sizeof(entry->plane_info));
+  return entry->plane_err;
+}
+
+void BufferInfoCache::SetProperties(GrallocProperties props) {
+  std::lock_guard<std::mutex> lock(lock_);
+  validate_ = props.validate_buffer_info_cache;
+  // UBWC and adreno alignment depend on the properties, drop stale results
+  lru_.clear();
+  map_.clear();
+}
+
+void BufferInfoCache::GetStats(uint64_t *hits, uint64_t *misses) {
+  std::lock_guard<std::mutex> lock(lock_);
+  *hits = hits_;
+  *misses = misses_;
+}
+
+}  // namespace gralloc
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __GR_BUF_INFO_CACHE_H__
+#define __GR_BUF_INFO_CACHE_H__
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "gr_utils.h"
+
+namespace gralloc {
+
+// Bounded LRU cache of buffer size, aligned dimensions and plane layout.
+// Results only depend on the buffer descriptor and on the gralloc properties,
+// so they are cached per (width, height, format, usage, layer_count) and the
+// cache is dropped whenever the properties change.
+class BufferInfoCache {
+ public:
+  static BufferInfoCache *GetInstance();
+
+  int GetBufferSizeAndDimensions(const BufferInfo &info, unsigned int *size,
+                                 unsigned int *alignedw, unsigned int *alignedh,
+                                 GraphicsMetadata *graphics_metadata);
+  int GetPlaneLayout(const BufferInfo &info, unsigned int alignedw, unsigned int alignedh,
+                     int32_t flags, int *plane_count, PlaneLayoutInfo plane_info[8]);
+  void SetProperties(GrallocProperties props);
+  void GetStats(uint64_t *hits, uint64_t *misses);
+
+ private:
+  static const size_t kMaxEntries = 64;
+
+  struct Key {
+    int width;
+    int height;
+    int format;
+    int layer_count;
+    uint64_t usage;
+    bool operator==(const Key &other) const {
+      return width == other.width && height == other.height && format == other.format &&
+             layer_count == other.layer_count && usage == other.usage;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const;
+  };
+
+  struct Entry {
+    int err = 0;
+    unsigned int size = 0;
+    unsigned int alignedw = 0;
+    unsigned int alignedh = 0;
+    GraphicsMetadata graphics_metadata = {};
+    bool plane_layout_valid = false;
+    int32_t plane_flags = 0;
+    int plane_err = 0;
+    int plane_count = 0;
+    PlaneLayoutInfo plane_info[8] = {};
+  };
+
+  using LruList = std::list<std::pair<Key, Entry>>;
+
+  BufferInfoCache() {}
+  Entry *LookupLocked(const Key &key);
+  Entry *InsertLocked(const Key &key, const Entry &entry);
+  static void ComputeSize(const BufferInfo &info, Entry *entry);
+  static void ComputePlaneLayout(const BufferInfo &info, int32_t flags, Entry *entry);
+
+  static BufferInfoCache *s_instance;
+  std::mutex lock_;
+  LruList lru_ = {};
+  std::unordered_map<Key, LruList::iterator, KeyHash> map_ = {};
+  bool validate_ = false;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+}  // namespace gralloc
+
+#endif  // __GR_BUF_INFO_CACHE_H__
@@ -71,6 +71,7 @@
 #include <fstream>
 #include "gr_adreno_info.h"
 #include "gr_buf_descriptor.h"
+#include "gr_buf_info_cache.h"
 #include "gr_priv_handle.h"
 #include "gr_utils.h"
 #include "qdMetaData.h"
@@ -787,16 +788,12 @@ static Error getFormatLayout(private_handle_t *handle, std::vector<PlaneLayout>
   BufferInfo info(handle->unaligned_width, handle->unaligned_height, handle->format, handle->usage);
 
   gralloc::PlaneLayoutInfo plane_layout[8] = {};
-  if (gralloc::IsYuvFormat(handle->format)) {
-    gralloc::GetYUVPlaneInfo(info, handle->format, handle->width, handle->height, handle->flags,
-                             &plane_count, plane_layout);
-  } else if (gralloc::IsUncompressedRGBFormat(handle->format) ||
-             gralloc::IsCompressedRGBFormat(handle->format)) {
-    gralloc::GetRGBPlaneInfo(info, handle->format, handle->width, handle->height, handle->flags,
-                             &plane_count, plane_layout);
-  } else {
+  if (!gralloc::IsYuvFormat(handle->format) && !gralloc::IsUncompressedRGBFormat(handle->format) &&
+      !gralloc::IsCompressedRGBFormat(handle->format)) {
     return Error::BAD_BUFFER;
   }
+  BufferInfoCache::GetInstance()->GetPlaneLayout(info, UINT(handle->width), UINT(handle->height),
+                                                 handle->flags, &plane_count, plane_layout);
   plane_info.resize(plane_count);
   for (int i = 0; i < plane_count; i++) {
     std::vector<PlaneLayoutComponent> components;
@@ -845,7 +842,6 @@ int BufferManager::GetCustomDimensions(private_handle_t *hnd, int *stride, int *
 }
 
 BufferManager::BufferManager() : next_id_(0) {
-  handles_map_.clear();
   allocator_ = new Allocator();
 }
 
@@ -863,6 +859,7 @@ BufferManager::~BufferManager() {
 void BufferManager::SetGrallocDebugProperties(gralloc::GrallocProperties props) {
   allocator_->SetProperties(props);
   AdrenoMemInfo::GetInstance()->AdrenoSetProperties(props);
+  BufferInfoCache::GetInstance()->SetProperties(props);
 }
 
 Error BufferManager::FreeBuffer(std::shared_ptr<Buffer> buf) {
@@ -876,6 +873,9 @@ Error BufferManager::FreeBuffer(std::shared_ptr<Buffer> buf) {
 
   auto meta_size = getMetaDataSize(hnd->reserved_size);
 
+  // Freed memory is returned to the heap right away and never recycled for a later
+  // allocation: the allocator drops its reference as soon as the handle is sent to the
+  // client, so the fds may still be imported and mapped by other processes here.
   if (allocator_->FreeBuffer(reinterpret_cast<void *>(hnd->base), hnd->size, hnd->offset, hnd->fd,
                              buf->ion_handle_main) != 0) {
     return Error::BAD_BUFFER;
@@ -928,7 +928,7 @@ void BufferManager::RegisterHandleLocked(const private_handle_t *hnd, int ion_ha
 #endif
   }
 
-  handles_map_.emplace(std::make_pair(hnd, buffer));
+  GetShard(hnd).handles_map.emplace(std::make_pair(hnd, buffer));
 }
 
 Error BufferManager::ImportHandleLocked(private_handle_t *hnd) {
@@ -963,17 +963,20 @@ Error BufferManager::ImportHandleLocked(private_handle_t *hnd) {
 
   RegisterHandleLocked(hnd, ion_handle, ion_handle_meta);
   allocated_ += hnd->size;
-  if (allocated_ >=  kAllocThreshold) {
-    kAllocThreshold += kMemoryOffset;
-    BuffersDump();
-  }
   return Error::NONE;
 }
 
+BufferManager::HandleShard &BufferManager::GetShard(const private_handle_t *hnd) {
+  // Handles are heap allocated, drop the alignment bits before picking a shard
+  auto key = reinterpret_cast<uintptr_t>(hnd);
+  return shards_[((key >> 4) ^ (key >> 12)) % kHandleShards];
+}
+
 std::shared_ptr<BufferManager::Buffer> BufferManager::GetBufferFromHandleLocked(
     const private_handle_t *hnd) {
-  auto it = handles_map_.find(hnd);
-  if (it != handles_map_.end()) {
+  auto &handles_map = GetShard(hnd).handles_map;
+  auto it = handles_map.find(hnd);
+  if (it != handles_map.end()) {
     return it->second;
   } else {
     return nullptr;
@@ -993,7 +996,7 @@ Error BufferManager::MapBuffer(private_handle_t const *handle) {
 }
 
 Error BufferManager::IsBufferImported(const private_handle_t *hnd) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(hnd).lock);
   auto buf = GetBufferFromHandleLocked(hnd);
   if (buf != nullptr) {
     return Error::NONE;
@@ -1004,30 +1007,45 @@ Error BufferManager::IsBufferImported(const private_handle_t *hnd) {
 Error BufferManager::RetainBuffer(private_handle_t const *hnd) {
   ALOGD_IF(DEBUG, "Retain buffer handle:%p id: %" PRIu64, hnd, hnd->id);
   auto err = Error::NONE;
-  std::lock_guard<std::mutex> lock(buffer_lock_);
-  auto buf = GetBufferFromHandleLocked(hnd);
-  if (buf != nullptr) {
-    buf->IncRef();
-  } else {
-    private_handle_t *handle = const_cast<private_handle_t *>(hnd);
-    err = ImportHandleLocked(handle);
+  bool imported = false;
+  {
+    std::lock_guard<std::mutex> lock(GetShard(hnd).lock);
+    auto buf = GetBufferFromHandleLocked(hnd);
+    if (buf != nullptr) {
+      buf->IncRef();
+    } else {
+      private_handle_t *handle = const_cast<private_handle_t *>(hnd);
+      err = ImportHandleLocked(handle);
+      imported = (err == Error::NONE);
+    }
+  }
+
+  // Dump walks every shard, so it must run without holding one
+  if (imported) {
+    std::lock_guard<std::mutex> lock(dump_lock_);
+    if (allocated_ >= kAllocThreshold) {
+      kAllocThreshold += kMemoryOffset;
+      BuffersDump();
+    }
   }
   return err;
 }
 
 Error BufferManager::ReleaseBuffer(private_handle_t const *hnd) {
   ALOGD_IF(DEBUG, "Release buffer handle:%p", hnd);
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  auto &shard = GetShard(hnd);
+  std::lock_guard<std::mutex> lock(shard.lock);
   auto buf = GetBufferFromHandleLocked(hnd);
   if (buf == nullptr) {
     ALOGE("Could not find handle: %p id: %" PRIu64, hnd, hnd->id);
     return Error::BAD_BUFFER;
   } else {
     if (buf->DecRef()) {
-      handles_map_.erase(hnd);
+      shard.handles_map.erase(hnd);
       // Unmap, close ion handle and close fd
-      if (allocated_ >= hnd->size) {
-        allocated_ -= hnd->size;
+      uint64_t allocated = allocated_;
+      while (allocated >= hnd->size &&
+             !allocated_.compare_exchange_weak(allocated, allocated - hnd->size)) {
       }
       FreeBuffer(buf);
     }
@@ -1036,7 +1054,7 @@ Error BufferManager::ReleaseBuffer(private_handle_t const *hnd) {
 }
 
 Error BufferManager::LockBuffer(const private_handle_t *hnd, uint64_t usage) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(hnd).lock);
   auto err = Error::NONE;
   ALOGD_IF(DEBUG, "LockBuffer buffer handle:%p id: %" PRIu64, hnd, hnd->id);
 
@@ -1078,7 +1096,7 @@ Error BufferManager::LockBuffer(const private_handle_t *hnd, uint64_t usage) {
 }
 
 Error BufferManager::FlushBuffer(const private_handle_t *handle) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   auto status = Error::NONE;
 
   private_handle_t *hnd = const_cast<private_handle_t *>(handle);
@@ -1096,7 +1114,7 @@ Error BufferManager::FlushBuffer(const private_handle_t *handle) {
 }
 
 Error BufferManager::RereadBuffer(const private_handle_t *handle) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   auto status = Error::NONE;
 
   private_handle_t *hnd = const_cast<private_handle_t *>(handle);
@@ -1114,7 +1132,7 @@ Error BufferManager::RereadBuffer(const private_handle_t *handle) {
 }
 
 Error BufferManager::UnlockBuffer(const private_handle_t *handle) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   auto status = Error::NONE;
 
   private_handle_t *hnd = const_cast<private_handle_t *>(handle);
@@ -1143,7 +1161,7 @@ Error BufferManager::AllocateBuffer(const BufferDescriptor &descriptor, buffer_h
                                     unsigned int bufferSize, bool testAlloc) {
   if (!handle)
     return Error::BAD_BUFFER;
-  std::lock_guard<std::mutex> buffer_lock(buffer_lock_);
+  std::lock_guard<std::mutex> alloc_lock(alloc_lock_);
 
   uint64_t usage = descriptor.GetUsage();
   int format = GetImplDefinedFormat(usage, descriptor.GetFormat());
@@ -1159,7 +1177,8 @@ Error BufferManager::AllocateBuffer(const BufferDescriptor &descriptor, buffer_h
   info.layer_count = layer_count;
 
   GraphicsMetadata graphics_metadata = {};
-  err = GetBufferSizeAndDimensions(info, &size, &alignedw, &alignedh, &graphics_metadata);
+  err = BufferInfoCache::GetInstance()->GetBufferSizeAndDimensions(info, &size, &alignedw,
+                                                                   &alignedh, &graphics_metadata);
   if (err == -ENOTSUP) {
     return Error::UNSUPPORTED;
   } else if (err < 0) {
@@ -1253,6 +1272,7 @@ Error BufferManager::AllocateBuffer(const BufferDescriptor &descriptor, buffer_h
 
   *handle = hnd;
 
+  std::lock_guard<std::mutex> lock(GetShard(hnd).lock);
   RegisterHandleLocked(hnd, data.ion_handle, e_data.ion_handle);
   ALOGD_IF(DEBUG, "Allocated buffer handle: %p id: %" PRIu64, hnd, hnd->id);
   if (DEBUG) {
@@ -1281,18 +1301,23 @@ void BufferManager:: BuffersDump() {
   }
   fs << "============================" << std::endl;
   fs << timeStamp << std::endl;
-  fs << "Total layers = " << handles_map_.size() << std::endl;
+  size_t totalLayers = 0;
   uint64_t totalAllocationSize = 0;
-  for (auto it : handles_map_) {
-    auto buf = it.second;
-    auto hnd = buf->handle;
-    auto metadata = reinterpret_cast<MetaData_t *>(hnd->base_metadata);
-    fs  << std::setw(80) << "Client:" << (metadata ? metadata->name: "No name");
-    fs  << std::setw(20) << "WxH:" << std::setw(4) << hnd->width << " x "
-        << std::setw(4) << hnd->height;
-    fs  << std::setw(20) << "Size: " << std::setw(9) << hnd->size <<  std::endl;
-    totalAllocationSize += hnd->size;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    totalLayers += shard.handles_map.size();
+    for (auto it : shard.handles_map) {
+      auto buf = it.second;
+      auto hnd = buf->handle;
+      auto metadata = reinterpret_cast<MetaData_t *>(hnd->base_metadata);
+      fs  << std::setw(80) << "Client:" << (metadata ? metadata->name: "No name");
+      fs  << std::setw(20) << "WxH:" << std::setw(4) << hnd->width << " x "
+          << std::setw(4) << hnd->height;
+      fs  << std::setw(20) << "Size: " << std::setw(9) << hnd->size <<  std::endl;
+      totalAllocationSize += hnd->size;
+    }
   }
+  fs << "Total layers = " << totalLayers << std::endl;
   fs << "Total allocation  = " << totalAllocationSize/1024 << "KiB" << std::endl;
   file_dump_.position = fs.tellp();
   if (file_dump_.position > (20 * 1024 * 1024)) {
@@ -1302,46 +1327,52 @@ void BufferManager:: BuffersDump() {
 }
 
 Error BufferManager::Dump(std::ostringstream *os) {
-  std::lock_guard<std::mutex> buffer_lock(buffer_lock_);
-  for (auto it : handles_map_) {
-    auto buf = it.second;
-    auto hnd = buf->handle;
-    *os << "handle id: " << std::setw(4) << hnd->id;
-    *os << " fd: " << std::setw(3) << hnd->fd;
-    *os << " fd_meta: " << std::setw(3) << hnd->fd_metadata;
-    *os << " wxh: " << std::setw(4) << hnd->width << " x " << std::setw(4) << hnd->height;
-    *os << " uwxuh: " << std::setw(4) << hnd->unaligned_width << " x ";
-    *os << std::setw(4) << hnd->unaligned_height;
-    *os << " size: " << std::setw(9) << hnd->size;
-    *os << std::hex << std::setfill('0');
-    *os << " priv_flags: "
-        << "0x" << std::setw(8) << hnd->flags;
-    *os << " usage: "
-        << "0x" << std::setw(8) << hnd->usage;
-    // TODO(user): get format string from qdutils
-    *os << " format: "
-        << "0x" << std::setw(8) << hnd->format;
-    *os << std::dec << std::setfill(' ') << std::endl;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    for (auto it : shard.handles_map) {
+      auto buf = it.second;
+      auto hnd = buf->handle;
+      *os << "handle id: " << std::setw(4) << hnd->id;
+      *os << " fd: " << std::setw(3) << hnd->fd;
+      *os << " fd_meta: " << std::setw(3) << hnd->fd_metadata;
+      *os << " wxh: " << std::setw(4) << hnd->width << " x " << std::setw(4) << hnd->height;
+      *os << " uwxuh: " << std::setw(4) << hnd->unaligned_width << " x ";
+      *os << std::setw(4) << hnd->unaligned_height;
+      *os << " size: " << std::setw(9) << hnd->size;
+      *os << std::hex << std::setfill('0');
+      *os << " priv_flags: "
+          << "0x" << std::setw(8) << hnd->flags;
+      *os << " usage: "
+          << "0x" << std::setw(8) << hnd->usage;
+      // TODO(user): get format string from qdutils
+      *os << " format: "
+          << "0x" << std::setw(8) << hnd->format;
+      *os << std::dec << std::setfill(' ') << std::endl;
+    }
   }
+  uint64_t hits = 0, misses = 0;
+  BufferInfoCache::GetInstance()->GetStats(&hits, &misses);
+  *os << "buffer info cache hits: " << hits << " misses: " << misses << std::endl;
   return Error::NONE;
 }
 
-// Get list of private handles in handles_map_
+// Get list of private handles in all handle map shards
 Error BufferManager::GetAllHandles(std::vector<const private_handle_t *> *out_handle_list) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
-  if (handles_map_.empty()) {
-    return Error::NO_RESOURCES;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    for (auto handle : shard.handles_map) {
+      out_handle_list->push_back(handle.first);
+    }
   }
-  out_handle_list->reserve(handles_map_.size());
-  for (auto handle : handles_map_) {
-    out_handle_list->push_back(handle.first);
+  if (out_handle_list->empty()) {
+    return Error::NO_RESOURCES;
   }
   return Error::NONE;
 }
 
 Error BufferManager::GetReservedRegion(private_handle_t *handle, void **reserved_region,
                                        uint64_t *reserved_region_size) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   if (!handle)
     return Error::BAD_BUFFER;
 
@@ -1360,7 +1391,7 @@ Error BufferManager::GetReservedRegion(private_handle_t *handle, void **reserved
 
 Error BufferManager::GetMetadata(private_handle_t *handle, int64_t metadatatype_value,
                                  hidl_vec<uint8_t> *out) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   if (!handle)
     return Error::BAD_BUFFER;
   auto buf = GetBufferFromHandleLocked(handle);
@@ -1701,7 +1732,7 @@ Error BufferManager::GetMetadata(private_handle_t *handle, int64_t metadatatype_
 
 Error BufferManager::SetMetadata(private_handle_t *handle, int64_t metadatatype_value,
                                  hidl_vec<uint8_t> in) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   if (!handle)
     return Error::BAD_BUFFER;
 
@@ -58,6 +58,8 @@
 
 #include <pthread.h>
 
+#include <array>
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -103,7 +105,7 @@ class BufferManager {
   // Imports the ion fds into the current process. Returns an error for invalid handles
   Error ImportHandleLocked(private_handle_t *hnd);
 
-  // Creates a Buffer from the valid private handle and adds it to the map
+  // Creates a Buffer from the valid private handle and adds it to its shard's map
   void RegisterHandleLocked(const private_handle_t *hnd, int ion_handle, int ion_handle_meta);
 
   // Wrapper structure over private handle
@@ -113,7 +115,9 @@ class BufferManager {
   // unlike private_handle_t
   struct Buffer {
     const private_handle_t *handle = nullptr;
-    int ref_count = 1;
+    // Only changed under the shard lock, atomic so that the count stays exact for any path
+    // that takes or drops a reference on a Buffer it holds a shared_ptr to
+    std::atomic<int> ref_count{1};
     // Hold the main and metadata ion handles
     // Freed from the allocator process
     // and unused in the mapping process
@@ -123,21 +127,35 @@ class BufferManager {
     Buffer() = delete;
     explicit Buffer(const private_handle_t *h, int ih_main = -1, int ih_meta = -1)
         : handle(h), ion_handle_main(ih_main), ion_handle_meta(ih_meta) {}
-    void IncRef() { ++ref_count; }
-    bool DecRef() { return --ref_count == 0; }
+    void IncRef() { ref_count.fetch_add(1, std::memory_order_relaxed); }
+    bool DecRef() { return ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1; }
     uint64_t reserved_size = 0;
     void *reserved_region_ptr = nullptr;
   };
 
   Error FreeBuffer(std::shared_ptr<Buffer> buf);
 
+  // Handles are spread over shards by address so that clients working on
+  // unrelated buffers do not contend on a single lock. A shard's lock guards
+  // its map and every Buffer in it.
+  static const size_t kHandleShards = 32;
+  struct HandleShard {
+    std::mutex lock;
+    std::unordered_map<const private_handle_t *, std::shared_ptr<Buffer>> handles_map;
+  };
+  HandleShard &GetShard(const private_handle_t *hnd);
+
   // Get the wrapper Buffer object from the handle, returns nullptr if handle is not found
+  // Caller must hold the lock of the handle's shard
   std::shared_ptr<Buffer> GetBufferFromHandleLocked(const private_handle_t *hnd);
   Allocator *allocator_ = NULL;
-  std::mutex buffer_lock_;
-  std::unordered_map<const private_handle_t *, std::shared_ptr<Buffer>> handles_map_ = {};
+  std::array<HandleShard, kHandleShards> shards_;
+  // Serializes allocations, does not block import/lock/metadata calls
+  std::mutex alloc_lock_;
+  // Guards kAllocThreshold and file_dump_
+  std::mutex dump_lock_;
   std::atomic<uint64_t> next_id_;
-  uint64_t allocated_ = 0;
+  std::atomic<uint64_t> allocated_{0};
   uint64_t kAllocThreshold = (uint64_t)2*1024*1024*1024;
   uint64_t kMemoryOffset = 50*1024*1024;
   struct {
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <cutils/native_handle.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "gr_buf_descriptor.h"
+#include "gr_buf_mgr.h"
+
+namespace gralloc {
+
+// Mapper clients in several threads import, retain and free the same buffers, while dumps walk
+// every shard. Each buffer must end up with the one reference its allocation took.
+TEST(BufferManagerTest, ConcurrentImportAndRelease) {
+  const int kBuffers = 16;
+  const int kThreads = 8;
+  const int kIterations = 2000;
+  BufferManager *buf_mgr = BufferManager::GetInstance();
+
+  std::vector<const private_handle_t *> buffers;
+  for (int i = 0; i < kBuffers; i++) {
+    BufferDescriptor descriptor(static_cast<uint64_t>(i));
+    descriptor.SetDimensions(64 + i, 64);
+    descriptor.SetColorFormat(HAL_PIXEL_FORMAT_RGBA_8888);
+    descriptor.SetLayerCount(1);
+    descriptor.SetUsage(GRALLOC_USAGE_SW_READ_OFTEN | GRALLOC_USAGE_SW_WRITE_OFTEN);
+    buffer_handle_t handle = nullptr;
+    ASSERT_EQ(Error::NONE, buf_mgr->AllocateBuffer(descriptor, &handle));
+    buffers.push_back(static_cast<const private_handle_t *>(handle));
+  }
+
+  std::atomic<int> failures(0);
+  std::atomic<bool> done(false);
+  std::thread dumper([&] {
+    while (!done.load()) {
+      std::ostringstream os;
+      std::vector<const private_handle_t *> handles;
+      buf_mgr->Dump(&os);
+      buf_mgr->GetAllHandles(&handles);
+    }
+  });
+
+  auto begin = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kIterations; i++) {
+        const private_handle_t *buffer = buffers[(t * 7 + i) % kBuffers];
+        // Another reference on the shared Buffer, contended by every thread
+        if (buf_mgr->RetainBuffer(buffer) != Error::NONE) {
+          failures++;
+          continue;
+        }
+        // A clone is a new handle to the same buffer, as importBuffer creates it
+        native_handle_t *clone = native_handle_clone(buffer);
+        auto import = static_cast<const private_handle_t *>(clone);
+        if (buf_mgr->RetainBuffer(import) != Error::NONE ||
+            buf_mgr->IsBufferImported(import) != Error::NONE ||
+            buf_mgr->ReleaseBuffer(import) != Error::NONE) {
+          failures++;
+        }
+        if (buf_mgr->ReleaseBuffer(buffer) != Error::NONE) {
+          failures++;
+        }
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - begin;
+  done = true;
+  dumper.join();
+  EXPECT_EQ(0, failures.load());
+
+  // Every clone was freed, only the allocations are left
+  std::vector<const private_handle_t *> handles;
+  ASSERT_EQ(Error::NONE, buf_mgr->GetAllHandles(&handles));
+  std::sort(handles.begin(), handles.end());
+  std::vector<const private_handle_t *> expected = buffers;
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(expected, handles);
+
+  // One reference each, the first release frees the buffer
+  for (const private_handle_t *buffer : buffers) {
+    EXPECT_EQ(Error::NONE, buf_mgr->ReleaseBuffer(buffer));
+    EXPECT_EQ(Error::BAD_BUFFER, buf_mgr->IsBufferImported(buffer));
+  }
+
+  std::cout << kThreads << " threads: "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+                   (kThreads * kIterations)
+            << " ns per import and release" << std::endl;
+}
+
+}  // namespace gralloc
@@ -106,6 +106,7 @@ struct GrallocProperties {
   bool use_system_heap_for_sensors = true;
   bool ubwc_disable = false;
   bool ahardware_buffer_disable = false;
+  bool validate_buffer_info_cache = false;
 };
 
 template <class Type1, class Type2>
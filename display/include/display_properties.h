@@ -112,6 +112,9 @@
 #define ENABLE_GPU_TONEMAPPER_PROP           DISPLAY_PROP("enable_gpu_tonemapper")
 #define ENABLE_FORCE_SPLIT                   DISPLAY_PROP("enable_force_split")
 #define DISABLE_GPU_COLOR_CONVERT            DISPLAY_PROP("disable_gpu_color_convert")
+// Run HWC tone mapping and colour conversion on the CPU instead of GLES. Off by default, the CPU
+// tone map is synchronous and too slow for the present path at full frame rates.
+#define ENABLE_CPU_COLOR_BACKEND_PROP        DISPLAY_PROP("enable_cpu_color_backend")
 #define ENABLE_ASYNC_VDS_CREATION            DISPLAY_PROP("enable_async_vds_creation")
 // MMNOC efficiency factor for Camera and Non-Camera cases
 #define NORMAL_NOC_EFFICIENCY_FACTOR         DISPLAY_PROP("normal_noc_efficiency_factor")
@@ -146,6 +149,7 @@
 #define WINDOW_RECT_PROP                     DISPLAY_PROP("window_rect")
 #define DISABLE_IDLE_TIME_HDR                DISPLAY_PROP("disable_idle_time_hdr")
 #define DISABLE_IDLE_TIME_VIDEO              DISPLAY_PROP("disable_idle_time_video")
+#define DISABLE_DEFAULT_STRATEGY_PROP        DISPLAY_PROP("disable_default_strategy")
 // Add all other.properties above
 // End of property
 #endif  // __DISPLAY_PROPERTIES_H__
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __SOFTWARE_CONVERTER_KERNELS_H__
+#define __SOFTWARE_CONVERTER_KERNELS_H__
+
+#include <stddef.h>
+
+#if defined(__aarch64__) || defined(__ARM_NEON) || defined(__ARM_HAVE_NEON)
+#include <arm_neon.h>
+#define COPYBIT_USE_NEON
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COPYBIT_USE_SSE2
+#endif
+
+typedef void (*interleave_fn)(unsigned char *dst, const unsigned char *cr,
+                              const unsigned char *cb, size_t count);
+
+/* Writes count Cr/Cb pairs to dst, Cr first as in YCrCb_420_SP */
+static void interleaveChromaC(unsigned char *dst, const unsigned char *cr,
+                              const unsigned char *cb, size_t count)
+{
+    for(size_t i = 0; i < count; i++) {
+        dst[i*2]   = cr[i];
+        dst[i*2+1] = cb[i];
+    }
+}
+
+#if defined(COPYBIT_USE_NEON)
+static void interleaveChromaNeon(unsigned char *dst, const unsigned char *cr,
+                                 const unsigned char *cb, size_t count)
+{
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        uint8x16x2_t pairs;
+        pairs.val[0] = vld1q_u8(cr + i);
+        pairs.val[1] = vld1q_u8(cb + i);
+        vst2q_u8(dst + i*2, pairs);
+    }
+    interleaveChromaC(dst + i*2, cr + i, cb + i, count - i);
+}
+#endif
+
+#if defined(COPYBIT_USE_SSE2)
+__attribute__((target("sse2")))
+static void interleaveChromaSse2(unsigned char *dst, const unsigned char *cr,
+                                 const unsigned char *cb, size_t count)
+{
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(cr + i));
+        __m128i u = _mm_loadu_si128((const __m128i *)(cb + i));
+        _mm_storeu_si128((__m128i *)(dst + i*2), _mm_unpacklo_epi8(v, u));
+        _mm_storeu_si128((__m128i *)(dst + i*2 + 16), _mm_unpackhi_epi8(v, u));
+    }
+    interleaveChromaC(dst + i*2, cr + i, cb + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static void interleaveChromaAvx2(unsigned char *dst, const unsigned char *cr,
+                                 const unsigned char *cb, size_t count)
+{
+    size_t i = 0;
+    for(; i + 32 <= count; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(cr + i));
+        __m256i u = _mm256_loadu_si256((const __m256i *)(cb + i));
+        // unpack works within 128 bit lanes, put the lanes back in order
+        __m256i lo = _mm256_unpacklo_epi8(v, u);
+        __m256i hi = _mm256_unpackhi_epi8(v, u);
+        _mm256_storeu_si256((__m256i *)(dst + i*2),
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + i*2 + 32),
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    interleaveChromaSse2(dst + i*2, cr + i, cb + i, count - i);
+}
+#endif
+
+static interleave_fn selectInterleaveChroma()
+{
+#if defined(COPYBIT_USE_NEON)
+    return interleaveChromaNeon;
+#elif defined(COPYBIT_USE_SSE2)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        return interleaveChromaAvx2;
+    }
+    return interleaveChromaSse2;
+#else
+    return interleaveChromaC;
+#endif
+}
+
+static void interleaveChroma(unsigned char *dst, const unsigned char *cr,
+                             const unsigned char *cb, size_t count)
+{
+    static const interleave_fn fn = selectInterleaveChroma();
+    fn(dst, cr, cb, count);
+}
+
+/* Interleaves rows of count samples from chroma planes padded to
+ * src_stride, the destination rows are packed without padding */
+static void interleaveChromaRows(unsigned char *dst, const unsigned char *cr,
+                                 const unsigned char *cb, size_t src_stride,
+                                 size_t count, size_t rows)
+{
+    for(size_t r = 0; r < rows; r++) {
+        interleaveChroma(dst + r * count * 2, cr + r * src_stride,
+                         cb + r * src_stride, count);
+    }
+}
+
+#endif // __SOFTWARE_CONVERTER_KERNELS_H__
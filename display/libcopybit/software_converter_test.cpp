@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "software_converter_kernels.h"
+
+namespace {
+
+struct Kernel {
+    const char *name;
+    interleave_fn fn;
+};
+
+/* Every kernel this build and CPU can run, the scalar one first */
+std::vector<Kernel> availableKernels()
+{
+    std::vector<Kernel> kernels = {{"C", interleaveChromaC}};
+#if defined(COPYBIT_USE_NEON)
+    kernels.push_back({"NEON", interleaveChromaNeon});
+#elif defined(COPYBIT_USE_SSE2)
+    kernels.push_back({"SSE2", interleaveChromaSse2});
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        kernels.push_back({"AVX2", interleaveChromaAvx2});
+    }
+#endif
+    kernels.push_back({"dispatch", interleaveChroma});
+    return kernels;
+}
+
+std::vector<unsigned char> randomBytes(size_t size, unsigned int seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<unsigned char> bytes(size);
+    for(auto &b : bytes) {
+        b = (unsigned char)dist(gen);
+    }
+    return bytes;
+}
+
+/* The conversion as written before the vector kernels */
+void referenceRows(unsigned char *dst, const unsigned char *cr, const unsigned char *cb,
+                   size_t src_stride, size_t count, size_t rows)
+{
+    for(size_t r = 0; r < rows; r++) {
+        for(size_t i = 0; i < count; i++) {
+            dst[r * count * 2 + i * 2]     = cr[r * src_stride + i];
+            dst[r * count * 2 + i * 2 + 1] = cb[r * src_stride + i];
+        }
+    }
+}
+
+} // namespace
+
+/* Counts around each vector width and its tails, at every source alignment */
+TEST(SoftwareConverterTest, KernelsMatchScalar)
+{
+    const unsigned char kGuard = 0xa5;
+    std::vector<unsigned char> cr = randomBytes(256, 1);
+    std::vector<unsigned char> cb = randomBytes(256, 2);
+
+    for(const Kernel &kernel : availableKernels()) {
+        for(size_t offset = 0; offset < 4; offset++) {
+            for(size_t count = 0; count <= 200; count++) {
+                std::vector<unsigned char> expected(count * 2 + 8, kGuard);
+                std::vector<unsigned char> actual(count * 2 + 8, kGuard);
+                interleaveChromaC(expected.data() + offset, cr.data() + offset,
+                                  cb.data() + offset, count);
+                kernel.fn(actual.data() + offset, cr.data() + offset,
+                          cb.data() + offset, count);
+                ASSERT_EQ(expected, actual) << kernel.name << " count " << count
+                                            << " offset " << offset;
+            }
+        }
+    }
+}
+
+/* Odd widths with the source rows padded to the 16 aligned chroma stride */
+TEST(SoftwareConverterTest, PaddedRowsMatchScalar)
+{
+    const size_t kWidths[] = {2, 18, 34, 50, 66, 130, 258, 642, 1282, 1922};
+    const size_t kRows = 9;
+
+    for(size_t width : kWidths) {
+        size_t count = width / 2;
+        size_t stride = (count + 15) & ~(size_t)15;
+        for(size_t src_stride : {stride, stride + 16, stride + 48}) {
+            std::vector<unsigned char> cr = randomBytes(src_stride * kRows, 3);
+            std::vector<unsigned char> cb = randomBytes(src_stride * kRows, 4);
+            std::vector<unsigned char> expected(count * 2 * kRows);
+            std::vector<unsigned char> actual(count * 2 * kRows);
+            referenceRows(expected.data(), cr.data(), cb.data(), src_stride, count, kRows);
+            interleaveChromaRows(actual.data(), cr.data(), cb.data(), src_stride, count,
+                                 kRows);
+            ASSERT_EQ(expected, actual) << "width " << width << " stride " << src_stride;
+        }
+    }
+}
+
+/* YV12 chroma of a full frame, per kernel */
+TEST(SoftwareConverterTest, InterleaveTime)
+{
+    const struct {
+        const char *name;
+        size_t width;
+        size_t height;
+    } kSizes[] = {{"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4K", 3840, 2160}};
+    const int kIterations = 50;
+
+    for(const auto &size : kSizes) {
+        size_t count = size.width / 2 * size.height / 2;
+        std::vector<unsigned char> cr = randomBytes(count, 5);
+        std::vector<unsigned char> cb = randomBytes(count, 6);
+        std::vector<unsigned char> dst(count * 2);
+        for(const Kernel &kernel : availableKernels()) {
+            auto begin = std::chrono::steady_clock::now();
+            for(int i = 0; i < kIterations; i++) {
+                kernel.fn(dst.data(), cr.data(), cb.data(), count);
+            }
+            auto time = std::chrono::steady_clock::now() - begin;
+            std::cout << size.name << " " << kernel.name << ": "
+                      << std::chrono::duration_cast<std::chrono::microseconds>(time).count() /
+                             kIterations
+                      << " us per frame" << std::endl;
+        }
+    }
+}
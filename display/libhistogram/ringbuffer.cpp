@@ -17,7 +17,8 @@
 #include <log/log.h>
 #include <unistd.h>
 #include <algorithm>
-#include <iostream>
+#include <chrono>
+#include <limits>
 
 #include "ringbuffer.h"
 
@@ -26,7 +27,13 @@ nsecs_t histogram::DefaultTimeKeeper::current_time() const {
 }
 
 histogram::Ringbuffer::Ringbuffer(size_t ringbuffer_size, std::unique_ptr<histogram::TimeKeeper> tk)
-    : rb_max_size(ringbuffer_size), timekeeper(std::move(tk)), cumulative_frame_count(0) {
+    : ringbuffer(ringbuffer_size),
+      rb_head(0),
+      rb_size(0),
+      latest_frame{},
+      rb_max_size(ringbuffer_size),
+      timekeeper(std::move(tk)),
+      cumulative_frame_count(0) {
   cumulative_bins.fill(0);
 }
 
@@ -38,55 +45,76 @@ std::unique_ptr<histogram::Ringbuffer> histogram::Ringbuffer::create(
       new histogram::Ringbuffer(ringbuffer_size, std::move(tk)));
 }
 
+// age 0 is the most recently inserted frame
+histogram::Ringbuffer::HistogramEntry const &histogram::Ringbuffer::entry_at(size_t age) const {
+  return ringbuffer[(rb_head + rb_max_size - age) % rb_max_size];
+}
+
+void histogram::Ringbuffer::weighted_add(Bins &bins, drm_msm_hist const &frame, nsecs_t start,
+                                         nsecs_t end) const {
+  const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::nanoseconds(end - start));
+  for (auto i = 0u; i < HIST_V_SIZE; i++) {
+    bins[i] += frame.data[i] * delta.count();
+  }
+}
+
 void histogram::Ringbuffer::update_cumulative(nsecs_t now, uint64_t &count,
                                               std::array<uint64_t, HIST_V_SIZE> &bins) const {
-  if (ringbuffer.empty())
+  if (rb_size == 0)
     return;
 
   count++;
-  ALOGI("count : %llu", static_cast<unsigned long long>(count));
 
   const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(
-      std::chrono::nanoseconds(now - ringbuffer.front().start_timestamp));
+      std::chrono::nanoseconds(now - entry_at(0).start_timestamp));
 
   for (auto i = 0u; i < bins.size(); i++) {
-    ALOGI("histogram.data[%d]: %u\n", i, ringbuffer.front().histogram.data[i]);
-    auto const increment = ringbuffer.front().histogram.data[i] * delta.count();
+    auto const increment = latest_frame.data[i] * delta.count();
     if (CC_UNLIKELY((bins[i] + increment < bins[i]) ||
-                    (increment < ringbuffer.front().histogram.data[i]))) {
+                    (increment < latest_frame.data[i]))) {
       bins[i] = std::numeric_limits<uint64_t>::max();
     } else {
       bins[i] += increment;
     }
-    ALOGI("bins[%d]: %llu\n", i, static_cast<unsigned long long>(bins[i]));
   }
 }
 
 void histogram::Ringbuffer::insert(drm_msm_hist const &frame) {
-  std::cout << "Enter insert ringbuffer" << std::endl;
-
   std::unique_lock<decltype(mutex)> lk(mutex);
   auto now = timekeeper->current_time();
 
-  std::cout << "update cumulative count" << std::endl;
   update_cumulative(now, cumulative_frame_count, cumulative_bins);
 
-  if (ringbuffer.size() == rb_max_size)
-    ringbuffer.pop_back();
-  if (!ringbuffer.empty())
-    ringbuffer.front().end_timestamp = now;
+  Bins prefix_bins;
+  prefix_bins.fill(0);
+  if (rb_size != 0) {
+    // the previous frame is now complete, fold it into the running sum
+    prefix_bins = entry_at(0).prefix_bins;
+    weighted_add(prefix_bins, latest_frame, entry_at(0).start_timestamp, now);
+  }
 
-  std::cout << "Exit insert ringbuffer" << std::endl;
-  ringbuffer.push_front({frame, now, 0});
+  rb_head = (rb_head + 1) % rb_max_size;
+  rb_size = std::min(rb_size + 1, rb_max_size);
+  ringbuffer[rb_head] = {now, prefix_bins};
+  latest_frame = frame;
 }
 
 bool histogram::Ringbuffer::resize(size_t ringbuffer_size) {
   std::unique_lock<decltype(mutex)> lk(mutex);
   if (ringbuffer_size == 0)
     return false;
+
+  // keep the newest frames, oldest first, at the start of the new array
+  auto const keep = std::min(rb_size, ringbuffer_size);
+  std::vector<HistogramEntry> resized(ringbuffer_size);
+  for (auto age = 0u; age < keep; age++) {
+    resized[keep - 1 - age] = entry_at(age);
+  }
+  ringbuffer.swap(resized);
   rb_max_size = ringbuffer_size;
-  if (ringbuffer.size() > rb_max_size)
-    ringbuffer.resize(rb_max_size);
+  rb_size = keep;
+  rb_head = keep ? keep - 1 : 0;
   return true;
 }
 
@@ -99,12 +127,12 @@ histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_cumulative() const
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_ringbuffer_all() const {
   std::unique_lock<decltype(mutex)> lk(mutex);
-  return collect_max(ringbuffer.size(), lk);
+  return collect_max(rb_size, lk);
 }
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_after(nsecs_t timestamp) const {
   std::unique_lock<decltype(mutex)> lk(mutex);
-  return collect_max_after(timestamp, ringbuffer.size(), lk);
+  return collect_max_after(timestamp, rb_size, lk);
 }
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_max(uint32_t max_frames) const {
@@ -120,33 +148,36 @@ histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_max_after(nsecs_t t
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_max(
     uint32_t max_frames, std::unique_lock<std::mutex> const &) const {
-  auto collect_first = std::min(static_cast<size_t>(max_frames), ringbuffer.size());
+  auto collect_first = std::min(static_cast<size_t>(max_frames), rb_size);
   if (collect_first == 0)
     return {0, {}};
+
+  // completed frames are the running sum difference, the newest one is
+  // weighted up to now
+  auto const &newest = entry_at(0);
+  auto const &oldest = entry_at(collect_first - 1);
   std::array<uint64_t, HIST_V_SIZE> bins;
-  bins.fill(0);
-  for (auto it = ringbuffer.begin(); it != ringbuffer.end() &&
-    it != ringbuffer.begin() + collect_first; it++) {
-    nsecs_t end_timestamp = it->end_timestamp;
-    if (it == ringbuffer.begin()) {
-      end_timestamp = timekeeper->current_time();
-    }
-    const auto time_displayed = std::chrono::nanoseconds(end_timestamp - it->start_timestamp);
-    const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(time_displayed);
-    for (auto i = 0u; i < HIST_V_SIZE; i++) {
-      bins[i] += it->histogram.data[i] * delta.count();
-    }
+  for (auto i = 0u; i < HIST_V_SIZE; i++) {
+    bins[i] = newest.prefix_bins[i] - oldest.prefix_bins[i];
   }
+  weighted_add(bins, latest_frame, newest.start_timestamp, timekeeper->current_time());
   return {collect_first, bins};
 }
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_max_after(
     nsecs_t timestamp, uint32_t max_frames, std::unique_lock<std::mutex> const &lk) const {
-  auto ts_filter_begin = std::lower_bound(
-      ringbuffer.begin(), ringbuffer.end(), HistogramEntry{{}, timestamp, 0},
-      [](auto const &a, auto const &b) { return a.start_timestamp >= b.start_timestamp; });
+  // start timestamps decrease with age, find the first frame started before timestamp
+  size_t lo = 0;
+  size_t hi = rb_size;
+  while (lo < hi) {
+    auto const mid = lo + (hi - lo) / 2;
+    if (entry_at(mid).start_timestamp >= timestamp) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
 
-  auto collect_last = std::min(std::distance(ringbuffer.begin(), ts_filter_begin),
-                               static_cast<std::ptrdiff_t>(max_frames));
+  auto collect_last = std::min(lo, static_cast<size_t>(max_frames));
   return collect_max(collect_last, lk);
 }
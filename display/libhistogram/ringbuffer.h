@@ -59,10 +59,10 @@
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <array>
-#include <deque>
 #include <memory>
 #include <mutex>
 #include <tuple>
+#include <vector>
 
 namespace histogram {
 
@@ -106,12 +106,25 @@ class Ringbuffer {
                          std::array<uint64_t, HIST_V_SIZE> &bins) const;
 
   std::mutex mutable mutex;
+  using Bins = std::array<uint64_t, HIST_V_SIZE>;
+  /*
+   * Frames are kept in a fixed-capacity circular array. Instead of the
+   * histogram itself, each slot stores the running sum of the time-weighted
+   * bins of every frame inserted before it, so the weighted sum of any run
+   * of completed frames is the difference of two slots. Only the newest
+   * frame, whose display time is still growing, keeps its histogram.
+   */
   struct HistogramEntry {
-    drm_msm_hist histogram;
     nsecs_t start_timestamp;
-    nsecs_t end_timestamp;
+    Bins prefix_bins;
   };
-  std::deque<HistogramEntry> ringbuffer;
+  HistogramEntry const &entry_at(size_t age) const;
+  void weighted_add(Bins &bins, drm_msm_hist const &frame, nsecs_t start, nsecs_t end) const;
+
+  std::vector<HistogramEntry> ringbuffer;
+  size_t rb_head;
+  size_t rb_size;
+  drm_msm_hist latest_frame;
   size_t rb_max_size;
   std::unique_ptr<TimeKeeper> const timekeeper;
 
@@ -14,8 +14,12 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
+#include <iostream>
 #include <numeric>
+#include <random>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -407,6 +411,141 @@ TEST_F(RingbufferTestCases, TimeWeightingTest) {
   }
 }
 
+// Straightforward deque implementation the circular prefix-sum ringbuffer must match.
+struct ReferenceRingbuffer {
+  ReferenceRingbuffer(size_t size, TickingTimeKeeper const &tk) : max_size(size), tk(tk) {}
+
+  void insert(drm_msm_hist const &frame) {
+    auto now = tk.current_time();
+    if (entries.size() == max_size)
+      entries.pop_back();
+    if (!entries.empty())
+      entries.front().end_timestamp = now;
+    entries.push_front({frame, now, 0});
+  }
+
+  void resize(size_t size) {
+    max_size = size;
+    if (entries.size() > max_size)
+      entries.resize(max_size);
+  }
+
+  histogram::Ringbuffer::Sample collect_max(uint32_t max_frames) const {
+    auto collect_first = std::min(static_cast<size_t>(max_frames), entries.size());
+    if (collect_first == 0)
+      return {0, {}};
+    std::array<uint64_t, HIST_V_SIZE> bins;
+    bins.fill(0);
+    for (auto it = entries.begin(); it != entries.begin() + collect_first; it++) {
+      nsecs_t end_timestamp = (it == entries.begin()) ? tk.current_time() : it->end_timestamp;
+      auto delta = toMs(std::chrono::nanoseconds(end_timestamp - it->start_timestamp));
+      for (auto i = 0u; i < HIST_V_SIZE; i++) {
+        bins[i] += it->histogram.data[i] * delta;
+      }
+    }
+    return {collect_first, bins};
+  }
+
+  histogram::Ringbuffer::Sample collect_max_after(nsecs_t timestamp, uint32_t max_frames) const {
+    auto count = std::count_if(entries.begin(), entries.end(),
+                               [timestamp](auto const &e) { return e.start_timestamp >= timestamp; });
+    return collect_max(std::min(static_cast<uint32_t>(count), max_frames));
+  }
+
+  struct Entry {
+    drm_msm_hist histogram;
+    nsecs_t start_timestamp;
+    nsecs_t end_timestamp;
+  };
+  std::deque<Entry> entries;
+  size_t max_size;
+  TickingTimeKeeper const &tk;
+};
+
+class RingbufferEquivalence : public ::testing::TestWithParam<size_t> {
+ protected:
+  void SetUp() {
+    tk = std::make_shared<TickingTimeKeeper>();
+    rb = histogram::Ringbuffer::create(GetParam(), std::make_unique<TimeKeeperWrapper>(tk));
+    ref = std::make_unique<ReferenceRingbuffer>(GetParam(), *tk);
+  }
+
+  void insert_random_frame() {
+    drm_msm_hist frame;
+    for (auto i = 0u; i < HIST_V_SIZE; i++) {
+      frame.data[i] = rng() % 100000;
+    }
+    rb->insert(frame);
+    ref->insert(frame);
+    tk->increment_by(std::chrono::microseconds(rng() % 50000));
+  }
+
+  std::mt19937 rng{1234};
+  std::shared_ptr<TickingTimeKeeper> tk;
+  std::unique_ptr<histogram::Ringbuffer> rb;
+  std::unique_ptr<ReferenceRingbuffer> ref;
+};
+
+TEST_P(RingbufferEquivalence, MatchesReferenceOnRandomQueries) {
+  auto const capacity = GetParam();
+  for (auto frame = 0u; frame < 3 * capacity + 7; frame++) {
+    insert_random_frame();
+
+    uint32_t max_frames = rng() % (capacity + 2);
+    EXPECT_THAT(rb->collect_max(max_frames), Eq(ref->collect_max(max_frames)));
+    EXPECT_THAT(rb->collect_ringbuffer_all(), Eq(ref->collect_max(capacity)));
+
+    auto timestamp = static_cast<nsecs_t>(rng() % (tk->current_time() + 1));
+    EXPECT_THAT(rb->collect_after(timestamp),
+                Eq(ref->collect_max_after(timestamp, std::numeric_limits<uint32_t>::max())));
+    EXPECT_THAT(rb->collect_max_after(timestamp, max_frames),
+                Eq(ref->collect_max_after(timestamp, max_frames)));
+  }
+}
+
+TEST_P(RingbufferEquivalence, MatchesReferenceAcrossResize) {
+  auto capacity = GetParam();
+  for (auto round = 0u; round < 6; round++) {
+    for (auto frame = 0u; frame < capacity + round; frame++) {
+      insert_random_frame();
+    }
+    capacity = (round % 2) ? capacity * 2 : std::max<size_t>(1, capacity / 3);
+    EXPECT_TRUE(rb->resize(capacity));
+    ref->resize(capacity);
+    EXPECT_THAT(rb->collect_ringbuffer_all(), Eq(ref->collect_max(capacity)));
+    EXPECT_THAT(rb->collect_after(tk->current_time() / 2),
+                Eq(ref->collect_max_after(tk->current_time() / 2, capacity)));
+  }
+}
+
+TEST_P(RingbufferEquivalence, QueryCost) {
+  auto const capacity = GetParam();
+  for (auto frame = 0u; frame < capacity; frame++) {
+    insert_random_frame();
+  }
+
+  static constexpr int numQueries = 1000;
+  uint64_t checksum = 0;
+  auto begin = std::chrono::steady_clock::now();
+  for (auto i = 0; i < numQueries; i++) {
+    checksum += std::get<1>(rb->collect_max_after(tk->current_time() / 2, capacity))[0];
+  }
+  auto rb_time = std::chrono::steady_clock::now() - begin;
+
+  begin = std::chrono::steady_clock::now();
+  for (auto i = 0; i < numQueries; i++) {
+    checksum -= std::get<1>(ref->collect_max_after(tk->current_time() / 2, capacity))[0];
+  }
+  auto ref_time = std::chrono::steady_clock::now() - begin;
+
+  EXPECT_THAT(checksum, Eq(0u));
+  std::cout << "capacity " << capacity << ": ringbuffer "
+            << toNsecs(rb_time) / numQueries << "ns/query, reference "
+            << toNsecs(ref_time) / numQueries << "ns/query" << std::endl;
+}
+
+INSTANTIATE_TEST_SUITE_P(Capacities, RingbufferEquivalence, Values(1, 4, 300, 1200));
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
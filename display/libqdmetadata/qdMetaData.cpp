@@ -74,8 +74,12 @@
 #include <log/log.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <cinttypes>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 static int colorMetaDataToColorSpace(ColorMetaData in, ColorSpace_t *out) {
   if (in.colorPrimaries == ColorPrimaries_BT601_6_525 ||
@@ -321,6 +325,168 @@ static void unmapAndReset(private_handle_t *handle) {
     }
 }
 
+// The *AndUnmap helpers used to mmap and munmap the metadata buffer on every
+// call. Their mappings are now kept in a process wide cache keyed by the
+// metadata fd, so repeated queries on the same handle only cost an fstat. An
+// entry remembers the buffer id and inode it was mapped for, and a lookup
+// through an fd that was closed and reused by another buffer drops the stale
+// entry. A cached mapping keeps the metadata buffer alive after the buffer is
+// freed, so every miss also unmaps the idle entries whose fd no longer refers
+// to their buffer, and idle mappings are evicted in LRU order once more than
+// kMaxCachedMetaDataBytes are mapped.
+namespace {
+
+struct MetaDataMapping {
+    int fd;
+    uint64_t id;
+    dev_t dev;
+    ino_t ino;
+    void *base;
+    size_t size;
+    uint32_t ref_count;
+    bool stale;  // Dropped while in use, unmapped on the last release
+};
+
+using MetaDataMappingList = std::list<MetaDataMapping>;
+
+const size_t kMaxCachedMetaDataBytes = 256 * 1024;
+
+std::mutex mapping_lock;
+// Most recently used first
+MetaDataMappingList mapping_lru;
+std::unordered_map<int, MetaDataMappingList::iterator> mapping_map;
+size_t mapped_bytes = 0;
+
+}  // namespace
+
+static void *mapMetaData(int fd, off_t file_size, size_t *out_size) {
+    // The metadata buffer is allocated with its reserved region, so its file
+    // size lets us map everything at once instead of peeking at reservedSize
+    size_t size = getMetaDataSize();
+    if (file_size > 0 && static_cast<size_t>(file_size) > size) {
+        size = static_cast<size_t>(file_size);
+    }
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == reinterpret_cast<void *>(MAP_FAILED)) {
+        ALOGE("%s: metadata mmap failed - fd: %d err: %s", __func__, fd, strerror(errno));
+        return nullptr;
+    }
+
+    auto metadata = reinterpret_cast<MetaData_t *>(base);
+    size_t required = getMetaDataSizeWithReservedRegion(metadata->reservedSize);
+    if (required > size) {
+        munmap(base, size);
+        size = required;
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == reinterpret_cast<void *>(MAP_FAILED)) {
+            ALOGE("%s: metadata mmap failed - fd: %d err: %s", __func__, fd, strerror(errno));
+            return nullptr;
+        }
+    }
+    *out_size = size;
+    return base;
+}
+
+// Must be called with mapping_lock held
+static MetaDataMappingList::iterator unmapMapping(MetaDataMappingList::iterator it) {
+    munmap(it->base, it->size);
+    mapped_bytes -= it->size;
+    return mapping_lru.erase(it);
+}
+
+// Must be called with mapping_lock held
+static void dropMapping(MetaDataMappingList::iterator it) {
+    mapping_map.erase(it->fd);
+    if (it->ref_count) {
+        it->stale = true;
+        return;
+    }
+    unmapMapping(it);
+}
+
+// Must be called with mapping_lock held. Unmaps idle entries of buffers that
+// were freed, i.e. whose fd was closed or now refers to another file.
+static void dropClosedMappings() {
+    for (auto it = mapping_lru.begin(); it != mapping_lru.end();) {
+        struct stat st;
+        if (it->ref_count || it->stale ||
+            (fstat(it->fd, &st) == 0 && st.st_dev == it->dev && st.st_ino == it->ino)) {
+            ++it;
+            continue;
+        }
+        mapping_map.erase(it->fd);
+        it = unmapMapping(it);
+    }
+}
+
+// Must be called with mapping_lock held
+static void evictIdleMappings() {
+    auto it = mapping_lru.end();
+    while (mapped_bytes > kMaxCachedMetaDataBytes && it != mapping_lru.begin()) {
+        --it;
+        if (it->ref_count) {
+            continue;
+        }
+        mapping_map.erase(it->fd);
+        it = unmapMapping(it);
+    }
+}
+
+static MetaData_t *acquireCachedMapping(private_handle_t *handle,
+                                        MetaDataMappingList::iterator *out_it) {
+    int fd = handle->fd_metadata;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ALOGE("%s: fstat failed - fd: %d err: %s", __func__, fd, strerror(errno));
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mapping_lock);
+    auto map_it = mapping_map.find(fd);
+    if (map_it != mapping_map.end()) {
+        auto it = map_it->second;
+        if (it->id == handle->id && it->dev == st.st_dev && it->ino == st.st_ino) {
+            it->ref_count++;
+            mapping_lru.splice(mapping_lru.begin(), mapping_lru, it);
+            *out_it = it;
+            return reinterpret_cast<MetaData_t *>(it->base);
+        }
+        // The fd was closed and reused by another buffer
+        dropMapping(it);
+    }
+
+    dropClosedMappings();
+    size_t size = 0;
+    void *base = mapMetaData(fd, st.st_size, &size);
+    if (!base) {
+        return nullptr;
+    }
+    mapping_lru.push_front({fd, handle->id, st.st_dev, st.st_ino, base, size, 1, false});
+    mapping_map[fd] = mapping_lru.begin();
+    mapped_bytes += size;
+    evictIdleMappings();
+    *out_it = mapping_lru.begin();
+    return reinterpret_cast<MetaData_t *>(base);
+}
+
+static void releaseCachedMapping(MetaDataMappingList::iterator it) {
+    std::lock_guard<std::mutex> lock(mapping_lock);
+    if (it->ref_count) {
+        it->ref_count--;
+    }
+    if (it->stale && !it->ref_count) {
+        unmapMapping(it);
+        return;
+    }
+    evictIdleMappings();
+}
+
+// Handles already mapped by their owner keep the old map-and-reset behavior
+static bool useCachedMapping(private_handle_t *handle) {
+    return private_handle_t::validate(handle) == 0 && handle->fd_metadata >= 0 &&
+           !handle->base_metadata;
+}
+
 int setMetaData(private_handle_t *handle, DispParamType paramType,
                 void *param) {
     auto err = validateAndMap(handle);
@@ -664,15 +830,35 @@ int copyMetaDataVaToVa(MetaData_t *src_data, MetaData_t *dst_data) {
 
 int setMetaDataAndUnmap(struct private_handle_t *handle, enum DispParamType paramType,
                         void *param) {
-    auto ret = setMetaData(handle, paramType, param);
-    unmapAndReset(handle);
+    if (!useCachedMapping(handle)) {
+        auto ret = setMetaData(handle, paramType, param);
+        unmapAndReset(handle);
+        return ret;
+    }
+
+    MetaDataMappingList::iterator mapping;
+    auto data = acquireCachedMapping(handle, &mapping);
+    if (!data)
+        return -1;
+    auto ret = setMetaDataVa(data, paramType, param);
+    releaseCachedMapping(mapping);
     return ret;
 }
 
 int getMetaDataAndUnmap(struct private_handle_t *handle,
                         enum DispFetchParamType paramType,
                         void *param) {
-    auto ret = getMetaData(handle, paramType, param);
-    unmapAndReset(handle);
+    if (!useCachedMapping(handle)) {
+        auto ret = getMetaData(handle, paramType, param);
+        unmapAndReset(handle);
+        return ret;
+    }
+
+    MetaDataMappingList::iterator mapping;
+    auto data = acquireCachedMapping(handle, &mapping);
+    if (!data)
+        return -1;
+    auto ret = getMetaDataVa(data, paramType, param);
+    releaseCachedMapping(mapping);
     return ret;
 }
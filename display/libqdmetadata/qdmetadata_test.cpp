@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gralloc_priv.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "qdMetaData.h"
+
+namespace {
+
+// Metadata buffer backed by a memfd, as gralloc would hand it out
+struct TestBuffer {
+  TestBuffer(const char *name, uint64_t id, uint32_t reserved_size) : name(name) {
+    size = getMetaDataSizeWithReservedRegion(reserved_size);
+    int fd = memfd_create(name, MFD_CLOEXEC);
+    EXPECT_GE(fd, 0);
+    EXPECT_EQ(0, ftruncate(fd, static_cast<off_t>(size)));
+    auto metadata = reinterpret_cast<MetaData_t *>(
+        mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    EXPECT_NE(MAP_FAILED, reinterpret_cast<void *>(metadata));
+    metadata->reservedSize = reserved_size;
+    munmap(metadata, size);
+
+    handle = new private_handle_t(-1, fd, 0, 64, 64, 64, 64, HAL_PIXEL_FORMAT_RGBA_8888, 0,
+                                  64 * 64 * 4);
+    handle->id = id;
+    handle->reserved_size = reserved_size;
+  }
+
+  ~TestBuffer() {
+    Close();
+    delete handle;
+  }
+
+  void Close() {
+    if (handle->fd_metadata >= 0) {
+      close(handle->fd_metadata);
+      handle->fd_metadata = -1;
+    }
+  }
+
+  // Writes the refresh rate through a private mapping, bypassing the cache
+  void SetRefreshRate(float rate) {
+    auto metadata = reinterpret_cast<MetaData_t *>(
+        mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, handle->fd_metadata, 0));
+    ASSERT_NE(MAP_FAILED, reinterpret_cast<void *>(metadata));
+    EXPECT_EQ(0, setMetaDataVa(metadata, UPDATE_REFRESH_RATE, &rate));
+    munmap(metadata, size);
+  }
+
+  // Number of mappings of this buffer in the process
+  int MappingCount() {
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    int count = 0;
+    while (std::getline(maps, line)) {
+      count += (line.find(std::string("/memfd:") + name + " ") != std::string::npos);
+    }
+    return count;
+  }
+
+  std::string name;
+  size_t size = 0;
+  private_handle_t *handle = nullptr;
+};
+
+}  // namespace
+
+TEST(QdMetaDataTest, SetAndGetThroughCache) {
+  TestBuffer buffer("qdmetadata_test_set_get", 1, 0);
+  float rate = 90.0f;
+
+  ASSERT_EQ(0, setMetaDataAndUnmap(buffer.handle, UPDATE_REFRESH_RATE, &rate));
+  rate = 0.0f;
+  ASSERT_EQ(0, getMetaDataAndUnmap(buffer.handle, GET_REFRESH_RATE, &rate));
+  EXPECT_EQ(90.0f, rate);
+  // The handle is left unmapped and the cache holds a single mapping
+  EXPECT_EQ(0u, buffer.handle->base_metadata);
+  EXPECT_EQ(1, buffer.MappingCount());
+}
+
+// A buffer that is freed and whose metadata fd number is then reused by another buffer, with a
+// larger reserved region, must not see the old mapping; the old mapping is dropped.
+TEST(QdMetaDataTest, FdReuseAfterClose) {
+  TestBuffer first("qdmetadata_test_reuse_first", 2, 0);
+  first.SetRefreshRate(60.0f);
+  float rate = 0.0f;
+  ASSERT_EQ(0, getMetaDataAndUnmap(first.handle, GET_REFRESH_RATE, &rate));
+  EXPECT_EQ(60.0f, rate);
+  int fd = first.handle->fd_metadata;
+  first.Close();
+
+  TestBuffer second("qdmetadata_test_reuse_second", 3, 8192);
+  ASSERT_EQ(fd, second.handle->fd_metadata);
+  second.SetRefreshRate(120.0f);
+  ASSERT_EQ(0, getMetaDataAndUnmap(second.handle, GET_REFRESH_RATE, &rate));
+  EXPECT_EQ(120.0f, rate);
+  EXPECT_EQ(0, first.MappingCount());
+  EXPECT_EQ(1, second.MappingCount());
+}
+
+// A cached mapping of a freed buffer is unmapped on the next miss, it does not keep the buffer
+// alive until it ages out of the cache.
+TEST(QdMetaDataTest, FreedBufferIsUnmapped) {
+  TestBuffer freed("qdmetadata_test_freed", 4, 0);
+  TestBuffer other("qdmetadata_test_other", 5, 0);
+  float rate = 0.0f;
+
+  freed.SetRefreshRate(30.0f);
+  ASSERT_EQ(0, getMetaDataAndUnmap(freed.handle, GET_REFRESH_RATE, &rate));
+  EXPECT_EQ(1, freed.MappingCount());
+  freed.Close();
+
+  other.SetRefreshRate(60.0f);
+  ASSERT_EQ(0, getMetaDataAndUnmap(other.handle, GET_REFRESH_RATE, &rate));
+  EXPECT_EQ(60.0f, rate);
+  EXPECT_EQ(0, freed.MappingCount());
+}
+
+// Cost of a get/set pair through the cache, against mapping and unmapping the buffer around
+// every call as the *AndUnmap helpers did before.
+TEST(QdMetaDataTest, GetSetTime) {
+  const int kIterations = 20000;
+  TestBuffer buffer("qdmetadata_test_time", 6, 4096);
+  float rate = 60.0f;
+
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    setMetaDataAndUnmap(buffer.handle, UPDATE_REFRESH_RATE, &rate);
+    getMetaDataAndUnmap(buffer.handle, GET_REFRESH_RATE, &rate);
+  }
+  auto cached_time = std::chrono::steady_clock::now() - begin;
+
+  begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    setMetaData(buffer.handle, UPDATE_REFRESH_RATE, &rate);
+    munmap(reinterpret_cast<void *>(buffer.handle->base_metadata), buffer.size);
+    buffer.handle->base_metadata = 0;
+    getMetaData(buffer.handle, GET_REFRESH_RATE, &rate);
+    munmap(reinterpret_cast<void *>(buffer.handle->base_metadata), buffer.size);
+    buffer.handle->base_metadata = 0;
+  }
+  auto mapped_time = std::chrono::steady_clock::now() - begin;
+
+  EXPECT_EQ(60.0f, rate);
+  auto per_pair = [&](std::chrono::steady_clock::duration time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / kIterations;
+  };
+  std::cout << "get/set pair: cached " << per_pair(cached_time) << " ns, map and unmap "
+            << per_pair(mapped_time) << " ns" << std::endl;
+}
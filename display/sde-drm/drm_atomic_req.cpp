@@ -195,6 +195,7 @@ int DRMAtomicReq::Validate() {
 
   drm_mgr_->GetPlaneMgr()->PostValidate(token_.crtc_id, !ret);
   drm_mgr_->GetCrtcMgr()->PostValidate(token_.crtc_id, !ret);
+  drm_mgr_->GetConnectorMgr()->PostValidate(token_.conn_id, !ret);
   drmModeAtomicSetCursor(drm_atomic_req_, 0);
 
   return ret;
@@ -223,6 +224,7 @@ int DRMAtomicReq::Commit(bool synchronous, bool retain_planes) {
 
   drm_mgr_->GetPlaneMgr()->PostCommit(token_.crtc_id, !ret);
   drm_mgr_->GetCrtcMgr()->PostCommit(token_.crtc_id, !ret);
+  drm_mgr_->GetConnectorMgr()->PostCommit(token_.conn_id, !ret);
   drmModeAtomicSetCursor(drm_atomic_req_, 0);
 
   return ret;
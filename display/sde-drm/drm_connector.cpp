@@ -480,6 +480,22 @@ void DRMConnectorManager::Free(DRMDisplayToken *token) {
   token->conn_id = 0;
 }
 
+void DRMConnectorManager::PostValidate(uint32_t conn_id, bool success) {
+  lock_guard<mutex> lock(lock_);
+  auto it = connector_pool_.find(conn_id);
+  if (it != connector_pool_.end()) {
+    it->second->PostValidate(success);
+  }
+}
+
+void DRMConnectorManager::PostCommit(uint32_t conn_id, bool success) {
+  lock_guard<mutex> lock(lock_);
+  auto it = connector_pool_.find(conn_id);
+  if (it != connector_pool_.end()) {
+    it->second->PostCommit(success);
+  }
+}
+
 // ==============================================================================================//
 
 #undef __CLASS__
@@ -491,6 +507,24 @@ DRMConnector::~DRMConnector() {
   }
 }
 
+void DRMConnector::Unlock() {
+  tmp_prop_val_map_.clear();
+  committed_prop_val_map_.clear();
+  status_ = DRMStatus::FREE;
+}
+
+void DRMConnector::PostValidate(bool /*success*/) {
+  tmp_prop_val_map_ = committed_prop_val_map_;
+}
+
+void DRMConnector::PostCommit(bool success) {
+  if (success) {
+    committed_prop_val_map_ = tmp_prop_val_map_;
+  } else {
+    tmp_prop_val_map_ = committed_prop_val_map_;
+  }
+}
+
 void DRMConnector::ParseProperties() {
   drmModeObjectProperties *props =
       drmModeObjectGetProperties(fd_, drm_connector_->connector_id, DRM_MODE_OBJECT_CONNECTOR);
@@ -864,6 +898,8 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
     case DRMOps::CONNECTOR_SET_CRTC: {
       uint32_t crtc = va_arg(args, uint32_t);
       drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::CRTC_ID), crtc);
+      // Resend the cached properties after the connector is attached or detached
+      tmp_prop_val_map_.clear();
       DRM_LOGD("Connector %d: Setting CRTC %d", obj_id, crtc);
     } break;
 
@@ -876,14 +912,14 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
 
     case DRMOps::CONNECTOR_SET_OUTPUT_RECT: {
       DRMRect rect = va_arg(args, DRMRect);
-      drmModeAtomicAddProperty(req, obj_id,
-                               prop_mgr_.GetPropertyId(DRMProperty::DST_X), rect.left);
-      drmModeAtomicAddProperty(req, obj_id,
-                               prop_mgr_.GetPropertyId(DRMProperty::DST_Y), rect.top);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_W),
-                               rect.right - rect.left);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_H),
-                               rect.bottom - rect.top);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_X), rect.left,
+                  true /* cache */, tmp_prop_val_map_);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_Y), rect.top,
+                  true /* cache */, tmp_prop_val_map_);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_W),
+                  rect.right - rect.left, true /* cache */, tmp_prop_val_map_);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_H),
+                  rect.bottom - rect.top, true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting dst [x,y,w,h][%d,%d,%d,%d]", obj_id, rect.left,
                   rect.top, (rect.right - rect.left), (rect.bottom - rect.top));
     } break;
@@ -915,6 +951,10 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
           break;
       }
       drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::LP), power_mode);
+      if (power_mode == OFF) {
+        // Resend the cached properties once the connector is powered back on
+        tmp_prop_val_map_.clear();
+      }
       DRM_LOGD("Connector %d: Setting power_mode %d", obj_id, power_mode);
     } break;
 
@@ -926,6 +966,7 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
 
     case DRMOps::CONNECTOR_SET_AUTOREFRESH: {
       uint32_t enable = va_arg(args, uint32_t);
+      // The driver reconfigures autorefresh only in commits that set it, so it is sent every time
       drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::AUTOREFRESH),
                                enable);
       DRM_LOGD("Connector %d: Setting autorefresh %d", obj_id, enable);
@@ -934,9 +975,8 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
     case DRMOps::CONNECTOR_SET_FB_SECURE_MODE: {
       int secure_mode = va_arg(args, int);
       uint32_t fb_secure_mode = (secure_mode == (int)DRMSecureMode::SECURE) ? SECURE : NON_SECURE;
-      drmModeAtomicAddProperty(req, obj_id,
-                               prop_mgr_.GetPropertyId(DRMProperty::FB_TRANSLATION_MODE),
-                               fb_secure_mode);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::FB_TRANSLATION_MODE),
+                  fb_secure_mode, true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting FB secure mode %d", obj_id, fb_secure_mode);
     } break;
 
@@ -958,6 +998,7 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
       }
       int drm_qsync_mode = va_arg(args, int);
       uint32_t qsync_mode = static_cast<uint32_t>(drm_qsync_mode);
+      // Not diffed, the driver arms qsync (one shot mode in particular) on each commit that sets it
       drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::QSYNC_MODE),
                                qsync_mode);
       DRM_LOGD("Connector %d: Setting Qsync mode %d", obj_id, qsync_mode);
@@ -1044,8 +1085,8 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
         return;
       }
       uint32_t drm_panel_mode = va_arg(args, uint32_t);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::PANEL_MODE),
-                               drm_panel_mode);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::PANEL_MODE), drm_panel_mode,
+                  true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting Panel mode 0x%x", obj_id, drm_panel_mode);
     } break;
 
@@ -72,6 +72,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <display/drm/sde_drm.h>
 #include <mutex>
 #include <set>
+#include <unordered_map>
 #include "drm_pp_manager.h"
 
 #include "drm_utils.h"
@@ -85,7 +86,7 @@ class DRMConnector {
   ~DRMConnector();
   void InitAndParse(drmModeConnector *conn);
   void Lock() { status_ = DRMStatus::BUSY; }
-  void Unlock() { status_ = DRMStatus::FREE; }
+  void Unlock();
   DRMStatus GetStatus() { return status_; }
   int GetInfo(DRMConnectorInfo *info);
   void GetType(uint32_t *conn_type) { *conn_type = drm_connector_->connector_type; }
@@ -94,6 +95,8 @@ class DRMConnector {
   int GetPossibleEncoders(std::set<uint32_t> *possible_encoders);
   void SetSkipConnectorReload(bool skip_reload) { skip_connector_reload_ = skip_reload; };
   void Dump();
+  void PostValidate(bool success);
+  void PostCommit(bool success);
 
  private:
   void ParseProperties();
@@ -111,6 +114,8 @@ class DRMConnector {
   bool skip_connector_reload_ = false; //  Usually set to true for new TV/pluggable displays.
   DRMStatus status_ = DRMStatus::FREE;
   std::unique_ptr<DRMPPManager> pp_mgr_{};
+  std::unordered_map<uint32_t, uint64_t> tmp_prop_val_map_ {};
+  std::unordered_map<uint32_t, uint64_t> committed_prop_val_map_ {};
 };
 
 class DRMConnectorManager {
@@ -128,6 +133,8 @@ class DRMConnectorManager {
   int GetConnectorInfo(uint32_t conn_id, DRMConnectorInfo *info);
   void GetConnectorList(std::vector<uint32_t> *conn_ids);
   int GetPossibleEncoders(uint32_t connector_id, std::set<uint32_t> *possible_encoders);
+  void PostValidate(uint32_t conn_id, bool success);
+  void PostCommit(uint32_t conn_id, bool success);
   ~DRMConnectorManager() {}
 
  private:
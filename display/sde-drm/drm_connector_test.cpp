@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+#include <stdarg.h>
+#include <string.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "drm_connector.h"
+#include "drm_property.h"
+
+using sde_drm::DRMProperty;
+using sde_drm::DRMPropertyManager;
+
+namespace {
+
+// Connector properties exposed by the fake driver
+const DRMProperty kConnectorProperties[] = {
+  DRMProperty::CRTC_ID, DRMProperty::DST_X, DRMProperty::DST_Y, DRMProperty::DST_W,
+  DRMProperty::DST_H, DRMProperty::LP, DRMProperty::AUTOREFRESH,
+  DRMProperty::FB_TRANSLATION_MODE, DRMProperty::QSYNC_MODE, DRMProperty::PANEL_MODE,
+  DRMProperty::RETIRE_FENCE,
+};
+
+uint32_t PropertyId(DRMProperty prop) {
+  return 100 + static_cast<uint32_t>(prop);
+}
+
+struct AddedProperty {
+  uint32_t object_id;
+  uint32_t property_id;
+  uint64_t value;
+};
+
+// Properties added to the atomic request since the last frame
+std::vector<AddedProperty> added_properties;
+
+}  // namespace
+
+// Driver side of the property API, the test links this instead of libdrm
+
+int drmModeAtomicAddProperty(drmModeAtomicReqPtr req, uint32_t object_id, uint32_t property_id,
+                             uint64_t value) {
+  added_properties.push_back({object_id, property_id, value});
+  return 0;
+}
+
+drmModeObjectPropertiesPtr drmModeObjectGetProperties(int fd, uint32_t object_id,
+                                                      uint32_t object_type) {
+  const uint32_t count = sizeof(kConnectorProperties) / sizeof(kConnectorProperties[0]);
+  drmModeObjectPropertiesPtr props = new drmModeObjectProperties();
+  props->count_props = count;
+  props->props = new uint32_t[count];
+  props->prop_values = new uint64_t[count]();
+  for (uint32_t i = 0; i < count; i++) {
+    props->props[i] = PropertyId(kConnectorProperties[i]);
+  }
+  return props;
+}
+
+void drmModeFreeObjectProperties(drmModeObjectPropertiesPtr props) {
+  if (props) {
+    delete[] props->props;
+    delete[] props->prop_values;
+    delete props;
+  }
+}
+
+drmModePropertyPtr drmModeGetProperty(int fd, uint32_t property_id) {
+  drmModePropertyPtr info = new drmModePropertyRes();
+  info->prop_id = property_id;
+  auto prop = static_cast<DRMProperty>(property_id - PropertyId(DRMProperty::INVALID));
+  strncpy(info->name, DRMPropertyManager::GetPropertyName(prop), sizeof(info->name) - 1);
+  return info;
+}
+
+void drmModeFreeProperty(drmModePropertyPtr info) {
+  delete info;
+}
+
+// Not reached by these tests
+drmModeConnectorPtr drmModeGetConnector(int fd, uint32_t connector_id) { return nullptr; }
+void drmModeFreeConnector(drmModeConnectorPtr connector) {}
+drmModePropertyBlobPtr drmModeGetPropertyBlob(int fd, uint32_t blob_id) { return nullptr; }
+void drmModeFreePropertyBlob(drmModePropertyBlobPtr blob) {}
+drmModeResPtr drmModeGetResources(int fd) { return nullptr; }
+void drmModeFreeResources(drmModeResPtr res) {}
+int drmModeCreatePropertyBlob(int fd, const void *data, size_t size, uint32_t *id) {
+  return -1;
+}
+int drmModeDestroyPropertyBlob(int fd, uint32_t id) { return -1; }
+
+namespace sde_drm {
+
+class DRMConnectorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    drm_connector_.connector_id = kConnectorId;
+    connector_.reset(new DRMConnector(-1));
+    connector_->InitAndParse(&drm_connector_);
+    connector_->Lock();
+    added_properties.clear();
+  }
+
+  void Perform(DRMOps code, ...) {
+    va_list args;
+    va_start(args, code);
+    connector_->Perform(code, req_, args);
+    va_end(args);
+  }
+
+  // The connector ops of a frame on a writeback or command mode display
+  void StaticFrame(const DRMRect &rect, DRMSecureMode secure_mode) {
+    int64_t retire_fence = -1;
+    Perform(DRMOps::CONNECTOR_GET_RETIRE_FENCE, &retire_fence);
+    Perform(DRMOps::CONNECTOR_SET_OUTPUT_RECT, rect);
+    Perform(DRMOps::CONNECTOR_SET_FB_SECURE_MODE, static_cast<int>(secure_mode));
+    Perform(DRMOps::CONNECTOR_SET_PANEL_MODE, 1u);
+  }
+
+  // Ends the frame, returns the number of properties it added
+  size_t Commit(bool success) {
+    size_t count = added_properties.size();
+    connector_->PostCommit(success);
+    last_frame_ = added_properties;
+    added_properties.clear();
+    return count;
+  }
+
+  size_t Validate(bool success) {
+    size_t count = added_properties.size();
+    connector_->PostValidate(success);
+    last_frame_ = added_properties;
+    added_properties.clear();
+    return count;
+  }
+
+  // Number of times the last frame set the property, with the last value set
+  int Sent(DRMProperty prop, uint64_t *value = nullptr) {
+    int count = 0;
+    for (const AddedProperty &added : last_frame_) {
+      EXPECT_EQ(kConnectorId, added.object_id);
+      if (added.property_id == PropertyId(prop)) {
+        count++;
+        if (value) {
+          *value = added.value;
+        }
+      }
+    }
+    return count;
+  }
+
+  static constexpr uint32_t kConnectorId = 31;
+  const DRMRect kRect = {0, 0, 1080, 2400};
+  drmModeConnector drm_connector_ = {};
+  std::unique_ptr<DRMConnector> connector_;
+  drmModeAtomicReqPtr req_ = reinterpret_cast<drmModeAtomicReqPtr>(1);
+  std::vector<AddedProperty> last_frame_;
+};
+
+TEST_F(DRMConnectorTest, UnchangedPropertiesAreSkipped) {
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  size_t first = Commit(true);
+  EXPECT_EQ(7u, first);
+
+  for (int i = 0; i < 3; i++) {
+    StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+    // Only the retire fence, which is new every frame
+    EXPECT_EQ(1u, Commit(true));
+    EXPECT_EQ(1, Sent(DRMProperty::RETIRE_FENCE));
+  }
+  std::cout << "connector properties: " << first << " on the first frame, 1 per static frame"
+            << std::endl;
+}
+
+TEST_F(DRMConnectorTest, ChangedPropertyIsSent) {
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  Commit(true);
+
+  DRMRect rect = kRect;
+  rect.right = 720;
+  StaticFrame(rect, DRMSecureMode::NON_SECURE);
+  EXPECT_EQ(2u, Commit(true));
+  uint64_t value = 0;
+  EXPECT_EQ(1, Sent(DRMProperty::DST_W, &value));
+  EXPECT_EQ(720u, value);
+
+  StaticFrame(rect, DRMSecureMode::SECURE);
+  EXPECT_EQ(2u, Commit(true));
+  EXPECT_EQ(1, Sent(DRMProperty::FB_TRANSLATION_MODE));
+}
+
+// A failed commit did not reach the driver, its values are sent again
+TEST_F(DRMConnectorTest, FailedCommitRollsBack) {
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  Commit(true);
+
+  StaticFrame(kRect, DRMSecureMode::SECURE);
+  Commit(false);
+  StaticFrame(kRect, DRMSecureMode::SECURE);
+  EXPECT_EQ(2u, Commit(true));
+  uint64_t value = 0;
+  EXPECT_EQ(1, Sent(DRMProperty::FB_TRANSLATION_MODE, &value));
+  EXPECT_EQ(1u, value);
+
+  StaticFrame(kRect, DRMSecureMode::SECURE);
+  EXPECT_EQ(1u, Commit(true));
+}
+
+// A validate only tests the state, the commit after it sends the same values again
+TEST_F(DRMConnectorTest, ValidateDoesNotPromote) {
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  Commit(true);
+
+  StaticFrame(kRect, DRMSecureMode::SECURE);
+  EXPECT_EQ(2u, Validate(true));
+  StaticFrame(kRect, DRMSecureMode::SECURE);
+  EXPECT_EQ(2u, Commit(true));
+  EXPECT_EQ(1, Sent(DRMProperty::FB_TRANSLATION_MODE));
+}
+
+// The driver acts on these only in commits that set them, the same value is sent every time
+TEST_F(DRMConnectorTest, QsyncAndAutorefreshAreResent) {
+  for (int i = 0; i < 3; i++) {
+    Perform(DRMOps::CONNECTOR_SET_QSYNC_MODE, static_cast<int>(DRMQsyncMode::ONESHOT));
+    Perform(DRMOps::CONNECTOR_SET_AUTOREFRESH, 1u);
+    EXPECT_EQ(2u, Commit(true));
+    uint64_t value = 0;
+    EXPECT_EQ(1, Sent(DRMProperty::QSYNC_MODE, &value));
+    EXPECT_EQ(static_cast<uint64_t>(DRMQsyncMode::ONESHOT), value);
+    EXPECT_EQ(1, Sent(DRMProperty::AUTOREFRESH, &value));
+    EXPECT_EQ(1u, value);
+  }
+
+  // Also after a failed commit, and in a frame that otherwise sends nothing new
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  Commit(true);
+  Perform(DRMOps::CONNECTOR_SET_QSYNC_MODE, static_cast<int>(DRMQsyncMode::CONTINUOUS));
+  Commit(false);
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  Perform(DRMOps::CONNECTOR_SET_QSYNC_MODE, static_cast<int>(DRMQsyncMode::CONTINUOUS));
+  Perform(DRMOps::CONNECTOR_SET_AUTOREFRESH, 0u);
+  EXPECT_EQ(3u, Commit(true));
+  EXPECT_EQ(1, Sent(DRMProperty::QSYNC_MODE));
+  EXPECT_EQ(1, Sent(DRMProperty::AUTOREFRESH));
+}
+
+TEST_F(DRMConnectorTest, PowerOffResendsState) {
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  Commit(true);
+
+  Perform(DRMOps::CONNECTOR_SET_POWER_MODE, static_cast<int>(DRMPowerMode::OFF));
+  Commit(true);
+  Perform(DRMOps::CONNECTOR_SET_POWER_MODE, static_cast<int>(DRMPowerMode::ON));
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  EXPECT_EQ(8u, Commit(true));
+  EXPECT_EQ(1, Sent(DRMProperty::DST_X));
+  EXPECT_EQ(1, Sent(DRMProperty::PANEL_MODE));
+
+  // Low power modes keep the state
+  Perform(DRMOps::CONNECTOR_SET_POWER_MODE, static_cast<int>(DRMPowerMode::DOZE));
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  EXPECT_EQ(2u, Commit(true));
+}
+
+TEST_F(DRMConnectorTest, ModesetResendsState) {
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  Commit(true);
+
+  Perform(DRMOps::CONNECTOR_SET_CRTC, 81u);
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  EXPECT_EQ(8u, Commit(true));
+  EXPECT_EQ(1, Sent(DRMProperty::CRTC_ID));
+  EXPECT_EQ(1, Sent(DRMProperty::FB_TRANSLATION_MODE));
+
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  EXPECT_EQ(1u, Commit(true));
+}
+
+// A connector handed to another display starts from scratch
+TEST_F(DRMConnectorTest, UnlockForgetsState) {
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  Commit(true);
+
+  connector_->Unlock();
+  connector_->Lock();
+  StaticFrame(kRect, DRMSecureMode::NON_SECURE);
+  EXPECT_EQ(7u, Commit(true));
+}
+
+}  // namespace sde_drm
@@ -86,20 +86,33 @@ DRMPPManager::DRMPPManager(int fd) : fd_(fd) {
 
 DRMPPManager::~DRMPPManager() {
 #ifdef PP_DRM_ENABLE
-  DRMPPPropInfo prop_info = {};
-
   /* free previously created blob to avoid memory leak */
-  for (int i = 0; i < kPPFeaturesMax; i++) {
-    prop_info = pp_prop_map_[i];
-    if (prop_info.blob_id > 0) {
-      drmModeDestroyPropertyBlob(fd_, prop_info.blob_id);
-      prop_info.blob_id = 0;
-    }
+  for (auto &blob : blobs_) {
+    drmModeDestroyPropertyBlob(fd_, blob.blob_id);
   }
+  blobs_.clear();
 #endif
   fd_ = -1;
 }
 
+uint64_t DRMPPManager::HashPayload(const void *payload, uint32_t size) {
+  // FNV-1a over 64-bit words, the LUT payloads are large and word aligned in practice
+  const uint64_t kPrime = 0x100000001b3ULL;
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(payload);
+  uint64_t hash = 0xcbf29ce484222325ULL ^ size;
+  uint32_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * kPrime;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ bytes[i]) * kPrime;
+  }
+
+  return hash;
+}
+
 void DRMPPManager::Init(const DRMPropertyManager &pm , uint32_t object_type) {
   object_type_ = object_type;
   for (uint32_t i = (uint32_t)DRMProperty::INVALID + 1; i < (uint32_t)DRMProperty::MAX; i++) {
@@ -268,36 +281,89 @@ int DRMPPManager::SetPPBlobProperty(drmModeAtomicReq *req, uint32_t obj_id,
                                     DRMPPFeatureInfo &feature) {
   int ret = DRM_ERR_INVALID;
 #ifdef PP_DRM_ENABLE
-  uint32_t blob_id = 0;
-
-  /* free previously created blob for this feature if exist */
-  if (prop_info->blob_id > 0) {
-    ret = drmModeDestroyPropertyBlob(fd_, prop_info->blob_id);
-    if (ret) {
-      DRM_LOGE("failed to destroy property blob for feature %d, ret = %d", feature.id, ret);
-      return ret;
-    } else {
-      prop_info->blob_id = 0;
-    }
-  }
-
   if (!feature.payload) {
     // feature disable case
+    ReleaseBlob(prop_info->blob_id);
+    prop_info->blob_id = 0;
     drmModeAtomicAddProperty(req, obj_id, prop_info->prop_id, 0);
     return 0;
   }
 
-  ret = drmModeCreatePropertyBlob(fd_, feature.payload, feature.payload_size, &blob_id);
-  if (ret || blob_id == 0) {
-    DRM_LOGE("failed to create property blob ret %d, blob_id = %d", ret, blob_id);
+  // Acquire before releasing the previous blob, re-applying the same LUT then keeps its blob
+  uint32_t blob_id = AcquireBlob(feature);
+  if (!blob_id) {
     return DRM_ERR_INVALID;
   }
 
+  ReleaseBlob(prop_info->blob_id);
   prop_info->blob_id = blob_id;
   drmModeAtomicAddProperty(req, obj_id, prop_info->prop_id, blob_id);
-
+  ret = 0;
 #endif
   return ret;
 }
 
+uint32_t DRMPPManager::AcquireBlob(const DRMPPFeatureInfo &feature) {
+#ifdef PP_DRM_ENABLE
+  uint64_t hash = HashPayload(feature.payload, feature.payload_size);
+  for (auto it = blobs_.begin(); it != blobs_.end(); it++) {
+    if (it->hash == hash && it->payload.size() == feature.payload_size &&
+        !memcmp(it->payload.data(), feature.payload, feature.payload_size)) {
+      it->ref_count++;
+      blobs_.splice(blobs_.begin(), blobs_, it);
+      return it->blob_id;
+    }
+  }
+
+  uint32_t blob_id = 0;
+  int ret = drmModeCreatePropertyBlob(fd_, feature.payload, feature.payload_size, &blob_id);
+  if (ret || blob_id == 0) {
+    DRM_LOGE("failed to create property blob ret %d, blob_id = %d", ret, blob_id);
+    return 0;
+  }
+
+  const uint8_t *payload = reinterpret_cast<const uint8_t *>(feature.payload);
+  blobs_.emplace_front();
+  DRMPPBlob &blob = blobs_.front();
+  blob.blob_id = blob_id;
+  blob.hash = hash;
+  blob.payload.assign(payload, payload + feature.payload_size);
+  blob.ref_count = 1;
+
+  return blob_id;
+#else
+  return 0;
+#endif
+}
+
+void DRMPPManager::ReleaseBlob(uint32_t blob_id) {
+#ifdef PP_DRM_ENABLE
+  if (!blob_id) {
+    return;
+  }
+
+  for (auto &blob : blobs_) {
+    if (blob.blob_id == blob_id) {
+      blob.ref_count--;
+      break;
+    }
+  }
+
+  // Committed state holds its own reference, so destroying an idle blob is safe at any time
+  uint32_t idle_count = 0;
+  for (auto it = blobs_.begin(); it != blobs_.end();) {
+    if (it->ref_count || ++idle_count <= kMaxIdleBlobs) {
+      it++;
+      continue;
+    }
+
+    int ret = drmModeDestroyPropertyBlob(fd_, it->blob_id);
+    if (ret) {
+      DRM_LOGE("failed to destroy property blob %d, ret = %d", it->blob_id, ret);
+    }
+    it = blobs_.erase(it);
+  }
+#endif
+}
+
 }  // namespace sde_drm
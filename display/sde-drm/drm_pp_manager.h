@@ -31,6 +31,8 @@
 #define __DRM_PP_MANAGER_H__
 
 #include <limits>
+#include <list>
+#include <vector>
 #include "drm_utils.h"
 #include "drm_interface.h"
 #include "drm_property.h"
@@ -53,13 +55,31 @@ class DRMPPManager {
   void GetPPInfo(DRMPPFeatureInfo *info);
   void SetPPFeature(drmModeAtomicReq *req, uint32_t obj_id, DRMPPFeatureInfo &feature);
 
+  // Content hash of a blob payload, a match is confirmed against the cached payload
+  static uint64_t HashPayload(const void *payload, uint32_t size);
+
+  // Unreferenced blobs kept around so that switching back to a recent mode reuses them
+  static const uint32_t kMaxIdleBlobs = 4;
+
  private:
+  // Kernel blob created for a payload, shared by every feature programmed with the same content
+  struct DRMPPBlob {
+    uint32_t blob_id = 0;
+    uint64_t hash = 0;
+    std::vector<uint8_t> payload;
+    uint32_t ref_count = 0;
+  };
+
   int SetPPBlobProperty(drmModeAtomicReq *req, uint32_t obj_id, struct DRMPPPropInfo *prop_info,
                         DRMPPFeatureInfo &feature);
+  uint32_t AcquireBlob(const DRMPPFeatureInfo &feature);
+  void ReleaseBlob(uint32_t blob_id);
 
   int fd_ = -1;
   uint32_t object_type_ = std::numeric_limits<uint32_t>::max();
   DRMPPPropInfo pp_prop_map_[kPPFeaturesMax] = {};
+  // Most recently used first
+  std::list<DRMPPBlob> blobs_ {};
 };
 
 }  // namespace sde_drm
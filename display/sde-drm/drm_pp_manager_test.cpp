@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <errno.h>
+#include <gtest/gtest.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include <map>
+#include <vector>
+
+#include "drm_pp_manager.h"
+
+#ifdef PP_DRM_ENABLE
+
+namespace {
+
+// Kernel side of the blob API, the test links this instead of libdrm
+struct FakeBlobs {
+  std::map<uint32_t, std::vector<uint8_t>> live;
+  uint32_t next_id = 1;
+  int creates = 0;
+  int destroys = 0;
+  int dead_refs = 0;
+};
+
+FakeBlobs *fake_blobs = nullptr;
+
+}  // namespace
+
+int drmModeCreatePropertyBlob(int fd, const void *data, size_t size, uint32_t *id) {
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+  *id = fake_blobs->next_id++;
+  fake_blobs->live[*id].assign(bytes, bytes + size);
+  fake_blobs->creates++;
+  return 0;
+}
+
+int drmModeDestroyPropertyBlob(int fd, uint32_t id) {
+  fake_blobs->destroys++;
+  return fake_blobs->live.erase(id) ? 0 : -EINVAL;
+}
+
+int drmModeAtomicAddProperty(drmModeAtomicReqPtr req, uint32_t object_id, uint32_t property_id,
+                             uint64_t value) {
+  if (value && !fake_blobs->live.count(static_cast<uint32_t>(value))) {
+    fake_blobs->dead_refs++;
+  }
+  return 0;
+}
+
+namespace sde_drm {
+
+class DRMPPManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { fake_blobs = &blobs_; }
+  void TearDown() override {
+    EXPECT_EQ(0, blobs_.dead_refs);
+    fake_blobs = nullptr;
+  }
+
+  // Programs the payload on a feature, or disables it
+  void Set(DRMPPManager *manager, DRMPPFeatureID id, std::vector<uint64_t> *payload) {
+    DRMPPFeatureInfo feature = {};
+    feature.id = id;
+    feature.type = kPropBlob;
+    feature.payload = payload ? payload->data() : nullptr;
+    feature.payload_size = payload ? payload->size() * sizeof(uint64_t) : 0;
+    manager->SetPPFeature(req_, 1, feature);
+  }
+
+  // Blob holding the payload, 0 if there is none
+  uint32_t FindBlob(const std::vector<uint64_t> &payload) {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(payload.data());
+    std::vector<uint8_t> content(bytes, bytes + payload.size() * sizeof(uint64_t));
+    for (auto &blob : blobs_.live) {
+      if (blob.second == content) {
+        return blob.first;
+      }
+    }
+    return 0;
+  }
+
+  FakeBlobs blobs_;
+  drmModeAtomicReqPtr req_ = reinterpret_cast<drmModeAtomicReqPtr>(1);
+};
+
+TEST_F(DRMPPManagerTest, SameContentReusesBlob) {
+  DRMPPManager manager(-1);
+  std::vector<uint64_t> a(512, 1), b(512, 2);
+
+  for (int i = 0; i < 10; i++) {
+    Set(&manager, kFeatureGamut, (i % 2) ? &a : &b);
+  }
+  EXPECT_EQ(2, blobs_.creates);
+  EXPECT_EQ(0, blobs_.destroys);
+
+  // A copy with the same content is not a new blob either
+  std::vector<uint64_t> a_copy = a;
+  Set(&manager, kFeatureIgc, &a_copy);
+  EXPECT_EQ(2, blobs_.creates);
+}
+
+// Payloads that hash the same but differ get their own blobs
+TEST_F(DRMPPManagerTest, HashCollisionComparesContent) {
+  DRMPPManager manager(-1);
+  std::vector<uint64_t> a = {0x1111, 0x2222};
+  std::vector<uint64_t> b = {0x3333, 0};
+  // FNV-1a over words: pick the second word of b so that both hashes meet after it
+  const uint64_t kPrime = 0x100000001b3ULL;
+  uint64_t seed = 0xcbf29ce484222325ULL ^ (a.size() * sizeof(uint64_t));
+  b[1] = ((seed ^ a[0]) * kPrime) ^ ((seed ^ b[0]) * kPrime) ^ a[1];
+  ASSERT_EQ(DRMPPManager::HashPayload(a.data(), 16), DRMPPManager::HashPayload(b.data(), 16));
+
+  Set(&manager, kFeatureIgc, &a);
+  Set(&manager, kFeatureDgmIgc, &b);
+  EXPECT_EQ(2, blobs_.creates);
+  uint32_t blob_a = FindBlob(a);
+  uint32_t blob_b = FindBlob(b);
+  ASSERT_NE(0u, blob_a);
+  ASSERT_NE(0u, blob_b);
+  EXPECT_NE(blob_a, blob_b);
+
+  // Re-applying either one finds its own blob
+  Set(&manager, kFeatureIgc, &b);
+  Set(&manager, kFeatureDgmIgc, &a);
+  EXPECT_EQ(2, blobs_.creates);
+}
+
+// A blob shared by features stays until the last of them lets go, then it is kept idle
+TEST_F(DRMPPManagerTest, SharedBlobIsReleasedByLastFeature) {
+  DRMPPManager manager(-1);
+  std::vector<uint64_t> a(256, 7), b(256, 8);
+
+  Set(&manager, kFeatureIgc, &a);
+  Set(&manager, kFeatureDgmIgc, &a);
+  Set(&manager, kFeatureVigIgc, &a);
+  uint32_t blob_a = FindBlob(a);
+  EXPECT_EQ(1, blobs_.creates);
+
+  Set(&manager, kFeatureIgc, nullptr);
+  Set(&manager, kFeatureDgmIgc, &b);
+  EXPECT_EQ(1u, blobs_.live.count(blob_a));
+  Set(&manager, kFeatureVigIgc, nullptr);
+  // Idle, but within kMaxIdleBlobs
+  EXPECT_EQ(1u, blobs_.live.count(blob_a));
+  EXPECT_EQ(0, blobs_.destroys);
+
+  // Taking it back does not create a new blob
+  Set(&manager, kFeatureVigIgc, &a);
+  EXPECT_EQ(blob_a, FindBlob(a));
+  EXPECT_EQ(2, blobs_.creates);
+}
+
+// Idle blobs beyond kMaxIdleBlobs are destroyed, least recently used first
+TEST_F(DRMPPManagerTest, IdleBlobsAreEvicted) {
+  DRMPPManager manager(-1);
+  const uint32_t kPayloads = DRMPPManager::kMaxIdleBlobs * 3;
+  std::vector<std::vector<uint64_t>> payloads;
+  for (uint32_t i = 0; i < kPayloads; i++) {
+    payloads.emplace_back(128, i);
+  }
+
+  for (uint32_t i = 0; i < kPayloads; i++) {
+    Set(&manager, kFeatureGamut, &payloads[i]);
+    // The programmed blob plus at most kMaxIdleBlobs idle ones
+    EXPECT_LE(blobs_.live.size(), DRMPPManager::kMaxIdleBlobs + 1);
+  }
+  EXPECT_EQ(static_cast<int>(kPayloads), blobs_.creates);
+  for (uint32_t i = 0; i < kPayloads; i++) {
+    bool recent = i + DRMPPManager::kMaxIdleBlobs + 1 >= kPayloads;
+    EXPECT_EQ(recent, FindBlob(payloads[i]) != 0) << i;
+  }
+
+  // A blob still cached is reused, an evicted one is created again
+  Set(&manager, kFeatureGamut, &payloads[kPayloads - 2]);
+  EXPECT_EQ(static_cast<int>(kPayloads), blobs_.creates);
+  Set(&manager, kFeatureGamut, &payloads[0]);
+  EXPECT_EQ(static_cast<int>(kPayloads) + 1, blobs_.creates);
+}
+
+TEST_F(DRMPPManagerTest, DestructorDestroysAllBlobs) {
+  {
+    DRMPPManager manager(-1);
+    std::vector<uint64_t> a(64, 1), b(64, 2), c(64, 3);
+    Set(&manager, kFeatureIgc, &a);
+    Set(&manager, kFeaturePgc, &b);
+    Set(&manager, kFeatureGamut, &c);
+    Set(&manager, kFeatureGamut, &a);
+    EXPECT_EQ(3u, blobs_.live.size());
+  }
+  EXPECT_TRUE(blobs_.live.empty());
+  EXPECT_EQ(blobs_.creates, blobs_.destroys);
+}
+
+}  // namespace sde_drm
+
+#endif  // PP_DRM_ENABLE
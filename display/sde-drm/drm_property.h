@@ -215,6 +215,8 @@ enum struct DRMProperty {
 
 struct DRMPropertyManager {
   DRMProperty GetPropertyEnum(const std::string &name) const;
+  // Returns the kernel name of prop_enum, or nullptr for INVALID and MAX
+  static const char *GetPropertyName(DRMProperty prop_enum);
 
   void SetPropertyId(DRMProperty prop_enum, uint32_t prop_id) {
     properties_[(uint32_t)prop_enum] = prop_id;
@@ -57,6 +57,7 @@ BufferLayout GetBufferLayout(LayerBufferFormat format);
 DisplayError GetBufferFormatTileSize(LayerBufferFormat format, FormatTileSize *tile_size);
 float GetBufferFormatBpp(LayerBufferFormat format);
 bool HasAlphaChannel(LayerBufferFormat format);
+bool IsYuvFormat(LayerBufferFormat format);
 bool IsWideColor(const ColorPrimaries &color_primary);
 
 }  // namespace sdm
@@ -351,6 +351,34 @@ DisplayError CompManager::Prepare(Handle display_ctx, HWLayers *hw_layers) {
   return error;
 }
 
+bool CompManager::CanReuseStrategy(Handle display_ctx) {
+  SCOPE_LOCK(locker_);
+  DisplayCompositionContext *display_comp_ctx =
+                             reinterpret_cast<DisplayCompositionContext *>(display_ctx);
+
+  // The strategy extension keeps its own state across draw cycles, only the default strategy is
+  // a pure function of the layer stack and the constraints.
+  return display_comp_ctx->strategy->UsesDefaultStrategy() && !safe_mode_ &&
+         !display_comp_ctx->idle_fallback && !display_comp_ctx->thermal_fallback_ &&
+         !display_comp_ctx->first_cycle_;
+}
+
+DisplayError CompManager::PrepareReusedStrategy(Handle display_ctx, HWLayers *hw_layers) {
+  SCOPE_LOCK(locker_);
+
+  DTRACE_SCOPED();
+  DisplayCompositionContext *display_comp_ctx =
+                             reinterpret_cast<DisplayCompositionContext *>(display_ctx);
+  Handle &display_resource_ctx = display_comp_ctx->display_resource_ctx;
+
+  // Strategy was restored by the caller, only allocate resources for it.
+  resource_intf_->Start(display_resource_ctx);
+  DisplayError error = resource_intf_->Prepare(display_resource_ctx, hw_layers);
+  DisplayError stop_error = resource_intf_->Stop(display_resource_ctx, hw_layers);
+
+  return (error != kErrorNone) ? error : stop_error;
+}
+
 DisplayError CompManager::PostPrepare(Handle display_ctx, HWLayers *hw_layers) {
   SCOPE_LOCK(locker_);
   DisplayCompositionContext *display_comp_ctx =
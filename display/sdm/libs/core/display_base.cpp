@@ -406,7 +406,25 @@ DisplayError DisplayBase::Prepare(LayerStack *layer_stack) {
 
   comp_manager_->PrePrepare(display_comp_ctx_, &hw_layers_);
 
-  while (true) {
+  // A stack with the same geometry as a recently validated one gets the same composition, without
+  // strategy selection and the TEST_ONLY commit. Virtual and CWB output buffers are mapped during
+  // validation, such frames always go through it.
+  uint64_t validate_key = 0;
+  bool validated = false;
+  bool use_validate_cache = !layer_stack->output_buffer && !layer_stack->flags.fast_path &&
+                            !rc_panel_feature_init_ &&
+                            comp_manager_->CanReuseStrategy(display_comp_ctx_);
+  if (use_validate_cache) {
+    validate_key = ValidateCache::GetKey(hw_layers_.info);
+    if (validate_cache_.Restore(validate_key, &hw_layers_.info) &&
+        comp_manager_->PrepareReusedStrategy(display_comp_ctx_, &hw_layers_) == kErrorNone) {
+      DLOGI_IF(kTagDisplay, "Reusing validated composition for display %d-%d", display_id_,
+               display_type_);
+      needs_validate_ = false;
+    }
+  }
+
+  while (needs_validate_) {
     error = comp_manager_->Prepare(display_comp_ctx_, &hw_layers_);
     if (error != kErrorNone) {
       break;
@@ -423,6 +441,7 @@ DisplayError DisplayBase::Prepare(LayerStack *layer_stack) {
     if (error == kErrorNone) {
       // Strategy is successful now, wait for Commit().
       needs_validate_ = false;
+      validated = true;
       break;
     }
     if (error == kErrorShutDown) {
@@ -431,6 +450,10 @@ DisplayError DisplayBase::Prepare(LayerStack *layer_stack) {
     }
   }
 
+  if (use_validate_cache && validated) {
+    validate_cache_.Store(validate_key, hw_layers_.info);
+  }
+
   if (color_mgr_)
     color_mgr_->Validate(&hw_layers_);
 
@@ -570,6 +593,7 @@ DisplayError DisplayBase::Commit(LayerStack *layer_stack) {
 
   error = comp_manager_->Commit(display_comp_ctx_, &hw_layers_);
   if (error != kErrorNone) {
+    validate_cache_.Clear(ValidateCache::kClearCommitFailure);
     return error;
   }
 
@@ -583,6 +607,8 @@ DisplayError DisplayBase::Commit(LayerStack *layer_stack) {
 
   error = hw_intf_->Commit(&hw_layers_);
   if (error != kErrorNone) {
+    // A composition the hardware rejected must go through validation again
+    validate_cache_.Clear(ValidateCache::kClearCommitFailure);
     if (layer_stack->flags.fast_path && hw_layers_.info.fast_path_composition) {
       // If COMMIT fails on the Fast Path, set Safe Mode.
       DLOGE("COMMIT failed in Fast Path, set Safe Mode!");
@@ -727,6 +753,7 @@ DisplayError DisplayBase::GetVSyncState(bool *enabled) {
 DisplayError DisplayBase::SetDisplayState(DisplayState state, bool teardown,
                                           shared_ptr<Fence> *release_fence) {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearPowerChange);
   DisplayError error = kErrorNone;
   bool active = false;
 
@@ -872,6 +899,7 @@ DisplayError DisplayBase::SetActiveConfig(uint32_t index) {
 
 DisplayError DisplayBase::SetMaxMixerStages(uint32_t max_mixer_stages) {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearConfigChange);
   DisplayError error = kErrorNone;
 
   error = comp_manager_->SetMaxMixerStages(display_comp_ctx_, max_mixer_stages);
@@ -934,6 +962,8 @@ std::string DisplayBase::Dump() {
   os << " Topology: " << display_attributes_.topology;
   os << " Qsync mode: " << active_qsync_mode_;
   os << std::noboolalpha;
+  hw_intf_->Dump(&os);
+  validate_cache_.Dump(&os);
 
   os << "\nCurrent Color Mode: " << current_color_mode_.c_str();
   os << "\nAvailable Color Modes:\n";
@@ -1119,6 +1149,7 @@ DisplayError DisplayBase::ColorSVCRequestRoute(const PPDisplayAPIPayload &in_pay
                                                PPDisplayAPIPayload *out_payload,
                                                PPPendingParams *pending_action) {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearColorChange);
   if (color_mgr_)
     return color_mgr_->ColorSVCRequestRoute(in_payload, out_payload, pending_action);
   else
@@ -1238,6 +1269,7 @@ DisplayError DisplayBase::SetColorModeInternal(const std::string &color_mode,
                                                const std::string &str_render_intent,
                                                const PrimariesTransfer &pt) {
   DLOGV_IF(kTagQDCM, "Color Mode = %s", color_mode.c_str());
+  validate_cache_.Clear(ValidateCache::kClearColorChange);
 
   ColorModeMap::iterator it = color_mode_map_.find(color_mode);
   if (it == color_mode_map_.end()) {
@@ -1315,6 +1347,7 @@ bool DisplayBase::IsSupportColorModeAttribute(const std::string &color_mode) {
 
 DisplayError DisplayBase::SetColorTransform(const uint32_t length, const double *color_transform) {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearColorChange);
   if (!color_mgr_) {
     return kErrorNotSupported;
   }
@@ -1466,6 +1499,7 @@ DisplayError DisplayBase::SetVSyncState(bool enable) {
 
 DisplayError DisplayBase::ReconfigureDisplay() {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearModeChange);
   DisplayError error = kErrorNone;
   HWDisplayAttributes display_attributes;
   HWMixerAttributes mixer_attributes;
@@ -1559,6 +1593,7 @@ DisplayError DisplayBase::GetMixerResolution(uint32_t *width, uint32_t *height)
 
 DisplayError DisplayBase::ReconfigureMixer(uint32_t width, uint32_t height) {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearConfigChange);
   DisplayError error = kErrorNone;
 
   DTRACE_SCOPED();
@@ -1695,6 +1730,7 @@ bool DisplayBase::NeedsMixerReconfiguration(LayerStack *layer_stack, uint32_t *n
 
 DisplayError DisplayBase::SetFrameBufferConfig(const DisplayConfigVariableInfo &variable_info) {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearConfigChange);
   uint32_t width = variable_info.x_pixels;
   uint32_t height = variable_info.y_pixels;
 
@@ -1744,6 +1780,7 @@ DisplayError DisplayBase::GetFrameBufferConfig(DisplayConfigVariableInfo *variab
 
 DisplayError DisplayBase::SetDetailEnhancerData(const DisplayDetailEnhancerData &de_data) {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearConfigChange);
   DisplayError error = comp_manager_->SetDetailEnhancerData(display_comp_ctx_, de_data);
   if (error != kErrorNone) {
     return error;
@@ -1803,6 +1840,7 @@ bool DisplayBase::IsPrimaryDisplay() {
 
 DisplayError DisplayBase::SetCompositionState(LayerComposition composition_type, bool enable) {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearConfigChange);
 
   return comp_manager_->SetCompositionState(display_comp_ctx_, composition_type, enable);
 }
@@ -77,6 +77,7 @@
 #include "comp_manager.h"
 #include "color_manager.h"
 #include "hw_events_interface.h"
+#include "validate_cache.h"
 
 namespace sdm {
 
@@ -258,6 +259,7 @@ class DisplayBase : public DisplayInterface {
   Handle hw_device_ = 0;
   Handle display_comp_ctx_ = 0;
   HWLayers hw_layers_;
+  ValidateCache validate_cache_;
   bool needs_validate_ = true;
   bool vsync_enable_ = false;
   uint32_t max_mixer_stages_ = 0;
@@ -1061,6 +1061,7 @@ void DppsInfo::DppsNotifyOps(enum DppsNotifyOps op, void *payload, size_t size)
 }
 
 DisplayError DisplayBuiltIn::HandleSecureEvent(SecureEvent secure_event, LayerStack *layer_stack) {
+  validate_cache_.Clear(ValidateCache::kClearSecureChange);
   hw_layers_.info.stack = layer_stack;
   DisplayError err = hw_intf_->HandleSecureEvent(secure_event, &hw_layers_);
   if (err != kErrorNone) {
@@ -1292,6 +1293,7 @@ DisplayError DisplayBuiltIn::SetActiveConfig(uint32_t index) {
 
 DisplayError DisplayBuiltIn::ReconfigureDisplay() {
   lock_guard<recursive_mutex> obj(recursive_mutex_);
+  validate_cache_.Clear(ValidateCache::kClearModeChange);
   DisplayError error = kErrorNone;
   HWDisplayAttributes display_attributes;
   HWMixerAttributes mixer_attributes;
@@ -357,6 +357,7 @@ static PrimariesTransfer GetBlendSpaceFromAttributes(const std::string &color_ga
 }
 
 DisplayError DisplayPluggable::SetColorMode(const std::string &color_mode) {
+  validate_cache_.Clear(ValidateCache::kClearColorChange);
   auto current_color_attr_ = color_mode_attr_map_.find(color_mode);
   if (current_color_attr_ == color_mode_attr_map_.end()) {
     DLOGW("Failed to get the color mode = %s", color_mode.c_str());
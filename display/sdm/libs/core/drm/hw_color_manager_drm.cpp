@@ -67,22 +67,18 @@
 
 #include <array>
 #include <map>
+#include <new>
 #include <cstring>
 #include <vector>
 
 #ifdef PP_DRM_ENABLE
 #include <display/drm/msm_drm_pp.h>
+#include "hw_color_manager_drm_lut.h"
 #endif
 #include <utils/debug.h>
 #include "hw_color_manager_drm.h"
 
 #ifdef PP_DRM_ENABLE
-static const uint32_t kPgcDataMask = 0x3FF;
-static const uint32_t kPgcShift = 16;
-
-static const uint32_t kIgcDataMask = 0xFFF;
-static const uint32_t kIgcShift = 16;
-
 #ifdef DRM_MSM_PA_HSIC
 static const uint32_t kPAHueMask = (1 << 12);
 static const uint32_t kPASatMask = (1 << 13);
@@ -153,8 +149,8 @@ static const std::array<const DrmPPFeatureMap *,
   {&g_dspp_map, &g_vig_map, &g_dgm_map}
 };
 
-DisplayError (*HWColorManagerDrm::pp_features_[])(const PPFeatureInfo &,
-                                                    DRMPPFeatureInfo *) = {
+DisplayError (HWColorManagerDrm::*HWColorManagerDrm::pp_features_[])(const PPFeatureInfo &,
+                                                                      DRMPPFeatureInfo *) = {
   [kFeaturePcc] = &HWColorManagerDrm::GetDrmPCC,
   [kFeatureIgc] = &HWColorManagerDrm::GetDrmIGC,
   [kFeaturePgc] = &HWColorManagerDrm::GetDrmPGC,
@@ -265,7 +261,7 @@ DisplayError HWColorManagerDrm::GetDrmFeature(PPFeatureInfo *in_data,
   }
 
   if (pp_features_[out_data->id])
-    ret = pp_features_[out_data->id](*in_data, out_data);
+    ret = (this->*pp_features_[out_data->id])(*in_data, out_data);
 
 
   /* Restore the original enable_flags_ */
@@ -277,93 +273,20 @@ DisplayError HWColorManagerDrm::GetDrmFeature(PPFeatureInfo *in_data,
 }
 
 void HWColorManagerDrm::FreeDrmFeatureData(DRMPPFeatureInfo *feature) {
-  if (feature && feature->payload) {
-#ifdef PP_DRM_ENABLE
-    void *ptr = feature->payload;
-#endif
-
-    switch (feature->id) {
-      case kFeaturePcc: {
-#ifdef PP_DRM_ENABLE
-        drm_msm_pcc *pcc = reinterpret_cast<drm_msm_pcc *>(ptr);
-        delete pcc;
-#endif
-        break;
-      }
-      case kFeatureIgc:
-      case kFeatureDgmIgc:
-      case kFeatureVigIgc: {
-#ifdef PP_DRM_ENABLE
-        drm_msm_igc_lut *igc = reinterpret_cast<drm_msm_igc_lut *>(ptr);
-        delete igc;
-#endif
-        break;
-      }
-      case kFeaturePgc:
-      case kFeatureDgmGc: {
-#ifdef PP_DRM_ENABLE
-        drm_msm_pgc_lut *pgc = reinterpret_cast<drm_msm_pgc_lut *>(ptr);
-        delete pgc;
-#endif
-        break;
-      }
-      case kFeatureDither: {
-#ifdef PP_DRM_ENABLE
-        drm_msm_dither *dither = reinterpret_cast<drm_msm_dither *>(ptr);
-        delete dither;
-#endif
-        break;
-      }
-      case kFeatureGamut:
-      case kFeatureVigGamut: {
-#ifdef PP_DRM_ENABLE
-        drm_msm_3d_gamut *gamut = reinterpret_cast<drm_msm_3d_gamut *>(ptr);
-        delete gamut;
-#endif
-        break;
-      }
-      case kFeaturePADither: {
-#if defined(PP_DRM_ENABLE) && defined(DRM_MSM_PA_DITHER)
-        drm_msm_pa_dither *pa_dither = reinterpret_cast<drm_msm_pa_dither *>(ptr);
-        delete pa_dither;
-#endif
-        break;
-      }
-      case kFeaturePAHsic: {
-#if defined(PP_DRM_ENABLE) && defined(DRM_MSM_PA_HSIC)
-        drm_msm_pa_hsic *hsic = reinterpret_cast<drm_msm_pa_hsic *>(ptr);
-        delete hsic;
-#endif
-        break;
-      }
-      case kFeaturePASixZone: {
-#if defined(PP_DRM_ENABLE) && defined(DRM_MSM_SIXZONE)
-        drm_msm_sixzone *sixzone = reinterpret_cast<drm_msm_sixzone *>(ptr);
-        delete sixzone;
-#endif
-        break;
-      }
-      case kFeaturePAMemColSkin:
-      case kFeaturePAMemColSky:
-      case kFeaturePAMemColFoliage:
-      case kFeaturePAMemColProt: {
-#if defined(PP_DRM_ENABLE) && defined(DRM_MSM_MEMCOL)
-        drm_msm_memcol *memcol = reinterpret_cast<drm_msm_memcol *>(ptr);
-        delete memcol;
-#endif
-        break;
-      }
-      case kFeatureMixerGc:
-      case kFeaturePaV2:
-      default: {
-        DLOGE("Invalid feature: %d\n", feature->id);
-        return;
-      }
-    }
+  // The payload stays with the feature for its next conversion
+  if (feature) {
     feature->payload = nullptr;
   }
 }
 
+template <class T>
+T *HWColorManagerDrm::GetPayload(DRMPPFeatureID id) {
+  std::vector<uint64_t> &payload = payloads_[id];
+  payload.resize((sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+  // Zeroed like a new payload, table entries past the configured size must read as zero
+  return new (payload.data()) T();
+}
+
 DisplayError HWColorManagerDrm::GetDrmPCC(const PPFeatureInfo &in_data,
                                           DRMPPFeatureInfo *out_data) {
   DisplayError ret = kErrorNone;
@@ -396,7 +319,7 @@ DisplayError HWColorManagerDrm::GetDrmPCC(const PPFeatureInfo &in_data,
     return kErrorParameters;
   }
 
-  mdp_pcc = new drm_msm_pcc();
+  mdp_pcc = GetPayload<drm_msm_pcc>(out_data->id);
   if (!mdp_pcc) {
     DLOGE("Failed to allocate memory for pcc");
     return kErrorMemory;
@@ -474,7 +397,7 @@ DisplayError HWColorManagerDrm::GetDrmIGC(const PPFeatureInfo &in_data,
     return kErrorParameters;
   }
 
-  mdp_igc = new drm_msm_igc_lut();
+  mdp_igc = GetPayload<drm_msm_igc_lut>(out_data->id);
   if (!mdp_igc) {
     DLOGE("Failed to allocate memory for igc");
     return kErrorMemory;
@@ -488,16 +411,11 @@ DisplayError HWColorManagerDrm::GetDrmIGC(const PPFeatureInfo &in_data,
 
   if (!c0_c1_data_ptr || !c2_data_ptr) {
     DLOGE("Invaid igc data pointer");
-    delete mdp_igc;
     out_data->payload = NULL;
     return kErrorParameters;
   }
 
-  for (int i = 0; i < IGC_TBL_LEN; i++) {
-    mdp_igc->c0[i] = c0_c1_data_ptr[i] & kIgcDataMask;
-    mdp_igc->c1[i] = (c0_c1_data_ptr[i] >> kIgcShift) & kIgcDataMask;
-    mdp_igc->c2[i] = c2_data_ptr[i] & kIgcDataMask;
-  }
+  UnpackIgcLut(c0_c1_data_ptr, c2_data_ptr, IGC_TBL_LEN, mdp_igc->c0, mdp_igc->c1, mdp_igc->c2);
   out_data->payload = mdp_igc;
 #endif
   return ret;
@@ -525,7 +443,7 @@ DisplayError HWColorManagerDrm::GetDrmPGC(const PPFeatureInfo &in_data,
     return kErrorParameters;
   }
 
-  mdp_pgc = new drm_msm_pgc_lut();
+  mdp_pgc = GetPayload<drm_msm_pgc_lut>(out_data->id);
   if (!mdp_pgc) {
     DLOGE("Failed to allocate memory for pgc");
     return kErrorMemory;
@@ -533,14 +451,9 @@ DisplayError HWColorManagerDrm::GetDrmPGC(const PPFeatureInfo &in_data,
 
   mdp_pgc->flags = 0;
 
-  for (int i = 0, j = 0; i < PGC_TBL_LEN; i++, j += 2) {
-    mdp_pgc->c0[i] = (sde_pgc->c0_data[j] & kPgcDataMask) |
-        (sde_pgc->c0_data[j + 1] & kPgcDataMask) << kPgcShift;
-    mdp_pgc->c1[i] = (sde_pgc->c1_data[j] & kPgcDataMask) |
-        (sde_pgc->c1_data[j + 1] & kPgcDataMask) << kPgcShift;
-    mdp_pgc->c2[i] = (sde_pgc->c2_data[j] & kPgcDataMask) |
-        (sde_pgc->c2_data[j + 1] & kPgcDataMask) << kPgcShift;
-  }
+  PackPgcLut(sde_pgc->c0_data, PGC_TBL_LEN, mdp_pgc->c0);
+  PackPgcLut(sde_pgc->c1_data, PGC_TBL_LEN, mdp_pgc->c1);
+  PackPgcLut(sde_pgc->c2_data, PGC_TBL_LEN, mdp_pgc->c2);
   out_data->payload = mdp_pgc;
 #endif
   return ret;
@@ -585,7 +498,7 @@ DisplayError HWColorManagerDrm::GetDrmPAHsic(const PPFeatureInfo &in_data,
     return ret;
   }
 
-  mdp_hsic = new drm_msm_pa_hsic();
+  mdp_hsic = GetPayload<drm_msm_pa_hsic>(out_data->id);
   if (!mdp_hsic) {
     DLOGE("Failed to allocate memory for pa hsic");
     return kErrorMemory;
@@ -615,7 +528,6 @@ DisplayError HWColorManagerDrm::GetDrmPAHsic(const PPFeatureInfo &in_data,
     out_data->payload_size = sizeof(struct drm_msm_pa_hsic);
   } else {
     /* PA HSIC configuration unchanged, no better return code available */
-    delete mdp_hsic;
     ret = kErrorPermission;
   }
 #endif
@@ -658,7 +570,7 @@ DisplayError HWColorManagerDrm::GetDrmPASixZone(const PPFeatureInfo &in_data,
         return kErrorParameters;
     }
 
-    mdp_sixzone = new drm_msm_sixzone();
+    mdp_sixzone = GetPayload<drm_msm_sixzone>(out_data->id);
     if (!mdp_sixzone) {
       DLOGE("Failed to allocate memory for six zone");
       return kErrorMemory;
@@ -727,7 +639,7 @@ DisplayError HWColorManagerDrm::GetDrmPAMemColSkin(const PPFeatureInfo &in_data,
     struct drm_msm_memcol *mdp_memcol = NULL;
     struct SDEPaMemColorData *pa_memcol = &sde_pa->skin;
 
-    mdp_memcol = new drm_msm_memcol();
+    mdp_memcol = GetPayload<drm_msm_memcol>(out_data->id);
     if (!mdp_memcol) {
       DLOGE("Failed to allocate memory for memory color skin");
       return kErrorMemory;
@@ -784,7 +696,7 @@ DisplayError HWColorManagerDrm::GetDrmPAMemColSky(const PPFeatureInfo &in_data,
     struct drm_msm_memcol *mdp_memcol = NULL;
     struct SDEPaMemColorData *pa_memcol = &sde_pa->sky;
 
-    mdp_memcol = new drm_msm_memcol();
+    mdp_memcol = GetPayload<drm_msm_memcol>(out_data->id);
     if (!mdp_memcol) {
       DLOGE("Failed to allocate memory for memory color sky");
       return kErrorMemory;
@@ -841,7 +753,7 @@ DisplayError HWColorManagerDrm::GetDrmPAMemColFoliage(const PPFeatureInfo &in_da
     struct drm_msm_memcol *mdp_memcol = NULL;
     struct SDEPaMemColorData *pa_memcol = &sde_pa->foliage;
 
-    mdp_memcol = new drm_msm_memcol();
+    mdp_memcol = GetPayload<drm_msm_memcol>(out_data->id);
     if (!mdp_memcol) {
       DLOGE("Failed to allocate memory for memory color foliage");
       return kErrorMemory;
@@ -896,7 +808,7 @@ DisplayError HWColorManagerDrm::GetDrmPAMemColProt(const PPFeatureInfo &in_data,
     return ret;
   }
 
-  mdp_memcol = new drm_msm_memcol();
+  mdp_memcol = GetPayload<drm_msm_memcol>(out_data->id);
   if (!mdp_memcol) {
     DLOGE("Failed to allocate memory for memory color prot");
     return kErrorMemory;
@@ -934,7 +846,7 @@ DisplayError HWColorManagerDrm::GetDrmDither(const PPFeatureInfo &in_data,
     return kErrorParameters;
   }
 
-  mdp_dither = new drm_msm_dither();
+  mdp_dither = GetPayload<drm_msm_dither>(out_data->id);
   if (!mdp_dither) {
     DLOGE("Failed to allocate memory for dither");
     return kErrorMemory;
@@ -975,7 +887,7 @@ DisplayError HWColorManagerDrm::GetDrmGamut(const PPFeatureInfo &in_data,
     return kErrorParameters;
   }
 
-  mdp_gamut = new drm_msm_3d_gamut();
+  mdp_gamut = GetPayload<drm_msm_3d_gamut>(out_data->id);
   if (!mdp_gamut) {
     DLOGE("Failed to allocate memory for gamut");
     return kErrorMemory;
@@ -1001,7 +913,6 @@ DisplayError HWColorManagerDrm::GetDrmGamut(const PPFeatureInfo &in_data,
       break;
     default:
       DLOGE("Invalid gamut mode %d", sde_gamut->mode);
-      delete mdp_gamut;
       return kErrorParameters;
   }
 
@@ -1015,10 +926,8 @@ DisplayError HWColorManagerDrm::GetDrmGamut(const PPFeatureInfo &in_data,
   }
 
   for (uint32_t row = 0; row < GAMUT_3D_TBL_NUM; row++) {
-    for (uint32_t col = 0; col < size; col++) {
-      mdp_gamut->col[row][col].c0 = sde_gamut->c0_data[row][col];
-      mdp_gamut->col[row][col].c2_c1 = sde_gamut->c1_c2_data[row][col];
-    }
+    InterleaveGamutTable(sde_gamut->c0_data[row], sde_gamut->c1_c2_data[row], size,
+                         mdp_gamut->col[row]);
   }
   out_data->payload = mdp_gamut;
 #endif
@@ -1052,7 +961,7 @@ DisplayError HWColorManagerDrm::GetDrmPADither(const PPFeatureInfo &in_data,
     return kErrorParameters;
   }
 
-  mdp_dither = new drm_msm_pa_dither();
+  mdp_dither = GetPayload<drm_msm_pa_dither>(out_data->id);
   if (!mdp_dither) {
     DLOGE("Failed to allocate memory for dither");
     return kErrorMemory;
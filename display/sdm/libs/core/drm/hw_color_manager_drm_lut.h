@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __HW_COLOR_MANAGER_DRM_LUT_H__
+#define __HW_COLOR_MANAGER_DRM_LUT_H__
+
+#include <display/drm/msm_drm_pp.h>
+#include <stdint.h>
+
+namespace sdm {
+
+static const uint32_t kPgcDataMask = 0x3FF;
+static const uint32_t kPgcShift = 16;
+
+static const uint32_t kIgcDataMask = 0xFFF;
+static const uint32_t kIgcShift = 16;
+
+// LUT conversion kernels. Source and destination are passed as hoisted, non-aliasing pointers
+// so that the compiler can vectorize the loops (NEON on arm64); reading the table pointers
+// through the config structs would reload them after every store.
+inline void UnpackIgcLut(const uint32_t *__restrict c0_c1, const uint32_t *__restrict c2,
+                         uint32_t len, uint32_t *__restrict c0_out, uint32_t *__restrict c1_out,
+                         uint32_t *__restrict c2_out) {
+  for (uint32_t i = 0; i < len; i++) {
+    c0_out[i] = c0_c1[i] & kIgcDataMask;
+    c1_out[i] = (c0_c1[i] >> kIgcShift) & kIgcDataMask;
+    c2_out[i] = c2[i] & kIgcDataMask;
+  }
+}
+
+// Packs two consecutive 10 bit entries into each 32 bit word.
+inline void PackPgcLut(const uint32_t *__restrict in, uint32_t len, uint32_t *__restrict out) {
+  for (uint32_t i = 0; i < len; i++) {
+    out[i] = (in[2 * i] & kPgcDataMask) | (in[2 * i + 1] & kPgcDataMask) << kPgcShift;
+  }
+}
+
+inline void InterleaveGamutTable(const uint32_t *__restrict c0, const uint32_t *__restrict c1_c2,
+                                 uint32_t len, struct drm_msm_3d_col *__restrict out) {
+  for (uint32_t i = 0; i < len; i++) {
+    out[i].c0 = c0[i];
+    out[i].c2_c1 = c1_c2[i];
+  }
+}
+
+}  // namespace sdm
+
+#endif  // __HW_COLOR_MANAGER_DRM_LUT_H__
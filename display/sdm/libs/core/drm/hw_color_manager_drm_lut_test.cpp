@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "hw_color_manager_drm_lut.h"
+
+namespace sdm {
+
+namespace {
+
+// Source tables as the colour HAL hands them over, behind pointers in the config structs
+struct IgcSource {
+  uint32_t *c0_c1_data;
+  uint32_t *c2_data;
+};
+
+struct PgcSource {
+  uint32_t *c0_data;
+  uint32_t *c1_data;
+  uint32_t *c2_data;
+};
+
+struct GamutSource {
+  uint32_t *c0_data[GAMUT_3D_TBL_NUM];
+  uint32_t *c1_c2_data[GAMUT_3D_TBL_NUM];
+};
+
+// The per-element loops the kernels replaced, kept as the reference
+void LegacyIgc(const IgcSource *sde_igc, drm_msm_igc_lut *mdp_igc) {
+  for (int i = 0; i < IGC_TBL_LEN; i++) {
+    mdp_igc->c0[i] = sde_igc->c0_c1_data[i] & kIgcDataMask;
+    mdp_igc->c1[i] = (sde_igc->c0_c1_data[i] >> kIgcShift) & kIgcDataMask;
+    mdp_igc->c2[i] = sde_igc->c2_data[i] & kIgcDataMask;
+  }
+}
+
+void LegacyPgc(const PgcSource *sde_pgc, drm_msm_pgc_lut *mdp_pgc) {
+  for (int i = 0, j = 0; i < PGC_TBL_LEN; i++, j += 2) {
+    mdp_pgc->c0[i] = (sde_pgc->c0_data[j] & kPgcDataMask) |
+        (sde_pgc->c0_data[j + 1] & kPgcDataMask) << kPgcShift;
+    mdp_pgc->c1[i] = (sde_pgc->c1_data[j] & kPgcDataMask) |
+        (sde_pgc->c1_data[j + 1] & kPgcDataMask) << kPgcShift;
+    mdp_pgc->c2[i] = (sde_pgc->c2_data[j] & kPgcDataMask) |
+        (sde_pgc->c2_data[j + 1] & kPgcDataMask) << kPgcShift;
+  }
+}
+
+void LegacyGamut(const GamutSource *sde_gamut, uint32_t size, drm_msm_3d_gamut *mdp_gamut) {
+  for (uint32_t row = 0; row < GAMUT_3D_TBL_NUM; row++) {
+    for (uint32_t col = 0; col < size; col++) {
+      mdp_gamut->col[row][col].c0 = sde_gamut->c0_data[row][col];
+      mdp_gamut->col[row][col].c2_c1 = sde_gamut->c1_c2_data[row][col];
+    }
+  }
+}
+
+void Gamut(const GamutSource *sde_gamut, uint32_t size, drm_msm_3d_gamut *mdp_gamut) {
+  for (uint32_t row = 0; row < GAMUT_3D_TBL_NUM; row++) {
+    InterleaveGamutTable(sde_gamut->c0_data[row], sde_gamut->c1_c2_data[row], size,
+                         mdp_gamut->col[row]);
+  }
+}
+
+// Random words, with the all zero and all one words and the mask boundaries mixed in
+std::vector<uint32_t> TestWords(size_t count, uint32_t seed) {
+  static const uint32_t kBoundaries[] = {0x0, 0xFFFFFFFF, 0x3FF, 0x400, 0xFFF, 0x1000,
+                                         0xFFF0FFF, 0xF000F000, 0x0FFF0000, 0x80000000};
+  std::mt19937 rng(seed);
+  std::vector<uint32_t> words(count);
+  for (size_t i = 0; i < count; i++) {
+    words[i] = (i % 7) ? rng() : kBoundaries[(i / 7) % (sizeof(kBoundaries) / sizeof(uint32_t))];
+  }
+  return words;
+}
+
+}  // namespace
+
+TEST(HWColorManagerDrmLutTest, IgcMatchesLegacy) {
+  for (uint32_t seed = 0; seed < 16; seed++) {
+    std::vector<uint32_t> c0_c1 = TestWords(IGC_TBL_LEN, seed);
+    std::vector<uint32_t> c2 = TestWords(IGC_TBL_LEN, seed + 100);
+    IgcSource source = {c0_c1.data(), c2.data()};
+    auto expected = std::make_unique<drm_msm_igc_lut>();
+    auto actual = std::make_unique<drm_msm_igc_lut>();
+
+    LegacyIgc(&source, expected.get());
+    UnpackIgcLut(c0_c1.data(), c2.data(), IGC_TBL_LEN, actual->c0, actual->c1, actual->c2);
+    ASSERT_EQ(0, memcmp(expected.get(), actual.get(), sizeof(drm_msm_igc_lut))) << seed;
+  }
+}
+
+TEST(HWColorManagerDrmLutTest, PgcMatchesLegacy) {
+  for (uint32_t seed = 0; seed < 16; seed++) {
+    std::vector<uint32_t> c0 = TestWords(PGC_TBL_LEN * 2, seed);
+    std::vector<uint32_t> c1 = TestWords(PGC_TBL_LEN * 2, seed + 100);
+    std::vector<uint32_t> c2 = TestWords(PGC_TBL_LEN * 2, seed + 200);
+    PgcSource source = {c0.data(), c1.data(), c2.data()};
+    auto expected = std::make_unique<drm_msm_pgc_lut>();
+    auto actual = std::make_unique<drm_msm_pgc_lut>();
+
+    LegacyPgc(&source, expected.get());
+    PackPgcLut(c0.data(), PGC_TBL_LEN, actual->c0);
+    PackPgcLut(c1.data(), PGC_TBL_LEN, actual->c1);
+    PackPgcLut(c2.data(), PGC_TBL_LEN, actual->c2);
+    ASSERT_EQ(0, memcmp(expected.get(), actual.get(), sizeof(drm_msm_pgc_lut))) << seed;
+  }
+}
+
+TEST(HWColorManagerDrmLutTest, GamutMatchesLegacy) {
+  for (uint32_t size : {GAMUT_3D_MODE17_TBL_SZ, GAMUT_3D_MODE13_TBL_SZ, GAMUT_3D_MODE5_TBL_SZ}) {
+    std::vector<uint32_t> tables[GAMUT_3D_TBL_NUM * 2];
+    GamutSource source = {};
+    for (uint32_t row = 0; row < GAMUT_3D_TBL_NUM; row++) {
+      tables[row] = TestWords(size, row);
+      tables[GAMUT_3D_TBL_NUM + row] = TestWords(size, row + 100);
+      source.c0_data[row] = tables[row].data();
+      source.c1_c2_data[row] = tables[GAMUT_3D_TBL_NUM + row].data();
+    }
+    auto expected = std::make_unique<drm_msm_3d_gamut>();
+    auto actual = std::make_unique<drm_msm_3d_gamut>();
+
+    LegacyGamut(&source, size, expected.get());
+    Gamut(&source, size, actual.get());
+    ASSERT_EQ(0, memcmp(expected.get(), actual.get(), sizeof(drm_msm_3d_gamut))) << size;
+  }
+}
+
+// Conversion of a full 17x17x17 gamut table, the largest LUT a colour mode sets
+TEST(HWColorManagerDrmLutTest, Gamut17Time) {
+  const int kIterations = 2000;
+  std::vector<uint32_t> tables[GAMUT_3D_TBL_NUM * 2];
+  GamutSource source = {};
+  for (uint32_t row = 0; row < GAMUT_3D_TBL_NUM; row++) {
+    tables[row] = TestWords(GAMUT_3D_MODE17_TBL_SZ, row);
+    tables[GAMUT_3D_TBL_NUM + row] = TestWords(GAMUT_3D_MODE17_TBL_SZ, row + 100);
+    source.c0_data[row] = tables[row].data();
+    source.c1_c2_data[row] = tables[GAMUT_3D_TBL_NUM + row].data();
+  }
+  auto gamut = std::make_unique<drm_msm_3d_gamut>();
+  Gamut(&source, GAMUT_3D_MODE17_TBL_SZ, gamut.get());
+
+  auto begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    Gamut(&source, GAMUT_3D_MODE17_TBL_SZ, gamut.get());
+  }
+  auto kernel_time = std::chrono::steady_clock::now() - begin;
+
+  begin = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; i++) {
+    LegacyGamut(&source, GAMUT_3D_MODE17_TBL_SZ, gamut.get());
+  }
+  auto legacy_time = std::chrono::steady_clock::now() - begin;
+
+  auto per_table = [&](std::chrono::steady_clock::duration time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / kIterations;
+  };
+  std::cout << "17x17x17 gamut: kernel " << per_table(kernel_time) << " ns, per element "
+            << per_table(legacy_time) << " ns per table" << std::endl;
+}
+
+}  // namespace sdm
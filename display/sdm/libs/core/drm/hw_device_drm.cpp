@@ -105,16 +105,6 @@
 
 #define __CLASS__ "HWDeviceDRM"
 
-#ifndef DRM_FORMAT_MOD_QCOM_COMPRESSED
-#define DRM_FORMAT_MOD_QCOM_COMPRESSED fourcc_mod_code(QCOM, 1)
-#endif
-#ifndef DRM_FORMAT_MOD_QCOM_DX
-#define DRM_FORMAT_MOD_QCOM_DX fourcc_mod_code(QCOM, 0x2)
-#endif
-#ifndef DRM_FORMAT_MOD_QCOM_TIGHT
-#define DRM_FORMAT_MOD_QCOM_TIGHT fourcc_mod_code(QCOM, 0x4)
-#endif
-
 using std::string;
 using std::to_string;
 using std::fstream;
@@ -167,321 +157,6 @@ static PPBlock GetPPBlock(const HWToneMapLut &lut_type) {
   return pp_block;
 }
 
-static void GetDRMFormat(LayerBufferFormat format, uint32_t *drm_format,
-                         uint64_t *drm_format_modifier) {
-  switch (format) {
-    case kFormatRGBA8888:
-      *drm_format = DRM_FORMAT_ABGR8888;
-      break;
-    case kFormatRGBA8888Ubwc:
-      *drm_format = DRM_FORMAT_ABGR8888;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_COMPRESSED;
-      break;
-    case kFormatRGBA5551:
-      *drm_format = DRM_FORMAT_ABGR1555;
-      break;
-    case kFormatRGBA4444:
-      *drm_format = DRM_FORMAT_ABGR4444;
-      break;
-    case kFormatBGRA8888:
-      *drm_format = DRM_FORMAT_ARGB8888;
-      break;
-    case kFormatRGBX8888:
-      *drm_format = DRM_FORMAT_XBGR8888;
-      break;
-    case kFormatRGBX8888Ubwc:
-      *drm_format = DRM_FORMAT_XBGR8888;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_COMPRESSED;
-      break;
-    case kFormatBGRX8888:
-      *drm_format = DRM_FORMAT_XRGB8888;
-      break;
-    case kFormatRGB888:
-      *drm_format = DRM_FORMAT_BGR888;
-      break;
-    case kFormatBGR888:
-      *drm_format = DRM_FORMAT_RGB888;
-      break;
-    case kFormatRGB565:
-      *drm_format = DRM_FORMAT_BGR565;
-      break;
-    case kFormatBGR565:
-      *drm_format = DRM_FORMAT_RGB565;
-      break;
-    case kFormatBGR565Ubwc:
-      *drm_format = DRM_FORMAT_BGR565;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_COMPRESSED;
-      break;
-    case kFormatRGBA1010102:
-      *drm_format = DRM_FORMAT_ABGR2101010;
-      break;
-    case kFormatRGBA1010102Ubwc:
-      *drm_format = DRM_FORMAT_ABGR2101010;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_COMPRESSED;
-      break;
-    case kFormatARGB2101010:
-      *drm_format = DRM_FORMAT_BGRA1010102;
-      break;
-    case kFormatRGBX1010102:
-      *drm_format = DRM_FORMAT_XBGR2101010;
-      break;
-    case kFormatRGBX1010102Ubwc:
-      *drm_format = DRM_FORMAT_XBGR2101010;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_COMPRESSED;
-      break;
-    case kFormatXRGB2101010:
-      *drm_format = DRM_FORMAT_BGRX1010102;
-      break;
-    case kFormatBGRA1010102:
-      *drm_format = DRM_FORMAT_ARGB2101010;
-      break;
-    case kFormatABGR2101010:
-      *drm_format = DRM_FORMAT_RGBA1010102;
-      break;
-    case kFormatBGRX1010102:
-      *drm_format = DRM_FORMAT_XRGB2101010;
-      break;
-    case kFormatXBGR2101010:
-      *drm_format = DRM_FORMAT_RGBX1010102;
-      break;
-    case kFormatYCbCr420SemiPlanar:
-      *drm_format = DRM_FORMAT_NV12;
-      break;
-    case kFormatYCbCr420SemiPlanarVenus:
-      *drm_format = DRM_FORMAT_NV12;
-      break;
-    case kFormatYCbCr420SPVenusUbwc:
-      *drm_format = DRM_FORMAT_NV12;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_COMPRESSED;
-      break;
-    case kFormatYCbCr420SPVenusTile:
-      *drm_format = DRM_FORMAT_NV12;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_TILE;
-      break;
-    case kFormatYCrCb420SemiPlanar:
-      *drm_format = DRM_FORMAT_NV21;
-      break;
-    case kFormatYCrCb420SemiPlanarVenus:
-      *drm_format = DRM_FORMAT_NV21;
-      break;
-    case kFormatYCbCr420P010:
-    case kFormatYCbCr420P010Venus:
-      *drm_format = DRM_FORMAT_NV12;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_DX;
-      break;
-    case kFormatYCbCr420P010Ubwc:
-      *drm_format = DRM_FORMAT_NV12;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_COMPRESSED |
-        DRM_FORMAT_MOD_QCOM_DX;
-      break;
-    case kFormatYCbCr420P010Tile:
-      *drm_format = DRM_FORMAT_NV12;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_TILE |
-        DRM_FORMAT_MOD_QCOM_DX;
-      break;
-    case kFormatYCbCr420TP10Ubwc:
-      *drm_format = DRM_FORMAT_NV12;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_COMPRESSED |
-        DRM_FORMAT_MOD_QCOM_DX | DRM_FORMAT_MOD_QCOM_TIGHT;
-      break;
-    case kFormatYCbCr420TP10Tile:
-      *drm_format = DRM_FORMAT_NV12;
-      *drm_format_modifier = DRM_FORMAT_MOD_QCOM_TILE |
-        DRM_FORMAT_MOD_QCOM_DX | DRM_FORMAT_MOD_QCOM_TIGHT;
-      break;
-    case kFormatYCbCr422H2V1SemiPlanar:
-      *drm_format = DRM_FORMAT_NV16;
-      break;
-    case kFormatYCrCb422H2V1SemiPlanar:
-      *drm_format = DRM_FORMAT_NV61;
-      break;
-    case kFormatYCrCb420PlanarStride16:
-      *drm_format = DRM_FORMAT_YVU420;
-      break;
-    default:
-      DLOGW("Unsupported format %s", GetFormatString(format));
-  }
-}
-
-class FrameBufferObject : public LayerBufferObject {
- public:
-  explicit FrameBufferObject(uint32_t fb_id, LayerBufferFormat format,
-                             uint32_t width, uint32_t height)
-    :fb_id_(fb_id), format_(format), width_(width), height_(height) {
-  }
-
-  ~FrameBufferObject() {
-    DRMMaster *master;
-    DRMMaster::GetInstance(&master);
-    int ret = master->RemoveFbId(fb_id_);
-    if (ret < 0) {
-      DLOGE("Removing fb_id %d failed with error %d", fb_id_, errno);
-    }
-  }
-  uint32_t GetFbId() { return fb_id_; }
-  bool IsEqual(LayerBufferFormat format, uint32_t width, uint32_t height) {
-    return (format == format_ && width == width_ && height == height_);
-  }
-
- private:
-  uint32_t fb_id_;
-  LayerBufferFormat format_;
-  uint32_t width_;
-  uint32_t height_;
-};
-
-HWDeviceDRM::Registry::Registry(BufferAllocator *buffer_allocator) :
-  buffer_allocator_(buffer_allocator) {
-  int value = 0;
-  if (Debug::GetProperty(DISABLE_FBID_CACHE, &value) == kErrorNone) {
-    disable_fbid_cache_ = (value == 1);
-  }
-}
-
-void HWDeviceDRM::Registry::Register(HWLayers *hw_layers) {
-  HWLayersInfo &hw_layer_info = hw_layers->info;
-  uint32_t hw_layer_count = UINT32(hw_layer_info.hw_layers.size());
-
-  for (uint32_t i = 0; i < hw_layer_count; i++) {
-    Layer &layer = hw_layer_info.hw_layers.at(i);
-    LayerBuffer input_buffer = layer.input_buffer;
-    HWRotatorSession *hw_rotator_session = &hw_layers->config[i].hw_rotator_session;
-    HWRotateInfo *hw_rotate_info = &hw_rotator_session->hw_rotate_info[0];
-    fbid_cache_limit_ = input_buffer.flags.video ? VIDEO_FBID_LIMIT : UI_FBID_LIMIT;
-
-    if (hw_rotator_session->mode == kRotatorOffline && hw_rotate_info->valid) {
-      input_buffer = hw_rotator_session->output_buffer;
-      fbid_cache_limit_ = OFFLINE_ROTATOR_FBID_LIMIT;
-    }
-
-    if (input_buffer.flags.interlace) {
-      input_buffer.width *= 2;
-      input_buffer.height /= 2;
-    }
-    MapBufferToFbId(&layer, input_buffer);
-  }
-}
-
-int HWDeviceDRM::Registry::CreateFbId(const LayerBuffer &buffer, uint32_t *fb_id) {
-  DRMMaster *master = nullptr;
-  DRMMaster::GetInstance(&master);
-  int ret = -1;
-
-  if (!master) {
-    DLOGE("Failed to acquire DRM Master instance");
-    return ret;
-  }
-
-  DRMBuffer layout{};
-  AllocatedBufferInfo buf_info{};
-  buf_info.fd = layout.fd = buffer.planes[0].fd;
-  buf_info.aligned_width = layout.width = buffer.width;
-  buf_info.aligned_height = layout.height = buffer.height;
-  buf_info.format = buffer.format;
-  GetDRMFormat(buf_info.format, &layout.drm_format, &layout.drm_format_modifier);
-  buffer_allocator_->GetBufferLayout(buf_info, layout.stride, layout.offset, &layout.num_planes);
-  ret = master->CreateFbId(layout, fb_id);
-  if (ret < 0) {
-    DLOGE("CreateFbId failed. width %d, height %d, format: %s, stride %u, error %d",
-        layout.width, layout.height, GetFormatString(buf_info.format), layout.stride[0], errno);
-  }
-
-  return ret;
-}
-
-void HWDeviceDRM::Registry::MapBufferToFbId(Layer* layer, const LayerBuffer &buffer) {
-  if (buffer.planes[0].fd < 0) {
-    return;
-  }
-
-  uint64_t handle_id = buffer.handle_id;
-  if (!handle_id || disable_fbid_cache_) {
-    // In legacy path, clear fb_id map in each frame.
-    layer->buffer_map->buffer_map.clear();
-  } else {
-    auto it = layer->buffer_map->buffer_map.find(handle_id);
-    if (it != layer->buffer_map->buffer_map.end()) {
-      FrameBufferObject *fb_obj = static_cast<FrameBufferObject*>(it->second.get());
-      if (fb_obj->IsEqual(buffer.format, buffer.width, buffer.height)) {
-        // Found fb_id for given handle_id key
-        return;
-      } else {
-        // Erase from fb_id map if format or size have been modified
-        layer->buffer_map->buffer_map.erase(it);
-      }
-    }
-
-    if (layer->buffer_map->buffer_map.size() >= fbid_cache_limit_) {
-      // Clear fb_id map, if the size reaches cache limit.
-      layer->buffer_map->buffer_map.clear();
-    }
-  }
-
-  uint32_t fb_id = 0;
-  if (CreateFbId(buffer, &fb_id) >= 0) {
-    // Create and cache the fb_id in map
-    layer->buffer_map->buffer_map[handle_id] = std::make_shared<FrameBufferObject>(fb_id,
-        buffer.format, buffer.width, buffer.height);
-  }
-}
-
-void HWDeviceDRM::Registry::MapOutputBufferToFbId(LayerBuffer *output_buffer) {
-  if (output_buffer->planes[0].fd < 0) {
-    return;
-  }
-
-  uint64_t handle_id = output_buffer->handle_id;
-  if (!handle_id || disable_fbid_cache_) {
-    // In legacy path, clear output buffer map in each frame.
-    output_buffer_map_.clear();
-  } else {
-    auto it = output_buffer_map_.find(handle_id);
-    if (it != output_buffer_map_.end()) {
-      FrameBufferObject *fb_obj = static_cast<FrameBufferObject*>(it->second.get());
-      if (fb_obj->IsEqual(output_buffer->format, output_buffer->width, output_buffer->height)) {
-        return;
-      } else {
-        output_buffer_map_.erase(it);
-      }
-    }
-
-    if (output_buffer_map_.size() >= UI_FBID_LIMIT) {
-      // Clear output buffer map, if the size reaches cache limit.
-      output_buffer_map_.clear();
-    }
-  }
-
-  uint32_t fb_id = 0;
-  if (CreateFbId(*output_buffer, &fb_id) >= 0) {
-    output_buffer_map_[handle_id] = std::make_shared<FrameBufferObject>(fb_id,
-        output_buffer->format, output_buffer->width, output_buffer->height);
-  }
-}
-
-void HWDeviceDRM::Registry::Clear() {
-  output_buffer_map_.clear();
-}
-
-uint32_t HWDeviceDRM::Registry::GetFbId(Layer *layer, uint64_t handle_id) {
-  auto it = layer->buffer_map->buffer_map.find(handle_id);
-  if (it != layer->buffer_map->buffer_map.end()) {
-    FrameBufferObject *fb_obj = static_cast<FrameBufferObject*>(it->second.get());
-    return fb_obj->GetFbId();
-  }
-
-  return 0;
-}
-
-uint32_t HWDeviceDRM::Registry::GetOutputFbId(uint64_t handle_id) {
-  auto it = output_buffer_map_.find(handle_id);
-  if (it != output_buffer_map_.end()) {
-    FrameBufferObject *fb_obj = static_cast<FrameBufferObject*>(it->second.get());
-    return fb_obj->GetFbId();
-  }
-
-  return 0;
-}
-
 HWDeviceDRM::HWDeviceDRM(BufferAllocator *buffer_allocator, HWInfoInterface *hw_info_intf)
     : hw_info_intf_(hw_info_intf), registry_(buffer_allocator) {
   hw_info_intf_ = hw_info_intf;
@@ -1681,11 +1356,18 @@ DisplayError HWDeviceDRM::AtomicCommit(HWLayers *hw_layers) {
     HWRotatorSession *hw_rotator_session = &hw_layers->config[i].hw_rotator_session;
     if (hw_rotator_session->mode == kRotatorOffline) {
       hw_rotator_session->output_buffer.release_fence = release_fence;
+      registry_.SetReleaseFence(&layer, hw_rotator_session->output_buffer.handle_id,
+                                release_fence);
     } else {
       layer.input_buffer.release_fence = release_fence;
+      registry_.SetReleaseFence(&layer, layer.input_buffer.handle_id, release_fence);
     }
   }
 
+  if (stack->output_buffer) {
+    registry_.SetOutputReleaseFence(stack->output_buffer->handle_id, retire_fence);
+  }
+
   hw_layer_info.sync_handle = release_fence;
 
   if (vrefresh_) {
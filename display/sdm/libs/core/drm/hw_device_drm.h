@@ -71,6 +71,7 @@
 #include <pthread.h>
 #include <xf86drmMode.h>
 #include <atomic>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -149,6 +150,7 @@ class HWDeviceDRM : public HWInterface {
   virtual DisplayError GetMixerAttributes(HWMixerAttributes *mixer_attributes);
   virtual void InitializeConfigs();
   virtual DisplayError DumpDebugData();
+  virtual void Dump(std::ostringstream *os) { registry_.Dump(os); }
   virtual void PopulateHWPanelInfo();
   virtual DisplayError SetDppsFeature(void *payload, size_t size) { return kErrorNotSupported; }
   virtual DisplayError GetDppsFeatureInfo(void *payload, size_t size) { return kErrorNotSupported; }
@@ -235,19 +237,33 @@ class HWDeviceDRM : public HWInterface {
     // Create the fd_id for the given buffer.
     int CreateFbId(const LayerBuffer &buffer, uint32_t *fb_id);
     // Find handle_id in the layer map. Else create fb_id and add <handle_id,fb_id> in map.
-    void MapBufferToFbId(Layer* layer, const LayerBuffer &buffer);
+    void MapBufferToFbId(Layer* layer, const LayerBuffer &buffer, uint32_t fbid_cache_limit);
     // Find handle_id in output buffer map. Else create fb_id and add <handle_id,fb_id> in map.
     void MapOutputBufferToFbId(LayerBuffer* buffer);
     // Find fb_id for given handle_id in the layer map.
     uint32_t GetFbId(Layer *layer, uint64_t handle_id);
     // Find fb_id for given handle_id in output buffer map.
     uint32_t GetOutputFbId(uint64_t handle_id);
+    // Called on each Commit to mark the fb_ids scanned out until the release fence signals.
+    void SetReleaseFence(Layer *layer, uint64_t handle_id, const shared_ptr<Fence> &fence);
+    // Called on each Commit to mark the output fb_id written until the retire fence signals.
+    void SetOutputReleaseFence(uint64_t handle_id, const shared_ptr<Fence> &fence);
+    void Dump(std::ostringstream *os);
 
    private:
+    typedef std::unordered_map<uint64_t, std::shared_ptr<LayerBufferObject>> FbIdMap;
+
+    void MapToFbId(FbIdMap *fb_map, const LayerBuffer &buffer, uint32_t fbid_cache_limit);
+    bool EvictLeastRecentlyUsed(FbIdMap *fb_map);
+
     bool disable_fbid_cache_ = false;
-    std::unordered_map<uint64_t, std::shared_ptr<LayerBufferObject>> output_buffer_map_ {};
+    FbIdMap output_buffer_map_ {};
     BufferAllocator *buffer_allocator_ = {};
-    uint8_t fbid_cache_limit_ = UI_FBID_LIMIT;
+    uint64_t use_count_ = 0;
+    uint64_t hit_count_ = 0;
+    uint64_t miss_count_ = 0;
+    uint64_t evict_count_ = 0;
+    uint64_t over_budget_count_ = 0;
   };
 
  protected:
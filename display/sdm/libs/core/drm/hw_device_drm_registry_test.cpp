@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <drm_master.h>
+#include <gtest/gtest.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <utils/fence.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "hw_device_drm.h"
+
+namespace {
+
+// fb ids handed out by the fake DRMMaster
+struct FakeFbIds {
+  std::set<uint32_t> live;
+  uint32_t next_id = 1;
+  int creates = 0;
+  int removes = 0;
+  int bad_removes = 0;
+};
+
+FakeFbIds *fake_fb_ids = nullptr;
+
+}  // namespace
+
+// DRMMaster of the fake driver, the test links this instead of libdrmutils
+namespace drm_utils {
+
+DRMMaster *DRMMaster::s_instance = nullptr;
+std::mutex DRMMaster::s_lock;
+
+DRMMaster::~DRMMaster() {}
+
+int DRMMaster::GetInstance(DRMMaster **master) {
+  std::lock_guard<std::mutex> obj(s_lock);
+  if (!s_instance) {
+    s_instance = new DRMMaster();
+  }
+  *master = s_instance;
+  return 0;
+}
+
+int DRMMaster::CreateFbId(const DRMBuffer &drm_buffer, uint32_t *fb_id) {
+  *fb_id = fake_fb_ids->next_id++;
+  fake_fb_ids->live.insert(*fb_id);
+  fake_fb_ids->creates++;
+  return 0;
+}
+
+int DRMMaster::RemoveFbId(uint32_t fb_id) {
+  fake_fb_ids->removes++;
+  if (!fake_fb_ids->live.erase(fb_id)) {
+    fake_fb_ids->bad_removes++;
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace drm_utils
+
+namespace sdm {
+
+namespace {
+
+// Fences are eventfds, pending until the test signals them
+class FakeSyncHandler : public BufferSyncHandler {
+ public:
+  DisplayError SyncWait(int fd) { return SyncWait(fd, -1); }
+  DisplayError SyncWait(int fd, int timeout) {
+    return pending_.count(fd) ? kErrorTimeOut : kErrorNone;
+  }
+  DisplayError SyncMerge(int fd1, int fd2, int *merged_fd) { return kErrorNotSupported; }
+  bool IsSyncSignaled(int fd) { return !pending_.count(fd); }
+  void GetSyncInfo(int fd, std::ostringstream *os) {}
+
+  shared_ptr<Fence> CreateFence() {
+    int fd = eventfd(0, EFD_CLOEXEC);
+    shared_ptr<Fence> fence = Fence::Create(fd, "fbid_test");
+    fds_[fence.get()] = fd;
+    pending_.insert(fd);
+    return fence;
+  }
+  void Signal(const shared_ptr<Fence> &fence) { pending_.erase(fds_[fence.get()]); }
+
+ private:
+  std::map<Fence *, int> fds_;
+  std::set<int> pending_;
+};
+
+class FakeBufferAllocator : public BufferAllocator {
+ public:
+  DisplayError AllocateBuffer(BufferInfo *buffer_info) { return kErrorNotSupported; }
+  DisplayError FreeBuffer(BufferInfo *buffer_info) { return kErrorNotSupported; }
+  uint32_t GetBufferSize(BufferInfo *buffer_info) { return 0; }
+  DisplayError GetAllocatedBufferInfo(const BufferConfig &buffer_config,
+                                      AllocatedBufferInfo *allocated_buffer_info) {
+    return kErrorNotSupported;
+  }
+  DisplayError GetBufferLayout(const AllocatedBufferInfo &buf_info, uint32_t stride[4],
+                               uint32_t offset[4], uint32_t *num_planes) {
+    stride[0] = buf_info.aligned_width;
+    offset[0] = 0;
+    *num_planes = 1;
+    return kErrorNone;
+  }
+  DisplayError GetHeight(void *buf, uint32_t &height) { return kErrorNotSupported; }
+  DisplayError GetWidth(void *buf, uint32_t &width) { return kErrorNotSupported; }
+  int GetUnalignedHeight(void *buf, uint32_t &height) { return -1; }
+  int GetUnalignedWidth(void *buf, uint32_t &width) { return -1; }
+  DisplayError GetFd(void *buf, int &fd) { return kErrorNotSupported; }
+  DisplayError GetAllocationSize(void *buf, uint32_t &alloc_size) { return kErrorNotSupported; }
+  DisplayError GetBufferId(void *buf, uint64_t &id) { return kErrorNotSupported; }
+  int GetFormat(void *buf, int32_t &format) { return -1; }
+  int GetPrivateFlags(void *buf, int32_t &flags) { return -1; }
+};
+
+// Registry is internal to HWDeviceDRM
+class RegistryAccess : public HWDeviceDRM {
+ public:
+  using HWDeviceDRM::Registry;
+};
+
+typedef RegistryAccess::Registry Registry;
+
+}  // namespace
+
+class FbIdRegistryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    fake_fb_ids = &fb_ids_;
+    Fence::Set(&sync_handler_);
+    registry_.reset(new Registry(&allocator_));
+    layer_.buffer_map = std::make_shared<LayerBufferMap>();
+  }
+
+  void TearDown() override {
+    registry_.reset();
+    layer_.buffer_map = nullptr;
+    // Every fb id is removed once, when its buffer leaves the cache
+    EXPECT_TRUE(fb_ids_.live.empty());
+    EXPECT_EQ(fb_ids_.creates, fb_ids_.removes);
+    EXPECT_EQ(0, fb_ids_.bad_removes);
+    fake_fb_ids = nullptr;
+  }
+
+  LayerBuffer Buffer(uint64_t handle_id, bool video) {
+    LayerBuffer buffer;
+    buffer.width = 1920;
+    buffer.height = 1088;
+    buffer.format = video ? kFormatYCbCr420SPVenusUbwc : kFormatRGBA8888Ubwc;
+    buffer.flags.video = video;
+    buffer.planes[0].fd = 100;
+    buffer.handle_id = handle_id;
+    return buffer;
+  }
+
+  // Validate and commit of one frame showing the buffer, returns its fb id. The frame is on
+  // screen until the release fence of the next commit signals.
+  uint32_t Present(const LayerBuffer &buffer) {
+    HWLayers hw_layers;
+    layer_.input_buffer = buffer;
+    hw_layers.info.hw_layers.push_back(layer_);
+    registry_->Register(&hw_layers);
+    registry_->Register(&hw_layers);
+    shared_ptr<Fence> release_fence = sync_handler_.CreateFence();
+    registry_->SetReleaseFence(&layer_, buffer.handle_id, release_fence);
+    if (on_screen_) {
+      sync_handler_.Signal(on_screen_);
+    }
+    on_screen_ = release_fence;
+    return registry_->GetFbId(&layer_, buffer.handle_id);
+  }
+
+  size_t CacheSize() { return layer_.buffer_map->buffer_map.size(); }
+
+  FakeFbIds fb_ids_;
+  FakeSyncHandler sync_handler_;
+  FakeBufferAllocator allocator_;
+  std::unique_ptr<Registry> registry_;
+  Layer layer_;
+  shared_ptr<Fence> on_screen_;
+};
+
+TEST_F(FbIdRegistryTest, BuffersWithinBudgetAreReused) {
+  std::map<uint64_t, uint32_t> fb_ids;
+  for (int frame = 0; frame < 100; frame++) {
+    uint64_t handle_id = 1 + (frame % VIDEO_FBID_LIMIT);
+    uint32_t fb_id = Present(Buffer(handle_id, true));
+    ASSERT_NE(0u, fb_id);
+    if (fb_ids.count(handle_id)) {
+      EXPECT_EQ(fb_ids[handle_id], fb_id);
+    }
+    fb_ids[handle_id] = fb_id;
+  }
+  EXPECT_EQ(VIDEO_FBID_LIMIT, fb_ids_.creates);
+  EXPECT_EQ(0, fb_ids_.removes);
+}
+
+// A miss over budget drops the least recently used fb id only, not the whole map
+TEST_F(FbIdRegistryTest, MissEvictsLeastRecentlyUsed) {
+  std::vector<uint32_t> fb_ids;
+  for (uint64_t handle_id = 1; handle_id <= UI_FBID_LIMIT; handle_id++) {
+    fb_ids.push_back(Present(Buffer(handle_id, false)));
+  }
+  // Buffer 2 becomes the least recently used one
+  Present(Buffer(1, false));
+  Present(Buffer(3, false));
+  Present(Buffer(4, false));
+
+  Present(Buffer(UI_FBID_LIMIT + 1, false));
+  EXPECT_EQ(1, fb_ids_.removes);
+  EXPECT_EQ(0u, fb_ids_.live.count(fb_ids[1]));
+  EXPECT_EQ(UI_FBID_LIMIT, CacheSize());
+  EXPECT_EQ(fb_ids[0], Present(Buffer(1, false)));
+  EXPECT_EQ(fb_ids[2], Present(Buffer(3, false)));
+}
+
+TEST_F(FbIdRegistryTest, FormatChangeRecreatesFbId) {
+  LayerBuffer buffer = Buffer(1, false);
+  uint32_t fb_id = Present(buffer);
+  buffer.width = 1280;
+  uint32_t resized_fb_id = Present(buffer);
+  EXPECT_NE(fb_id, resized_fb_id);
+  EXPECT_EQ(0u, fb_ids_.live.count(fb_id));
+  buffer.format = kFormatRGBX8888Ubwc;
+  EXPECT_NE(resized_fb_id, Present(buffer));
+  EXPECT_EQ(1u, CacheSize());
+}
+
+// An fb id still being scanned out is skipped, the map goes over budget if nothing else is
+// free, and shrinks back once the fences signal.
+TEST_F(FbIdRegistryTest, InFlightFbIdsAreKept) {
+  std::vector<shared_ptr<Fence>> fences;
+  std::vector<uint32_t> fb_ids;
+  for (uint64_t handle_id = 1; handle_id <= UI_FBID_LIMIT; handle_id++) {
+    fb_ids.push_back(Present(Buffer(handle_id, false)));
+    // Held by hw, e.g. a writeback or a late release
+    fences.push_back(sync_handler_.CreateFence());
+    registry_->SetReleaseFence(&layer_, handle_id, fences.back());
+  }
+
+  Present(Buffer(UI_FBID_LIMIT + 1, false));
+  EXPECT_EQ(0, fb_ids_.removes);
+  EXPECT_EQ(UI_FBID_LIMIT + 1, CacheSize());
+
+  // The least recently used buffer is still held, the next one is free
+  for (size_t i = 1; i < fences.size(); i++) {
+    sync_handler_.Signal(fences[i]);
+  }
+  Present(Buffer(UI_FBID_LIMIT + 2, false));
+  EXPECT_EQ(1u, fb_ids_.live.count(fb_ids[0]));
+  EXPECT_EQ(0u, fb_ids_.live.count(fb_ids[1]));
+
+  std::ostringstream os;
+  registry_->Dump(&os);
+  EXPECT_NE(std::string::npos, os.str().find("over budget 1")) << os.str();
+  sync_handler_.Signal(fences[0]);
+}
+
+// A video stream cycling through more buffers than the budget, then switching to a new set of
+// buffers as after a seek or a resolution change. Every frame creates and removes at most one fb
+// id; flushing the map instead created a burst of them in a single frame.
+TEST_F(FbIdRegistryTest, VideoRotationHasNoFlushStalls) {
+  const int kPoolSize = VIDEO_FBID_LIMIT + 4;
+  const int kFrames = 600;
+  int max_creates = 0;
+  int max_removes = 0;
+
+  for (int frame = 0; frame < kFrames; frame++) {
+    uint64_t pool = 1000 * (1 + frame / (kFrames / 3));
+    int creates = fb_ids_.creates;
+    int removes = fb_ids_.removes;
+    ASSERT_NE(0u, Present(Buffer(pool + (frame % kPoolSize), true)));
+    max_creates = std::max(max_creates, fb_ids_.creates - creates);
+    max_removes = std::max(max_removes, fb_ids_.removes - removes);
+    ASSERT_LE(CacheSize(), static_cast<size_t>(VIDEO_FBID_LIMIT));
+  }
+
+  EXPECT_EQ(1, max_creates);
+  EXPECT_EQ(1, max_removes);
+  std::ostringstream os;
+  registry_->Dump(&os);
+  std::cout << kFrames << " video frames:" << os.str() << ", at most " << max_creates
+            << " fb id created and " << max_removes << " removed per frame" << std::endl;
+}
+
+TEST_F(FbIdRegistryTest, OutputBufferUsesRetireFence) {
+  LayerBuffer output[UI_FBID_LIMIT + 1];
+  for (uint32_t i = 0; i <= UI_FBID_LIMIT; i++) {
+    output[i] = Buffer(50 + i, false);
+  }
+
+  shared_ptr<Fence> retire_fence;
+  for (uint32_t i = 0; i < UI_FBID_LIMIT; i++) {
+    if (retire_fence) {
+      sync_handler_.Signal(retire_fence);
+    }
+    registry_->MapOutputBufferToFbId(&output[i]);
+    retire_fence = sync_handler_.CreateFence();
+    registry_->SetOutputReleaseFence(output[i].handle_id, retire_fence);
+  }
+  uint32_t last_fb_id = registry_->GetOutputFbId(output[UI_FBID_LIMIT - 1].handle_id);
+
+  // Only the output being written is pending, the oldest one is evicted
+  registry_->MapOutputBufferToFbId(&output[UI_FBID_LIMIT]);
+  EXPECT_EQ(0u, registry_->GetOutputFbId(output[0].handle_id));
+  EXPECT_NE(0u, registry_->GetOutputFbId(output[UI_FBID_LIMIT].handle_id));
+  EXPECT_EQ(last_fb_id, registry_->GetOutputFbId(output[UI_FBID_LIMIT - 1].handle_id));
+  sync_handler_.Signal(retire_fence);
+  registry_->Clear();
+}
+
+}  // namespace sdm
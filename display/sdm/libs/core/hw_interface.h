@@ -67,6 +67,7 @@
 #include <private/color_interface.h>
 #include <private/panel_feature_property_intf.h>
 #include <utils/constants.h>
+#include <sstream>
 #include <string>
 
 #include "hw_info_interface.h"
@@ -153,6 +154,7 @@ class HWInterface {
   virtual DisplayError SetMixerAttributes(const HWMixerAttributes &mixer_attributes) = 0;
   virtual DisplayError GetMixerAttributes(HWMixerAttributes *mixer_attributes) = 0;
   virtual DisplayError DumpDebugData() = 0;
+  virtual void Dump(std::ostringstream *os) = 0;
   virtual DisplayError SetDppsFeature(void *payload, size_t size) = 0;
   virtual DisplayError GetDppsFeatureInfo(void *payload, size_t size) = 0;
   virtual DisplayError HandleSecureEvent(SecureEvent secure_event, HWLayers *hw_layers) = 0;
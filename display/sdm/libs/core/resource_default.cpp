@@ -219,57 +219,72 @@ DisplayError ResourceDefault::Prepare(Handle display_ctx, HWLayers *hw_layers) {
   DisplayError error = kErrorNone;
   const struct HWLayersInfo &layer_info = hw_layers->info;
   HWBlockType hw_block_type = display_resource_ctx->hw_block_type;
+  uint32_t hw_layer_count = UINT32(layer_info.hw_layers.size());
 
   DLOGV_IF(kTagResources, "==== Resource reserving start: hw_block_type = %d ====", hw_block_type);
 
-  if (layer_info.hw_layers.size() > 1) {
-    DLOGV_IF(kTagResources, "More than one FB layers");
+  if (!hw_layer_count || hw_layer_count > UINT32(kMaxSDELayers)) {
+    DLOGV_IF(kTagResources, "Invalid number of layers %d", hw_layer_count);
     return kErrorResources;
   }
 
-  const Layer &layer = layer_info.hw_layers.at(0);
-
-  if (layer.composition != kCompositionGPUTarget) {
-    DLOGV_IF(kTagResources, "Not an FB layer");
-    return kErrorParameters;
-  }
-
-  error = Config(display_resource_ctx, hw_layers);
-  if (error != kErrorNone) {
-    DLOGV_IF(kTagResources, "Resource config failed");
-    return error;
-  }
-
   for (uint32_t i = 0; i < num_pipe_; i++) {
     if (src_pipes_[i].hw_block_type == hw_block_type && src_pipes_[i].owner == kPipeOwnerUserMode) {
       src_pipes_[i].ResetState();
     }
   }
 
+  // Layers are staged bottom to top in the order chosen by the strategy.
+  for (uint32_t i = 0; i < hw_layer_count; i++) {
+    const Layer &layer = layer_info.hw_layers.at(i);
+
+    if (layer.composition != kCompositionGPUTarget && layer.composition != kCompositionSDE) {
+      DLOGV_IF(kTagResources, "Layer %d is neither an FB layer nor an SDE layer", i);
+      return kErrorParameters;
+    }
+
+    error = Config(display_resource_ctx, hw_layers, i);
+    if (error != kErrorNone) {
+      DLOGV_IF(kTagResources, "Resource config failed for layer %d", i);
+      return error;
+    }
+
+    error = AcquirePipes(hw_block_type, layer, &hw_layers->config[i]);
+    if (error != kErrorNone) {
+      DLOGV_IF(kTagResources, "Resource reserving failed! hw_block_type = %d", hw_block_type);
+      return error;
+    }
+  }
+
+  return kErrorNone;
+}
+
+DisplayError ResourceDefault::AcquirePipes(HWBlockType hw_block_type, const Layer &layer,
+                                           HWLayerConfig *layer_config) {
+  DisplayError error = kErrorNone;
   uint32_t left_index = num_pipe_;
   uint32_t right_index = num_pipe_;
   bool need_scale = false;
+  bool is_yuv = IsYuvFormat(layer.input_buffer.format);
 
-  struct HWLayerConfig &layer_config = hw_layers->config[0];
-
-  HWPipeInfo *left_pipe = &layer_config.left_pipe;
-  HWPipeInfo *right_pipe = &layer_config.right_pipe;
+  HWPipeInfo *left_pipe = &layer_config->left_pipe;
+  HWPipeInfo *right_pipe = &layer_config->right_pipe;
 
   // left pipe is needed
   if (left_pipe->valid) {
     need_scale = IsScalingNeeded(left_pipe);
-    left_index = GetPipe(hw_block_type, need_scale);
+    left_index = GetPipe(hw_block_type, need_scale, is_yuv);
     if (left_index >= num_pipe_) {
       DLOGV_IF(kTagResources, "Get left pipe failed: hw_block_type = %d, need_scale = %d",
                hw_block_type, need_scale);
       ResourceStateLog();
-      goto CleanupOnError;
+      return kErrorResources;
     }
   }
 
   error = SetDecimationFactor(left_pipe);
   if (error != kErrorNone) {
-    goto CleanupOnError;
+    return kErrorResources;
   }
 
   if (!right_pipe->valid) {
@@ -277,18 +292,18 @@ DisplayError ResourceDefault::Prepare(Handle display_ctx, HWLayers *hw_layers) {
     if (left_index < num_pipe_) {
       left_pipe->pipe_id = src_pipes_[left_index].mdss_pipe_id;
     }
-    DLOGV_IF(kTagResources, "1 pipe acquired for FB layer, left_pipe = %x", left_pipe->pipe_id);
+    DLOGV_IF(kTagResources, "1 pipe acquired for layer, left_pipe = %x", left_pipe->pipe_id);
     return kErrorNone;
   }
 
   need_scale = IsScalingNeeded(right_pipe);
 
-  right_index = GetPipe(hw_block_type, need_scale);
+  right_index = GetPipe(hw_block_type, need_scale, is_yuv);
   if (right_index >= num_pipe_) {
     DLOGV_IF(kTagResources, "Get right pipe failed: hw_block_type = %d, need_scale = %d",
              hw_block_type, need_scale);
     ResourceStateLog();
-    goto CleanupOnError;
+    return kErrorResources;
   }
 
   if (src_pipes_[right_index].priority < src_pipes_[left_index].priority) {
@@ -302,18 +317,13 @@ DisplayError ResourceDefault::Prepare(Handle display_ctx, HWLayers *hw_layers) {
 
   error = SetDecimationFactor(right_pipe);
   if (error != kErrorNone) {
-    goto CleanupOnError;
+    return kErrorResources;
   }
 
-  DLOGV_IF(kTagResources, "2 pipes acquired for FB layer, left_pipe = %x, right_pipe = %x",
+  DLOGV_IF(kTagResources, "2 pipes acquired for layer, left_pipe = %x, right_pipe = %x",
            left_pipe->pipe_id,  right_pipe->pipe_id);
 
   return kErrorNone;
-
-CleanupOnError:
-  DLOGV_IF(kTagResources, "Resource reserving failed! hw_block_type = %d", hw_block_type);
-
-  return kErrorResources;
 }
 
 DisplayError ResourceDefault::PostPrepare(Handle display_ctx, HWLayers *hw_layers) {
@@ -406,9 +416,14 @@ uint32_t ResourceDefault::NextPipe(PipeType type, HWBlockType hw_block_type) {
   return SearchPipe(hw_block_type, src_pipes, num_pipe);
 }
 
-uint32_t ResourceDefault::GetPipe(HWBlockType hw_block_type, bool need_scale) {
+uint32_t ResourceDefault::GetPipe(HWBlockType hw_block_type, bool need_scale, bool is_yuv) {
   uint32_t index = num_pipe_;
 
+  // Only VIG pipes can fetch YUV formats
+  if (is_yuv) {
+    return NextPipe(kPipeTypeVIG, hw_block_type);
+  }
+
   // The default behavior is to assume RGB and VG pipes have scalars
   if (!need_scale) {
     index = NextPipe(kPipeTypeDMA, hw_block_type);
@@ -525,17 +540,17 @@ DisplayError ResourceDefault::DisplaySplitConfig(DisplayResourceContext *display
 }
 
 DisplayError ResourceDefault::Config(DisplayResourceContext *display_resource_ctx,
-                                HWLayers *hw_layers) {
+                                HWLayers *hw_layers, uint32_t index) {
   HWLayersInfo &layer_info = hw_layers->info;
   DisplayError error = kErrorNone;
-  const Layer &layer = layer_info.hw_layers.at(0);
+  const Layer &layer = layer_info.hw_layers.at(index);
 
   error = ValidateLayerParams(&layer);
   if (error != kErrorNone) {
     return error;
   }
 
-  struct HWLayerConfig *layer_config = &hw_layers->config[0];
+  struct HWLayerConfig *layer_config = &hw_layers->config[index];
   HWPipeInfo &left_pipe = layer_config->left_pipe;
   HWPipeInfo &right_pipe = layer_config->right_pipe;
 
@@ -570,9 +585,9 @@ DisplayError ResourceDefault::Config(DisplayResourceContext *display_resource_ct
   }
 
   // set z_order, left_pipe should always be valid
-  left_pipe.z_order = 0;
+  left_pipe.z_order = index;
 
-  DLOGV_IF(kTagResources, "==== FB layer Config ====");
+  DLOGV_IF(kTagResources, "==== Layer %d Config ====", index);
   Log(kTagResources, "input layer src_rect", layer.src_rect);
   Log(kTagResources, "input layer dst_rect", layer.dst_rect);
   Log(kTagResources, "cropped src_rect", src_rect);
@@ -580,7 +595,7 @@ DisplayError ResourceDefault::Config(DisplayResourceContext *display_resource_ct
   Log(kTagResources, "left pipe src", layer_config->left_pipe.src_roi);
   Log(kTagResources, "left pipe dst", layer_config->left_pipe.dst_roi);
   if (right_pipe.valid) {
-    right_pipe.z_order = 0;
+    right_pipe.z_order = index;
     Log(kTagResources, "right pipe src", layer_config->right_pipe.src_roi);
     Log(kTagResources, "right pipe dst", layer_config->right_pipe.dst_roi);
   }
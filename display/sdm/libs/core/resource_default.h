@@ -120,9 +120,12 @@ class ResourceDefault : public ResourceInterface {
   DisplayError Deinit();
   uint32_t NextPipe(PipeType pipe_type, HWBlockType hw_block_type);
   uint32_t SearchPipe(HWBlockType hw_block_type, SourcePipe *src_pipes, uint32_t num_pipe);
-  uint32_t GetPipe(HWBlockType hw_block_type, bool need_scale);
+  uint32_t GetPipe(HWBlockType hw_block_type, bool need_scale, bool is_yuv);
+  DisplayError AcquirePipes(HWBlockType hw_block_type, const Layer &layer,
+                            HWLayerConfig *layer_config);
   bool IsScalingNeeded(const HWPipeInfo *pipe_info);
-  DisplayError Config(DisplayResourceContext *display_resource_ctx, HWLayers *hw_layers);
+  DisplayError Config(DisplayResourceContext *display_resource_ctx, HWLayers *hw_layers,
+                      uint32_t index);
   DisplayError DisplaySplitConfig(DisplayResourceContext *display_resource_ctx,
                                  const LayerRect &src_rect, const LayerRect &dst_rect,
                                  HWLayerConfig *layer_config);
@@ -24,6 +24,9 @@
 
 #include <utils/constants.h>
 #include <utils/debug.h>
+#include <utils/formats.h>
+#include <math.h>
+#include <algorithm>
 #include <vector>
 
 #include "strategy.h"
@@ -52,6 +55,11 @@ Strategy::Strategy(ExtensionInterface *extension_intf,
 DisplayError Strategy::Init() {
   DisplayError error = kErrorNone;
 
+  int value = 0;
+  if (Debug::GetProperty(DISABLE_DEFAULT_STRATEGY_PROP, &value) == kErrorNone) {
+    disable_default_strategy_ = (value == 1);
+  }
+
   if (extension_intf_) {
     error = extension_intf_->CreateStrategyExtn(display_id_, display_type_, buffer_allocator_,
                                                 hw_resource_info_, hw_panel_info_,
@@ -109,7 +117,7 @@ DisplayError Strategy::Start(HWLayersInfo *hw_layers_info, uint32_t *max_attempt
     }
   }
 
-  *max_attempts = 1;
+  *max_attempts = StartDefaultStrategy();
 
   return kErrorNone;
 }
@@ -127,42 +135,278 @@ DisplayError Strategy::GetNextStrategy(StrategyConstraints *constraints) {
     return strategy_intf_->GetNextStrategy(constraints);
   }
 
+  return GetNextDefaultStrategy(*constraints);
+}
+
+uint32_t Strategy::StartDefaultStrategy() {
+  uint32_t app_layer_count = hw_layers_info_->app_layer_count;
+  LayerStack *layer_stack = hw_layers_info_->stack;
+
+  default_strategy_exhausted_ = false;
+  batch_start_ = 0;
+  batch_end_ = app_layer_count;
+  if (disable_default_strategy_) {
+    return 1;
+  }
+
+  // The initial batch is the smallest contiguous range that covers every layer SDE can not fetch.
+  uint32_t first = app_layer_count;
+  uint32_t last = 0;
+  for (uint32_t i = 0; i < app_layer_count; i++) {
+    if (!IsOverlayCandidate(*layer_stack->layers.at(i))) {
+      first = std::min(first, i);
+      last = i + 1;
+    }
+  }
+
+  if (first < last) {
+    batch_start_ = first;
+    batch_end_ = last;
+  } else {
+    batch_start_ = batch_end_ = 0;
+  }
+
+  // One attempt per layer that can still move into the batch, plus the current one.
+  return app_layer_count - (batch_end_ - batch_start_) + 1;
+}
+
+DisplayError Strategy::GetNextDefaultStrategy(const StrategyConstraints &constraints) {
+  uint32_t app_layer_count = hw_layers_info_->app_layer_count;
+  LayerStack *layer_stack = hw_layers_info_->stack;
+
+  if (default_strategy_exhausted_) {
+    return kErrorNotSupported;
+  }
+
+  if (constraints.safe_mode) {
+    batch_start_ = 0;
+    batch_end_ = app_layer_count;
+  }
+
+  uint32_t num_pipes = hw_resource_info_.num_vig_pipe + hw_resource_info_.num_dma_pipe +
+                       hw_resource_info_.num_rgb_pipe;
+  uint32_t num_stages = 0;
+  while ((GetStageCount(&num_stages) > constraints.max_layers || num_stages > num_pipes) &&
+         GrowGPUBatch()) {}
+
+  bool gpu_batch = (batch_end_ > batch_start_);
   // Do not fallback to GPU if GPU comp is disabled.
-  if (disable_gpu_comp_) {
+  if (gpu_batch && disable_gpu_comp_) {
     return kErrorNotSupported;
   }
 
-  // Mark all application layers for GPU composition. Find GPU target buffer and store its index for
-  // programming the hardware.
+  hw_layers_info_->hw_layers.clear();
+  hw_layers_info_->index.clear();
+  hw_layers_info_->roi_index.clear();
+
+  // Stage the layers bottom to top, the GPU target takes the place of the batch.
+  for (uint32_t i = 0; i < app_layer_count; i++) {
+    Layer *layer = layer_stack->layers.at(i);
+    layer->request.flags.request_flags = 0;  // Reset layer request
+    if (i >= batch_start_ && i < batch_end_) {
+      layer->composition = kCompositionGPU;
+      if (i == batch_start_) {
+        AddHWLayer(hw_layers_info_->gpu_target_index);
+      }
+    } else {
+      layer->composition = kCompositionSDE;
+      AddHWLayer(i);
+    }
+  }
+
+  DLOGV_IF(kTagResources, "GPU batch [%d, %d) of %d app layers", batch_start_, batch_end_,
+           app_layer_count);
+
+  // Set up the next attempt in case resources can not be allocated for this one.
+  default_strategy_exhausted_ = !GrowGPUBatch();
+
+  return kErrorNone;
+}
+
+bool Strategy::IsOverlayCandidate(const Layer &layer) {
+  const LayerBuffer &input_buffer = layer.input_buffer;
+  const LayerRect &src = layer.src_rect;
+  const LayerRect &dst = layer.dst_rect;
+
+  if (layer.flags.skip || layer.flags.solid_fill || layer.flags.color_transform ||
+      input_buffer.planes[0].fd < 0 || input_buffer.format == kFormatInvalid) {
+    return false;
+  }
+
+  // Rotation needs a rotator, tone mapping and deinterlacing are not handled here.
+  if (layer.transform.rotation != 0.0f || input_buffer.flags.hdr || input_buffer.flags.interlace) {
+    return false;
+  }
+
+  bool is_yuv = IsYuvFormat(input_buffer.format);
+  // Pipes do no gamut or gamma conversion, content has to be in the blend space already. The
+  // range of YUV content is handled by the CSC of the VIG pipe, RGB content has to be full range.
+  const ColorMetaData &color_metadata = input_buffer.color_metadata;
+  if (color_metadata.colorPrimaries != blend_space_.primaries ||
+      color_metadata.transfer != blend_space_.transfer ||
+      (!is_yuv && color_metadata.range != Range_Full)) {
+    return false;
+  }
+
+  if (!IsValid(src) || !IsValid(dst) || (src.left != roundf(src.left)) ||
+      (src.top != roundf(src.top)) || (src.right != roundf(src.right)) ||
+      (src.bottom != roundf(src.bottom))) {
+    return false;
+  }
+
+  auto is_supported = [&](HWSubBlockType sub_block_type, uint32_t num_pipe) {
+    if (!num_pipe) {
+      return false;
+    }
+    auto it = hw_resource_info_.supported_formats_map.find(sub_block_type);
+    if (it == hw_resource_info_.supported_formats_map.end()) {
+      return true;
+    }
+    return std::find(it->second.begin(), it->second.end(), input_buffer.format) !=
+           it->second.end();
+  };
+
+  if (!is_supported(kHWVIGPipe, hw_resource_info_.num_vig_pipe) &&
+      (is_yuv || !is_supported(kHWDMAPipe, hw_resource_info_.num_dma_pipe))) {
+    return false;
+  }
+
+  float scale_x = (src.right - src.left) / (dst.right - dst.left);
+  float scale_y = (src.bottom - src.top) / (dst.bottom - dst.top);
+  if (scale_x != 1.0f || scale_y != 1.0f) {
+    float max_scale_down = FLOAT(hw_resource_info_.max_scale_down);
+    float max_scale_up = FLOAT(hw_resource_info_.max_scale_up);
+    if (!hw_resource_info_.num_vig_pipe || scale_x > max_scale_down ||
+        scale_y > max_scale_down || (1.0f / scale_x) > max_scale_up ||
+        (1.0f / scale_y) > max_scale_up) {
+      return false;
+    }
+  }
+
+  // Wider layers would need more than a pair of pipes.
+  if ((src.right - src.left) > FLOAT(2 * hw_resource_info_.max_pipe_width)) {
+    return false;
+  }
+
+  return true;
+}
+
+bool Strategy::GrowGPUBatch() {
+  uint32_t app_layer_count = hw_layers_info_->app_layer_count;
   LayerStack *layer_stack = hw_layers_info_->stack;
+
+  if (batch_start_ == 0 && batch_end_ == app_layer_count) {
+    return false;
+  }
+
+  auto area = [&](uint32_t index) {
+    const LayerRect &dst = layer_stack->layers.at(index)->dst_rect;
+    return (dst.right - dst.left) * (dst.bottom - dst.top);
+  };
+
+  // Large layers save the most GPU and bandwidth on SDE, so the smallest ones move first.
+  if (batch_start_ == batch_end_) {
+    uint32_t smallest = 0;
+    for (uint32_t i = 1; i < app_layer_count; i++) {
+      if (area(i) < area(smallest)) {
+        smallest = i;
+      }
+    }
+    batch_start_ = smallest;
+    batch_end_ = smallest + 1;
+    return true;
+  }
+
+  bool grow_down = (batch_start_ > 0);
+  if (grow_down && batch_end_ < app_layer_count) {
+    grow_down = (area(batch_start_ - 1) <= area(batch_end_));
+  }
+
+  if (grow_down) {
+    batch_start_--;
+  } else {
+    batch_end_++;
+  }
+
+  return true;
+}
+
+uint32_t Strategy::GetStageCount(uint32_t *num_pipes) {
+  LayerStack *layer_stack = hw_layers_info_->stack;
+  uint32_t num_layers = 0;
+
+  *num_pipes = 0;
   for (uint32_t i = 0; i < hw_layers_info_->app_layer_count; i++) {
-    layer_stack->layers.at(i)->composition = kCompositionGPU;
-    layer_stack->layers.at(i)->request.flags.request_flags = 0;  // Reset layer request
+    if (i >= batch_start_ && i < batch_end_) {
+      continue;
+    }
+    *num_pipes += GetPipeCount(*layer_stack->layers.at(i));
+    num_layers++;
+  }
+
+  if (batch_end_ > batch_start_) {
+    *num_pipes += GetPipeCount(*layer_stack->layers.at(hw_layers_info_->gpu_target_index));
+    num_layers++;
+  }
+
+  return num_layers;
+}
+
+uint32_t Strategy::GetPipeCount(const Layer &layer) {
+  const LayerRect &src = layer.src_rect;
+  LayerRect dst = GetMixerRect(layer);
+  float src_width = src.right - src.left;
+  float dst_width = dst.right - dst.left;
+  float max_pipe_width = FLOAT(hw_resource_info_.max_pipe_width);
+
+  if (src_width != dst_width) {
+    max_pipe_width = FLOAT(hw_resource_info_.max_scaler_pipe_width);
+  }
+
+  // Same split rules as the resource manager: wide layers are fetched by a pair of pipes, and
+  // each side of the mixer split needs its own pipe.
+  float split_left = FLOAT(mixer_attributes_.split_left);
+  if (src_width > max_pipe_width || dst_width > max_pipe_width ||
+      (dst.left < split_left && dst.right > split_left)) {
+    return 2;
   }
 
+  return 1;
+}
+
+LayerRect Strategy::GetMixerRect(const Layer &layer) {
   // When mixer resolution and panel resolutions are same (1600x2560) and FB resolution is
   // 1080x1920 FB_Target destination coordinates(mapped to FB resolution 1080x1920) need to
   // be mapped to destination coordinates of mixer resolution(1600x2560).
-  Layer *gpu_target_layer = layer_stack->layers.at(hw_layers_info_->gpu_target_index);
   float layer_mixer_width = FLOAT(mixer_attributes_.width);
   float layer_mixer_height = FLOAT(mixer_attributes_.height);
   float fb_width = FLOAT(fb_config_.x_pixels);
   float fb_height = FLOAT(fb_config_.y_pixels);
   LayerRect src_domain = (LayerRect){0.0f, 0.0f, fb_width, fb_height};
   LayerRect dst_domain = (LayerRect){0.0f, 0.0f, layer_mixer_width, layer_mixer_height};
+  LayerTransform transform = layer.transform;
+  LayerRect dst_rect;
 
-  Layer layer = *gpu_target_layer;
-  hw_layers_info_->index.push_back(hw_layers_info_->gpu_target_index);
+  transform.flip_horizontal ^= hw_panel_info_.panel_orientation.flip_horizontal;
+  transform.flip_vertical ^= hw_panel_info_.panel_orientation.flip_vertical;
+  // Flip rect to match transform.
+  TransformHV(src_domain, layer.dst_rect, transform, &dst_rect);
+  // Scale to mixer resolution.
+  MapRect(src_domain, dst_domain, dst_rect, &dst_rect);
+
+  return dst_rect;
+}
+
+void Strategy::AddHWLayer(uint32_t index) {
+  LayerStack *layer_stack = hw_layers_info_->stack;
+
+  Layer layer = *layer_stack->layers.at(index);
+  hw_layers_info_->index.push_back(index);
   hw_layers_info_->roi_index.push_back(0);
+  layer.dst_rect = GetMixerRect(layer);
   layer.transform.flip_horizontal ^= hw_panel_info_.panel_orientation.flip_horizontal;
   layer.transform.flip_vertical ^= hw_panel_info_.panel_orientation.flip_vertical;
-  // Flip rect to match transform.
-  TransformHV(src_domain, layer.dst_rect, layer.transform, &layer.dst_rect);
-  // Scale to mixer resolution.
-  MapRect(src_domain, dst_domain, layer.dst_rect, &layer.dst_rect);
   hw_layers_info_->hw_layers.push_back(layer);
-
-  return kErrorNone;
 }
 
 void Strategy::GenerateROI() {
@@ -268,6 +512,7 @@ DisplayError Strategy::SetColorModesInfo(const std::vector<PrimariesTransfer> &c
 }
 
 DisplayError Strategy::SetBlendSpace(const PrimariesTransfer &blend_space) {
+  blend_space_ = blend_space;
   if (strategy_intf_) {
     return strategy_intf_->SetBlendSpace(blend_space);
   }
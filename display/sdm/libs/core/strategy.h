@@ -58,9 +58,22 @@ class Strategy {
   bool CanSkipValidate(bool *needs_buffer_swap);
   void GenerateROI(HWLayersInfo *hw_layers_info, const PUConstraints &pu_constraints);
   DisplayError SwapBuffers();
+  bool UsesDefaultStrategy() { return !extn_start_success_; }
 
  private:
   void GenerateROI();
+  // Built-in strategy, used when the strategy extension is not available. Layers that SDE can
+  // not fetch are composed by GPU in one contiguous batch, every other layer gets its own pipe.
+  // Each failed attempt moves one more layer into the batch, down to full GPU composition.
+  uint32_t StartDefaultStrategy();
+  DisplayError GetNextDefaultStrategy(const StrategyConstraints &constraints);
+  bool IsOverlayCandidate(const Layer &layer);
+  bool GrowGPUBatch();
+  // Returns the number of staged layers and the pipes they need for the current GPU batch.
+  uint32_t GetStageCount(uint32_t *num_pipes);
+  uint32_t GetPipeCount(const Layer &layer);
+  LayerRect GetMixerRect(const Layer &layer);
+  void AddHWLayer(uint32_t index);
 
   ExtensionInterface *extension_intf_ = NULL;
   StrategyInterface *strategy_intf_ = NULL;
@@ -75,7 +88,12 @@ class Strategy {
   DisplayConfigVariableInfo fb_config_ = {};
   bool extn_start_success_ = false;
   bool disable_gpu_comp_ = false;
+  bool disable_default_strategy_ = false;
   BufferAllocator *buffer_allocator_ = NULL;
+  uint32_t batch_start_ = 0;  // First app layer composed by GPU
+  uint32_t batch_end_ = 0;    // One past the last app layer composed by GPU
+  bool default_strategy_exhausted_ = false;
+  PrimariesTransfer blend_space_ = {};  // Colour space the mixer blends in
 };
 
 }  // namespace sdm
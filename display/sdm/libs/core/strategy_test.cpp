@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+#include <utils/constants.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "strategy.h"
+
+namespace sdm {
+
+namespace {
+
+const uint32_t kFbWidth = 1080;
+const uint32_t kFbHeight = 2400;
+
+struct TestLayer {
+  LayerRect dst;
+  LayerBufferFormat format = kFormatRGBA8888;
+  float scale = 1.0f;  // src size over dst size
+  bool skip = false;
+  float rotation = 0.0f;
+  ColorPrimaries primaries = ColorPrimaries_BT709_5;
+  GammaTransfer transfer = Transfer_sRGB;
+  ColorRange range = Range_Full;
+};
+
+struct TestResources {
+  uint32_t num_vig_pipe = 2;
+  uint32_t num_dma_pipe = 2;
+  uint32_t max_pipe_width = 2048;
+  uint32_t max_layers = kMaxSDELayers;
+  uint32_t split_left = kFbWidth;  // No mixer split when it equals the mixer width
+  PrimariesTransfer blend_space = {};
+  bool safe_mode = false;
+};
+
+struct StrategyCase {
+  const char *name;
+  std::vector<TestLayer> layers;
+  TestResources resources;
+  // Composition of each app layer on the first attempt, S for SDE and G for GPU.
+  const char *first;
+  uint32_t max_attempts;
+};
+
+TestLayer Rect(float left, float top, float right, float bottom) {
+  TestLayer layer;
+  layer.dst = {left, top, right, bottom};
+  return layer;
+}
+
+TestLayer FullScreen() { return Rect(0.0f, 0.0f, kFbWidth, kFbHeight); }
+
+TestLayer Video(TestLayer layer) {
+  layer.format = kFormatYCbCr420SemiPlanarVenus;
+  return layer;
+}
+
+template <class T>
+TestLayer With(TestLayer layer, T TestLayer::*field, T value) {
+  layer.*field = value;
+  return layer;
+}
+
+const StrategyCase kCases[] = {
+  {"AllOnPipes", {FullScreen(), Rect(0, 0, 1080, 200), Rect(0, 2200, 1080, 2400)}, {},
+   "SSS", 4},
+  {"SkipLayerInTheMiddle",
+   {FullScreen(), With(Rect(0, 0, 1080, 200), &TestLayer::skip, true), Rect(0, 2200, 1080, 2400)},
+   {}, "SGS", 3},
+  {"BatchCoversEverythingBetweenSkipLayers",
+   {FullScreen(), With(Rect(0, 0, 1080, 200), &TestLayer::skip, true), Rect(0, 500, 1080, 600),
+    With(Rect(0, 900, 1080, 1000), &TestLayer::skip, true), Rect(0, 2200, 1080, 2400)},
+   {}, "SGGGS", 3},
+  {"SmallestLayersMoveToGPUFirst",
+   {FullScreen(), Rect(0, 0, 1080, 200), Rect(0, 300, 1080, 400), Rect(0, 500, 1080, 650),
+    FullScreen()},
+   {}, "SSGGS", 6},
+  {"MaxLayersConstraint",
+   {FullScreen(), Rect(0, 0, 1080, 200), Rect(0, 300, 1080, 400)},
+   {2, 2, 2048, 2}, "SGG", 4},
+  {"WideLayersTakeTwoPipes",
+   {FullScreen(), Rect(0, 0, 1080, 400), Rect(0, 500, 500, 800)},
+   {2, 2, 1024}, "SGG", 4},
+  {"LayersCrossingTheSplitTakeTwoPipes",
+   {FullScreen(), Rect(0, 0, 1080, 400), Rect(0, 500, 500, 800)},
+   {2, 2, 2048, kMaxSDELayers, 540}, "SGG", 4},
+  {"LayersOnOneSideOfTheSplit",
+   {Rect(0, 0, 540, 2400), Rect(540, 0, 1080, 2400), Rect(0, 0, 500, 300),
+    Rect(600, 0, 1000, 300)},
+   {2, 2, 2048, kMaxSDELayers, 540}, "SSSS", 5},
+  {"RotatedLayer", {FullScreen(), With(Rect(0, 0, 1080, 200), &TestLayer::rotation, 90.0f)}, {},
+   "SG", 2},
+  {"ScaledLayerUsesVIG", {FullScreen(), With(Rect(0, 0, 540, 200), &TestLayer::scale, 2.0f)},
+   {}, "SS", 3},
+  {"ScaledLayerWithoutVIG", {FullScreen(), With(Rect(0, 0, 540, 200), &TestLayer::scale, 2.0f)},
+   {0, 4}, "SG", 2},
+  {"ScaleBeyondLimit", {FullScreen(), With(Rect(0, 0, 108, 240), &TestLayer::scale, 10.0f)}, {},
+   "SG", 2},
+  {"VideoUsesVIG", {FullScreen(), Video(Rect(0, 0, 1080, 600))}, {}, "SS", 3},
+  {"VideoWithoutVIG", {FullScreen(), Video(Rect(0, 0, 1080, 600))}, {0, 4}, "SG", 2},
+  {"LimitedRangeVideo",
+   {FullScreen(), With(Video(Rect(0, 0, 1080, 600)), &TestLayer::range, Range_Limited)}, {},
+   "SS", 3},
+  {"LimitedRangeRGB", {FullScreen(), With(Rect(0, 0, 1080, 200), &TestLayer::range, Range_Limited)},
+   {}, "SG", 2},
+  {"P3LayerInSRGBBlendSpace",
+   {FullScreen(), With(Rect(0, 0, 1080, 200), &TestLayer::primaries, ColorPrimaries_DCIP3)},
+   {}, "SG", 2},
+  {"P3LayerInP3BlendSpace",
+   {With(FullScreen(), &TestLayer::primaries, ColorPrimaries_DCIP3),
+    With(Rect(0, 0, 1080, 200), &TestLayer::primaries, ColorPrimaries_DCIP3)},
+   {2, 2, 2048, kMaxSDELayers, kFbWidth, {ColorPrimaries_DCIP3, Transfer_sRGB}}, "SS", 3},
+  {"GammaMismatch",
+   {FullScreen(), With(Rect(0, 0, 1080, 200), &TestLayer::transfer, Transfer_Gamma2_2)},
+   {}, "SG", 2},
+  {"SafeMode", {FullScreen(), Rect(0, 0, 1080, 200)},
+   {2, 2, 2048, kMaxSDELayers, kFbWidth, {}, true}, "GG", 3},
+};
+
+}  // namespace
+
+class StrategyTest : public ::testing::TestWithParam<StrategyCase> {
+ protected:
+  // Sets up the display and the stack of the case, the GPU target is the last layer.
+  void SetUpCase(const StrategyCase &test_case) {
+    const TestResources &resources = test_case.resources;
+    HWResourceInfo hw_resource_info;
+    hw_resource_info.num_vig_pipe = resources.num_vig_pipe;
+    hw_resource_info.num_dma_pipe = resources.num_dma_pipe;
+    hw_resource_info.max_pipe_width = resources.max_pipe_width;
+    hw_resource_info.max_scaler_pipe_width = resources.max_pipe_width;
+    hw_resource_info.max_scale_down = 4;
+    hw_resource_info.max_scale_up = 20;
+
+    HWMixerAttributes mixer_attributes;
+    mixer_attributes.width = kFbWidth;
+    mixer_attributes.height = kFbHeight;
+    mixer_attributes.split_left = resources.split_left;
+    mixer_attributes.split_type = (resources.split_left < kFbWidth) ? kDualSplit : kNoSplit;
+
+    HWDisplayAttributes display_attributes;
+    display_attributes.x_pixels = kFbWidth;
+    display_attributes.y_pixels = kFbHeight;
+    DisplayConfigVariableInfo fb_config;
+    fb_config.x_pixels = kFbWidth;
+    fb_config.y_pixels = kFbHeight;
+
+    strategy_.reset(new Strategy(nullptr, nullptr, 0, kBuiltIn, hw_resource_info, HWPanelInfo(),
+                                 mixer_attributes, display_attributes, fb_config));
+    ASSERT_EQ(kErrorNone, strategy_->Init());
+    strategy_->SetBlendSpace(resources.blend_space);
+
+    layers_.clear();
+    layers_.resize(test_case.layers.size() + 1);
+    for (size_t i = 0; i < test_case.layers.size(); i++) {
+      const TestLayer &test_layer = test_case.layers[i];
+      Layer &layer = layers_[i];
+      const LayerRect &dst = test_layer.dst;
+      layer.dst_rect = dst;
+      layer.src_rect = {0.0f, 0.0f, (dst.right - dst.left) * test_layer.scale,
+                        (dst.bottom - dst.top) * test_layer.scale};
+      layer.flags.skip = test_layer.skip;
+      layer.transform.rotation = test_layer.rotation;
+      layer.input_buffer.format = test_layer.format;
+      layer.input_buffer.planes[0].fd = 10;
+      layer.input_buffer.color_metadata.colorPrimaries = test_layer.primaries;
+      layer.input_buffer.color_metadata.transfer = test_layer.transfer;
+      layer.input_buffer.color_metadata.range = test_layer.range;
+    }
+    Layer &gpu_target = layers_.back();
+    gpu_target.src_rect = {0.0f, 0.0f, kFbWidth, kFbHeight};
+    gpu_target.dst_rect = gpu_target.src_rect;
+    gpu_target.composition = kCompositionGPUTarget;
+    gpu_target.input_buffer.format = kFormatRGBA8888;
+
+    stack_.layers.clear();
+    for (Layer &layer : layers_) {
+      stack_.layers.push_back(&layer);
+    }
+    info_ = HWLayersInfo();
+    info_.stack = &stack_;
+    info_.app_layer_count = UINT32(test_case.layers.size());
+    info_.gpu_target_index = info_.app_layer_count;
+    constraints_ = StrategyConstraints();
+    constraints_.max_layers = resources.max_layers;
+    constraints_.safe_mode = resources.safe_mode;
+  }
+
+  std::string Compositions() {
+    std::string compositions;
+    for (uint32_t i = 0; i < info_.app_layer_count; i++) {
+      compositions += (layers_[i].composition == kCompositionSDE) ? 'S' : 'G';
+    }
+    return compositions;
+  }
+
+  std::unique_ptr<Strategy> strategy_;
+  std::vector<Layer> layers_;
+  LayerStack stack_;
+  HWLayersInfo info_;
+  StrategyConstraints constraints_;
+};
+
+TEST_P(StrategyTest, FirstAttempt) {
+  const StrategyCase &test_case = GetParam();
+  SetUpCase(test_case);
+
+  uint32_t max_attempts = 0;
+  ASSERT_EQ(kErrorNone, strategy_->Start(&info_, &max_attempts));
+  ASSERT_EQ(kErrorNone, strategy_->GetNextStrategy(&constraints_));
+  EXPECT_EQ(test_case.first, Compositions());
+  EXPECT_EQ(test_case.max_attempts, max_attempts);
+
+  // The staged layers are the SDE layers plus the GPU target in place of the batch.
+  std::string first = test_case.first;
+  uint32_t num_sde = UINT32(std::count(first.begin(), first.end(), 'S'));
+  EXPECT_EQ(num_sde + ((num_sde < info_.app_layer_count) ? 1 : 0), info_.hw_layers.size());
+}
+
+TEST_P(StrategyTest, AttemptsEndWithGPUComposition) {
+  const StrategyCase &test_case = GetParam();
+  SetUpCase(test_case);
+
+  uint32_t max_attempts = 0;
+  ASSERT_EQ(kErrorNone, strategy_->Start(&info_, &max_attempts));
+  uint32_t attempts = 0;
+  std::string last;
+  while (strategy_->GetNextStrategy(&constraints_) == kErrorNone) {
+    last = Compositions();
+    attempts++;
+  }
+
+  // Every attempt the stack allows is handed out, the last one composes everything on GPU.
+  EXPECT_LE(attempts, max_attempts);
+  EXPECT_EQ(std::string(info_.app_layer_count, 'G'), last);
+}
+
+INSTANTIATE_TEST_SUITE_P(DefaultStrategy, StrategyTest, ::testing::ValuesIn(kCases),
+                         [](const ::testing::TestParamInfo<StrategyCase> &info) {
+                           return std::string(info.param.name);
+                         });
+
+// Strategy selection cost of a 10 layer stack, with resources for every layer and with half of
+// them, which makes the batch grow once per missing pipe.
+TEST_F(StrategyTest, SelectionTime) {
+  const int kFrames = 10000;
+  for (uint32_t num_pipes : {10, 5}) {
+    StrategyCase test_case = {"Bench", {}, {num_pipes / 2, num_pipes - num_pipes / 2}, "", 0};
+    for (uint32_t i = 0; i < 10; i++) {
+      test_case.layers.push_back(Rect(0.0f, FLOAT(i * 200), kFbWidth, FLOAT(i * 200 + 100 + i)));
+    }
+    SetUpCase(test_case);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < kFrames; frame++) {
+      uint32_t max_attempts = 0;
+      strategy_->Start(&info_, &max_attempts);
+      strategy_->GetNextStrategy(&constraints_);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+
+    EXPECT_EQ(num_pipes, info_.hw_layers.size());
+    std::cout << "10 layers, " << num_pipes << " pipes: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / kFrames
+              << " ns per frame" << std::endl;
+  }
+}
+
+}  // namespace sdm
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <utils/constants.h>
+#include <utils/debug.h>
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "validate_cache.h"
+
+#define __CLASS__ "ValidateCache"
+
+namespace sdm {
+
+static const uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ULL;
+static const uint64_t kFnvPrime = 0x100000001b3ULL;
+
+template <class T>
+static void HashValue(const T &value, uint64_t *hash) {
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&value);
+  for (size_t i = 0; i < sizeof(T); i++) {
+    *hash = (*hash ^ bytes[i]) * kFnvPrime;
+  }
+}
+
+static void HashRect(const LayerRect &rect, uint64_t *hash) {
+  HashValue(rect.left, hash);
+  HashValue(rect.top, hash);
+  HashValue(rect.right, hash);
+  HashValue(rect.bottom, hash);
+}
+
+uint64_t ValidateCache::GetKey(const HWLayersInfo &hw_layers_info) {
+  uint64_t hash = kFnvOffsetBasis;
+
+  HashValue(hw_layers_info.app_layer_count, &hash);
+  HashValue(hw_layers_info.gpu_target_index, &hash);
+
+  // Fields are hashed one at a time, structs may have padding with undefined contents.
+  for (const Layer *layer : hw_layers_info.stack->layers) {
+    const LayerBuffer &input_buffer = layer->input_buffer;
+    // updating follows every buffer update, only the composition related flags are part of the key
+    LayerFlags flags = layer->flags;
+    flags.updating = 0;
+    HashRect(layer->src_rect, &hash);
+    HashRect(layer->dst_rect, &hash);
+    HashValue(layer->composition, &hash);
+    HashValue(layer->blending, &hash);
+    HashValue(layer->plane_alpha, &hash);
+    HashValue(layer->transform.rotation, &hash);
+    HashValue(layer->transform.flip_horizontal, &hash);
+    HashValue(layer->transform.flip_vertical, &hash);
+    HashValue(flags.flags, &hash);
+    HashValue(input_buffer.width, &hash);
+    HashValue(input_buffer.height, &hash);
+    HashValue(input_buffer.unaligned_width, &hash);
+    HashValue(input_buffer.unaligned_height, &hash);
+    HashValue(input_buffer.format, &hash);
+    HashValue(input_buffer.flags.flags, &hash);
+    HashValue(input_buffer.color_metadata.colorPrimaries, &hash);
+    HashValue(input_buffer.color_metadata.range, &hash);
+    HashValue(input_buffer.color_metadata.transfer, &hash);
+    HashValue(input_buffer.planes[0].fd >= 0, &hash);
+  }
+
+  for (const LayerRect &roi : hw_layers_info.left_frame_roi) {
+    HashRect(roi, &hash);
+  }
+  for (const LayerRect &roi : hw_layers_info.right_frame_roi) {
+    HashRect(roi, &hash);
+  }
+
+  return hash;
+}
+
+bool ValidateCache::Restore(uint64_t key, HWLayersInfo *hw_layers_info) {
+  auto it = std::find_if(entries_.begin(), entries_.end(),
+                         [key](const Entry &entry) { return entry.key == key; });
+  LayerStack *layer_stack = hw_layers_info->stack;
+  if (it == entries_.end() || it->compositions.size() != hw_layers_info->app_layer_count) {
+    miss_count_++;
+    return false;
+  }
+
+  it->last_use = ++use_count_;
+  hit_count_++;
+
+  for (uint32_t i = 0; i < hw_layers_info->app_layer_count; i++) {
+    Layer *layer = layer_stack->layers.at(i);
+    layer->composition = it->compositions.at(i);
+    layer->request = it->requests.at(i);
+  }
+
+  hw_layers_info->hw_layers.clear();
+  hw_layers_info->index.clear();
+  hw_layers_info->roi_index.clear();
+  for (const StagedLayer &staged_layer : it->staged_layers) {
+    Layer hw_layer = *layer_stack->layers.at(staged_layer.index);
+    hw_layer.src_rect = staged_layer.src_rect;
+    hw_layer.dst_rect = staged_layer.dst_rect;
+    hw_layer.transform = staged_layer.transform;
+    hw_layers_info->hw_layers.push_back(hw_layer);
+    hw_layers_info->index.push_back(staged_layer.index);
+    hw_layers_info->roi_index.push_back(staged_layer.roi_index);
+  }
+
+  DLOGV_IF(kTagCompManager, "Restored %zu hw layers for key %" PRIx64, it->staged_layers.size(),
+           key);
+
+  return true;
+}
+
+void ValidateCache::Store(uint64_t key, const HWLayersInfo &hw_layers_info) {
+  auto it = std::find_if(entries_.begin(), entries_.end(),
+                         [key](const Entry &entry) { return entry.key == key; });
+  if (it == entries_.end()) {
+    if (entries_.size() < kMaxEntries) {
+      it = entries_.emplace(entries_.end());
+    } else {
+      it = std::min_element(entries_.begin(), entries_.end(),
+                            [](const Entry &a, const Entry &b) { return a.last_use < b.last_use; });
+    }
+  }
+
+  LayerStack *layer_stack = hw_layers_info.stack;
+  it->key = key;
+  it->last_use = ++use_count_;
+  it->compositions.clear();
+  it->requests.clear();
+  for (uint32_t i = 0; i < hw_layers_info.app_layer_count; i++) {
+    it->compositions.push_back(layer_stack->layers.at(i)->composition);
+    it->requests.push_back(layer_stack->layers.at(i)->request);
+  }
+
+  it->staged_layers.resize(hw_layers_info.hw_layers.size());
+  for (uint32_t i = 0; i < hw_layers_info.hw_layers.size(); i++) {
+    const Layer &hw_layer = hw_layers_info.hw_layers.at(i);
+    StagedLayer &staged_layer = it->staged_layers.at(i);
+    staged_layer.index = hw_layers_info.index.at(i);
+    staged_layer.roi_index = hw_layers_info.roi_index.at(i);
+    staged_layer.src_rect = hw_layer.src_rect;
+    staged_layer.dst_rect = hw_layer.dst_rect;
+    staged_layer.transform = hw_layer.transform;
+  }
+}
+
+void ValidateCache::Clear(ClearReason reason) {
+  if (!entries_.empty()) {
+    clear_count_[reason]++;
+  }
+  entries_.clear();
+}
+
+void ValidateCache::Dump(std::ostringstream *os) {
+  static const char *kClearReasonNames[kClearReasonMax] = {
+    "mode", "power", "color", "secure", "config", "commit failure",
+  };
+
+  *os << "\nValidate cache: entries " << entries_.size() << ", hits " << hit_count_;
+  *os << ", misses " << miss_count_ << ", clears:";
+  for (uint32_t i = 0; i < kClearReasonMax; i++) {
+    *os << " " << kClearReasonNames[i] << " " << clear_count_[i];
+  }
+}
+
+}  // namespace sdm
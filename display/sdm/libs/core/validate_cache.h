@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __VALIDATE_CACHE_H__
+#define __VALIDATE_CACHE_H__
+
+#include <private/hw_info_types.h>
+
+#include <sstream>
+#include <vector>
+
+namespace sdm {
+
+// Remembers the composition of recently validated layer stacks. A stack whose geometry hashes to
+// a cached entry gets that composition back without strategy selection or a TEST_ONLY commit.
+// Buffers, fences and damage are not part of the key, they are taken from the current stack.
+class ValidateCache {
+ public:
+  // Hash of everything strategy selection depends on: per layer geometry, format, blending,
+  // transform and flags except updating, plus the frame ROI computed for this cycle.
+  static uint64_t GetKey(const HWLayersInfo &hw_layers_info);
+
+  // Restores the app layer compositions and the staged hw layers of a cached entry.
+  bool Restore(uint64_t key, HWLayersInfo *hw_layers_info);
+  void Store(uint64_t key, const HWLayersInfo &hw_layers_info);
+  // Why the display dropped the cached compositions, counted separately in Dump().
+  enum ClearReason {
+    kClearModeChange,
+    kClearPowerChange,
+    kClearColorChange,
+    kClearSecureChange,
+    kClearConfigChange,   // Mixer, frame buffer, mixer stages, DE or composition state
+    kClearCommitFailure,  // The hardware rejected a commit of this display
+    kClearReasonMax,
+  };
+
+  // Drops all entries.
+  void Clear(ClearReason reason);
+  void Dump(std::ostringstream *os);
+
+ private:
+  static const uint32_t kMaxEntries = 4;
+
+  struct StagedLayer {
+    uint32_t index = 0;
+    uint32_t roi_index = 0;
+    LayerRect src_rect = {};
+    LayerRect dst_rect = {};
+    LayerTransform transform = {};
+  };
+
+  struct Entry {
+    uint64_t key = 0;
+    uint64_t last_use = 0;
+    std::vector<LayerComposition> compositions;
+    std::vector<LayerRequest> requests;
+    std::vector<StagedLayer> staged_layers;
+  };
+
+  std::vector<Entry> entries_;
+  uint64_t use_count_ = 0;
+  uint64_t hit_count_ = 0;
+  uint64_t miss_count_ = 0;
+  uint64_t clear_count_[kClearReasonMax] = {};
+};
+
+}  // namespace sdm
+
+#endif  // __VALIDATE_CACHE_H__
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <gtest/gtest.h>
+#include <utils/constants.h>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "strategy.h"
+#include "validate_cache.h"
+
+namespace sdm {
+
+class ValidateCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (uint32_t i = 0; i < kNumLayers; i++) {
+      Layer &layer = layers_[i];
+      layer.src_rect = {0.0f, 0.0f, 1080.0f, FLOAT(400 * (i + 1))};
+      layer.dst_rect = layer.src_rect;
+      layer.composition = kCompositionSDE;
+      layer.input_buffer.width = 1088;
+      layer.input_buffer.height = 2400;
+      layer.input_buffer.unaligned_width = 1080;
+      layer.input_buffer.unaligned_height = 2400;
+      layer.input_buffer.format = kFormatRGBA8888;
+      layer.input_buffer.color_metadata.colorPrimaries = ColorPrimaries_BT709_5;
+      layer.input_buffer.color_metadata.transfer = Transfer_sRGB;
+      layer.input_buffer.color_metadata.range = Range_Full;
+      layer.input_buffer.planes[0].fd = 10 + INT(i);
+      layer.input_buffer.buffer_id = 0x1000 + i;
+      stack_.layers.push_back(&layer);
+    }
+    info_.stack = &stack_;
+    info_.app_layer_count = kNumLayers;
+    info_.left_frame_roi.push_back({0.0f, 0.0f, 1080.0f, 2400.0f});
+  }
+
+  // Stages every layer the way strategy does for a full SDE composition.
+  void StageAll() {
+    info_.hw_layers.clear();
+    info_.index.clear();
+    info_.roi_index.clear();
+    for (uint32_t i = 0; i < kNumLayers; i++) {
+      info_.hw_layers.push_back(layers_[i]);
+      info_.index.push_back(i);
+      info_.roi_index.push_back(0);
+    }
+  }
+
+  // A new buffer for each layer: fd, buffer id and damage change, and the client marks the
+  // layers as updating.
+  void UpdateBuffers(uint32_t frame) {
+    for (uint32_t i = 0; i < kNumLayers; i++) {
+      Layer &layer = layers_[i];
+      layer.flags.updating = (frame & 1) ? 1 : 0;
+      layer.input_buffer.planes[0].fd = INT(20 + frame * kNumLayers + i);
+      layer.input_buffer.buffer_id = 0x2000 + frame * kNumLayers + i;
+      layer.dirty_regions.clear();
+      layer.dirty_regions.push_back({0.0f, 0.0f, 1080.0f, FLOAT(frame % 400)});
+    }
+  }
+
+  // Toggles between the two geometries of a UI that switches between two states, the middle layer
+  // shrinks to half the width.
+  void SetAlternateGeometry(bool alternate) {
+    layers_[1].dst_rect.right = alternate ? 540.0f : 1080.0f;
+    layers_[1].src_rect = layers_[1].dst_rect;
+  }
+
+  static constexpr uint32_t kNumLayers = 3;
+  Layer layers_[kNumLayers];
+  LayerStack stack_;
+  HWLayersInfo info_;
+  ValidateCache cache_;
+};
+
+TEST_F(ValidateCacheTest, HitAcrossBufferOnlyUpdate) {
+  uint64_t key = ValidateCache::GetKey(info_);
+  StageAll();
+  cache_.Store(key, info_);
+
+  for (uint32_t frame = 1; frame <= 4; frame++) {
+    UpdateBuffers(frame);
+    uint64_t new_key = ValidateCache::GetKey(info_);
+    EXPECT_EQ(key, new_key) << "frame " << frame;
+    ASSERT_TRUE(cache_.Restore(new_key, &info_)) << "frame " << frame;
+    ASSERT_EQ(kNumLayers, info_.hw_layers.size());
+    // Staged layers carry the buffer of the current frame.
+    for (uint32_t i = 0; i < kNumLayers; i++) {
+      EXPECT_EQ(layers_[i].input_buffer.buffer_id, info_.hw_layers.at(i).input_buffer.buffer_id);
+    }
+  }
+}
+
+TEST_F(ValidateCacheTest, MissOnGeometryChange) {
+  uint64_t key = ValidateCache::GetKey(info_);
+  StageAll();
+  cache_.Store(key, info_);
+
+  layers_[1].dst_rect.right = 540.0f;
+  uint64_t new_key = ValidateCache::GetKey(info_);
+  EXPECT_NE(key, new_key);
+  EXPECT_FALSE(cache_.Restore(new_key, &info_));
+}
+
+TEST_F(ValidateCacheTest, MissOnCompositionFlagChange) {
+  uint64_t key = ValidateCache::GetKey(info_);
+  StageAll();
+  cache_.Store(key, info_);
+
+  layers_[0].flags.skip = 1;
+  EXPECT_NE(key, ValidateCache::GetKey(info_));
+}
+
+class ValidateCacheClearTest : public ValidateCacheTest,
+                               public ::testing::WithParamInterface<ValidateCache::ClearReason> {};
+
+// Display changes drop every entry, the same geometry goes through validation again afterwards.
+TEST_P(ValidateCacheClearTest, DisplayChangeDropsEntries) {
+  uint64_t keys[2] = {};
+  for (int alternate = 0; alternate < 2; alternate++) {
+    SetAlternateGeometry(alternate);
+    keys[alternate] = ValidateCache::GetKey(info_);
+    StageAll();
+    cache_.Store(keys[alternate], info_);
+  }
+  ASSERT_NE(keys[0], keys[1]);
+  EXPECT_TRUE(cache_.Restore(keys[1], &info_));
+
+  cache_.Clear(GetParam());
+  for (int alternate = 0; alternate < 2; alternate++) {
+    SetAlternateGeometry(alternate);
+    EXPECT_EQ(keys[alternate], ValidateCache::GetKey(info_));
+    EXPECT_FALSE(cache_.Restore(keys[alternate], &info_));
+  }
+
+  // Validated again after the change, the entry is usable until the next one.
+  StageAll();
+  cache_.Store(keys[1], info_);
+  EXPECT_TRUE(cache_.Restore(keys[1], &info_));
+
+  static const char *kReasonNames[] = {
+    "mode 1", "power 1", "color 1", "secure 1", "config 1", "commit failure 1",
+  };
+  std::ostringstream os;
+  cache_.Dump(&os);
+  EXPECT_NE(std::string::npos, os.str().find(kReasonNames[GetParam()])) << os.str();
+}
+
+INSTANTIATE_TEST_SUITE_P(Reasons, ValidateCacheClearTest,
+                         ::testing::Values(ValidateCache::kClearModeChange,
+                                           ValidateCache::kClearPowerChange,
+                                           ValidateCache::kClearColorChange,
+                                           ValidateCache::kClearSecureChange,
+                                           ValidateCache::kClearConfigChange,
+                                           ValidateCache::kClearCommitFailure));
+
+// A UI toggling between two states every frame: the cost of a cache hit against strategy selection
+// for the same stacks, which a miss pays before its TEST_ONLY commit.
+TEST_F(ValidateCacheTest, AlternatingStacksTime) {
+  const int kFrames = 10000;
+  HWResourceInfo hw_resource_info;
+  hw_resource_info.num_vig_pipe = 2;
+  hw_resource_info.num_dma_pipe = 2;
+  hw_resource_info.max_pipe_width = 2048;
+  hw_resource_info.max_scaler_pipe_width = 2048;
+  hw_resource_info.max_scale_down = 4;
+  hw_resource_info.max_scale_up = 20;
+  HWMixerAttributes mixer_attributes;
+  mixer_attributes.width = 1080;
+  mixer_attributes.height = 2400;
+  mixer_attributes.split_left = 1080;
+  HWDisplayAttributes display_attributes;
+  display_attributes.x_pixels = 1080;
+  display_attributes.y_pixels = 2400;
+  DisplayConfigVariableInfo fb_config;
+  fb_config.x_pixels = 1080;
+  fb_config.y_pixels = 2400;
+  Strategy strategy(nullptr, nullptr, 0, kBuiltIn, hw_resource_info, HWPanelInfo(),
+                    mixer_attributes, display_attributes, fb_config);
+  ASSERT_EQ(kErrorNone, strategy.Init());
+
+  Layer gpu_target;
+  gpu_target.src_rect = {0.0f, 0.0f, 1080.0f, 2400.0f};
+  gpu_target.dst_rect = gpu_target.src_rect;
+  gpu_target.composition = kCompositionGPUTarget;
+  gpu_target.input_buffer.format = kFormatRGBA8888;
+  stack_.layers.push_back(&gpu_target);
+  info_.gpu_target_index = kNumLayers;
+
+  StrategyConstraints constraints;
+  auto begin = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; frame++) {
+    SetAlternateGeometry(frame & 1);
+    UpdateBuffers(UINT32(frame));
+    uint64_t key = ValidateCache::GetKey(info_);
+    uint32_t max_attempts = 0;
+    strategy.Start(&info_, &max_attempts);
+    strategy.GetNextStrategy(&constraints);
+    if (frame < 2) {
+      cache_.Store(key, info_);
+    }
+  }
+  auto strategy_time = std::chrono::steady_clock::now() - begin;
+
+  uint32_t hits = 0;
+  begin = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < kFrames; frame++) {
+    SetAlternateGeometry(frame & 1);
+    UpdateBuffers(UINT32(frame));
+    hits += cache_.Restore(ValidateCache::GetKey(info_), &info_) ? 1 : 0;
+  }
+  auto cache_time = std::chrono::steady_clock::now() - begin;
+
+  EXPECT_EQ(UINT32(kFrames), hits);
+  auto per_frame = [&](std::chrono::steady_clock::duration time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / kFrames;
+  };
+  std::cout << "Alternating stacks: cache hit " << per_frame(cache_time) << " ns, strategy "
+            << per_frame(strategy_time) << " ns per frame, without the TEST_ONLY commit"
+            << std::endl;
+}
+
+}  // namespace sdm
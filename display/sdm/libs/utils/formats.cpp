@@ -244,6 +244,10 @@ bool HasAlphaChannel(LayerBufferFormat format) {
   }
 }
 
+bool IsYuvFormat(LayerBufferFormat format) {
+  return (format >= kFormatYCbCr420Planar && format != kFormatInvalid);
+}
+
 bool IsWideColor(const ColorPrimaries &primary) {
   switch (primary) {
     case ColorPrimaries_DCIP3: